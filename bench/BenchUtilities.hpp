@@ -0,0 +1,60 @@
+// What every benchmark does the same way: reading its "--key value" options and reporting the checks that decide its
+// exit code.
+#pragma once
+
+#include <cstdio>
+#include <exception>
+#include <string>
+
+namespace Bench
+{
+    // Hands the value of every "--key value" pair on the command line to setOption, which returns false for a key it
+    // doesn't know and may throw on a value it can't read. Anything else on the command line is an error as well. On
+    // errors this prints why and returns false, and the benchmark is expected to exit with 2.
+    template <typename SetOption>
+    bool ParseOptions(int argc, char** argv, SetOption&& setOption)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string key = argv[i];
+            if (key.rfind("--", 0) != 0 || i + 1 >= argc)
+            {
+                std::fprintf(stderr, "Unexpected argument: %s\n", argv[i]);
+                return false;
+            }
+
+            try
+            {
+                if (!setOption(key.substr(2), std::string(argv[++i])))
+                {
+                    std::fprintf(stderr, "Unknown option: %s\n", key.c_str());
+                    return false;
+                }
+            }
+            catch (const std::exception&)
+            {
+                std::fprintf(stderr, "Invalid option value: %s %s\n", key.c_str(), argv[i]);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    inline bool Check(bool condition, const char* description)
+    {
+        std::printf("  %-48s %s\n", description, condition ? "ok" : "FAILED");
+        return condition;
+    }
+
+    inline std::size_t CountOccurrences(const std::string& text, const std::string& pattern)
+    {
+        std::size_t count = 0;
+        for (auto position = text.find(pattern); position != std::string::npos;
+             position = text.find(pattern, position + pattern.size()))
+        {
+            count++;
+        }
+        return count;
+    }
+}  // namespace Bench
@@ -0,0 +1,494 @@
+// Drives the capture pipeline (sub-frame blending, output fan-out, segmented encoding, statistics) with synthetic
+// frames, so its throughput can be measured without the game or a GPU.
+//
+// usage: CaptureBench [--width 1920] [--height 1080] [--fps 250] [--frames 2000] [--sub-frames 1]
+//                     [--sink null|file|images|ffmpeg[,...]] [--encoders 1] [--output capture_bench]
+//                     [--ffmpeg ffmpeg] [--csv stats.csv] [--lut grade.cube] [--grading-threads 4] [--hold 1]
+//
+// --hold shows every generated frame this many times, like a capture over a paused demo. Frames are then hashed and
+// repeats passed on as such; the images sink (one raw file per frame, written by GNU split) turns them into hard links.
+// --lut grades every frame on its way into the sinks, like a capture with colour grading enabled.
+// Several comma separated sinks are fed from the same frames, like a capture with multiple outputs.
+// --fps 0 feeds frames as fast as the pipeline accepts them. Otherwise frames are produced on a fixed schedule like a
+// real-time source, and any frame whose slot has already passed when the pipeline becomes ready is dropped.
+#include "BenchUtilities.hpp"
+#include "Capture/CaptureStatistics.hpp"
+#include "Capture/ColorGradingStage.hpp"
+#include "Capture/FrameAccumulator.hpp"
+#include "Capture/FrameFanOut.hpp"
+#include "Capture/FrameHash.hpp"
+#include "Capture/FrameSink.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace IWXMVM::Capture;
+    using Clock = CaptureStatistics::Clock;
+
+    struct BenchSettings
+    {
+        std::int32_t width = 1920;
+        std::int32_t height = 1080;
+        std::int32_t framerate = 250;
+        std::int32_t frameCount = 2000;
+        std::int32_t subFrameCount = 1;
+        std::int32_t holdCount = 1;
+        std::vector<std::string> sinks = {"null"};
+        std::int32_t encoderCount = 1;
+        std::filesystem::path output = "capture_bench";
+        std::string ffmpeg = "ffmpeg";
+        std::filesystem::path csv;
+        std::filesystem::path lut;
+        std::int32_t gradingThreadCount =
+            static_cast<std::int32_t>(std::max(std::thread::hardware_concurrency() / 2, 1u));
+
+        std::size_t GetFrameByteSize() const
+        {
+            return static_cast<std::size_t>(width) * height * 4;
+        }
+    };
+
+    class NullSink : public FrameSink
+    {
+       public:
+        bool Open() override
+        {
+            return true;
+        }
+
+        bool Write(const SharedFrame& frame) override
+        {
+            // touch the frame so handing it to the sink isn't free
+            checksum += frame->pixels.front() + frame->pixels.back();
+            return true;
+        }
+
+        bool Close() override
+        {
+            return true;
+        }
+
+        std::string GetError() const override
+        {
+            return {};
+        }
+
+       private:
+        std::uint64_t checksum = 0;
+    };
+
+    class FileSink : public FrameSink
+    {
+       public:
+        FileSink(std::filesystem::path path, CaptureStatistics& statistics)
+            : path(std::move(path)), statistics(statistics)
+        {
+        }
+
+        ~FileSink() override
+        {
+            if (file)
+                std::fclose(file);
+        }
+
+        bool Open() override
+        {
+            file = std::fopen(path.string().c_str(), "wb");
+            return file != nullptr;
+        }
+
+        bool Write(const SharedFrame& frame) override
+        {
+            ScopedStageTimer timer(&statistics, CaptureStage::PipeWrite);
+            return std::fwrite(frame->pixels.data(), frame->pixels.size(), 1, file) == 1;
+        }
+
+        bool Close() override
+        {
+            const auto result = std::fclose(file);
+            file = nullptr;
+            return result == 0;
+        }
+
+        std::string GetError() const override
+        {
+            return "Failed to write to " + path.string();
+        }
+
+       private:
+        std::filesystem::path path;
+        CaptureStatistics& statistics;
+        FILE* file = nullptr;
+    };
+
+    std::string Quote(const std::filesystem::path& path)
+    {
+        std::string quoted = "\"";
+        quoted += path.string();
+        quoted += '"';
+        return quoted;
+    }
+
+    std::string GetFFmpegCommand(const BenchSettings& settings, const std::filesystem::path& outputPath)
+    {
+        return settings.ffmpeg + " -loglevel error -f rawvideo -pix_fmt bgra -s " + std::to_string(settings.width) +
+               "x" + std::to_string(settings.height) + " -r " + std::to_string(settings.framerate) +
+               " -i - -c:v prores -profile:v 4 -q:v 1 -pix_fmt yuv444p10le -y " + Quote(outputPath);
+    }
+
+    std::unique_ptr<FrameSink> CreateSink(const BenchSettings& settings, const std::string& sink, std::size_t index,
+                                          CaptureStatistics& statistics)
+    {
+        const bool isFFmpeg = sink == "ffmpeg";
+        const auto outputName = settings.output.string() + std::to_string(index);
+        const auto outputPath = std::filesystem::path(outputName + (isFFmpeg ? ".mov" : ".raw"));
+
+        if (sink == "images")
+        {
+            // split numbers its files from 1 like ffmpeg's image2 muxer
+            std::filesystem::create_directories(outputName);
+            const auto pattern = std::filesystem::path(outputName) / "frame_%06d.raw";
+            const auto command = "split -b " + std::to_string(settings.GetFrameByteSize()) +
+                                 " -a 6 --numeric-suffixes=1 --additional-suffix=.raw - " +
+                                 Quote(std::filesystem::path(outputName) / "frame_");
+            return std::make_unique<ImageSequenceSink>(command, pattern, 1, &statistics);
+        }
+
+        if (settings.encoderCount <= 1)
+        {
+            if (sink == "null")
+                return std::make_unique<NullSink>();
+            if (sink == "file")
+                return std::make_unique<FileSink>(outputPath, statistics);
+            return std::make_unique<PipeSink>(GetFFmpegCommand(settings, outputPath), &statistics);
+        }
+
+        SegmentedEncoderSettings encoderSettings;
+        encoderSettings.segmentDirectory = outputName + ".segments";
+        encoderSettings.manifestKey = "bench " + std::to_string(std::rand());  // never resume a benchmark run
+        encoderSettings.segmentExtension = outputPath.extension().string();
+        encoderSettings.segmentFrameCount = std::max(settings.framerate, 1) * 2;
+        encoderSettings.encoderCount = settings.encoderCount;
+        encoderSettings.statistics = &statistics;
+
+        if (sink == "null")
+        {
+            encoderSettings.getEncoderCommand = [](const std::filesystem::path&) { return "cat > /dev/null"; };
+            encoderSettings.getConcatCommand = [](const std::filesystem::path&, const std::filesystem::path&) {
+                return std::string("true");
+            };
+        }
+        else if (sink == "file")
+        {
+            encoderSettings.getEncoderCommand = [](const std::filesystem::path& segmentPath) {
+                return "cat > " + Quote(segmentPath);
+            };
+            encoderSettings.getConcatCommand = [](const std::filesystem::path& listPath,
+                                                  const std::filesystem::path& outputPath) {
+                return "cd " + Quote(listPath.parent_path()) + " && sed -e \"s/^file '//\" -e \"s/'$//\" " +
+                       Quote(listPath.filename()) + " | xargs cat > " + Quote(std::filesystem::absolute(outputPath));
+            };
+        }
+        else
+        {
+            encoderSettings.getEncoderCommand = [settings](const std::filesystem::path& segmentPath) {
+                return GetFFmpegCommand(settings, segmentPath);
+            };
+            encoderSettings.getConcatCommand = [ffmpeg = settings.ffmpeg](const std::filesystem::path& listPath,
+                                                                        const std::filesystem::path& outputPath) {
+                return ffmpeg + " -loglevel error -f concat -safe 0 -i " + Quote(listPath) + " -c copy -y " +
+                       Quote(outputPath);
+            };
+        }
+
+        return std::make_unique<SegmentedSink>(std::move(encoderSettings), outputPath);
+    }
+
+    // A handful of distinct gradients cycled through, with the frame index stamped into the first pixels so
+    // consecutive frames never compare equal
+    class FrameGenerator
+    {
+       public:
+        static constexpr std::size_t PATTERN_COUNT = 4;
+
+        explicit FrameGenerator(const BenchSettings& settings) : frame(settings.GetFrameByteSize())
+        {
+            for (std::size_t i = 0; i < PATTERN_COUNT; i++)
+            {
+                auto& pattern = patterns.emplace_back(settings.GetFrameByteSize());
+                for (std::int32_t y = 0; y < settings.height; y++)
+                {
+                    auto* row = pattern.data() + static_cast<std::size_t>(y) * settings.width * 4;
+                    for (std::int32_t x = 0; x < settings.width; x++)
+                    {
+                        row[x * 4 + 0] = static_cast<std::uint8_t>(x + i * 64);
+                        row[x * 4 + 1] = static_cast<std::uint8_t>(y + i * 32);
+                        row[x * 4 + 2] = static_cast<std::uint8_t>((x ^ y) + i * 16);
+                        row[x * 4 + 3] = 255;
+                    }
+                }
+            }
+        }
+
+        std::span<const std::uint8_t> Generate(std::uint32_t index)
+        {
+            std::memcpy(frame.data(), patterns[index % PATTERN_COUNT].data(), frame.size());
+            std::memcpy(frame.data(), &index, std::min(sizeof(index), frame.size()));
+            return frame;
+        }
+
+       private:
+        std::vector<std::vector<std::uint8_t>> patterns;
+        std::vector<std::uint8_t> frame;
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "width")
+                settings.width = std::stoi(value);
+            else if (key == "height")
+                settings.height = std::stoi(value);
+            else if (key == "fps")
+                settings.framerate = std::stoi(value);
+            else if (key == "frames")
+                settings.frameCount = std::stoi(value);
+            else if (key == "sub-frames")
+                settings.subFrameCount = std::stoi(value);
+            else if (key == "hold")
+                settings.holdCount = std::stoi(value);
+            else if (key == "sink")
+            {
+                settings.sinks.clear();
+                for (std::size_t start = 0; start <= value.size();)
+                {
+                    const auto end = std::min(value.find(',', start), value.size());
+                    settings.sinks.push_back(value.substr(start, end - start));
+                    start = end + 1;
+                }
+            }
+            else if (key == "encoders")
+                settings.encoderCount = std::stoi(value);
+            else if (key == "output")
+                settings.output = value;
+            else if (key == "ffmpeg")
+                settings.ffmpeg = value;
+            else if (key == "csv")
+                settings.csv = value;
+            else if (key == "lut")
+                settings.lut = value;
+            else if (key == "grading-threads")
+                settings.gradingThreadCount = std::stoi(value);
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.width <= 0 || settings.height <= 0 || settings.framerate < 0 || settings.frameCount <= 0 ||
+            settings.subFrameCount < 1 || settings.subFrameCount > FrameAccumulator::MAX_SAMPLES ||
+            settings.gradingThreadCount < 1 || settings.holdCount < 1)
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        for (const auto& sink : settings.sinks)
+        {
+            if (sink != "null" && sink != "file" && sink != "images" && sink != "ffmpeg")
+            {
+                std::fprintf(stderr, "Unknown sink: %s\n", sink.c_str());
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void PrintHistogram(const char* label, const LatencyHistogram& histogram)
+    {
+        std::printf("  %-14s %8llu %10.3f %10.3f %10.3f %10.3f %10.3f\n", label,
+                    static_cast<unsigned long long>(histogram.GetCount()), histogram.GetMeanMicroseconds() / 1000.0,
+                    histogram.GetPercentileMicroseconds(50) / 1000.0, histogram.GetPercentileMicroseconds(90) / 1000.0,
+                    histogram.GetPercentileMicroseconds(99) / 1000.0, histogram.GetMaxMicroseconds() / 1000.0);
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    const bool usesFFmpeg = std::find(settings.sinks.begin(), settings.sinks.end(), "ffmpeg") != settings.sinks.end();
+    if (usesFFmpeg && std::system((settings.ffmpeg + " -version > /dev/null 2>&1").c_str()) != 0)
+    {
+        std::fprintf(stderr, "ffmpeg not found (%s); use --ffmpeg <path> or --sink null|file\n",
+                     settings.ffmpeg.c_str());
+        return 2;
+    }
+
+    CaptureStatistics statistics;
+    FrameFanOut fanOut(settings.GetFrameByteSize(), static_cast<std::size_t>(std::max(settings.encoderCount, 1)) + 3,
+                       &statistics);
+    if (!settings.lut.empty())
+    {
+        auto lut = std::make_shared<ColorLut>();
+        if (!lut->Load(settings.lut))
+        {
+            std::fprintf(stderr, "Failed to load %s: %s\n", settings.lut.string().c_str(), lut->GetError().c_str());
+            return 2;
+        }
+        fanOut.SetColorGrading(std::make_unique<ColorGradingStage>(std::move(lut), settings.width, settings.height,
+                                                                   settings.gradingThreadCount));
+    }
+
+    for (std::size_t i = 0; i < settings.sinks.size(); i++)
+    {
+        fanOut.AddSink(CreateSink(settings, settings.sinks[i], i, statistics));
+    }
+
+    if (!fanOut.Open())
+    {
+        std::fprintf(stderr, "Failed to open sink: %s\n", fanOut.GetError().c_str());
+        fanOut.Close();
+        return 1;
+    }
+
+    FrameGenerator generator(settings);
+    FrameAccumulator accumulator;
+    std::vector<std::uint8_t> blendedFrame;
+    if (settings.subFrameCount > 1)
+    {
+        accumulator.Reset(settings.GetFrameByteSize());
+        blendedFrame.resize(settings.GetFrameByteSize());
+    }
+
+    // time from a frame's slot to the pipeline having accepted it
+    LatencyHistogram latency;
+    std::int32_t droppedFrameCount = 0;
+    std::uint64_t lastFrameHash = 0;
+    bool failed = false;
+
+    const auto frameInterval = settings.framerate > 0
+                                   ? std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) /
+                                         settings.framerate
+                                   : Clock::duration::zero();
+
+    statistics.Start();
+    const auto startTime = Clock::now();
+
+    for (std::int32_t frameIndex = 0; frameIndex < settings.frameCount && !failed; frameIndex++)
+    {
+        const auto slotTime = startTime + frameInterval * frameIndex;
+        if (settings.framerate > 0)
+        {
+            if (Clock::now() > slotTime + frameInterval)
+            {
+                droppedFrameCount++;
+                continue;
+            }
+            std::this_thread::sleep_until(slotTime);
+        }
+
+        const auto frameStart = settings.framerate > 0 ? slotTime : Clock::now();
+
+        std::span<const std::uint8_t> outputFrame;
+        {
+            ScopedStageTimer timer(&statistics, CaptureStage::LockCopy);
+            for (std::int32_t subFrame = 0; subFrame < settings.subFrameCount; subFrame++)
+            {
+                const auto frame = generator.Generate(
+                    static_cast<std::uint32_t>(frameIndex / settings.holdCount * settings.subFrameCount + subFrame));
+                if (settings.subFrameCount == 1)
+                {
+                    outputFrame = frame;
+                }
+                else
+                {
+                    accumulator.Accumulate(frame);
+                }
+            }
+
+            if (settings.subFrameCount > 1)
+            {
+                accumulator.Resolve(blendedFrame);
+                outputFrame = blendedFrame;
+            }
+        }
+
+        bool isRepeat = false;
+        if (settings.holdCount > 1)
+        {
+            ScopedStageTimer timer(&statistics, CaptureStage::FrameHash);
+            const auto hash = HashFrame(outputFrame);
+            isRepeat = frameIndex > 0 && hash == lastFrameHash;
+            lastFrameHash = hash;
+        }
+
+        if (isRepeat)
+        {
+            statistics.AddRepeatedFrame();
+            failed = !fanOut.WriteRepeat(frameIndex);
+        }
+        else
+        {
+            statistics.AddFrame(outputFrame.size());
+            failed = !fanOut.Write(frameIndex, outputFrame);
+        }
+        latency.Record(Clock::now() - frameStart);
+    }
+
+    statistics.Stop();
+    const auto writeSeconds = statistics.GetElapsedSeconds();
+
+    const auto closeStart = Clock::now();
+    failed = !fanOut.Close() || failed;
+    const auto closeSeconds = std::chrono::duration<double>(Clock::now() - closeStart).count();
+
+    if (failed)
+    {
+        std::fprintf(stderr, "Pipeline error: %s\n", fanOut.GetError().c_str());
+    }
+
+    std::string sinkList;
+    for (const auto& sink : settings.sinks)
+    {
+        sinkList += (sinkList.empty() ? "" : ",") + sink;
+    }
+
+    std::printf("%dx%d, %d sub-frame(s), sink %s, %d encoder(s), target %d fps\n", settings.width, settings.height,
+                settings.subFrameCount, sinkList.c_str(), settings.encoderCount, settings.framerate);
+    std::printf("  frames     %llu written (%llu repeats), %d dropped\n",
+                static_cast<unsigned long long>(statistics.GetFrameCount()),
+                static_cast<unsigned long long>(statistics.GetRepeatedFrameCount()), droppedFrameCount);
+    std::printf("  sustained  %.1f fps, %.1f MB/s over %.2f s (+%.2f s to finish)\n", statistics.GetFramesPerSecond(),
+                statistics.GetMegabytesPerSecond(), writeSeconds, closeSeconds);
+    std::printf("\n  %-14s %8s %10s %10s %10s %10s %10s\n", "stage (ms)", "count", "mean", "p50", "p90", "p99", "max");
+    PrintHistogram("Frame Latency", latency);
+    for (std::size_t stage = 0; stage < static_cast<std::size_t>(CaptureStage::Count); stage++)
+    {
+        const auto& histogram = statistics.GetHistogram(static_cast<CaptureStage>(stage));
+        if (histogram.GetCount() > 0)
+        {
+            PrintHistogram(std::string(GetCaptureStageLabel(static_cast<CaptureStage>(stage))).c_str(), histogram);
+        }
+    }
+
+    if (!settings.csv.empty() && !statistics.WriteCsv(settings.csv))
+    {
+        std::fprintf(stderr, "Failed to write %s\n", settings.csv.string().c_str());
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,284 @@
+// Checks the colour grading kernels against the scalar reference and measures how many frames per second they grade,
+// single threaded and split over row bands like during a capture.
+//
+// usage: ColorLutBench [--width 1920] [--height 1080] [--fps 250] [--frames 500] [--size 33] [--lut grade.cube]
+//                      [--threads <hardware threads>]
+//
+// Without --lut a synthetic grade (contrast, saturation and a warm tint) is generated at --size, and written and
+// parsed as a .cube file. Every supported kernel grades all 2^24 colours and must stay within one step of the
+// reference; the exit code is 1 if one doesn't.
+#include "BenchUtilities.hpp"
+#include "Capture/CaptureStatistics.hpp"
+#include "Capture/ColorGradingStage.hpp"
+#include "Capture/ColorLut.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace IWXMVM::Capture;
+    using Clock = CaptureStatistics::Clock;
+
+    struct BenchSettings
+    {
+        std::int32_t width = 1920;
+        std::int32_t height = 1080;
+        std::int32_t framerate = 250;
+        std::int32_t frameCount = 500;
+        std::int32_t lutSize = 33;
+        std::filesystem::path lutPath;
+        std::int32_t threadCount = static_cast<std::int32_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "width")
+                settings.width = std::stoi(value);
+            else if (key == "height")
+                settings.height = std::stoi(value);
+            else if (key == "fps")
+                settings.framerate = std::stoi(value);
+            else if (key == "frames")
+                settings.frameCount = std::stoi(value);
+            else if (key == "size")
+                settings.lutSize = std::stoi(value);
+            else if (key == "lut")
+                settings.lutPath = value;
+            else if (key == "threads")
+                settings.threadCount = std::stoi(value);
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.width <= 0 || settings.height <= 0 || settings.framerate <= 0 || settings.frameCount <= 0 ||
+            settings.lutSize < ColorLut::MIN_SIZE || settings.lutSize > ColorLut::MAX_SIZE || settings.threadCount < 1)
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    // a grade that bends every channel differently and pushes some colours out of range, so the interpolation and
+    // the clamping both get exercised
+    std::string GenerateCube(std::int32_t size)
+    {
+        std::ostringstream cube;
+        cube << "# generated by ColorLutBench\n";
+        cube << "TITLE \"Synthetic Grade\"\n";
+        cube << "LUT_3D_SIZE " << size << "\n\n";
+
+        for (std::int32_t b = 0; b < size; b++)
+        {
+            for (std::int32_t g = 0; g < size; g++)
+            {
+                for (std::int32_t r = 0; r < size; r++)
+                {
+                    float rgb[3] = {static_cast<float>(r) / (size - 1), static_cast<float>(g) / (size - 1),
+                                    static_cast<float>(b) / (size - 1)};
+
+                    const auto luma = 0.2126f * rgb[0] + 0.7152f * rgb[1] + 0.0722f * rgb[2];
+                    for (auto& channel : rgb)
+                    {
+                        channel = luma + 1.3f * (channel - luma);
+                        const auto contrast = std::clamp(channel, 0.0f, 1.0f);
+                        channel = 0.5f * channel + 0.5f * contrast * contrast * (3.0f - 2.0f * contrast);
+                    }
+
+                    cube << rgb[0] * 1.06f << ' ' << std::pow(std::max(rgb[1], 0.0f), 0.95f) << ' '
+                         << rgb[2] * 0.9f + 0.02f << '\n';
+                }
+            }
+        }
+
+        return cube.str();
+    }
+
+    // image-like content: smooth gradients with some noise on top, so neighbouring pixels land in similar but not
+    // identical lattice cells
+    std::vector<std::uint8_t> GenerateFrame(const BenchSettings& settings)
+    {
+        std::vector<std::uint8_t> frame(static_cast<std::size_t>(settings.width) * settings.height * 4);
+        std::uint32_t noise = 0x12345678;
+        for (std::int32_t y = 0; y < settings.height; y++)
+        {
+            for (std::int32_t x = 0; x < settings.width; x++)
+            {
+                noise ^= noise << 13;
+                noise ^= noise >> 17;
+                noise ^= noise << 5;
+
+                auto* pixel = &frame[(static_cast<std::size_t>(y) * settings.width + x) * 4];
+                pixel[0] = static_cast<std::uint8_t>(x * 255 / settings.width + (noise & 15));
+                pixel[1] = static_cast<std::uint8_t>(y * 255 / settings.height + ((noise >> 4) & 15));
+                pixel[2] = static_cast<std::uint8_t>((x + y) * 127 / (settings.width + settings.height) +
+                                                     ((noise >> 8) & 63));
+                pixel[3] = 255;
+            }
+        }
+        return frame;
+    }
+
+    // grades every 8 bit colour (with varying alpha) and compares against the reference
+    bool Verify(const ColorLut& lut, ColorLut::Kernel kernel)
+    {
+        constexpr std::size_t CHUNK_PIXEL_COUNT = 1 << 20;
+
+        std::vector<std::uint8_t> source(CHUNK_PIXEL_COUNT * 4);
+        std::vector<std::uint8_t> expected(source.size());
+        std::vector<std::uint8_t> actual(source.size());
+
+        std::int32_t maxDifference = 0;
+        std::uint64_t differentChannels = 0;
+        bool alphaChanged = false;
+
+        for (std::uint32_t first = 0; first < (1u << 24); first += CHUNK_PIXEL_COUNT)
+        {
+            for (std::size_t i = 0; i < CHUNK_PIXEL_COUNT; i++)
+            {
+                const auto color = first + static_cast<std::uint32_t>(i);
+                source[i * 4 + 0] = static_cast<std::uint8_t>(color);
+                source[i * 4 + 1] = static_cast<std::uint8_t>(color >> 8);
+                source[i * 4 + 2] = static_cast<std::uint8_t>(color >> 16);
+                source[i * 4 + 3] = static_cast<std::uint8_t>(i * 7);
+            }
+
+            lut.Apply(source, expected, ColorLut::Kernel::Reference);
+
+            // every other chunk is graded in place, which is how the stage can be used on a frame it owns
+            if ((first / CHUNK_PIXEL_COUNT) % 2 == 0)
+            {
+                lut.Apply(source, actual, kernel);
+            }
+            else
+            {
+                actual = source;
+                lut.Apply(actual, actual, kernel);
+            }
+
+            for (std::size_t i = 0; i < source.size(); i++)
+            {
+                const auto difference = std::abs(static_cast<std::int32_t>(expected[i]) - actual[i]);
+                if (i % 4 == 3)
+                {
+                    alphaChanged = alphaChanged || actual[i] != source[i];
+                    continue;
+                }
+
+                maxDifference = std::max(maxDifference, difference);
+                differentChannels += difference != 0;
+            }
+        }
+
+        // the kernels round to nearest even where the reference rounds halves up
+        const bool passed = maxDifference <= 1 && !alphaChanged;
+        std::printf("  %-10s max difference %d, %llu of %llu channels differ%s  %s\n", ColorLut::GetKernelLabel(kernel),
+                    maxDifference, static_cast<unsigned long long>(differentChannels), 3ull << 24,
+                    alphaChanged ? ", alpha changed" : "", passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    double MeasureKernel(const ColorLut& lut, ColorLut::Kernel kernel, const std::vector<std::uint8_t>& frame,
+                         std::int32_t frameCount)
+    {
+        std::vector<std::uint8_t> output(frame.size());
+        const auto start = Clock::now();
+        for (std::int32_t i = 0; i < frameCount; i++)
+        {
+            lut.Apply(frame, output, kernel);
+        }
+        return frameCount / std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    auto lut = std::make_shared<ColorLut>();
+    const auto loadStart = Clock::now();
+    if (settings.lutPath.empty())
+    {
+        std::istringstream cube(GenerateCube(settings.lutSize));
+        if (!lut->Parse(cube))
+        {
+            std::fprintf(stderr, "Failed to parse generated LUT: %s\n", lut->GetError().c_str());
+            return 1;
+        }
+    }
+    else if (!lut->Load(settings.lutPath))
+    {
+        std::fprintf(stderr, "Failed to load %s: %s\n", settings.lutPath.string().c_str(), lut->GetError().c_str());
+        return 1;
+    }
+    const auto loadMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count();
+
+    std::printf("LUT \"%s\", %d^3, loaded in %.1f ms\n", lut->GetTitle().c_str(), lut->GetSize(), loadMilliseconds);
+
+    std::printf("\nverification against the reference\n");
+    bool passed = true;
+    std::vector<ColorLut::Kernel> kernels;
+    for (auto kernel : {ColorLut::Kernel::Reference, ColorLut::Kernel::Sse2, ColorLut::Kernel::Avx2})
+    {
+        if (!ColorLut::IsKernelSupported(kernel))
+        {
+            std::printf("  %-10s not supported on this CPU/build\n", ColorLut::GetKernelLabel(kernel));
+            continue;
+        }
+
+        kernels.push_back(kernel);
+        if (kernel != ColorLut::Kernel::Reference)
+        {
+            passed = Verify(*lut, kernel) && passed;
+        }
+    }
+
+    const auto frame = GenerateFrame(settings);
+    const auto megapixels = static_cast<double>(settings.width) * settings.height / 1'000'000.0;
+    const auto singleThreadFrameCount = std::max(settings.frameCount / 10, 1);
+
+    std::printf("\n%dx%d, single thread\n", settings.width, settings.height);
+    for (auto kernel : kernels)
+    {
+        const auto framesPerSecond = MeasureKernel(*lut, kernel, frame, singleThreadFrameCount);
+        std::printf("  %-10s %8.1f fps %8.1f MP/s\n", ColorLut::GetKernelLabel(kernel), framesPerSecond,
+                    framesPerSecond * megapixels);
+    }
+
+    ColorGradingStage stage(lut, settings.width, settings.height, settings.threadCount);
+    std::vector<std::uint8_t> output(frame.size());
+    LatencyHistogram latency;
+
+    const auto start = Clock::now();
+    for (std::int32_t i = 0; i < settings.frameCount; i++)
+    {
+        const auto frameStart = Clock::now();
+        stage.Apply(frame, output);
+        latency.Record(Clock::now() - frameStart);
+    }
+    const auto framesPerSecond =
+        settings.frameCount / std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("\n%dx%d, %s on %d thread(s), target %d fps\n", settings.width, settings.height,
+                ColorLut::GetKernelLabel(stage.GetKernel()), stage.GetThreadCount(), settings.framerate);
+    std::printf("  sustained  %.1f fps, %.1f MP/s (%s)\n", framesPerSecond, framesPerSecond * megapixels,
+                framesPerSecond >= settings.framerate ? "keeps up" : "too slow");
+    std::printf("  per frame  mean %.3f ms, p99 %.3f ms, max %.3f ms\n", latency.GetMeanMicroseconds() / 1000.0,
+                latency.GetPercentileMicroseconds(99) / 1000.0, latency.GetMaxMicroseconds() / 1000.0);
+
+    return passed ? 0 : 1;
+}
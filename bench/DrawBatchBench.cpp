@@ -0,0 +1,158 @@
+// Measures what sorting a frame's node, axis and gizmo draws into instanced batches costs, and checks that the
+// batches hold exactly what was submitted.
+//
+// usage: DrawBatchBench [--nodes 500] [--frames 1000]
+//
+// Every frame submits a camera model per campath node (one of them hovered), an axis on a bone, the orbit axis and a
+// three part gizmo, like GraphicsManager::Render does. The exit code is 1 if a batch is missing an instance, holds one
+// in the wrong order, or the draws don't end up as one batch per mesh and pass.
+#include "BenchUtilities.hpp"
+#include "Graphics/DrawBatch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace IWXMVM::GFX;
+    using Clock = std::chrono::steady_clock;
+
+    // mesh indices as the buffer manager would hand them out
+    constexpr std::size_t AXIS_MESH = 0;
+    constexpr std::size_t CAMERA_MESH = 1;
+    constexpr std::size_t GIZMO_TRANSLATE_MESH = 3;
+
+    struct BenchSettings
+    {
+        std::int32_t nodeCount = 500;
+        std::int32_t frameCount = 1000;
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "nodes")
+                settings.nodeCount = std::stoi(value);
+            else if (key == "frames")
+                settings.frameCount = std::stoi(value);
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.nodeCount < 0 || settings.frameCount <= 0)
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    InstanceData MakeInstance(float x, std::uint32_t color, bool ignoreLighting)
+    {
+        InstanceData instance = {};
+        instance.model = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, 0, 0, 1};
+        instance.color = color;
+        instance.ignoreLighting = ignoreLighting ? 1.0f : 0.0f;
+        return instance;
+    }
+
+    struct Draw
+    {
+        std::size_t meshIndex;
+        DrawPass pass;
+        InstanceData instance;
+    };
+
+    // the draws of one frame in the order Render submits them
+    std::vector<Draw> MakeFrame(std::int32_t nodeCount)
+    {
+        std::vector<Draw> draws;
+        draws.push_back({AXIS_MESH, DrawPass::Scene, MakeInstance(-1.0f, 0xFFFFFFFF, true)});
+        draws.push_back({AXIS_MESH, DrawPass::Overlay, MakeInstance(-2.0f, 0xFFFFFFFF, false)});
+        for (std::int32_t i = 0; i < nodeCount; i++)
+        {
+            draws.push_back({CAMERA_MESH, DrawPass::Scene, MakeInstance(static_cast<float>(i), 0xFFFFFFFF, i == 7)});
+            if (i == nodeCount / 2)
+            {
+                draws.push_back({GIZMO_TRANSLATE_MESH, DrawPass::Overlay, MakeInstance(0.0f, 0xFFFF0000, true)});
+                draws.push_back({GIZMO_TRANSLATE_MESH, DrawPass::Overlay, MakeInstance(1.0f, 0xFF00FF00, true)});
+                draws.push_back({GIZMO_TRANSLATE_MESH, DrawPass::Overlay, MakeInstance(2.0f, 0xFF0000FF, true)});
+            }
+        }
+        return draws;
+    }
+
+    bool AreInstancesEqual(const InstanceData& a, const InstanceData& b)
+    {
+        return a.model == b.model && a.color == b.color && a.ignoreLighting == b.ignoreLighting;
+    }
+
+    // every batch has to hold the draws of its mesh and pass, in the order they were submitted
+    bool CheckBatches(const DrawBatcher& batcher, const std::vector<Draw>& draws)
+    {
+        std::size_t batchedCount = 0;
+        for (auto pass : {DrawPass::Scene, DrawPass::Overlay})
+        {
+            for (const auto& batch : batcher.GetBatches(pass))
+            {
+                std::size_t instance = batch.firstInstance;
+                for (const auto& draw : draws)
+                {
+                    if (draw.meshIndex != batch.meshIndex || draw.pass != pass)
+                        continue;
+                    if (instance >= batch.firstInstance + batch.instanceCount ||
+                        !AreInstancesEqual(batcher.GetInstances()[instance], draw.instance))
+                        return false;
+                    instance++;
+                }
+                if (instance != batch.firstInstance + batch.instanceCount)
+                    return false;
+                batchedCount += batch.instanceCount;
+            }
+        }
+        return batchedCount == draws.size() && batcher.GetInstances().size() == draws.size();
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    const auto draws = MakeFrame(settings.nodeCount);
+
+    DrawBatcher batcher;
+    bool passed = true;
+    const auto start = Clock::now();
+    for (std::int32_t frame = 0; frame < settings.frameCount; frame++)
+    {
+        batcher.Clear();
+        for (const auto& draw : draws)
+        {
+            batcher.Submit(draw.meshIndex, draw.pass, draw.instance);
+        }
+        batcher.Build();
+
+        if (frame == 0)
+            passed = CheckBatches(batcher, draws);
+    }
+    const auto microseconds = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    // the scene has the bone axis and the nodes, the overlay the orbit axis and the gizmo
+    const auto batchCount = batcher.GetBatches(DrawPass::Scene).size() + batcher.GetBatches(DrawPass::Overlay).size();
+    const std::size_t expectedBatchCount = settings.nodeCount > 0 ? 4 : 2;
+    passed = passed && batchCount == expectedBatchCount;
+
+    std::printf("%d nodes, %zu draws per frame\n", settings.nodeCount, batcher.GetSubmittedCount());
+    std::printf("  batched into %zu draw calls  %s\n", batchCount, passed ? "ok" : "FAILED");
+    std::printf("  submit and build  %.2f us per frame\n", microseconds / settings.frameCount);
+
+    return passed ? 0 : 1;
+}
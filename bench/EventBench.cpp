@@ -0,0 +1,156 @@
+// Checks the order listeners are called in and what happens when they are added or removed during a dispatch, and
+// compares the cost of dispatching OnFrame with the map of std::function vectors events were kept in before.
+//
+// usage: EventBench [--listeners 8] [--frames 1000000]
+//
+// The exit code is 1 if listeners are called out of order, miss their arguments, are called after they were removed,
+// or are not timed while timing is enabled.
+#include "BenchUtilities.hpp"
+#include "Events.hpp"
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace IWXMVM;
+    using Bench::Check;
+
+    struct BenchSettings
+    {
+        std::int32_t listenerCount = 8;
+        std::int32_t frameCount = 1000000;
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "listeners")
+                settings.listenerCount = std::stoi(value);
+            else if (key == "frames")
+                settings.frameCount = std::stoi(value);
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.listenerCount <= 0 || settings.frameCount <= 0)
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    template <typename F>
+    double MeasureNanosecondsPerFrame(std::int32_t frameCount, F&& dispatch)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::int32_t i = 0; i < frameCount; i++)
+        {
+            dispatch();
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frameCount;
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    bool passed = true;
+
+    // these run on events the benchmark below doesn't use, and are removed again
+    {
+        std::string order;
+        std::vector<Events::ListenerHandle> handles;
+        handles.push_back(Events::RegisterListener<EventType::PostDemoLoad>("b", [&]() { order += 'b'; }));
+        handles.push_back(Events::RegisterListener<EventType::PostDemoLoad>("d", [&]() { order += 'd'; },
+                                                                            Events::ListenerPriority::Last));
+        handles.push_back(Events::RegisterListener<EventType::PostDemoLoad>("a", [&]() { order += 'a'; },
+                                                                            Events::ListenerPriority::First));
+        handles.push_back(Events::RegisterListener<EventType::PostDemoLoad>("c", [&]() { order += 'c'; }));
+        Events::Invoke<EventType::PostDemoLoad>();
+        passed &= Check(order == "abcd", "listeners are called by priority");
+
+        for (const auto& handle : handles)
+        {
+            Events::UnregisterListener(handle);
+        }
+        order.clear();
+        Events::Invoke<EventType::PostDemoLoad>();
+        passed &= Check(order.empty() && !Events::UnregisterListener(handles[0]), "removed listeners are not called");
+    }
+    {
+        Events::DemoBounds received = {};
+        std::int32_t callCount = 0;
+        const auto typed = Events::RegisterListener<EventType::OnDemoBoundsDetermined>(
+            "typed", [&](const Events::DemoBounds& bounds) { received = bounds; });
+        const auto untyped = Events::RegisterListener<EventType::OnDemoBoundsDetermined>("untyped", [&]() {
+            callCount++;
+        });
+        Events::Invoke<EventType::OnDemoBoundsDetermined>(Events::DemoBounds{100, 2500});
+        passed &= Check(received.startTick == 100 && received.endTick == 2500 && callCount == 1,
+                        "listeners get the event's arguments");
+        Events::UnregisterListener(typed);
+        Events::UnregisterListener(untyped);
+    }
+    {
+        // one listener removes itself and the one after it, and adds another that only sees the next dispatch
+        std::string order;
+        Events::ListenerHandle self = {}, next = {}, added = {};
+        self = Events::RegisterListener<EventType::OnRenderGameView>("self", [&]() {
+            order += 's';
+            Events::UnregisterListener(self);
+            Events::UnregisterListener(next);
+            added = Events::RegisterListener<EventType::OnRenderGameView>("added", [&]() { order += 'a'; });
+        });
+        next = Events::RegisterListener<EventType::OnRenderGameView>("next", [&]() { order += 'n'; });
+        Events::Invoke<EventType::OnRenderGameView>();
+        Events::Invoke<EventType::OnRenderGameView>();
+        passed &= Check(order == "sa", "listeners can be changed during a dispatch");
+        Events::UnregisterListener(added);
+    }
+
+    std::uint64_t counter = 0;
+    std::map<EventType, std::vector<std::function<void()>>> mapListeners;
+    for (std::int32_t i = 0; i < settings.listenerCount; i++)
+    {
+        mapListeners[EventType::OnFrame].push_back([&]() { counter++; });
+        Events::RegisterListener<EventType::OnFrame>("counter", [&]() { counter++; });
+    }
+
+    const auto mapTime = MeasureNanosecondsPerFrame(settings.frameCount, [&]() {
+        for (const auto& function : mapListeners[EventType::OnFrame])
+        {
+            function();
+        }
+    });
+    const auto busTime =
+        MeasureNanosecondsPerFrame(settings.frameCount, [&]() { Events::Invoke<EventType::OnFrame>(); });
+
+    Events::SetTimingEnabled(true);
+    const auto timedTime =
+        MeasureNanosecondsPerFrame(settings.frameCount, [&]() { Events::Invoke<EventType::OnFrame>(); });
+    Events::SetTimingEnabled(false);
+
+    const auto timings = Events::GetListenerTimings();
+    passed &= Check(timings.size() == static_cast<std::size_t>(settings.listenerCount) &&
+                        timings[0].callCount == static_cast<std::uint64_t>(settings.frameCount),
+                    "listeners are timed while timing is enabled");
+    passed &= Check(counter == static_cast<std::uint64_t>(settings.frameCount) * settings.listenerCount * 3,
+                    "every listener is called every frame");
+
+    std::printf("  %d listeners: map %.1f ns, event bus %.1f ns, timed %.1f ns per frame\n", settings.listenerCount,
+                mapTime, busTime, timedTime);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+// Checks that the SSE2 and the scalar frame hash agree, and measures how fast both hash a frame.
+//
+// usage: FrameHashBench [--buffers 2000] [--width 1920] [--height 1080] [--seed 1]
+//
+// Repeated frames are only told apart by their hash, so both paths have to give the same value for every input. The
+// exit code is 1 if they differ for any of the random buffers, which start at every alignment and have lengths around
+// the stripe and block sizes, or for a whole frame.
+#include "BenchUtilities.hpp"
+#include "Capture/FrameHash.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace IWXMVM::Capture;
+    using Clock = std::chrono::steady_clock;
+    using Bench::Check;
+
+    struct BenchSettings
+    {
+        std::int32_t bufferCount = 2000;
+        std::int32_t width = 1920;
+        std::int32_t height = 1080;
+        std::uint32_t seed = 1;
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "buffers")
+                settings.bufferCount = std::stoi(value);
+            else if (key == "width")
+                settings.width = std::stoi(value);
+            else if (key == "height")
+                settings.height = std::stoi(value);
+            else if (key == "seed")
+                settings.seed = static_cast<std::uint32_t>(std::stoul(value));
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.bufferCount <= 0 || settings.width <= 0 || settings.height <= 0)
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    template <typename F>
+    double MeasureMilliseconds(std::int32_t iterations, F&& function)
+    {
+        const auto start = Clock::now();
+        for (std::int32_t i = 0; i < iterations; i++)
+        {
+            function();
+        }
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    bool passed = true;
+    std::mt19937 random(settings.seed);
+
+    // 64 byte stripes, scrambled every 16 of them
+    constexpr std::size_t STRIPE_SIZE = 64;
+    constexpr std::size_t BLOCK_SIZE = STRIPE_SIZE * 16;
+    constexpr std::size_t MAX_OFFSET = 15;
+
+    std::vector<std::uint8_t> buffer(BLOCK_SIZE * 8 + MAX_OFFSET + 1);
+    const auto fillRandom = [&]() {
+        for (auto& byte : buffer)
+        {
+            byte = static_cast<std::uint8_t>(random());
+        }
+    };
+
+    {
+        bool isEqual = true;
+        for (std::size_t offset = 0; offset <= MAX_OFFSET; offset++)
+        {
+            for (const auto base : {std::size_t{0}, STRIPE_SIZE, BLOCK_SIZE, BLOCK_SIZE * 3})
+            {
+                for (std::size_t length = base > 0 ? base - 3 : 0; length <= base + 3; length++)
+                {
+                    fillRandom();
+                    const auto pixels = std::span(buffer.data() + offset, length);
+                    isEqual &= HashFrame(pixels) == HashFrameScalar(pixels);
+                }
+            }
+        }
+        passed &= Check(isEqual, "both paths agree around stripe and block sizes");
+    }
+    {
+        bool isEqual = true;
+        std::uniform_int_distribution<std::size_t> offsets(0, MAX_OFFSET);
+        std::uniform_int_distribution<std::size_t> lengths(0, buffer.size() - MAX_OFFSET - 1);
+        for (std::int32_t i = 0; i < settings.bufferCount; i++)
+        {
+            fillRandom();
+            const auto pixels = std::span(buffer.data() + offsets(random), lengths(random));
+            isEqual &= HashFrame(pixels) == HashFrameScalar(pixels);
+        }
+        passed &= Check(isEqual, "both paths agree on random buffers");
+    }
+
+    std::vector<std::uint8_t> frame(static_cast<std::size_t>(settings.width) * settings.height * 4);
+    for (auto& byte : frame)
+    {
+        byte = static_cast<std::uint8_t>(random());
+    }
+    passed &= Check(HashFrame(frame) == HashFrameScalar(frame), "both paths agree on a whole frame");
+
+    const auto previousHash = HashFrame(frame);
+    frame[frame.size() / 2] ^= 1;
+    passed &= Check(HashFrame(frame) != previousHash, "a changed pixel changes the hash");
+
+    constexpr std::int32_t ITERATIONS = 20;
+    std::uint64_t sink = 0;
+    const auto sse2Time = MeasureMilliseconds(ITERATIONS, [&]() { sink += HashFrame(frame); });
+    const auto scalarTime = MeasureMilliseconds(ITERATIONS, [&]() { sink += HashFrameScalar(frame); });
+
+    const auto gigabytes = static_cast<double>(frame.size()) / 1e9;
+    std::printf("  %dx%d frame: %.2f ms (%.1f GB/s) with SSE2, %.2f ms (%.1f GB/s) scalar (%llx)\n", settings.width,
+                settings.height, sse2Time, gigabytes / (sse2Time / 1000.0), scalarTime,
+                gigabytes / (scalarTime / 1000.0), static_cast<unsigned long long>(sink & 0xF));
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+// Checks what the frame profiler keeps of each frame, and measures what a zone costs while the profiler records and
+// while it doesn't.
+//
+// usage: FrameProfilerBench [--frames 2000] [--zones 64] [--output <frames.json>]
+//
+// The exit code is 1 if zones end up in the wrong frame or at the wrong depth, the history or the zone limit is not
+// kept, a disabled profiler records, the statistics don't add up, the written trace doesn't hold every zone, or frames
+// whose zones were written over stay in the history. With --output, the trace of the last frames is written there,
+// to open it in chrome://tracing or Perfetto.
+#include "BenchUtilities.hpp"
+#include "Utilities/FrameProfiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+    using namespace IWXMVM::Profiling;
+    using Bench::Check;
+    using Bench::CountOccurrences;
+
+    struct BenchSettings
+    {
+        std::int32_t frameCount = 2000;
+        std::int32_t zoneCount = 64;
+        std::filesystem::path outputPath;
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "frames")
+                settings.frameCount = std::stoi(value);
+            else if (key == "zones")
+                settings.zoneCount = std::stoi(value);
+            else if (key == "output")
+                settings.outputPath = value;
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.frameCount <= 0 || settings.zoneCount <= 0 ||
+            settings.zoneCount > static_cast<std::int32_t>(FrameProfiler::MAX_ZONES_PER_FRAME))
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    // zones are recorded in the order they end, so the innermost one comes first
+    void RunFrame(std::int32_t zoneCount)
+    {
+        IWXMVM_PROFILE_BEGIN_FRAME();
+        IWXMVM_PROFILE_ZONE("Outer");
+        for (std::int32_t i = 1; i < zoneCount; i++)
+        {
+            IWXMVM_PROFILE_ZONE("Inner");
+        }
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    bool passed = true;
+    auto& profiler = FrameProfiler::Get();
+
+    {
+        IWXMVM_PROFILE_BEGIN_FRAME();
+        {
+            IWXMVM_PROFILE_ZONE("A");
+            {
+                IWXMVM_PROFILE_ZONE("B");
+            }
+            std::thread([]() { IWXMVM_PROFILE_ZONE("C"); }).join();
+        }
+        IWXMVM_PROFILE_BEGIN_FRAME();
+
+        const auto frame = profiler.GetFrame(0);
+        passed &= Check(frame && frame->zones.size() == 3, "a frame keeps the zones recorded during it");
+        passed &= Check(frame && std::strcmp(frame->zones[0].name, "B") == 0 && frame->zones[0].depth == 1 &&
+                            std::strcmp(frame->zones[2].name, "A") == 0 && frame->zones[2].depth == 0,
+                        "nested zones get their depth");
+        passed &= Check(frame && std::strcmp(frame->zones[1].name, "C") == 0 && frame->zones[1].depth == 0 &&
+                            frame->zones[1].threadIndex != frame->zones[0].threadIndex,
+                        "other threads get their own depth and id");
+    }
+    {
+        profiler.SetEnabled(false);
+        const auto frameCount = profiler.GetFrameCount();
+        RunFrame(4);
+        RunFrame(4);
+        passed &= Check(profiler.GetFrameCount() == frameCount && profiler.GetFrame(0)->zones.size() == 3,
+                        "a disabled profiler doesn't record");
+        profiler.SetEnabled(true);
+    }
+    {
+        IWXMVM_PROFILE_BEGIN_FRAME();
+        for (std::size_t i = 0; i < FrameProfiler::MAX_ZONES_PER_FRAME + 10; i++)
+        {
+            IWXMVM_PROFILE_ZONE("Many");
+        }
+        IWXMVM_PROFILE_BEGIN_FRAME();
+
+        const auto frame = profiler.GetFrame(0);
+        passed &= Check(frame->zones.size() == FrameProfiler::MAX_ZONES_PER_FRAME && frame->droppedZoneCount == 10,
+                        "a full frame drops the zones beyond its limit");
+    }
+
+    // the rest of the history is filled with frames of the same shape
+    const auto start = Clock::now();
+    for (std::int32_t i = 0; i < settings.frameCount; i++)
+    {
+        RunFrame(settings.zoneCount);
+    }
+    const auto recordingTime = Clock::now() - start;
+    IWXMVM_PROFILE_BEGIN_FRAME();
+
+    // the checks above ended five frames, counting the empty one the profiler started with, unless the zones of the
+    // frames since have written over theirs
+    const auto expectedFrameCount =
+        std::min({static_cast<std::size_t>(settings.frameCount) + 5, FrameProfiler::FRAME_HISTORY - 1,
+                  FrameProfiler::ZONE_HISTORY / static_cast<std::size_t>(settings.zoneCount)});
+    passed &= Check(profiler.GetFrameCount() == expectedFrameCount && !profiler.GetFrame(expectedFrameCount),
+                    "the history keeps the last frames");
+    passed &= Check(profiler.GetFrameTimes(100).size() == std::min<std::size_t>(100, expectedFrameCount),
+                    "frame times are kept for every frame");
+
+    const auto statisticsFrames = std::min<std::size_t>(100, settings.frameCount);
+    const auto statistics = profiler.GetZoneStatistics(statisticsFrames);
+    const auto inner = std::find_if(statistics.begin(), statistics.end(),
+                                    [](const ZoneStatistics& zone) { return std::strcmp(zone.name, "Inner") == 0; });
+    const auto outer = std::find_if(statistics.begin(), statistics.end(),
+                                    [](const ZoneStatistics& zone) { return std::strcmp(zone.name, "Outer") == 0; });
+    passed &= Check(statistics.size() == (settings.zoneCount > 1 ? 2u : 1u) && outer != statistics.end() &&
+                        outer->callsPerFrame == 1.0 &&
+                        (settings.zoneCount == 1 || inner->callsPerFrame == settings.zoneCount - 1.0),
+                    "statistics count the calls of every frame");
+    passed &= Check(outer != statistics.end() && outer->longestMilliseconds >= outer->averageMilliseconds,
+                    "no frame spends less than the average");
+
+    const auto tracePath = settings.outputPath.empty()
+                               ? std::filesystem::temp_directory_path() / "FrameProfilerBench.json"
+                               : settings.outputPath;
+    if (profiler.WriteChromeTrace(tracePath, std::chrono::hours(1)))
+    {
+        std::ifstream file(tracePath, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        const auto json = contents.str();
+
+        std::size_t zoneTotal = 0;
+        for (std::size_t age = 0; age < profiler.GetFrameCount(); age++)
+        {
+            zoneTotal += profiler.GetFrame(age)->zones.size();
+        }
+        passed &= Check(CountOccurrences(json, "\"ph\":\"X\"") == zoneTotal + profiler.GetFrameCount() &&
+                            CountOccurrences(json, "\"name\":\"Frame\"") == profiler.GetFrameCount(),
+                        "the trace holds every frame and zone");
+    }
+    else
+    {
+        passed &= Check(false, "the trace holds every frame and zone");
+    }
+    if (settings.outputPath.empty())
+    {
+        std::error_code errorCode;
+        std::filesystem::remove(tracePath, errorCode);
+    }
+
+    {
+        // full frames go through the zones faster than through the frames
+        const auto keptFrameCount = FrameProfiler::ZONE_HISTORY / FrameProfiler::MAX_ZONES_PER_FRAME;
+        for (std::size_t i = 0; i < keptFrameCount + 10; i++)
+        {
+            RunFrame(static_cast<std::int32_t>(FrameProfiler::MAX_ZONES_PER_FRAME));
+        }
+        IWXMVM_PROFILE_BEGIN_FRAME();
+
+        const auto oldestFrame = profiler.GetFrame(keptFrameCount - 1);
+        passed &= Check(profiler.GetFrameCount() == keptFrameCount && oldestFrame &&
+                            oldestFrame->zones.size() == FrameProfiler::MAX_ZONES_PER_FRAME &&
+                            std::strcmp(oldestFrame->zones.back().name, "Outer") == 0,
+                        "frames leave once their zones are written over");
+    }
+
+    profiler.SetEnabled(false);
+    const auto disabledStart = Clock::now();
+    for (std::int32_t i = 0; i < settings.frameCount; i++)
+    {
+        RunFrame(settings.zoneCount);
+    }
+    const auto disabledTime = Clock::now() - disabledStart;
+
+    const auto zoneTotal = static_cast<double>(settings.frameCount) * settings.zoneCount;
+    std::printf("  %d frames of %d zones: %.1f ns per zone recording, %.1f ns disabled\n", settings.frameCount,
+                settings.zoneCount, std::chrono::duration<double, std::nano>(recordingTime).count() / zoneTotal,
+                std::chrono::duration<double, std::nano>(disabledTime).count() / zoneTotal);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+// Checks when the shader cache compiles, and measures how long getting a shader from memory and from disk takes.
+//
+// usage: ShaderCacheBench [--size 4096] [--iterations 1000] [--directory <temporary directory>]
+//
+// The compiler is a stand-in that returns --size bytes made from the source. The exit code is 1 if the cache compiles
+// when it shouldn't (a device reset, a new session with the same source), doesn't when it should (changed source or
+// flags, a damaged cache file or size), or returns other bytecode than was compiled.
+#include "BenchUtilities.hpp"
+#include "Graphics/ShaderCache.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    using namespace IWXMVM::GFX;
+    using Clock = std::chrono::steady_clock;
+    using Bench::Check;
+
+    struct BenchSettings
+    {
+        std::int32_t bytecodeSize = 4096;
+        std::int32_t iterations = 1000;
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "IWXMVMShaderCacheBench";
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "size")
+                settings.bytecodeSize = std::stoi(value);
+            else if (key == "iterations")
+                settings.iterations = std::stoi(value);
+            else if (key == "directory")
+                settings.directory = value;
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.bytecodeSize <= 0 || settings.iterations <= 0)
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    // counts how often it is called, and makes bytecode that depends on the key
+    struct FakeCompiler
+    {
+        std::int32_t size;
+        std::int32_t callCount = 0;
+
+        ShaderCache::Bytecode Compile(const ShaderKey& key) const
+        {
+            const auto hash = HashShaderKey(key);
+            ShaderCache::Bytecode bytecode(static_cast<std::size_t>(size));
+            for (std::size_t i = 0; i < bytecode.size(); i++)
+            {
+                bytecode[i] = static_cast<std::uint8_t>((hash >> (i % 8 * 8)) + i);
+            }
+            return bytecode;
+        }
+
+        ShaderCache::Compiler For(const ShaderKey& key)
+        {
+            return [this, key]() -> std::optional<ShaderCache::Bytecode> {
+                callCount++;
+                return Compile(key);
+            };
+        }
+    };
+
+    double MeasureMicroseconds(std::int32_t iterations, const std::function<void()>& function)
+    {
+        const auto start = Clock::now();
+        for (std::int32_t i = 0; i < iterations; i++)
+        {
+            function();
+        }
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    std::error_code errorCode;
+    std::filesystem::remove_all(settings.directory, errorCode);
+
+    const std::string source = "float4 main(float4 position : POSITION) : POSITION { return position; }";
+    const ShaderKey key = {source, "main", "vs_3_0", 0, 43};
+    FakeCompiler compiler{settings.bytecodeSize};
+    const auto expected = compiler.Compile(key);
+
+    std::printf("%d byte shaders in %s\n", settings.bytecodeSize, settings.directory.string().c_str());
+    bool passed = true;
+    {
+        ShaderCache cache;
+        cache.SetDirectory(settings.directory);
+        const auto* bytecode = cache.GetOrCompile(key, compiler.For(key));
+        passed &= Check(bytecode != nullptr && *bytecode == expected && compiler.callCount == 1,
+                        "first use compiles");
+
+        // what Initialize does again after a device reset
+        bytecode = cache.GetOrCompile(key, compiler.For(key));
+        passed &= Check(bytecode != nullptr && *bytecode == expected && compiler.callCount == 1,
+                        "device reset loads from memory");
+        passed &= Check(cache.GetStatistics().failedWrites == 0, "compiled shader is saved");
+    }
+    {
+        ShaderCache cache;
+        cache.SetDirectory(settings.directory);
+        const auto* bytecode = cache.GetOrCompile(key, compiler.For(key));
+        passed &= Check(bytecode != nullptr && *bytecode == expected && compiler.callCount == 1 &&
+                            cache.GetStatistics().diskHits == 1,
+                        "next session loads from disk");
+
+        auto changedSource = source;
+        changedSource.insert(changedSource.find('{') + 1, " position.w = 1;");
+        const ShaderKey changedSourceKey = {changedSource, "main", "vs_3_0", 0, 43};
+        bytecode = cache.GetOrCompile(changedSourceKey, compiler.For(changedSourceKey));
+        passed &= Check(bytecode != nullptr && compiler.callCount == 2, "changed source compiles");
+
+        const ShaderKey changedFlagsKey = {source, "main", "vs_3_0", 1, 43};
+        bytecode = cache.GetOrCompile(changedFlagsKey, compiler.For(changedFlagsKey));
+        passed &= Check(bytecode != nullptr && compiler.callCount == 3, "changed flags compile");
+    }
+    {
+        // flip a byte of the bytecode in every file, as if they were damaged
+        for (const auto& entry : std::filesystem::directory_iterator(settings.directory))
+        {
+            std::fstream file(entry.path(), std::ios::binary | std::ios::in | std::ios::out);
+            file.seekg(-1, std::ios::end);
+            const auto last = static_cast<char>(file.get());
+            file.seekp(-1, std::ios::end);
+            file.put(static_cast<char>(~last));
+        }
+
+        ShaderCache cache;
+        cache.SetDirectory(settings.directory);
+        const auto* bytecode = cache.GetOrCompile(key, compiler.For(key));
+        passed &= Check(bytecode != nullptr && *bytecode == expected && compiler.callCount == 4,
+                        "damaged file compiles again");
+    }
+    {
+        // claim more bytecode than the files hold, which must not be allocated before it is noticed
+        for (const auto& entry : std::filesystem::directory_iterator(settings.directory))
+        {
+            std::fstream file(entry.path(), std::ios::binary | std::ios::in | std::ios::out);
+            const std::uint64_t damagedSize = 1ull << 62;
+            file.seekp(16);  // after the magic, the version and the key hash
+            file.write(reinterpret_cast<const char*>(&damagedSize), sizeof(damagedSize));
+        }
+
+        ShaderCache cache;
+        cache.SetDirectory(settings.directory);
+        const auto* bytecode = cache.GetOrCompile(key, compiler.For(key));
+        passed &= Check(bytecode != nullptr && *bytecode == expected && compiler.callCount == 5,
+                        "damaged size compiles again");
+    }
+
+    ShaderCache memoryCache;
+    memoryCache.GetOrCompile(key, compiler.For(key));
+    const auto memoryMicroseconds =
+        MeasureMicroseconds(settings.iterations, [&] { memoryCache.GetOrCompile(key, compiler.For(key)); });
+    const auto diskMicroseconds = MeasureMicroseconds(settings.iterations, [&] {
+        ShaderCache cache;
+        cache.SetDirectory(settings.directory);
+        cache.GetOrCompile(key, compiler.For(key));
+    });
+    passed &= Check(compiler.callCount == 6, "timed loads never compile");
+
+    std::printf("  from memory  %.2f us\n", memoryMicroseconds);
+    std::printf("  from disk    %.2f us\n", diskMicroseconds);
+
+    std::filesystem::remove_all(settings.directory, errorCode);
+    return passed ? 0 : 1;
+}
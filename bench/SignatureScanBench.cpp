@@ -0,0 +1,332 @@
+// Checks the multi-pattern signature scanner against a naive scan per signature, and measures both on a module image,
+// along with checking the signatures where the signature cache says they are.
+//
+// usage: SignatureScanBench [--size 4194304] [--iterations 5] [--seed 1] [--threads 4] [--image <dumped module>]
+//
+// Without --image, a --size byte image is generated with the byte distribution of x86 code, and most of the
+// signatures are planted in it; the rest are not, so that the scan has to go through the whole image for them. Every
+// supported kernel, and the scan split over --threads threads, must find the same offsets as the naive scan, and the
+// cache must find them again but be dropped for another module or when damaged; the exit code is 1 if one of those
+// fails.
+#include "BenchUtilities.hpp"
+#include "Utilities/PatternScanner.hpp"
+#include "Utilities/SignatureCache.hpp"
+#include "Utilities/TaskPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace IWXMVM;
+    using namespace IWXMVM::Signatures;
+    using Clock = std::chrono::steady_clock;
+    using Bench::Check;
+
+    struct BenchSettings
+    {
+        std::int32_t imageSize = 4 * 1024 * 1024;
+        std::int32_t iterations = 5;
+        std::uint32_t seed = 1;
+        std::int32_t threadCount = 4;
+        std::filesystem::path imagePath;
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "size")
+                settings.imageSize = std::stoi(value);
+            else if (key == "iterations")
+                settings.iterations = std::stoi(value);
+            else if (key == "seed")
+                settings.seed = static_cast<std::uint32_t>(std::stoul(value));
+            else if (key == "threads")
+                settings.threadCount = std::stoi(value);
+            else if (key == "image")
+                settings.imagePath = value;
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.imageSize <= 0 || settings.iterations <= 0 || settings.threadCount <= 0)
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    // a selection of the signatures iw3 looks for
+    constexpr const char* SIGNATURES[] = {
+        "51 8D 90 ?? ?? ?? ?? 52 50 E8 ?? ?? ?? ?? 68 ?? ?? ?? ?? 57",
+        "53 8D 4C 24 ?? E8 ?? ?? ?? ?? 8D 54 24 ?? 8D 74 24 ?? 8B D8",
+        "8B F0 8B F9 FF 15 ?? ?? ?? ?? 8A 06",
+        "83 C7 10 8B 8E ?? 00 00 00 3B 0D ?? ?? ?? 00",
+        "C3 F6 05 ?? ?? ?? 00 10",
+        "8B C5 E8 ?? ?? ?? ?? BA",
+        "5C 24 ?? 55 8B 6C 24 ?? 56 8D 44 24 ?? 50 51 8B CB C6 44 24",
+        "00 53 56 57 8B F0 0F 85 ?? ?? ?? ?? 8D 44 24",
+        "6B FF ?? 81 C7 ?? ?? ?? ?? ?? ?? ?? ?? ?? 8D 74 24 ?? F3 A5 83 05 ?? ?? ?? ?? 01",
+        "8D 74 24 ?? D9 5C 24 ?? ?? ?? ?? ?? ?? 5F 5E 5B 8B E5 5D C3",
+        "53 55 56 8B F0 05 ?? ?? ?? ?? 8B C8 57 8B",
+        "81 EC ?? ?? 00 00 A1 ?? ?? ?? ?? 53 33 DB 39",
+        "85 C0 74 ?? 8B FE E8 ?? ?? ?? ?? 8B 0D ?? ?? ?? ?? D9 41 ?? D8 4C 24 0C D9 5E 0C 5F 5E C3",
+        "83 EC ?? D9 46 ?? D9 1D ?? ?? ?? ?? D9 46 ?? D9 1D",
+        "8B F8 6A 00 57 E8 ?? ?? ?? ?? D9 46 ?? D9 9F",
+        "8B C6 59 C3 56 E8 ?? ?? ?? ?? 83 C4 04 ?? ?? ?? ?? ?? CC",
+        "BA ?? ?? ?? ?? E8 ?? ?? ?? ?? 80 3D",
+        "68 ?? ?? ?? ?? E8 ?? ?? ?? ?? 83 C4 0C 68 ?? ?? ?? ?? C1 E6 04",
+        "05 ?? ?? ?? ?? B9 01 00 00 00 01 88 B8 56 02 00",
+        "BA ?? ?? ?? ?? E8 ?? ?? ?? ?? D9 03",
+        "89 1D ?? ?? ?? ?? 5E 5F",
+        "8B 1D ?? ?? ?? ?? 85 DB 74 E0",
+        "F8 83 EC 3C 53 56 57",
+        "?? ?? ?? ?? ?? 81 EC ?? ?? ?? ?? 8D 80 ?? ?? ?? ?? 8D 54 24 ?? 56",
+        "C6 05 ?? ?? ?? ?? 01 88 9E",
+        "5C 24 20 55 56 8B 74 24 20",
+        "69 C9 00 70 07 00 83 C4 0C 68 00 70 07 00 81",
+        "03 44 24 04 0F B7 04 45",
+        "0F BF F0 6B F6 64 81 C6",
+        "0F B6 80 ?? ?? ?? ?? FF 24 85 ?? ?? ?? ?? 83 3D ?? ?? ?? ?? 00 75",
+        "8B 0D ?? ?? ?? ?? 8B 40 04 8B 11 83 C6 04",
+        "83 C4 ?? 53 57 56 ?? ?? ?? ?? ?? 83 C4",
+        "89 86 ?? ?? ?? ?? E8 ?? ?? ?? ?? 88 9F FF 00 00 00",
+        "68 ?? ?? ?? ?? 89 1E",
+        "39 8C 07 ?? ?? ?? ?? 5F",
+        "8B C7 69 C0 58 02 00 00",
+        "E8 ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? 83 F8 0E 0F 87",
+        "55 8B 6C 24 38 85 ED",
+        "83 3D ?? ?? ?? ?? 09 75 ?? ?? ?? ?? ?? ?? 8B CD",
+        "83 C4 2C 5D 5B 59",
+        "83 EC 14 53 8B 5D 08 56 57 8B F8 E8 ?? ?? ?? ?? 8B F0 85 F6 74 0E",
+        "E8 ?? ?? ?? ?? 8B BB ?? ?? ?? ?? 8B F5",
+    };
+
+    std::vector<std::uint16_t> ParseSignature(std::string_view text)
+    {
+        std::vector<std::uint16_t> bytes;
+        for (std::size_t i = 0; i + 1 < text.size(); i += 3)
+        {
+            bytes.push_back(text[i] == '?' ? maskValue
+                                           : static_cast<std::uint16_t>(std::stoul(std::string(text.substr(i, 2)),
+                                                                                   nullptr, 16)));
+        }
+        return bytes;
+    }
+
+    // bytes that are common in x86 code (zeros, ModRM bytes of stack accesses, movs, calls and pushes) are drawn more
+    // often, so that anchoring on the rarest byte is measured with a realistic distribution
+    std::vector<std::uint8_t> GenerateImage(std::size_t size, std::mt19937& random)
+    {
+        std::array<double, 256> weights;
+        weights.fill(1.0);
+        weights[0x00] = 60.0;
+        weights[0xFF] = 12.0;
+        for (const auto common : {0x8B, 0x89, 0x24, 0x44, 0x04, 0xE8, 0x83, 0xC4, 0x0C, 0x08, 0x01, 0x50, 0x56, 0x57,
+                                  0x85, 0xC0, 0x74, 0x75, 0x6A, 0x68, 0xCC, 0xC3, 0x10, 0x5E, 0x5F, 0xD9, 0x0F, 0x8D})
+        {
+            weights[common] = 6.0;
+        }
+
+        std::discrete_distribution<std::int32_t> distribution(weights.begin(), weights.end());
+        std::vector<std::uint8_t> image(size);
+        for (auto& byte : image)
+        {
+            byte = static_cast<std::uint8_t>(distribution(random));
+        }
+        return image;
+    }
+
+    void Plant(std::vector<std::uint8_t>& image, std::span<const std::uint16_t> pattern, std::size_t offset,
+               std::mt19937& random)
+    {
+        for (std::size_t i = 0; i < pattern.size(); i++)
+        {
+            image[offset + i] = pattern[i] == maskValue ? static_cast<std::uint8_t>(random()) : pattern[i];
+        }
+    }
+
+    template <typename Function>
+    double MeasureMilliseconds(std::int32_t iterations, const Function& function)
+    {
+        const auto start = Clock::now();
+        for (std::int32_t i = 0; i < iterations; i++)
+        {
+            function();
+        }
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    std::mt19937 random(settings.seed);
+    std::vector<std::vector<std::uint16_t>> patterns;
+    for (const auto* signature : SIGNATURES)
+    {
+        patterns.push_back(ParseSignature(signature));
+    }
+
+    std::vector<std::uint8_t> image;
+    if (!settings.imagePath.empty())
+    {
+        std::ifstream file(settings.imagePath, std::ios::binary);
+        if (!file)
+        {
+            std::fprintf(stderr, "Failed to open %s\n", settings.imagePath.string().c_str());
+            return 2;
+        }
+        image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    else
+    {
+        image = GenerateImage(static_cast<std::size_t>(settings.imageSize), random);
+
+        // one in eight is left out, and the last one goes right at the end of the image
+        for (std::size_t i = 0; i < patterns.size(); i++)
+        {
+            if (i % 8 == 7 || patterns[i].size() > image.size())
+                continue;
+
+            const auto offset = i + 1 == patterns.size()
+                                    ? image.size() - patterns[i].size()
+                                    : std::uniform_int_distribution<std::size_t>(0, image.size() - patterns[i].size())(
+                                          random);
+            Plant(image, patterns[i], offset, random);
+        }
+    }
+
+    PatternScanner scanner;
+    for (const auto& pattern : patterns)
+    {
+        scanner.AddPattern(pattern);
+    }
+
+    std::vector<std::optional<std::size_t>> expected;
+    const auto naiveMilliseconds = MeasureMilliseconds(settings.iterations, [&] {
+        expected.clear();
+        for (const auto& pattern : patterns)
+        {
+            expected.push_back(FindPattern(image, pattern));
+        }
+    });
+
+    const auto foundCount = std::count_if(expected.begin(), expected.end(), [](const auto& x) { return x.has_value(); });
+    std::printf("%zu signatures in a %zu byte image, %td found\n", patterns.size(), image.size(), foundCount);
+
+    bool passed = true;
+    std::vector<std::pair<PatternScanner::Kernel, double>> timings;
+    for (const auto kernel :
+         {PatternScanner::Kernel::Reference, PatternScanner::Kernel::Sse2, PatternScanner::Kernel::Avx2})
+    {
+        if (!PatternScanner::IsKernelSupported(kernel))
+        {
+            std::printf("  %-48s skipped\n", PatternScanner::GetKernelLabel(kernel));
+            continue;
+        }
+
+        std::vector<std::optional<std::size_t>> results;
+        const auto milliseconds =
+            MeasureMilliseconds(settings.iterations, [&] { results = scanner.Scan(image, kernel); });
+        timings.emplace_back(kernel, milliseconds);
+
+        char description[64];
+        std::snprintf(description, sizeof(description), "%s finds what the naive scan finds",
+                      PatternScanner::GetKernelLabel(kernel));
+        passed &= Check(results == expected, description);
+
+        // the tail that is too short for a whole vector, and patterns that only fit at the very start or end
+        const std::vector<std::uint8_t> shortImage(image.end() - std::min<std::size_t>(image.size(), 45), image.end());
+        std::vector<std::optional<std::size_t>> shortExpected;
+        for (const auto& pattern : patterns)
+        {
+            shortExpected.push_back(FindPattern(shortImage, pattern));
+        }
+        std::snprintf(description, sizeof(description), "%s finds the same in a short image",
+                      PatternScanner::GetKernelLabel(kernel));
+        passed &= Check(scanner.Scan(shortImage, kernel) == shortExpected, description);
+    }
+
+    std::vector<std::optional<std::size_t>> parallelResults;
+    TaskPool pool(static_cast<std::size_t>(settings.threadCount));
+    const auto parallelMilliseconds =
+        MeasureMilliseconds(settings.iterations, [&] { parallelResults = scanner.Scan(image, pool); });
+    passed &= Check(parallelResults == expected, "split scan finds what the naive scan finds");
+
+    // what a launch with an unchanged game does: load the cache, and check every signature where it was found
+    const auto cachePath = std::filesystem::temp_directory_path() / "IWXMVMSignatureScanBench.cache";
+    const auto identity = HashSampledBytes(HASH_SEED, image);
+    {
+        SignatureCache cache;
+        cache.Reset(identity);
+        for (std::size_t i = 0; i < patterns.size(); i++)
+        {
+            if (expected[i].has_value())
+                cache.Store(i, {expected[i].value(), expected[i].value() + 1});
+        }
+        passed &= Check(cache.Save(cachePath), "cache is saved");
+    }
+
+    std::size_t validCount = 0;
+    const auto cachedMilliseconds = MeasureMilliseconds(settings.iterations, [&] {
+        SignatureCache cache;
+        validCount = 0;
+        if (!cache.Load(cachePath, HashSampledBytes(HASH_SEED, image)))
+            return;
+
+        for (std::size_t i = 0; i < patterns.size(); i++)
+        {
+            const auto entry = cache.Find(i);
+            if (entry.has_value() && MatchesAt(image, static_cast<std::size_t>(entry->matchAddress), patterns[i]) &&
+                entry->address == entry->matchAddress + 1)
+            {
+                validCount++;
+            }
+        }
+    });
+    passed &= Check(validCount == static_cast<std::size_t>(foundCount), "cached signatures are found again");
+    {
+        SignatureCache cache;
+        passed &= Check(!cache.Load(cachePath, identity + 1), "cache of another module is dropped");
+
+        std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(-1, std::ios::end);
+        const auto last = static_cast<char>(file.get());
+        file.seekp(-1, std::ios::end);
+        file.put(static_cast<char>(~last));
+        file.close();
+        passed &= Check(foundCount == 0 || !cache.Load(cachePath, identity), "damaged cache is dropped");
+    }
+    std::error_code errorCode;
+    std::filesystem::remove(cachePath, errorCode);
+
+    std::printf("  naive, one pass per signature  %8.2f ms\n", naiveMilliseconds);
+    for (const auto& [kernel, milliseconds] : timings)
+    {
+        std::printf("  %-30s %8.2f ms  (%.1fx)\n", PatternScanner::GetKernelLabel(kernel), milliseconds,
+                    naiveMilliseconds / milliseconds);
+    }
+    char label[32];
+    std::snprintf(label, sizeof(label), "split over %d threads", settings.threadCount);
+    std::printf("  %-30s %8.2f ms  (%.1fx)\n", label, parallelMilliseconds, naiveMilliseconds / parallelMilliseconds);
+    std::printf("  %-30s %8.2f ms  (%.1fx)\n", "cached", cachedMilliseconds, naiveMilliseconds / cachedMilliseconds);
+
+    return passed ? 0 : 1;
+}
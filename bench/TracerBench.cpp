@@ -0,0 +1,145 @@
+// Checks what the startup tracer records and writes, and measures what a zone costs.
+//
+// usage: TracerBench [--zones 100000] [--threads 4] [--output <trace.json>]
+//
+// The exit code is 1 if nested zones don't nest, threads don't get their own ids, a disabled tracer records, the
+// event limit is not kept, or the written trace doesn't hold every zone. With --output, the trace of the threaded case
+// is written there, to open it in chrome://tracing or Perfetto.
+#include "BenchUtilities.hpp"
+#include "Utilities/Tracer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace IWXMVM::Tracing;
+    using Bench::Check;
+    using Bench::CountOccurrences;
+
+    struct BenchSettings
+    {
+        std::int32_t zoneCount = 100000;
+        std::int32_t threadCount = 4;
+        std::filesystem::path outputPath;
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "zones")
+                settings.zoneCount = std::stoi(value);
+            else if (key == "threads")
+                settings.threadCount = std::stoi(value);
+            else if (key == "output")
+                settings.outputPath = value;
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.zoneCount <= 0 || settings.threadCount <= 0)
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        return true;
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    bool passed = true;
+    {
+        Tracer tracer;
+        {
+            ScopedZone outer("Initialize", tracer);
+            ScopedZone inner("Resolve \"signatures\"", tracer);
+        }
+
+        // zones are recorded when they end, so the inner one comes first
+        const auto events = tracer.GetEvents();
+        passed &= Check(events.size() == 2 && events[1].begin <= events[0].begin && events[0].end <= events[1].end &&
+                            events[0].threadIndex == events[1].threadIndex,
+                        "nested zones nest");
+
+        const auto json = tracer.ToChromeTraceJson();
+        passed &= Check(json.find("Resolve \\\"signatures\\\"") != std::string::npos, "names are escaped");
+
+        tracer.SetEnabled(false);
+        {
+            ScopedZone zone("Disabled", tracer);
+        }
+        passed &= Check(tracer.GetEvents().size() == 2, "disabled tracer records nothing");
+    }
+    {
+        Tracer tracer;
+        for (std::size_t i = 0; i < Tracer::MAX_EVENTS + 10; i++)
+        {
+            ScopedZone zone("Zone", tracer);
+        }
+        passed &= Check(tracer.GetEvents().size() == Tracer::MAX_EVENTS && tracer.GetDroppedCount() == 10,
+                        "zones beyond the limit are dropped");
+    }
+
+    Tracer tracer;
+    const auto zonesPerThread = settings.zoneCount / settings.threadCount;
+    const auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (std::int32_t i = 0; i < settings.threadCount; i++)
+    {
+        threads.emplace_back([&]() {
+            ScopedZone thread("Thread", tracer);
+            for (std::int32_t j = 0; j < zonesPerThread; j++)
+            {
+                ScopedZone zone("Zone", tracer);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    const auto events = tracer.GetEvents();
+    std::set<std::uint32_t> threadIndices;
+    for (const auto& event : events)
+    {
+        threadIndices.insert(event.threadIndex);
+    }
+    const auto expectedCount = std::min<std::size_t>(
+        static_cast<std::size_t>(settings.threadCount) * (zonesPerThread + 1), Tracer::MAX_EVENTS);
+    passed &= Check(events.size() == expectedCount, "every zone of every thread is recorded");
+    // once the limit is hit, a thread that started late may not have gotten any of its zones in
+    const auto threadCount = static_cast<std::size_t>(settings.threadCount);
+    passed &= Check(tracer.GetDroppedCount() == 0 ? threadIndices.size() == threadCount
+                                                  : threadIndices.size() <= threadCount,
+                    "threads get their own ids");
+
+    const auto json = tracer.ToChromeTraceJson();
+    passed &= Check(CountOccurrences(json, "\"ph\":\"X\"") == events.size() && json.front() == '{' &&
+                        json.find("\n]}") != std::string::npos,
+                    "trace holds every zone");
+
+    if (!settings.outputPath.empty())
+    {
+        passed &= Check(tracer.WriteChromeTrace(settings.outputPath), "trace is written");
+    }
+
+    std::printf("  %zu zones on %d threads, %.0f ns per zone\n", events.size() + tracer.GetDroppedCount(),
+                settings.threadCount, elapsed * settings.threadCount / std::max<std::size_t>(events.size(), 1));
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+// Measures what entity tracking costs the game thread per captured frame with every client tracked, then reads the
+// stream back and converts it to CSV and JSON.
+//
+// usage: TrackingBench [--frames 5000] [--entities 64] [--bones 8] [--output <temp directory>]
+//
+// Players walk in circles around a camera that turns with them, so points move on and off screen. The exit code is 1
+// if the stream doesn't read back exactly as written or a conversion fails.
+#include "BenchUtilities.hpp"
+#include "Capture/CaptureStatistics.hpp"
+#include "Capture/EntityTracking.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace
+{
+    using namespace IWXMVM::Capture;
+    using Clock = CaptureStatistics::Clock;
+
+    struct BenchSettings
+    {
+        std::int32_t frameCount = 5000;
+        std::int32_t entityCount = static_cast<std::int32_t>(MAX_TRACKED_ENTITIES);
+        std::int32_t boneCount = static_cast<std::int32_t>(MAX_TRACKED_BONES);
+        std::filesystem::path outputDirectory = std::filesystem::temp_directory_path();
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchSettings& settings)
+    {
+        const auto setOption = [&](const std::string& key, const std::string& value) {
+            if (key == "frames")
+                settings.frameCount = std::stoi(value);
+            else if (key == "entities")
+                settings.entityCount = std::stoi(value);
+            else if (key == "bones")
+                settings.boneCount = std::stoi(value);
+            else if (key == "output")
+                settings.outputDirectory = value;
+            else
+                return false;
+            return true;
+        };
+        if (!Bench::ParseOptions(argc, argv, setOption))
+            return false;
+
+        if (settings.frameCount <= 0 || settings.entityCount < 0 ||
+            settings.entityCount > static_cast<std::int32_t>(MAX_TRACKED_ENTITIES) || settings.boneCount < 0 ||
+            settings.boneCount > static_cast<std::int32_t>(MAX_TRACKED_BONES))
+        {
+            std::fprintf(stderr, "Option out of range\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    // what CaptureManager does per frame, with synthetic players instead of the game's entities
+    void GatherFrame(TrackingFrame& frame, std::int32_t frameIndex, const BenchSettings& settings)
+    {
+        const auto time = frameIndex / 250.0f;
+        const ScreenProjection projection({0.0f, 0.0f, 64.0f}, {5.0f, time * 20.0f, 0.0f}, 90.0f, 16.0f / 9.0f, 1920,
+                                          1080);
+
+        frame.frameIndex = frameIndex;
+        frame.tick = static_cast<std::uint32_t>(frameIndex * 4);
+        frame.entityCount = static_cast<std::size_t>(settings.entityCount);
+        for (std::size_t i = 0; i < frame.entityCount; i++)
+        {
+            auto& entity = frame.entities[i];
+            const auto angle = time + static_cast<float>(i) * 0.4f;
+            const auto radius = 200.0f + static_cast<float>(i) * 30.0f;
+
+            entity.entityId = static_cast<std::int32_t>(i);
+            entity.clientNum = static_cast<std::int32_t>(i);
+            entity.origin.position = {std::cos(angle) * radius, std::sin(angle) * radius, 0.0f};
+            entity.origin.isValid = true;
+            projection.Project(entity.origin);
+
+            for (std::int32_t bone = 0; bone < settings.boneCount; bone++)
+            {
+                auto& point = entity.bones[bone];
+                point.position = entity.origin.position;
+                point.position[2] += static_cast<float>(bone) * 8.0f;
+                // some models lack some bones
+                point.isValid = (i + bone) % 7 != 0;
+                projection.Project(point);
+            }
+        }
+    }
+
+    bool ArePointsEqual(const TrackedPoint& a, const TrackedPoint& b)
+    {
+        if (a.isValid != b.isValid)
+            return false;
+        return !a.isValid || (a.position == b.position && a.screen == b.screen && a.isOnScreen == b.isOnScreen);
+    }
+
+    bool AreFramesEqual(const TrackingFrame& a, const TrackingFrame& b, std::size_t boneCount)
+    {
+        if (a.frameIndex != b.frameIndex || a.tick != b.tick || a.entityCount != b.entityCount)
+            return false;
+
+        for (std::size_t i = 0; i < a.entityCount; i++)
+        {
+            const auto& entityA = a.entities[i];
+            const auto& entityB = b.entities[i];
+            if (entityA.entityId != entityB.entityId || entityA.clientNum != entityB.clientNum ||
+                !ArePointsEqual(entityA.origin, entityB.origin))
+                return false;
+
+            for (std::size_t bone = 0; bone < boneCount; bone++)
+            {
+                if (!ArePointsEqual(entityA.bones[bone], entityB.bones[bone]))
+                    return false;
+            }
+        }
+        return true;
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 2;
+
+    const std::vector<std::string> supportedBoneNames = {"j_head",        "j_mainroot",     "tag_weapon",
+                                                         "j_wrist_le",    "j_wrist_ri",     "j_ankle_le",
+                                                         "j_ankle_ri",    "j_shoulder_le"};
+    TrackingHeader header = {250, 1920, 1080, {}};
+    header.boneNames.assign(supportedBoneNames.begin(), supportedBoneNames.begin() + settings.boneCount);
+
+    const auto streamPath = settings.outputDirectory / "tracking_bench.iwxt";
+    TrackingWriter writer;
+    if (!writer.Open(streamPath, header))
+    {
+        std::fprintf(stderr, "Failed to open stream: %s\n", writer.GetError().c_str());
+        return 1;
+    }
+
+    auto frame = std::make_unique<TrackingFrame>();
+    LatencyHistogram gatherLatency;
+    LatencyHistogram writeLatency;
+
+    const auto start = Clock::now();
+    for (std::int32_t i = 0; i < settings.frameCount; i++)
+    {
+        const auto gatherStart = Clock::now();
+        GatherFrame(*frame, i, settings);
+        const auto writeStart = Clock::now();
+        writer.Write(*frame);
+        const auto writeEnd = Clock::now();
+
+        gatherLatency.Record(writeStart - gatherStart);
+        writeLatency.Record(writeEnd - writeStart);
+    }
+    const auto gameThreadSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (!writer.Close())
+    {
+        std::fprintf(stderr, "Failed to write stream: %s\n", writer.GetError().c_str());
+        return 1;
+    }
+    const auto streamByteSize = std::filesystem::file_size(streamPath);
+
+    std::printf("%d frames, %d entities with %d bones each\n", settings.frameCount, settings.entityCount,
+                settings.boneCount);
+    std::printf("  gather     mean %.2f us, p99 %.2f us, max %.2f us\n", gatherLatency.GetMeanMicroseconds(),
+                gatherLatency.GetPercentileMicroseconds(99), gatherLatency.GetMaxMicroseconds());
+    std::printf("  serialize  mean %.2f us, p99 %.2f us, max %.2f us\n", writeLatency.GetMeanMicroseconds(),
+                writeLatency.GetPercentileMicroseconds(99), writeLatency.GetMaxMicroseconds());
+    std::printf("  game thread total %.1f ms, stream %.1f KB (%.0f bytes per frame)\n", gameThreadSeconds * 1000.0,
+                streamByteSize / 1024.0, static_cast<double>(streamByteSize) / settings.frameCount);
+
+    // the stream must read back exactly as it was written
+    bool passed = true;
+    TrackingReader reader;
+    if (!reader.Open(streamPath))
+    {
+        std::fprintf(stderr, "Failed to read stream: %s\n", reader.GetError().c_str());
+        return 1;
+    }
+
+    auto readFrame = std::make_unique<TrackingFrame>();
+    std::int32_t readFrameCount = 0;
+    while (reader.ReadFrame(*readFrame))
+    {
+        GatherFrame(*frame, readFrameCount, settings);
+        if (!AreFramesEqual(*frame, *readFrame, header.boneNames.size()))
+        {
+            std::printf("  frame %d differs after reading it back\n", readFrameCount);
+            passed = false;
+            break;
+        }
+        readFrameCount++;
+    }
+    passed = passed && reader.GetError().empty() && readFrameCount == settings.frameCount &&
+             reader.GetHeader().boneNames == header.boneNames;
+    std::printf("  read back  %d frames  %s\n", readFrameCount, passed ? "ok" : "FAILED");
+
+    for (auto format : {TrackingFormat::Csv, TrackingFormat::Json})
+    {
+        auto outputPath = streamPath;
+        outputPath.replace_extension(GetTrackingFormatExtension(format));
+
+        std::string error;
+        const auto convertStart = Clock::now();
+        const bool converted = ConvertTrackingData(streamPath, outputPath, format, error);
+        const auto milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - convertStart).count();
+        if (!converted)
+        {
+            std::printf("  %-4s       FAILED: %s\n", GetTrackingFormatLabel(format).data(), error.c_str());
+            passed = false;
+            continue;
+        }
+
+        std::printf("  %-4s       %.1f ms, %.1f MB\n", GetTrackingFormatLabel(format).data(), milliseconds,
+                    std::filesystem::file_size(outputPath) / (1024.0 * 1024.0));
+        std::filesystem::remove(outputPath);
+    }
+    std::filesystem::remove(streamPath);
+
+    return passed ? 0 : 1;
+}
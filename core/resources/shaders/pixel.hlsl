@@ -4,6 +4,7 @@ struct PS_INPUT
     float3 normalWorld : NORMAL0;
     float3 positionWorld : NORMAL1;
     float3 color : COLOR;
+    float ignoreLighting : TEXCOORD0;
 };
 
 cbuffer LightInfo : register(c12)
@@ -12,12 +13,11 @@ cbuffer LightInfo : register(c12)
     float4 lightDirection : register(c13);
     float4 camPosition : register(c14);
     float4 filmtweaksParams : register(c15);
-    bool ignoreLighting : register(b0);
 };
 
 float4 main(PS_INPUT input) : COLOR
 {
-    if(ignoreLighting)
+    if(input.ignoreLighting > 0.5)
     {
 	    return float4(input.color, 1);
     }
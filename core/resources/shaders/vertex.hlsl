@@ -3,6 +3,14 @@ struct VS_INPUT
     float3 position : POSITION;
     float3 normal: NORMAL;
     float3 color: COLOR;
+
+    // per instance, from the second stream
+    float4 model0 : TEXCOORD1;
+    float4 model1 : TEXCOORD2;
+    float4 model2 : TEXCOORD3;
+    float4 model3 : TEXCOORD4;
+    float4 tint : COLOR1;
+    float ignoreLighting : TEXCOORD5;
 };
 
 struct VS_OUTPUT
@@ -11,12 +19,12 @@ struct VS_OUTPUT
     float3 normalWorld : NORMAL0;
     float3 positionWorld: NORMAL1;
     float3 color : COLOR;
+    float ignoreLighting : TEXCOORD0;
 };
 
 cbuffer Matrices : register(c0)
 {
     matrix viewProjectionMatrix : register(c0);
-    matrix modelMatrix : register(c4);
 };
 
 
@@ -24,11 +32,15 @@ VS_OUTPUT main(VS_INPUT input)
 {
     VS_OUTPUT output;
 
+    // the instance holds the model matrix column by column, which makes these the rows of its transpose
+    float4x4 modelMatrix = transpose(float4x4(input.model0, input.model1, input.model2, input.model3));
+
     output.position = mul(modelMatrix, float4(input.position, 1));
     output.position = mul(viewProjectionMatrix, output.position);
     output.normalWorld = normalize(mul(modelMatrix, float4(input.normal, 0))).xyz;
     output.positionWorld = mul(modelMatrix, float4(input.position, 1)).xyz;
-    output.color = input.color;
+    output.color = input.color * input.tint.rgb;
+    output.ignoreLighting = input.ignoreLighting;
 
     return output;
 }
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "CaptureStatistics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+
+namespace IWXMVM::Capture
+{
+    std::string_view GetCaptureStageLabel(CaptureStage stage)
+    {
+        switch (stage)
+        {
+            case CaptureStage::StretchRect:
+                return "StretchRect";
+            case CaptureStage::Readback:
+                return "Readback";
+            case CaptureStage::LockCopy:
+                return "Lock/Copy";
+            case CaptureStage::FrameHash:
+                return "Frame Hash";
+            case CaptureStage::EntityTracking:
+                return "Entity Tracking";
+            case CaptureStage::Backpressure:
+                return "Back-pressure";
+            case CaptureStage::ColorGrade:
+                return "Color Grade";
+            case CaptureStage::QueueWait:
+                return "Queue Wait";
+            case CaptureStage::PipeWrite:
+                return "Pipe Write";
+            default:
+                return "Unknown Stage";
+        }
+    }
+
+    void LatencyHistogram::Record(std::chrono::nanoseconds duration)
+    {
+        const auto nanoseconds = static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0));
+
+        buckets[GetBucketIndex(nanoseconds / 1000)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+        auto max = maxNanoseconds.load(std::memory_order_relaxed);
+        while (nanoseconds > max && !maxNanoseconds.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void LatencyHistogram::Reset()
+    {
+        for (auto& bucket : buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count.store(0, std::memory_order_relaxed);
+        totalNanoseconds.store(0, std::memory_order_relaxed);
+        maxNanoseconds.store(0, std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::GetMeanMicroseconds() const
+    {
+        const auto sampleCount = GetCount();
+        if (sampleCount == 0)
+            return 0.0;
+
+        return totalNanoseconds.load(std::memory_order_relaxed) / 1000.0 / sampleCount;
+    }
+
+    double LatencyHistogram::GetMaxMicroseconds() const
+    {
+        return maxNanoseconds.load(std::memory_order_relaxed) / 1000.0;
+    }
+
+    double LatencyHistogram::GetTotalMilliseconds() const
+    {
+        return totalNanoseconds.load(std::memory_order_relaxed) / 1'000'000.0;
+    }
+
+    double LatencyHistogram::GetPercentileMicroseconds(double percentile) const
+    {
+        const auto sampleCount = GetCount();
+        if (sampleCount == 0)
+            return 0.0;
+
+        const auto rank = static_cast<std::uint64_t>(std::clamp(percentile, 0.0, 100.0) / 100.0 * (sampleCount - 1));
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen > rank)
+            {
+                // the bucket bound can overshoot the largest sample that was actually recorded
+                return std::min(static_cast<double>(GetBucketUpperBound(i)), GetMaxMicroseconds());
+            }
+        }
+
+        return GetMaxMicroseconds();
+    }
+
+    std::size_t LatencyHistogram::GetBucketIndex(std::uint64_t microseconds)
+    {
+        constexpr std::uint64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+        if (microseconds < SUB_BUCKET_COUNT)
+            return static_cast<std::size_t>(microseconds);
+
+        const auto exponent = static_cast<std::size_t>(std::bit_width(microseconds) - 1);
+        const auto subBucket =
+            static_cast<std::size_t>((microseconds >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
+        return std::min((exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket, BUCKET_COUNT - 1);
+    }
+
+    std::uint64_t LatencyHistogram::GetBucketUpperBound(std::size_t index)
+    {
+        constexpr std::size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+        if (index < SUB_BUCKET_COUNT)
+            return index;
+
+        const auto shift = index / SUB_BUCKET_COUNT - 1;
+        const auto lowerBound = static_cast<std::uint64_t>(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+        return lowerBound + (std::uint64_t{1} << shift) - 1;
+    }
+
+    void CaptureStatistics::Start()
+    {
+        for (auto& histogram : histograms)
+        {
+            histogram.Reset();
+        }
+        frameCount.store(0, std::memory_order_relaxed);
+        repeatedFrameCount.store(0, std::memory_order_relaxed);
+        byteCount.store(0, std::memory_order_relaxed);
+
+        startTime = Clock::now();
+        isRunning = true;
+    }
+
+    void CaptureStatistics::Stop()
+    {
+        stopTime = Clock::now();
+        isRunning = false;
+    }
+
+    double CaptureStatistics::GetElapsedSeconds() const
+    {
+        const auto endTime = isRunning ? Clock::now() : stopTime;
+        return std::chrono::duration<double>(endTime - startTime).count();
+    }
+
+    double CaptureStatistics::GetFramesPerSecond() const
+    {
+        const auto elapsed = GetElapsedSeconds();
+        return elapsed > 0.0 ? GetFrameCount() / elapsed : 0.0;
+    }
+
+    double CaptureStatistics::GetMegabytesPerSecond() const
+    {
+        const auto elapsed = GetElapsedSeconds();
+        return elapsed > 0.0 ? byteCount.load(std::memory_order_relaxed) / (1024.0 * 1024.0) / elapsed : 0.0;
+    }
+
+    bool CaptureStatistics::WriteCsv(const std::filesystem::path& path) const
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        file << "stage,count,mean_us,p50_us,p90_us,p99_us,max_us,total_ms\n";
+        for (std::size_t i = 0; i < histograms.size(); i++)
+        {
+            const auto& histogram = histograms[i];
+            file << GetCaptureStageLabel(static_cast<CaptureStage>(i)) << ',' << histogram.GetCount() << ','
+                 << histogram.GetMeanMicroseconds() << ',' << histogram.GetPercentileMicroseconds(50) << ','
+                 << histogram.GetPercentileMicroseconds(90) << ',' << histogram.GetPercentileMicroseconds(99) << ','
+                 << histogram.GetMaxMicroseconds() << ',' << histogram.GetTotalMilliseconds() << '\n';
+        }
+
+        file << '\n';
+        file << "frames,repeated_frames,seconds,fps,mb_per_second\n";
+        file << GetFrameCount() << ',' << GetRepeatedFrameCount() << ',' << GetElapsedSeconds() << ','
+             << GetFramesPerSecond() << ',' << GetMegabytesPerSecond() << '\n';
+
+        return file.good();
+    }
+}  // namespace IWXMVM::Capture
@@ -0,0 +1,146 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace IWXMVM::Capture
+{
+    enum class CaptureStage
+    {
+        StretchRect,     // copying the back buffer into the capture render target
+        Readback,        // waiting for the render target to arrive in system memory
+        LockCopy,        // locking the surface and copying/blending the frame out of it
+        FrameHash,       // hashing the frame to find repeats of the previous one
+        EntityTracking,  // gathering and projecting the positions of tracked players
+        Backpressure,    // game thread blocked because every encoder buffer was in flight
+        ColorGrade,      // applying the colour grading LUT
+        QueueWait,       // time a frame spent queued before its encoder picked it up
+        PipeWrite,       // writing a frame into an encoder pipe
+
+        Count
+    };
+
+    std::string_view GetCaptureStageLabel(CaptureStage stage);
+
+    // Log-linear histogram of durations with microsecond resolution. Recording is a couple of relaxed atomic adds, so
+    // it's cheap enough to be called per frame from the game thread and encoder threads at the same time.
+    class LatencyHistogram
+    {
+       public:
+        // eight buckets per power of two (12.5% resolution), covering up to ~60 seconds
+        static constexpr std::size_t SUB_BUCKET_BITS = 3;
+        static constexpr std::size_t BUCKET_COUNT = 192;
+
+        void Record(std::chrono::nanoseconds duration);
+        void Reset();
+
+        std::uint64_t GetCount() const
+        {
+            return count.load(std::memory_order_relaxed);
+        }
+
+        double GetMeanMicroseconds() const;
+        double GetMaxMicroseconds() const;
+        double GetTotalMilliseconds() const;
+
+        // upper bound of the bucket containing the given percentile (0-100)
+        double GetPercentileMicroseconds(double percentile) const;
+
+       private:
+        static std::size_t GetBucketIndex(std::uint64_t microseconds);
+        static std::uint64_t GetBucketUpperBound(std::size_t index);
+
+        std::array<std::atomic<std::uint32_t>, BUCKET_COUNT> buckets = {};
+        std::atomic<std::uint64_t> count = 0;
+        std::atomic<std::uint64_t> totalNanoseconds = 0;
+        std::atomic<std::uint64_t> maxNanoseconds = 0;
+    };
+
+    class CaptureStatistics
+    {
+       public:
+        using Clock = std::chrono::steady_clock;
+
+        void Start();
+        void Stop();
+
+        void Record(CaptureStage stage, std::chrono::nanoseconds duration)
+        {
+            histograms[static_cast<std::size_t>(stage)].Record(duration);
+        }
+
+        void AddFrame(std::size_t byteSize)
+        {
+            frameCount.fetch_add(1, std::memory_order_relaxed);
+            byteCount.fetch_add(byteSize, std::memory_order_relaxed);
+        }
+
+        // a frame that was identical to the previous one and only passed on as a repeat
+        void AddRepeatedFrame()
+        {
+            frameCount.fetch_add(1, std::memory_order_relaxed);
+            repeatedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const LatencyHistogram& GetHistogram(CaptureStage stage) const
+        {
+            return histograms[static_cast<std::size_t>(stage)];
+        }
+
+        std::uint64_t GetFrameCount() const
+        {
+            return frameCount.load(std::memory_order_relaxed);
+        }
+
+        std::uint64_t GetRepeatedFrameCount() const
+        {
+            return repeatedFrameCount.load(std::memory_order_relaxed);
+        }
+
+        double GetElapsedSeconds() const;
+        double GetFramesPerSecond() const;
+        double GetMegabytesPerSecond() const;
+
+        bool WriteCsv(const std::filesystem::path& path) const;
+
+       private:
+        std::array<LatencyHistogram, static_cast<std::size_t>(CaptureStage::Count)> histograms;
+        std::atomic<std::uint64_t> frameCount = 0;
+        std::atomic<std::uint64_t> repeatedFrameCount = 0;
+        std::atomic<std::uint64_t> byteCount = 0;
+
+        Clock::time_point startTime = {};
+        Clock::time_point stopTime = {};
+        std::atomic_bool isRunning = false;
+    };
+
+    // Records the lifetime of the timer into a capture stage; does nothing if no statistics are given
+    class ScopedStageTimer
+    {
+       public:
+        ScopedStageTimer(CaptureStatistics* statistics, CaptureStage stage)
+            : statistics(statistics), stage(stage), start(statistics ? CaptureStatistics::Clock::now()
+                                                                     : CaptureStatistics::Clock::time_point{})
+        {
+        }
+
+        ~ScopedStageTimer()
+        {
+            if (statistics)
+            {
+                statistics->Record(stage, CaptureStatistics::Clock::now() - start);
+            }
+        }
+
+        ScopedStageTimer(ScopedStageTimer const&) = delete;
+        void operator=(ScopedStageTimer const&) = delete;
+
+       private:
+        CaptureStatistics* statistics;
+        CaptureStage stage;
+        CaptureStatistics::Clock::time_point start;
+    };
+}  // namespace IWXMVM::Capture
@@ -0,0 +1,93 @@
+#include "ColorGradingStage.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace IWXMVM::Capture
+{
+    ColorGradingStage::ColorGradingStage(std::shared_ptr<const ColorLut> lut, std::int32_t width, std::int32_t height,
+                                         std::int32_t threadCount, ColorLut::Kernel kernel)
+        : lut(std::move(lut)), width(width), height(height), kernel(kernel)
+    {
+        threadCount = std::clamp(threadCount, 1, std::max(height, 1));
+        for (std::int32_t band = 1; band < threadCount; band++)
+        {
+            workers.emplace_back([this, band]() { RunWorker(band); });
+        }
+    }
+
+    ColorGradingStage::~ColorGradingStage()
+    {
+        {
+            std::lock_guard lock(mutex);
+            quit = true;
+        }
+        startCondition.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ColorGradingStage::Apply(std::span<const std::uint8_t> source, std::span<std::uint8_t> destination)
+    {
+        assert(source.size() == destination.size());
+        assert(source.size() == static_cast<std::size_t>(width) * height * 4);
+
+        {
+            std::lock_guard lock(mutex);
+            this->source = source;
+            this->destination = destination;
+            pendingBands = static_cast<std::int32_t>(workers.size());
+            generation++;
+        }
+        startCondition.notify_all();
+
+        ApplyBand(0);
+
+        std::unique_lock lock(mutex);
+        doneCondition.wait(lock, [&]() { return pendingBands == 0; });
+    }
+
+    void ColorGradingStage::RunWorker(std::int32_t band)
+    {
+        std::uint64_t lastGeneration = 0;
+        while (true)
+        {
+            {
+                std::unique_lock lock(mutex);
+                startCondition.wait(lock, [&]() { return quit || generation != lastGeneration; });
+                if (quit)
+                    return;
+
+                lastGeneration = generation;
+            }
+
+            ApplyBand(band);
+
+            bool isLastBand = false;
+            {
+                std::lock_guard lock(mutex);
+                isLastBand = --pendingBands == 0;
+            }
+            if (isLastBand)
+            {
+                doneCondition.notify_one();
+            }
+        }
+    }
+
+    void ColorGradingStage::ApplyBand(std::int32_t band)
+    {
+        // bands are whole rows so no two threads ever write to the same cache line in the middle of a row
+        const auto bandCount = GetThreadCount();
+        const auto firstRow = static_cast<std::size_t>(height) * band / bandCount;
+        const auto lastRow = static_cast<std::size_t>(height) * (band + 1) / bandCount;
+        const auto rowByteSize = static_cast<std::size_t>(width) * 4;
+
+        const auto offset = firstRow * rowByteSize;
+        const auto byteCount = (lastRow - firstRow) * rowByteSize;
+        lut->Apply(source.subspan(offset, byteCount), destination.subspan(offset, byteCount), kernel);
+    }
+}  // namespace IWXMVM::Capture
@@ -0,0 +1,60 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "ColorLut.hpp"
+
+namespace IWXMVM::Capture
+{
+    // Applies a LUT to whole frames, split into bands of rows that are graded in parallel. The calling thread grades
+    // the first band itself and returns once every band is done, so frames leave the stage in order.
+    class ColorGradingStage
+    {
+       public:
+        // threadCount includes the calling thread
+        ColorGradingStage(std::shared_ptr<const ColorLut> lut, std::int32_t width, std::int32_t height,
+                          std::int32_t threadCount, ColorLut::Kernel kernel = ColorLut::GetFastestKernel());
+        ~ColorGradingStage();
+
+        ColorGradingStage(ColorGradingStage const&) = delete;
+        void operator=(ColorGradingStage const&) = delete;
+
+        // source and destination may be the same buffer
+        void Apply(std::span<const std::uint8_t> source, std::span<std::uint8_t> destination);
+
+        std::int32_t GetThreadCount() const
+        {
+            return static_cast<std::int32_t>(workers.size()) + 1;
+        }
+
+        ColorLut::Kernel GetKernel() const
+        {
+            return kernel;
+        }
+
+       private:
+        void RunWorker(std::int32_t band);
+        void ApplyBand(std::int32_t band);
+
+        std::shared_ptr<const ColorLut> lut;
+        std::int32_t width;
+        std::int32_t height;
+        ColorLut::Kernel kernel;
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable startCondition;
+        std::condition_variable doneCondition;
+        std::uint64_t generation = 0;
+        std::int32_t pendingBands = 0;
+        bool quit = false;
+
+        std::span<const std::uint8_t> source;
+        std::span<std::uint8_t> destination;
+    };
+}  // namespace IWXMVM::Capture
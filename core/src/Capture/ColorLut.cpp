@@ -0,0 +1,615 @@
+#include "ColorLut.hpp"
+
+#include "Utilities/CpuFeatures.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define IWXMVM_CAPTURE_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 is picked at runtime, so it's compiled in for every x86 build regardless of the baseline instruction set
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define IWXMVM_CAPTURE_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define IWXMVM_CAPTURE_AVX2_TARGET
+#else
+#define IWXMVM_CAPTURE_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace IWXMVM::Capture
+{
+    namespace
+    {
+        std::string_view Trim(std::string_view text)
+        {
+            const auto first = text.find_first_not_of(" \t\r\n");
+            if (first == std::string_view::npos)
+                return {};
+
+            const auto last = text.find_last_not_of(" \t\r\n");
+            return text.substr(first, last - first + 1);
+        }
+
+        // parses up to values.size() whitespace separated floats and returns how many were read
+        std::size_t ParseFloats(std::string_view text, std::span<float> values)
+        {
+            std::size_t count = 0;
+            const char* position = text.data();
+            const char* end = text.data() + text.size();
+            while (count < values.size())
+            {
+                while (position < end && (*position == ' ' || *position == '\t'))
+                {
+                    position++;
+                }
+                if (position == end)
+                    break;
+
+                const auto result = std::from_chars(position, end, values[count]);
+                if (result.ec != std::errc())
+                    break;
+
+                position = result.ptr;
+                count++;
+            }
+            return count;
+        }
+    }  // namespace
+
+    bool ColorLut::Load(const std::filesystem::path& path)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            error = "Failed to open " + path.string();
+            return false;
+        }
+
+        return Parse(file);
+    }
+
+    bool ColorLut::Parse(std::istream& stream)
+    {
+        std::int32_t newSize = 0;
+        std::string newTitle;
+        std::array<float, 3> domainMin = {0.0f, 0.0f, 0.0f};
+        std::array<float, 3> domainMax = {1.0f, 1.0f, 1.0f};
+        std::vector<float> values;
+
+        std::string line;
+        std::int32_t lineNumber = 0;
+        while (std::getline(stream, line))
+        {
+            lineNumber++;
+
+            const auto text = Trim(line);
+            if (text.empty() || text.front() == '#')
+                continue;
+
+            // table rows are by far the most common lines, so they're checked for first
+            if (text.front() == '-' || text.front() == '.' || (text.front() >= '0' && text.front() <= '9'))
+            {
+                std::array<float, 3> rgb = {};
+                if (newSize == 0 || ParseFloats(text, rgb) != rgb.size())
+                {
+                    error = "Invalid table entry on line " + std::to_string(lineNumber);
+                    return false;
+                }
+                values.insert(values.end(), rgb.begin(), rgb.end());
+                continue;
+            }
+
+            const auto keywordEnd = std::min(text.find_first_of(" \t"), text.size());
+            const auto keyword = text.substr(0, keywordEnd);
+            const auto arguments = Trim(text.substr(keywordEnd));
+
+            if (keyword == "TITLE")
+            {
+                newTitle = arguments;
+                newTitle.erase(std::remove(newTitle.begin(), newTitle.end(), '"'), newTitle.end());
+            }
+            else if (keyword == "LUT_3D_SIZE")
+            {
+                const auto result = std::from_chars(arguments.data(), arguments.data() + arguments.size(), newSize);
+                if (result.ec != std::errc() || newSize < MIN_SIZE || newSize > MAX_SIZE)
+                {
+                    error = "Unsupported LUT size " + std::string(arguments);
+                    return false;
+                }
+                values.reserve(static_cast<std::size_t>(newSize) * newSize * newSize * 3);
+            }
+            else if (keyword == "LUT_1D_SIZE")
+            {
+                error = "1D LUTs are not supported";
+                return false;
+            }
+            else if (keyword == "DOMAIN_MIN" || keyword == "DOMAIN_MAX")
+            {
+                auto& domain = keyword == "DOMAIN_MIN" ? domainMin : domainMax;
+                if (ParseFloats(arguments, domain) != domain.size())
+                {
+                    error = "Invalid domain on line " + std::to_string(lineNumber);
+                    return false;
+                }
+            }
+            else if (keyword == "LUT_3D_INPUT_RANGE")
+            {
+                // Resolve writes the same domain for all three channels like this
+                std::array<float, 2> range = {};
+                if (ParseFloats(arguments, range) != range.size())
+                {
+                    error = "Invalid input range on line " + std::to_string(lineNumber);
+                    return false;
+                }
+                domainMin.fill(range[0]);
+                domainMax.fill(range[1]);
+            }
+            // other keywords (e.g. LUT_IN_VIDEO_RANGE) don't change how the table is applied
+        }
+
+        if (newSize == 0)
+        {
+            error = "No LUT_3D_SIZE found";
+            return false;
+        }
+
+        if (values.size() != static_cast<std::size_t>(newSize) * newSize * newSize * 3)
+        {
+            error = "Expected " + std::to_string(newSize * newSize * newSize) + " table entries, found " +
+                    std::to_string(values.size() / 3);
+            return false;
+        }
+
+        for (std::size_t channel = 0; channel < 3; channel++)
+        {
+            if (domainMax[channel] <= domainMin[channel])
+            {
+                error = "Empty input domain";
+                return false;
+            }
+        }
+
+        title = std::move(newTitle);
+        Build(newSize, std::move(values), domainMin, domainMax);
+        return true;
+    }
+
+    void ColorLut::SetIdentity(std::int32_t newSize)
+    {
+        newSize = std::clamp(newSize, MIN_SIZE, MAX_SIZE);
+
+        std::vector<float> values;
+        values.reserve(static_cast<std::size_t>(newSize) * newSize * newSize * 3);
+        for (std::int32_t b = 0; b < newSize; b++)
+        {
+            for (std::int32_t g = 0; g < newSize; g++)
+            {
+                for (std::int32_t r = 0; r < newSize; r++)
+                {
+                    values.push_back(static_cast<float>(r) / (newSize - 1));
+                    values.push_back(static_cast<float>(g) / (newSize - 1));
+                    values.push_back(static_cast<float>(b) / (newSize - 1));
+                }
+            }
+        }
+
+        title = "Identity";
+        Build(newSize, std::move(values), {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f});
+    }
+
+    void ColorLut::Build(std::int32_t newSize, std::vector<float> values, const std::array<float, 3>& domainMin,
+                         const std::array<float, 3>& domainMax)
+    {
+        size = newSize;
+        error.clear();
+
+        const auto pointCount = values.size() / 3;
+        lattice.resize(pointCount * 4);
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            lattice[i * 4 + 0] = values[i * 3 + 2] * 255.0f;
+            lattice[i * 4 + 1] = values[i * 3 + 1] * 255.0f;
+            lattice[i * 4 + 2] = values[i * 3 + 0] * 255.0f;
+            lattice[i * 4 + 3] = 0.0f;
+        }
+
+        // the domain is given in RGB order, everything else here is in the pixel's BGR order
+        const std::array<std::int32_t, 3> strides = {size * size * 4, size * 4, 4};
+        for (std::size_t channel = 0; channel < 3; channel++)
+        {
+            const auto domainSize = domainMax[2 - channel] - domainMin[2 - channel];
+            coordinateScale[channel] = (size - 1) / (255.0f * domainSize);
+            coordinateBias[channel] = -domainMin[2 - channel] * (size - 1) / domainSize;
+
+            for (std::int32_t value = 0; value < 256; value++)
+            {
+                const auto coordinate = std::clamp(value * coordinateScale[channel] + coordinateBias[channel], 0.0f,
+                                                   static_cast<float>(size - 1));
+                const auto cell = std::min(static_cast<std::int32_t>(coordinate), size - 2);
+
+                cellOffsets[channel][value] = cell * strides[channel];
+                cellFractions[channel][value] = coordinate - cell;
+            }
+        }
+    }
+
+    void ColorLut::Apply(std::span<const std::uint8_t> source, std::span<std::uint8_t> destination,
+                         Kernel kernel) const
+    {
+        assert(source.size() == destination.size());
+        assert(IsLoaded());
+
+        const auto pixelCount = std::min(source.size(), destination.size()) / 4;
+        if (!IsLoaded())
+        {
+            if (source.data() != destination.data())
+            {
+                std::memcpy(destination.data(), source.data(), pixelCount * 4);
+            }
+            return;
+        }
+
+        if (!IsKernelSupported(kernel))
+        {
+            kernel = Kernel::Reference;
+        }
+
+        switch (kernel)
+        {
+            case Kernel::Avx2:
+                ApplyAvx2(source.data(), destination.data(), pixelCount);
+                break;
+            case Kernel::Sse2:
+                ApplySse2(source.data(), destination.data(), pixelCount);
+                break;
+            default:
+                ApplyReference(source.data(), destination.data(), pixelCount);
+                break;
+        }
+    }
+
+    bool ColorLut::IsKernelSupported(Kernel kernel)
+    {
+        static const bool isAvx2Supported = CpuFeatures::IsAvx2Supported();
+
+        switch (kernel)
+        {
+            case Kernel::Reference:
+                return true;
+            case Kernel::Sse2:
+#ifdef IWXMVM_CAPTURE_SSE2
+                return true;
+#else
+                return false;
+#endif
+            case Kernel::Avx2:
+                return isAvx2Supported;
+            default:
+                return false;
+        }
+    }
+
+    ColorLut::Kernel ColorLut::GetFastestKernel()
+    {
+        if (IsKernelSupported(Kernel::Avx2))
+            return Kernel::Avx2;
+        if (IsKernelSupported(Kernel::Sse2))
+            return Kernel::Sse2;
+        return Kernel::Reference;
+    }
+
+    const char* ColorLut::GetKernelLabel(Kernel kernel)
+    {
+        switch (kernel)
+        {
+            case Kernel::Reference:
+                return "Reference";
+            case Kernel::Sse2:
+                return "SSE2";
+            case Kernel::Avx2:
+                return "AVX2";
+            default:
+                return "Unknown Kernel";
+        }
+    }
+
+    void ColorLut::ApplyReference(const std::uint8_t* source, std::uint8_t* destination, std::size_t pixelCount) const
+    {
+        for (std::size_t i = 0; i < pixelCount; i++)
+        {
+            const std::uint8_t* pixel = source + i * 4;
+
+            std::array<std::int32_t, 3> cell = {};
+            std::array<float, 3> fraction = {};
+            for (std::size_t channel = 0; channel < 3; channel++)
+            {
+                const auto coordinate = std::clamp(pixel[channel] * coordinateScale[channel] + coordinateBias[channel],
+                                                   0.0f, static_cast<float>(size - 1));
+                cell[channel] = std::min(static_cast<std::int32_t>(coordinate), size - 2);
+                fraction[channel] = coordinate - cell[channel];
+            }
+
+            const auto point = [&](std::int32_t r, std::int32_t g, std::int32_t b) {
+                const auto index = ((cell[0] + b) * size + cell[1] + g) * size + cell[2] + r;
+                return &lattice[static_cast<std::size_t>(index) * 4];
+            };
+
+            const auto fb = fraction[0];
+            const auto fg = fraction[1];
+            const auto fr = fraction[2];
+            const float* c000 = point(0, 0, 0);
+            const float* c111 = point(1, 1, 1);
+
+            // pick the tetrahedron the colour lies in from the order of its position within the cell, and walk from
+            // c000 to c111 along the edges of that tetrahedron
+            const float* first = nullptr;
+            const float* second = nullptr;
+            std::array<float, 3> weights = {};
+            if (fr > fg)
+            {
+                if (fg > fb)
+                {
+                    first = point(1, 0, 0);
+                    second = point(1, 1, 0);
+                    weights = {fr, fg, fb};
+                }
+                else if (fr > fb)
+                {
+                    first = point(1, 0, 0);
+                    second = point(1, 0, 1);
+                    weights = {fr, fb, fg};
+                }
+                else
+                {
+                    first = point(0, 0, 1);
+                    second = point(1, 0, 1);
+                    weights = {fb, fr, fg};
+                }
+            }
+            else
+            {
+                if (fb > fg)
+                {
+                    first = point(0, 0, 1);
+                    second = point(0, 1, 1);
+                    weights = {fb, fg, fr};
+                }
+                else if (fb > fr)
+                {
+                    first = point(0, 1, 0);
+                    second = point(0, 1, 1);
+                    weights = {fg, fb, fr};
+                }
+                else
+                {
+                    first = point(0, 1, 0);
+                    second = point(1, 1, 0);
+                    weights = {fg, fr, fb};
+                }
+            }
+
+            for (std::size_t channel = 0; channel < 3; channel++)
+            {
+                const auto value = c000[channel] + weights[0] * (first[channel] - c000[channel]) +
+                                   weights[1] * (second[channel] - first[channel]) +
+                                   weights[2] * (c111[channel] - second[channel]);
+                destination[i * 4 + channel] = static_cast<std::uint8_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f);
+            }
+            destination[i * 4 + 3] = pixel[3];
+        }
+    }
+
+    void ColorLut::ApplySse2(const std::uint8_t* source, std::uint8_t* destination, std::size_t pixelCount) const
+    {
+        const std::int32_t strideR = 4;
+        const std::int32_t strideG = size * 4;
+        const std::int32_t strideB = size * size * 4;
+        const std::int32_t strideAll = strideR + strideG + strideB;
+
+        for (std::size_t i = 0; i < pixelCount; i++)
+        {
+            const std::uint8_t* pixel = source + i * 4;
+            const auto b = pixel[0];
+            const auto g = pixel[1];
+            const auto r = pixel[2];
+            const auto alpha = pixel[3];
+
+            const auto fb = cellFractions[0][b];
+            const auto fg = cellFractions[1][g];
+            const auto fr = cellFractions[2][r];
+            const float* c000 = lattice.data() + cellOffsets[0][b] + cellOffsets[1][g] + cellOffsets[2][r];
+
+            // same tetrahedra as the reference, written as a weighted sum of the four corners so a corner's three
+            // channels can be blended at once
+            std::int32_t first = 0, second = 0;
+            float largest = 0.0f, middle = 0.0f, smallest = 0.0f;
+            if (fr > fg)
+            {
+                if (fg > fb)
+                {
+                    first = strideR, second = strideR + strideG;
+                    largest = fr, middle = fg, smallest = fb;
+                }
+                else if (fr > fb)
+                {
+                    first = strideR, second = strideR + strideB;
+                    largest = fr, middle = fb, smallest = fg;
+                }
+                else
+                {
+                    first = strideB, second = strideB + strideR;
+                    largest = fb, middle = fr, smallest = fg;
+                }
+            }
+            else
+            {
+                if (fb > fg)
+                {
+                    first = strideB, second = strideB + strideG;
+                    largest = fb, middle = fg, smallest = fr;
+                }
+                else if (fb > fr)
+                {
+                    first = strideG, second = strideG + strideB;
+                    largest = fg, middle = fb, smallest = fr;
+                }
+                else
+                {
+                    first = strideG, second = strideG + strideR;
+                    largest = fg, middle = fr, smallest = fb;
+                }
+            }
+
+#ifdef IWXMVM_CAPTURE_SSE2
+            __m128 value = _mm_mul_ps(_mm_loadu_ps(c000), _mm_set1_ps(1.0f - largest));
+            value = _mm_add_ps(value, _mm_mul_ps(_mm_loadu_ps(c000 + first), _mm_set1_ps(largest - middle)));
+            value = _mm_add_ps(value, _mm_mul_ps(_mm_loadu_ps(c000 + second), _mm_set1_ps(middle - smallest)));
+            value = _mm_add_ps(value, _mm_mul_ps(_mm_loadu_ps(c000 + strideAll), _mm_set1_ps(smallest)));
+
+            // the saturating packs clamp to 0..255
+            __m128i packed = _mm_cvtps_epi32(value);
+            packed = _mm_packs_epi32(packed, packed);
+            packed = _mm_packus_epi16(packed, packed);
+
+            const auto graded = (static_cast<std::uint32_t>(_mm_cvtsi128_si32(packed)) & 0x00FFFFFF) |
+                                (static_cast<std::uint32_t>(alpha) << 24);
+            std::memcpy(destination + i * 4, &graded, sizeof(graded));
+#else
+            for (std::size_t channel = 0; channel < 3; channel++)
+            {
+                const auto value = c000[channel] * (1.0f - largest) + c000[first + channel] * (largest - middle) +
+                                   c000[second + channel] * (middle - smallest) +
+                                   c000[strideAll + channel] * smallest;
+                destination[i * 4 + channel] = static_cast<std::uint8_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f);
+            }
+            destination[i * 4 + 3] = alpha;
+#endif
+        }
+    }
+
+#ifdef IWXMVM_CAPTURE_AVX2
+    namespace
+    {
+        // blends one channel of eight pixels from the four corners of their tetrahedra, clamped to 0..255
+        IWXMVM_CAPTURE_AVX2_TARGET inline __m256i BlendCorners(const float* channel, __m256i c000, __m256i first,
+                                                               __m256i second, __m256i c111, __m256 weight000,
+                                                               __m256 weightFirst, __m256 weightSecond,
+                                                               __m256 weight111)
+        {
+            __m256 value = _mm256_mul_ps(_mm256_i32gather_ps(channel, c000, 4), weight000);
+            value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_i32gather_ps(channel, first, 4), weightFirst));
+            value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_i32gather_ps(channel, second, 4), weightSecond));
+            value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_i32gather_ps(channel, c111, 4), weight111));
+            value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+            return _mm256_cvtps_epi32(value);
+        }
+
+        // maps one channel of eight pixels onto the lattice, returning the cell's offset along that axis and the
+        // position within the cell
+        IWXMVM_CAPTURE_AVX2_TARGET inline __m256 GetCellFraction(__m256i value, __m256 scale, __m256 bias,
+                                                                 __m256 maxCoordinate, __m256i maxCell, __m256i stride,
+                                                                 __m256i& offset)
+        {
+            const __m256 coordinate = _mm256_min_ps(
+                _mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(value), scale), bias), _mm256_setzero_ps()),
+                maxCoordinate);
+            const __m256i cell = _mm256_min_epi32(_mm256_cvttps_epi32(coordinate), maxCell);
+
+            offset = _mm256_mullo_epi32(cell, stride);
+            return _mm256_sub_ps(coordinate, _mm256_cvtepi32_ps(cell));
+        }
+    }  // namespace
+
+    IWXMVM_CAPTURE_AVX2_TARGET void ColorLut::ApplyAvx2(const std::uint8_t* source, std::uint8_t* destination,
+                                                        std::size_t pixelCount) const
+    {
+        const __m256i byteMask = _mm256_set1_epi32(0xFF);
+        const __m256i alphaMask = _mm256_set1_epi32(static_cast<std::int32_t>(0xFF000000));
+        const __m256 maxCoordinate = _mm256_set1_ps(static_cast<float>(size - 1));
+        const __m256i maxCell = _mm256_set1_epi32(size - 2);
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        const __m256i strideR = _mm256_set1_epi32(4);
+        const __m256i strideG = _mm256_set1_epi32(size * 4);
+        const __m256i strideB = _mm256_set1_epi32(size * size * 4);
+        const __m256i strideAll = _mm256_add_epi32(strideR, _mm256_add_epi32(strideG, strideB));
+
+        const float* table = lattice.data();
+        std::size_t i = 0;
+        for (; i + 8 <= pixelCount; i += 8)
+        {
+            const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i * 4));
+
+            __m256i offsetB, offsetG, offsetR;
+            const __m256 fb = GetCellFraction(_mm256_and_si256(pixels, byteMask), _mm256_set1_ps(coordinateScale[0]),
+                                              _mm256_set1_ps(coordinateBias[0]), maxCoordinate, maxCell, strideB,
+                                              offsetB);
+            const __m256 fg = GetCellFraction(_mm256_and_si256(_mm256_srli_epi32(pixels, 8), byteMask),
+                                              _mm256_set1_ps(coordinateScale[1]), _mm256_set1_ps(coordinateBias[1]),
+                                              maxCoordinate, maxCell, strideG, offsetG);
+            const __m256 fr = GetCellFraction(_mm256_and_si256(_mm256_srli_epi32(pixels, 16), byteMask),
+                                              _mm256_set1_ps(coordinateScale[2]), _mm256_set1_ps(coordinateBias[2]),
+                                              maxCoordinate, maxCell, strideR, offsetR);
+            const __m256i c000 = _mm256_add_epi32(offsetB, _mm256_add_epi32(offsetG, offsetR));
+
+            // Instead of branching into one of six tetrahedra, find the axes with the largest and smallest fraction:
+            // the first corner steps along the largest axis, the second along every axis but the smallest. On ties
+            // either choice gives the same colour, since the corner in question is then weighted with zero.
+            const __m256i isRedLargest = _mm256_castps_si256(
+                _mm256_and_ps(_mm256_cmp_ps(fr, fg, _CMP_GE_OQ), _mm256_cmp_ps(fr, fb, _CMP_GE_OQ)));
+            const __m256i isGreenLargest =
+                _mm256_andnot_si256(isRedLargest, _mm256_castps_si256(_mm256_cmp_ps(fg, fb, _CMP_GE_OQ)));
+            const __m256i isBlueSmallest = _mm256_castps_si256(
+                _mm256_and_ps(_mm256_cmp_ps(fb, fr, _CMP_LE_OQ), _mm256_cmp_ps(fb, fg, _CMP_LE_OQ)));
+            const __m256i isGreenSmallest =
+                _mm256_andnot_si256(isBlueSmallest, _mm256_castps_si256(_mm256_cmp_ps(fg, fr, _CMP_LE_OQ)));
+
+            const __m256i firstStride =
+                _mm256_blendv_epi8(_mm256_blendv_epi8(strideB, strideG, isGreenLargest), strideR, isRedLargest);
+            const __m256i smallestStride =
+                _mm256_blendv_epi8(_mm256_blendv_epi8(strideR, strideG, isGreenSmallest), strideB, isBlueSmallest);
+
+            const __m256i first = _mm256_add_epi32(c000, firstStride);
+            const __m256i second = _mm256_sub_epi32(_mm256_add_epi32(c000, strideAll), smallestStride);
+            const __m256i c111 = _mm256_add_epi32(c000, strideAll);
+
+            const __m256 largest = _mm256_max_ps(fr, _mm256_max_ps(fg, fb));
+            const __m256 smallest = _mm256_min_ps(fr, _mm256_min_ps(fg, fb));
+            const __m256 middle = _mm256_sub_ps(_mm256_sub_ps(_mm256_add_ps(fr, _mm256_add_ps(fg, fb)), largest),
+                                                smallest);
+
+            const __m256 weight000 = _mm256_sub_ps(one, largest);
+            const __m256 weightFirst = _mm256_sub_ps(largest, middle);
+            const __m256 weightSecond = _mm256_sub_ps(middle, smallest);
+
+            const __m256i b = BlendCorners(table + 0, c000, first, second, c111, weight000, weightFirst, weightSecond,
+                                           smallest);
+            const __m256i g = BlendCorners(table + 1, c000, first, second, c111, weight000, weightFirst, weightSecond,
+                                           smallest);
+            const __m256i r = BlendCorners(table + 2, c000, first, second, c111, weight000, weightFirst, weightSecond,
+                                           smallest);
+
+            __m256i graded = _mm256_and_si256(pixels, alphaMask);
+            graded = _mm256_or_si256(graded, b);
+            graded = _mm256_or_si256(graded, _mm256_slli_epi32(g, 8));
+            graded = _mm256_or_si256(graded, _mm256_slli_epi32(r, 16));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i * 4), graded);
+        }
+
+        ApplySse2(source + i * 4, destination + i * 4, pixelCount - i);
+    }
+#else
+    void ColorLut::ApplyAvx2(const std::uint8_t* source, std::uint8_t* destination, std::size_t pixelCount) const
+    {
+        ApplySse2(source, destination, pixelCount);
+    }
+#endif
+}  // namespace IWXMVM::Capture
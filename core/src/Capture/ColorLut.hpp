@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace IWXMVM::Capture
+{
+    // 3D colour lookup table as written by Resolve, Premiere, OCIO and most other grading tools (.cube). Frames are
+    // graded with tetrahedral interpolation between the eight lattice points around each colour, which is what those
+    // tools use as well and avoids the hue shifts of trilinear interpolation along the grey axis.
+    class ColorLut
+    {
+       public:
+        enum class Kernel
+        {
+            Reference,  // plain scalar code the other kernels are checked against
+            Sse2,
+            Avx2,
+        };
+
+        // 65 is the largest size commonly exported; bigger tables only cost memory (a 65^3 table is ~4.4 MB)
+        static constexpr std::int32_t MIN_SIZE = 2;
+        static constexpr std::int32_t MAX_SIZE = 65;
+
+        bool Load(const std::filesystem::path& path);
+        bool Parse(std::istream& stream);
+        void SetIdentity(std::int32_t size);
+
+        bool IsLoaded() const
+        {
+            return size != 0;
+        }
+
+        std::int32_t GetSize() const
+        {
+            return size;
+        }
+
+        const std::string& GetTitle() const
+        {
+            return title;
+        }
+
+        std::string GetError() const
+        {
+            return error;
+        }
+
+        // Grades 8 bit BGRA pixels (the layout of D3DFMT_A8R8G8B8) from source into destination, which may be the same
+        // buffer. Alpha is passed through unchanged.
+        void Apply(std::span<const std::uint8_t> source, std::span<std::uint8_t> destination, Kernel kernel) const;
+
+        static bool IsKernelSupported(Kernel kernel);
+        static Kernel GetFastestKernel();
+        static const char* GetKernelLabel(Kernel kernel);
+
+       private:
+        void Build(std::int32_t newSize, std::vector<float> values, const std::array<float, 3>& domainMin,
+                   const std::array<float, 3>& domainMax);
+
+        void ApplyReference(const std::uint8_t* source, std::uint8_t* destination, std::size_t pixelCount) const;
+        void ApplySse2(const std::uint8_t* source, std::uint8_t* destination, std::size_t pixelCount) const;
+        void ApplyAvx2(const std::uint8_t* source, std::uint8_t* destination, std::size_t pixelCount) const;
+
+        std::int32_t size = 0;
+        std::string title;
+        std::string error;
+
+        // Lattice points with red changing fastest (the .cube order), four floats each in B, G, R, 0 order so a
+        // point can be blended as one vector and lands in the pixel's byte order. Values are scaled to 0..255.
+        std::vector<float> lattice;
+
+        // maps an 8 bit channel value onto the lattice, [0] is blue like in the pixel; the domain is folded in
+        std::array<float, 3> coordinateScale = {};
+        std::array<float, 3> coordinateBias = {};
+
+        // the same mapping precomputed for every channel value, as the float offset of the lattice cell's base point
+        // and the position within that cell
+        std::array<std::array<std::int32_t, 256>, 3> cellOffsets = {};
+        std::array<std::array<float, 256>, 3> cellFractions = {};
+    };
+}  // namespace IWXMVM::Capture
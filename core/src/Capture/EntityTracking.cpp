@@ -0,0 +1,493 @@
+#include "EntityTracking.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <numbers>
+
+namespace IWXMVM::Capture
+{
+    namespace
+    {
+        constexpr char MAGIC[4] = {'I', 'W', 'X', 'T'};
+        constexpr std::uint16_t VERSION = 1;
+
+        constexpr std::uint8_t POINT_VALID = 1;
+        constexpr std::uint8_t POINT_ON_SCREEN = 2;
+
+        constexpr std::size_t FRAME_HEADER_SIZE = sizeof(std::int32_t) + sizeof(std::uint32_t) + sizeof(std::uint8_t);
+        constexpr std::size_t ENTITY_HEADER_SIZE = sizeof(std::uint16_t) + sizeof(std::uint8_t);
+        constexpr std::size_t MAX_POINT_SIZE = sizeof(std::uint8_t) + 5 * sizeof(float);
+        constexpr std::size_t MAX_FRAME_SIZE =
+            FRAME_HEADER_SIZE + MAX_TRACKED_ENTITIES * (ENTITY_HEADER_SIZE + (1 + MAX_TRACKED_BONES) * MAX_POINT_SIZE);
+
+        // the tracking stream is only ever written and read on little endian machines, so values are stored as is
+        template <typename T>
+        std::uint8_t* Store(std::uint8_t* destination, T value)
+        {
+            std::memcpy(destination, &value, sizeof(T));
+            return destination + sizeof(T);
+        }
+
+        std::uint8_t* StorePoint(std::uint8_t* destination, const TrackedPoint& point)
+        {
+            if (!point.isValid)
+                return Store<std::uint8_t>(destination, 0);
+
+            destination = Store<std::uint8_t>(destination, POINT_VALID | (point.isOnScreen ? POINT_ON_SCREEN : 0));
+            for (auto value : point.position)
+                destination = Store(destination, value);
+            for (auto value : point.screen)
+                destination = Store(destination, value);
+            return destination;
+        }
+
+        float Dot(const std::array<float, 3>& a, const std::array<float, 3>& b)
+        {
+            return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        std::string EscapeJson(std::string_view text)
+        {
+            std::string escaped;
+            for (auto character : text)
+            {
+                if (character == '"' || character == '\\')
+                    escaped += '\\';
+                escaped += character;
+            }
+            return escaped;
+        }
+
+        void WriteCsv(TrackingReader& reader, std::FILE* output, TrackingFrame& frame)
+        {
+            const auto& boneNames = reader.GetHeader().boneNames;
+
+            std::fprintf(output, "frame,tick,entity,client,point,x,y,z,screen_x,screen_y,on_screen\n");
+            while (reader.ReadFrame(frame))
+            {
+                for (std::size_t i = 0; i < frame.entityCount; i++)
+                {
+                    const auto& entity = frame.entities[i];
+                    auto writePoint = [&](const TrackedPoint& point, std::string_view name) {
+                        if (!point.isValid)
+                            return;
+
+                        std::fprintf(output, "%d,%u,%d,%d,%.*s,%.3f,%.3f,%.3f,%.2f,%.2f,%d\n", frame.frameIndex,
+                                     frame.tick, entity.entityId, entity.clientNum, static_cast<int>(name.size()),
+                                     name.data(), point.position[0], point.position[1], point.position[2],
+                                     point.screen[0], point.screen[1], point.isOnScreen ? 1 : 0);
+                    };
+
+                    writePoint(entity.origin, "origin");
+                    for (std::size_t bone = 0; bone < boneNames.size(); bone++)
+                    {
+                        writePoint(entity.bones[bone], boneNames[bone]);
+                    }
+                }
+            }
+        }
+
+        void WriteJson(TrackingReader& reader, std::FILE* output, TrackingFrame& frame)
+        {
+            const auto& header = reader.GetHeader();
+
+            std::fprintf(output, "{\n  \"framerate\": %d,\n  \"width\": %d,\n  \"height\": %d,\n  \"bones\": [",
+                         header.framerate, header.width, header.height);
+            for (std::size_t bone = 0; bone < header.boneNames.size(); bone++)
+            {
+                std::fprintf(output, "%s\"%s\"", bone > 0 ? ", " : "", EscapeJson(header.boneNames[bone]).c_str());
+            }
+            std::fprintf(output, "],\n  \"frames\": [");
+
+            bool isFirstFrame = true;
+            while (reader.ReadFrame(frame))
+            {
+                std::fprintf(output, "%s\n    {\"frame\": %d, \"tick\": %u, \"entities\": [", isFirstFrame ? "" : ",",
+                             frame.frameIndex, frame.tick);
+                isFirstFrame = false;
+
+                for (std::size_t i = 0; i < frame.entityCount; i++)
+                {
+                    const auto& entity = frame.entities[i];
+                    std::fprintf(output, "%s\n      {\"entity\": %d, \"client\": %d, \"points\": {", i > 0 ? "," : "",
+                                 entity.entityId, entity.clientNum);
+
+                    bool isFirstPoint = true;
+                    auto writePoint = [&](const TrackedPoint& point, const std::string& name) {
+                        if (!point.isValid)
+                            return;
+
+                        std::fprintf(output,
+                                     "%s\"%s\": {\"position\": [%.3f, %.3f, %.3f], \"screen\": [%.2f, %.2f], "
+                                     "\"on_screen\": %s}",
+                                     isFirstPoint ? "" : ", ", name.c_str(), point.position[0], point.position[1],
+                                     point.position[2], point.screen[0], point.screen[1],
+                                     point.isOnScreen ? "true" : "false");
+                        isFirstPoint = false;
+                    };
+
+                    writePoint(entity.origin, "origin");
+                    for (std::size_t bone = 0; bone < header.boneNames.size(); bone++)
+                    {
+                        writePoint(entity.bones[bone], EscapeJson(header.boneNames[bone]));
+                    }
+                    std::fprintf(output, "}}");
+                }
+                std::fprintf(output, "%s]}", frame.entityCount > 0 ? "\n    " : "");
+            }
+            std::fprintf(output, "\n  ]\n}\n");
+        }
+    }  // namespace
+
+    ScreenProjection::ScreenProjection(const std::array<float, 3>& position, const std::array<float, 3>& angles,
+                                       float fov, float aspectRatio, std::int32_t width, std::int32_t height)
+        : position(position), width(static_cast<float>(width)), height(static_cast<float>(height))
+    {
+        constexpr auto DEGREES_TO_RADIANS = std::numbers::pi_v<float> / 180.0f;
+
+        // the game's AngleVectors: x is forward, y is left and z is up
+        const auto sp = std::sin(angles[0] * DEGREES_TO_RADIANS), cp = std::cos(angles[0] * DEGREES_TO_RADIANS);
+        const auto sy = std::sin(angles[1] * DEGREES_TO_RADIANS), cy = std::cos(angles[1] * DEGREES_TO_RADIANS);
+        const auto sr = std::sin(angles[2] * DEGREES_TO_RADIANS), cr = std::cos(angles[2] * DEGREES_TO_RADIANS);
+
+        forward = {cp * cy, cp * sy, -sp};
+        right = {-sr * sp * cy + cr * sy, -sr * sp * sy - cr * cy, -sr * cp};
+        up = {cr * sp * cy + sr * sy, cr * sp * sy - sr * cy, cr * cp};
+
+        tanHalfFovX = std::tan(fov * 0.5f * DEGREES_TO_RADIANS);
+        tanHalfFovY = tanHalfFovX / aspectRatio;
+    }
+
+    void ScreenProjection::Project(TrackedPoint& point) const
+    {
+        const std::array<float, 3> offset = {point.position[0] - position[0], point.position[1] - position[1],
+                                             point.position[2] - position[2]};
+
+        // points behind the near plane have no meaningful screen position
+        const auto depth = Dot(offset, forward);
+        if (depth < 1.0f)
+        {
+            point.screen = {0.0f, 0.0f};
+            point.isOnScreen = false;
+            return;
+        }
+
+        const auto x = Dot(offset, right) / (depth * tanHalfFovX);
+        const auto y = Dot(offset, up) / (depth * tanHalfFovY);
+        point.screen = {(1.0f + x) * 0.5f * width, (1.0f - y) * 0.5f * height};
+        point.isOnScreen = std::abs(x) <= 1.0f && std::abs(y) <= 1.0f;
+    }
+
+    TrackingWriter::~TrackingWriter()
+    {
+        Close();
+    }
+
+    bool TrackingWriter::Open(const std::filesystem::path& path, TrackingHeader header)
+    {
+        if (header.boneNames.size() > MAX_TRACKED_BONES)
+        {
+            error = "Too many tracked bones";
+            return false;
+        }
+
+        file = std::fopen(path.string().c_str(), "wb");
+        if (!file)
+        {
+            error = "Failed to open " + path.string();
+            return false;
+        }
+        this->header = std::move(header);
+
+        // the buffer for serializing frames doubles as the one for the header, which is always smaller
+        frameBytes.resize(MAX_FRAME_SIZE);
+        auto* end = std::copy(std::begin(MAGIC), std::end(MAGIC), frameBytes.data());
+        end = Store(end, VERSION);
+        end = Store(end, static_cast<std::uint8_t>(this->header.boneNames.size()));
+        end = Store(end, this->header.framerate);
+        end = Store(end, this->header.width);
+        end = Store(end, this->header.height);
+        for (const auto& name : this->header.boneNames)
+        {
+            const auto length = std::min<std::size_t>(name.size(), 255);
+            end = Store(end, static_cast<std::uint8_t>(length));
+            end = std::copy(name.begin(), name.begin() + length, end);
+        }
+
+        const auto byteCount = static_cast<std::size_t>(end - frameBytes.data());
+        if (std::fwrite(frameBytes.data(), 1, byteCount, file) != byteCount)
+        {
+            error = "Failed to write header";
+            std::fclose(file);
+            file = nullptr;
+            return false;
+        }
+
+        quit = false;
+        writerThread = std::thread([this]() { RunWriter(); });
+        return true;
+    }
+
+    void TrackingWriter::Write(const TrackingFrame& frame)
+    {
+        const auto boneCount = header.boneNames.size();
+        const auto entityCount = std::min(frame.entityCount, MAX_TRACKED_ENTITIES);
+
+        // serialized outside of the lock, so the writer thread is only ever held up by the copy
+        auto* end = Store(frameBytes.data(), frame.frameIndex);
+        end = Store(end, frame.tick);
+        end = Store(end, static_cast<std::uint8_t>(entityCount));
+        for (std::size_t i = 0; i < entityCount; i++)
+        {
+            const auto& entity = frame.entities[i];
+            end = Store(end, static_cast<std::uint16_t>(entity.entityId));
+            end = Store(end, static_cast<std::uint8_t>(entity.clientNum));
+            end = StorePoint(end, entity.origin);
+            for (std::size_t bone = 0; bone < boneCount; bone++)
+            {
+                end = StorePoint(end, entity.bones[bone]);
+            }
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            pendingBytes.insert(pendingBytes.end(), frameBytes.data(), end);
+        }
+        condition.notify_one();
+    }
+
+    bool TrackingWriter::Close()
+    {
+        if (writerThread.joinable())
+        {
+            {
+                std::lock_guard lock(mutex);
+                quit = true;
+            }
+            condition.notify_one();
+            writerThread.join();
+        }
+
+        if (file)
+        {
+            if (std::fclose(file) != 0 && error.empty())
+            {
+                error = "Failed to close tracking data";
+            }
+            file = nullptr;
+        }
+
+        return error.empty();
+    }
+
+    std::string TrackingWriter::GetError() const
+    {
+        std::lock_guard lock(mutex);
+        return error;
+    }
+
+    void TrackingWriter::RunWriter()
+    {
+        // frames are serialized into pendingBytes while this thread writes the previous batch, and the two buffers
+        // are swapped so neither side allocates once they have grown
+        std::vector<std::uint8_t> bytes;
+        while (true)
+        {
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [&]() { return quit || !pendingBytes.empty(); });
+                if (pendingBytes.empty())
+                    return;
+
+                std::swap(bytes, pendingBytes);
+            }
+
+            if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size())
+            {
+                std::lock_guard lock(mutex);
+                if (error.empty())
+                {
+                    error = "Failed to write tracking data";
+                }
+            }
+            bytes.clear();
+        }
+    }
+
+    bool TrackingReader::Open(const std::filesystem::path& path)
+    {
+        file.open(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            error = "Failed to open " + path.string();
+            return false;
+        }
+
+        char magic[4] = {};
+        std::uint16_t version = 0;
+        std::uint8_t boneCount = 0;
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        file.read(reinterpret_cast<char*>(&boneCount), sizeof(boneCount));
+        file.read(reinterpret_cast<char*>(&header.framerate), sizeof(header.framerate));
+        file.read(reinterpret_cast<char*>(&header.width), sizeof(header.width));
+        file.read(reinterpret_cast<char*>(&header.height), sizeof(header.height));
+        if (!file || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+        {
+            error = path.filename().string() + " is not a tracking stream";
+            return false;
+        }
+        if (version != VERSION || boneCount > MAX_TRACKED_BONES)
+        {
+            error = "Unsupported tracking stream version " + std::to_string(version);
+            return false;
+        }
+
+        header.boneNames.clear();
+        for (std::uint8_t i = 0; i < boneCount; i++)
+        {
+            std::uint8_t length = 0;
+            file.read(reinterpret_cast<char*>(&length), sizeof(length));
+            auto& name = header.boneNames.emplace_back(length, '\0');
+            file.read(name.data(), length);
+        }
+        if (!file)
+        {
+            error = "Tracking stream header is truncated";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool TrackingReader::ReadFrame(TrackingFrame& frame)
+    {
+        auto read = [&](auto& value) { file.read(reinterpret_cast<char*>(&value), sizeof(value)); };
+        auto readPoint = [&](TrackedPoint& point) {
+            std::uint8_t flags = 0;
+            read(flags);
+            point.isValid = (flags & POINT_VALID) != 0;
+            point.isOnScreen = (flags & POINT_ON_SCREEN) != 0;
+            point.position = {};
+            point.screen = {};
+            if (point.isValid)
+            {
+                read(point.position);
+                read(point.screen);
+            }
+        };
+
+        read(frame.frameIndex);
+        if (file.eof())
+            return false;
+
+        std::uint8_t entityCount = 0;
+        read(frame.tick);
+        read(entityCount);
+        if (entityCount > MAX_TRACKED_ENTITIES)
+        {
+            error = "Frame " + std::to_string(frame.frameIndex) + " has too many entities";
+            return false;
+        }
+
+        frame.entityCount = entityCount;
+        for (std::size_t i = 0; i < frame.entityCount; i++)
+        {
+            auto& entity = frame.entities[i];
+            std::uint16_t entityId = 0;
+            std::uint8_t clientNum = 0;
+            read(entityId);
+            read(clientNum);
+            entity.entityId = entityId;
+            entity.clientNum = clientNum;
+
+            readPoint(entity.origin);
+            for (std::size_t bone = 0; bone < header.boneNames.size(); bone++)
+            {
+                readPoint(entity.bones[bone]);
+            }
+        }
+
+        if (!file)
+        {
+            error = "Tracking stream is truncated";
+            return false;
+        }
+        return true;
+    }
+
+    std::string_view GetTrackingFormatLabel(TrackingFormat format)
+    {
+        switch (format)
+        {
+            case TrackingFormat::Binary:
+                return "Binary";
+            case TrackingFormat::Csv:
+                return "CSV";
+            case TrackingFormat::Json:
+                return "JSON";
+            default:
+                return "Unknown Tracking Format";
+        }
+    }
+
+    std::string_view GetTrackingFormatExtension(TrackingFormat format)
+    {
+        switch (format)
+        {
+            case TrackingFormat::Csv:
+                return ".csv";
+            case TrackingFormat::Json:
+                return ".json";
+            default:
+                return ".iwxt";
+        }
+    }
+
+    bool ConvertTrackingData(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath,
+                             TrackingFormat format, std::string& error)
+    {
+        if (format != TrackingFormat::Csv && format != TrackingFormat::Json)
+        {
+            error = "Tracking data can only be converted to CSV or JSON";
+            return false;
+        }
+
+        TrackingReader reader;
+        if (!reader.Open(inputPath))
+        {
+            error = reader.GetError();
+            return false;
+        }
+
+        std::FILE* output = std::fopen(outputPath.string().c_str(), "w");
+        if (!output)
+        {
+            error = "Failed to open " + outputPath.string();
+            return false;
+        }
+
+        // a whole frame is about 14 KB, which is better kept off the stack
+        auto frame = std::make_unique<TrackingFrame>();
+        if (format == TrackingFormat::Csv)
+        {
+            WriteCsv(reader, output, *frame);
+        }
+        else
+        {
+            WriteJson(reader, output, *frame);
+        }
+
+        const bool failed = std::ferror(output) != 0;
+        if (std::fclose(output) != 0 || failed)
+        {
+            error = "Failed to write " + outputPath.string();
+            return false;
+        }
+
+        error = reader.GetError();
+        return error.empty();
+    }
+}  // namespace IWXMVM::Capture
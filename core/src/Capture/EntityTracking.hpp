@@ -0,0 +1,146 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace IWXMVM::Capture
+{
+    // Per-frame positions of players and some of their bones, for compositors that want to attach effects or labels
+    // to them in post. Everything is fixed size, so gathering a frame on the game thread never allocates, and
+    // serialized frames are written to disk by a separate thread.
+    constexpr std::size_t MAX_TRACKED_ENTITIES = 64;  // one per client
+    constexpr std::size_t MAX_TRACKED_BONES = 8;
+
+    struct TrackedPoint
+    {
+        std::array<float, 3> position;
+        std::array<float, 2> screen;  // pixels from the top left corner of the output, may lie outside of it
+        bool isValid;                 // false if the entity's model doesn't have the bone
+        bool isOnScreen;              // in front of the camera and inside the output
+    };
+
+    struct TrackedEntity
+    {
+        std::int32_t entityId;
+        std::int32_t clientNum;
+        TrackedPoint origin;
+        std::array<TrackedPoint, MAX_TRACKED_BONES> bones;  // in the order of TrackingHeader::boneNames
+    };
+
+    struct TrackingFrame
+    {
+        std::int32_t frameIndex;
+        std::uint32_t tick;
+        std::size_t entityCount;
+        std::array<TrackedEntity, MAX_TRACKED_ENTITIES> entities;
+    };
+
+    struct TrackingHeader
+    {
+        std::int32_t framerate;
+        std::int32_t width, height;
+        std::vector<std::string> boneNames;  // at most MAX_TRACKED_BONES
+    };
+
+    // Projects world positions into the pixels of an output, the same way the game's camera sees them
+    class ScreenProjection
+    {
+       public:
+        // angles are pitch, yaw and roll in degrees, fov is horizontal like the game's; aspectRatio is that of the
+        // rendered frame, which is scaled to width x height
+        ScreenProjection(const std::array<float, 3>& position, const std::array<float, 3>& angles, float fov,
+                         float aspectRatio, std::int32_t width, std::int32_t height);
+
+        // sets the point's screen position from its world position
+        void Project(TrackedPoint& point) const;
+
+       private:
+        std::array<float, 3> position;
+        std::array<float, 3> forward, right, up;
+        float tanHalfFovX, tanHalfFovY;
+        float width, height;
+    };
+
+    // Binary tracking stream (little endian, as written by x86):
+    //   "IWXT", u16 version, u8 bone count, i32 framerate, i32 width, i32 height, per bone u8 length + name
+    //   per frame: i32 frame index, u32 tick, u8 entity count, then per entity u16 entity id, u8 client number and
+    //   the origin followed by every bone as u8 flags (1 valid, 2 on screen) and, if valid, 3 + 2 floats
+    class TrackingWriter
+    {
+       public:
+        ~TrackingWriter();
+
+        bool Open(const std::filesystem::path& path, TrackingHeader header);
+        // serializes the frame and queues it for the writer thread, so it never waits for the disk
+        void Write(const TrackingFrame& frame);
+        bool Close();
+
+        const TrackingHeader& GetHeader() const
+        {
+            return header;
+        }
+
+        std::string GetError() const;
+
+       private:
+        void RunWriter();
+
+        TrackingHeader header = {};
+        std::vector<std::uint8_t> frameBytes;
+        std::FILE* file = nullptr;
+        std::thread writerThread;
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        std::vector<std::uint8_t> pendingBytes;
+        bool quit = false;
+        std::string error;
+    };
+
+    class TrackingReader
+    {
+       public:
+        bool Open(const std::filesystem::path& path);
+        // returns false at the end of the stream, or if it is damaged (then GetError says so)
+        bool ReadFrame(TrackingFrame& frame);
+
+        const TrackingHeader& GetHeader() const
+        {
+            return header;
+        }
+
+        std::string GetError() const
+        {
+            return error;
+        }
+
+       private:
+        std::ifstream file;
+        TrackingHeader header = {};
+        std::string error;
+    };
+
+    enum class TrackingFormat
+    {
+        Binary,
+        Csv,   // one row per tracked point
+        Json,  // nested by frame and entity
+
+        Count
+    };
+
+    std::string_view GetTrackingFormatLabel(TrackingFormat format);
+    std::string_view GetTrackingFormatExtension(TrackingFormat format);
+
+    // converts a binary tracking stream into one of the text formats
+    bool ConvertTrackingData(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath,
+                             TrackingFormat format, std::string& error);
+}  // namespace IWXMVM::Capture
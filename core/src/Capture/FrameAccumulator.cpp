@@ -0,0 +1,95 @@
+// Capture pipeline sources are kept free of Windows/D3D9 headers (and therefore don't use the precompiled header), so
+// they can be compiled and benchmarked outside of the game.
+#include "FrameAccumulator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define IWXMVM_CAPTURE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace IWXMVM::Capture
+{
+    void FrameAccumulator::Reset(std::size_t frameByteSize)
+    {
+        sums.assign(frameByteSize, 0);
+        sampleCount = 0;
+    }
+
+    void FrameAccumulator::Accumulate(std::span<const std::uint8_t> frame)
+    {
+        assert(frame.size() == sums.size());
+        assert(sampleCount < MAX_SAMPLES);
+
+        const std::size_t size = std::min(frame.size(), sums.size());
+        std::size_t i = 0;
+
+#ifdef IWXMVM_CAPTURE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= size; i += 16)
+        {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame.data() + i));
+            __m128i* sum = reinterpret_cast<__m128i*>(sums.data() + i);
+
+            _mm_storeu_si128(sum, _mm_add_epi16(_mm_loadu_si128(sum), _mm_unpacklo_epi8(pixels, zero)));
+            _mm_storeu_si128(sum + 1, _mm_add_epi16(_mm_loadu_si128(sum + 1), _mm_unpackhi_epi8(pixels, zero)));
+        }
+#endif
+
+        for (; i < size; i++)
+        {
+            sums[i] += frame[i];
+        }
+
+        sampleCount++;
+    }
+
+    void FrameAccumulator::Resolve(std::span<std::uint8_t> output)
+    {
+        assert(output.size() == sums.size());
+
+        const std::size_t size = std::min(output.size(), sums.size());
+
+        if (sampleCount <= 1)
+        {
+            for (std::size_t i = 0; i < size; i++)
+            {
+                output[i] = static_cast<std::uint8_t>(sums[i]);
+            }
+            Reset(sums.size());
+            return;
+        }
+
+        // divide by multiplying with a 16 bit fixed point reciprocal; this is exact to within one LSB,
+        // which is well below anything visible in a blended frame
+        const auto bias = static_cast<std::uint16_t>(sampleCount / 2);
+        const auto reciprocal = static_cast<std::uint16_t>((65536 + sampleCount - 1) / sampleCount);
+        std::size_t i = 0;
+
+#ifdef IWXMVM_CAPTURE_SSE2
+        const __m128i biasVector = _mm_set1_epi16(static_cast<short>(bias));
+        const __m128i reciprocalVector = _mm_set1_epi16(static_cast<short>(reciprocal));
+        for (; i + 16 <= size; i += 16)
+        {
+            const __m128i* sum = reinterpret_cast<const __m128i*>(sums.data() + i);
+
+            const __m128i low = _mm_mulhi_epu16(_mm_add_epi16(_mm_loadu_si128(sum), biasVector), reciprocalVector);
+            const __m128i high = _mm_mulhi_epu16(_mm_add_epi16(_mm_loadu_si128(sum + 1), biasVector), reciprocalVector);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output.data() + i), _mm_packus_epi16(low, high));
+        }
+#endif
+
+        for (; i < size; i++)
+        {
+            const std::uint32_t value = (static_cast<std::uint32_t>(sums[i] + bias) * reciprocal) >> 16;
+            output[i] = static_cast<std::uint8_t>(std::min<std::uint32_t>(value, UINT8_MAX));
+        }
+
+        std::memset(sums.data(), 0, sums.size() * sizeof(sums[0]));
+        sampleCount = 0;
+    }
+}  // namespace IWXMVM::Capture
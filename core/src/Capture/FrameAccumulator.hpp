@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace IWXMVM::Capture
+{
+    // Blends a number of 8 bit sub-frames into a single output frame. Sub-frames are summed into a 16 bit buffer and
+    // averaged on Resolve, so the (expensive) encoder only ever sees one frame per output frame.
+    class FrameAccumulator
+    {
+       public:
+        // 255 * 256 still fits into an unsigned 16 bit lane
+        static constexpr std::int32_t MAX_SAMPLES = 256;
+
+        void Reset(std::size_t frameByteSize);
+        void Accumulate(std::span<const std::uint8_t> frame);
+        void Resolve(std::span<std::uint8_t> output);
+
+        std::int32_t GetSampleCount() const
+        {
+            return sampleCount;
+        }
+
+        std::size_t GetFrameByteSize() const
+        {
+            return sums.size();
+        }
+
+       private:
+        std::vector<std::uint16_t> sums;
+        std::int32_t sampleCount = 0;
+    };
+}  // namespace IWXMVM::Capture
@@ -0,0 +1,182 @@
+#include "FrameFanOut.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace IWXMVM::Capture
+{
+    FrameFanOut::FrameFanOut(std::size_t frameByteSize, std::size_t poolCapacity, CaptureStatistics* statistics)
+        : pool(frameByteSize, poolCapacity), statistics(statistics)
+    {
+    }
+
+    FrameFanOut::~FrameFanOut()
+    {
+        StopWorkers();
+    }
+
+    void FrameFanOut::AddSink(std::unique_ptr<FrameSink> sink)
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->sink = std::move(sink);
+        workers.push_back(std::move(worker));
+    }
+
+    void FrameFanOut::SetColorGrading(std::unique_ptr<ColorGradingStage> stage)
+    {
+        colorGrading = std::move(stage);
+    }
+
+    bool FrameFanOut::Open()
+    {
+        for (auto& worker : workers)
+        {
+            if (!worker->sink->Open())
+            {
+                worker->failed = true;
+                failed = true;
+                return false;
+            }
+
+            worker->isOpen = true;
+            worker->thread = std::thread([this, &worker = *worker]() { RunWorker(worker); });
+        }
+
+        return true;
+    }
+
+    bool FrameFanOut::Write(std::int32_t frameIndex, std::span<const std::uint8_t> pixels)
+    {
+        if (failed)
+            return false;
+
+        std::shared_ptr<CapturedFrame> frame;
+        {
+            ScopedStageTimer timer(statistics, CaptureStage::Backpressure);
+            frame = pool.Acquire();
+        }
+
+        frame->index = frameIndex;
+        if (colorGrading)
+        {
+            ScopedStageTimer timer(statistics, CaptureStage::ColorGrade);
+            colorGrading->Apply(pixels, frame->pixels);
+        }
+        else
+        {
+            std::memcpy(frame->pixels.data(), pixels.data(), std::min(frame->pixels.size(), pixels.size()));
+        }
+
+        lastFrame = frame;
+        Enqueue({frame, std::nullopt, CaptureStatistics::Clock::now()});
+        return !failed;
+    }
+
+    bool FrameFanOut::WriteRepeat(std::int32_t frameIndex)
+    {
+        if (failed || !lastFrame)
+            return false;
+
+        Enqueue({lastFrame, frameIndex, CaptureStatistics::Clock::now()});
+        return !failed;
+    }
+
+    bool FrameFanOut::Close()
+    {
+        lastFrame.reset();
+        StopWorkers();
+
+        for (auto& worker : workers)
+        {
+            if (worker->isOpen)
+            {
+                worker->isOpen = false;
+                if (!worker->sink->Close())
+                {
+                    worker->failed = true;
+                    failed = true;
+                }
+            }
+        }
+
+        return !failed;
+    }
+
+    std::string FrameFanOut::GetError() const
+    {
+        for (const auto& worker : workers)
+        {
+            if (worker->failed)
+                return worker->sink->GetError();
+        }
+        return {};
+    }
+
+    void FrameFanOut::RunWorker(Worker& worker)
+    {
+        while (true)
+        {
+            QueuedFrame queuedFrame;
+            {
+                std::unique_lock lock(worker.mutex);
+                worker.condition.wait(lock, [&]() { return worker.quit || !worker.frames.empty(); });
+                if (worker.frames.empty())
+                    return;
+
+                queuedFrame = std::move(worker.frames.front());
+                worker.frames.pop_front();
+            }
+
+            if (statistics)
+            {
+                statistics->Record(CaptureStage::QueueWait, CaptureStatistics::Clock::now() - queuedFrame.queueTime);
+            }
+
+            // a failed sink keeps draining its queue so the frames it holds go back to the pool
+            if (worker.failed)
+                continue;
+
+            const bool written =
+                queuedFrame.repeatIndex.has_value()
+                    ? worker.sink->WriteRepeat(queuedFrame.repeatIndex.value(), queuedFrame.frame)
+                    : worker.sink->Write(queuedFrame.frame);
+            if (!written)
+            {
+                worker.failed = true;
+                failed = true;
+            }
+        }
+    }
+
+    void FrameFanOut::Enqueue(const QueuedFrame& queuedFrame)
+    {
+        for (auto& worker : workers)
+        {
+            {
+                std::lock_guard lock(worker->mutex);
+                worker->frames.push_back(queuedFrame);
+            }
+            worker->condition.notify_one();
+        }
+    }
+
+    void FrameFanOut::StopWorkers()
+    {
+        for (auto& worker : workers)
+        {
+            {
+                std::lock_guard lock(worker->mutex);
+                worker->quit = true;
+            }
+            worker->condition.notify_one();
+        }
+
+        for (auto& worker : workers)
+        {
+            if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+        }
+    }
+}  // namespace IWXMVM::Capture
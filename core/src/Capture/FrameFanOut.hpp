@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CaptureStatistics.hpp"
+#include "ColorGradingStage.hpp"
+#include "FramePool.hpp"
+#include "FrameSink.hpp"
+
+namespace IWXMVM::Capture
+{
+    // Hands every captured frame to any number of sinks. The frame is copied once into a pooled buffer that all sinks
+    // share, and each sink consumes it on its own worker thread, so one readback can feed several outputs in a single
+    // playthrough.
+    class FrameFanOut
+    {
+       public:
+        FrameFanOut(std::size_t frameByteSize, std::size_t poolCapacity, CaptureStatistics* statistics);
+        ~FrameFanOut();
+
+        FrameFanOut(FrameFanOut const&) = delete;
+        void operator=(FrameFanOut const&) = delete;
+
+        void AddSink(std::unique_ptr<FrameSink> sink);
+
+        // grades frames while they're copied into the shared buffer, so every sink gets the graded frame
+        void SetColorGrading(std::unique_ptr<ColorGradingStage> stage);
+
+        bool Open();
+        bool Write(std::int32_t frameIndex, std::span<const std::uint8_t> pixels);
+        // passes on a frame that is identical to the last one written, without copying it again (see
+        // FrameSink::WriteRepeat); the last frame stays referenced for this, so it holds on to one pool buffer
+        bool WriteRepeat(std::int32_t frameIndex);
+        // drains all workers and closes every sink; returns false if any of them failed
+        bool Close();
+
+        std::size_t GetSinkCount() const
+        {
+            return workers.size();
+        }
+
+        // the first error any sink ran into
+        std::string GetError() const;
+
+       private:
+        struct QueuedFrame
+        {
+            SharedFrame frame;
+            std::optional<std::int32_t> repeatIndex;  // set if this is a repeat of the frame
+            CaptureStatistics::Clock::time_point queueTime;
+        };
+
+        struct Worker
+        {
+            std::unique_ptr<FrameSink> sink;
+            std::thread thread;
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::deque<QueuedFrame> frames;
+            bool quit = false;
+
+            std::atomic_bool failed = false;
+            bool isOpen = false;
+        };
+
+        void RunWorker(Worker& worker);
+        void Enqueue(const QueuedFrame& queuedFrame);
+        void StopWorkers();
+
+        FramePool pool;
+        CaptureStatistics* statistics;
+        std::unique_ptr<ColorGradingStage> colorGrading;
+        std::vector<std::unique_ptr<Worker>> workers;
+        SharedFrame lastFrame;
+        std::atomic_bool failed = false;
+    };
+}  // namespace IWXMVM::Capture
@@ -0,0 +1,199 @@
+#include "FrameHash.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define IWXMVM_CAPTURE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace IWXMVM::Capture
+{
+    namespace
+    {
+        constexpr std::uint64_t PRIME32_1 = 0x9E3779B1;
+        constexpr std::uint64_t PRIME32_2 = 0x85EBCA77;
+        constexpr std::uint64_t PRIME32_3 = 0xC2B2AE3D;
+        constexpr std::uint64_t PRIME64_1 = 0x9E3779B185EBCA87;
+        constexpr std::uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4F;
+        constexpr std::uint64_t PRIME64_3 = 0x165667B19E3779F9;
+        constexpr std::uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63;
+        constexpr std::uint64_t PRIME64_5 = 0x27D4EB2F165667C5;
+
+        constexpr std::size_t LANE_COUNT = 8;
+        constexpr std::size_t STRIPE_SIZE = LANE_COUNT * sizeof(std::uint64_t);
+        // accumulators are scrambled after every block, which keeps the multiplies from losing entropy over long inputs
+        constexpr std::size_t STRIPES_PER_BLOCK = 16;
+
+        using Lanes = std::array<std::uint64_t, LANE_COUNT>;
+
+        constexpr std::uint64_t SplitMix64(std::uint64_t value)
+        {
+            value += 0x9E3779B97F4A7C15;
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+            return value ^ (value >> 31);
+        }
+
+        constexpr Lanes MakeKey(std::uint64_t seed)
+        {
+            Lanes key = {};
+            for (std::size_t i = 0; i < LANE_COUNT; i++)
+            {
+                key[i] = SplitMix64(seed + i);
+            }
+            return key;
+        }
+
+        alignas(16) constexpr Lanes ACCUMULATE_KEY = MakeKey(0);
+        alignas(16) constexpr Lanes SCRAMBLE_KEY = MakeKey(LANE_COUNT);
+
+        std::uint64_t Read64(const std::uint8_t* data)
+        {
+            std::uint64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        std::uint64_t RotateLeft(std::uint64_t value, int count)
+        {
+            return (value << count) | (value >> (64 - count));
+        }
+
+        std::uint64_t Avalanche(std::uint64_t hash)
+        {
+            hash ^= hash >> 33;
+            hash *= PRIME64_2;
+            hash ^= hash >> 29;
+            hash *= PRIME64_3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+        void AccumulateStripe(Lanes& accumulators, const std::uint8_t* stripe)
+        {
+            for (std::size_t i = 0; i < LANE_COUNT; i++)
+            {
+                const auto data = Read64(stripe + i * sizeof(std::uint64_t));
+                const auto keyed = data ^ ACCUMULATE_KEY[i];
+                accumulators[i ^ 1] += data;
+                accumulators[i] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+            }
+        }
+
+        void Scramble(Lanes& accumulators)
+        {
+            for (std::size_t i = 0; i < LANE_COUNT; i++)
+            {
+                auto accumulator = accumulators[i];
+                accumulator ^= accumulator >> 47;
+                accumulator ^= SCRAMBLE_KEY[i];
+                accumulators[i] = accumulator * PRIME32_1;
+            }
+        }
+
+        // hashes all full stripes
+        void AccumulateStripes(Lanes& accumulators, const std::uint8_t* data, std::size_t stripeCount, bool useSse2)
+        {
+            std::size_t stripe = 0;
+
+#ifdef IWXMVM_CAPTURE_SSE2
+            const std::size_t vectorStripeCount = useSse2 ? stripeCount : 0;
+
+            constexpr std::size_t VECTOR_COUNT = LANE_COUNT / 2;
+
+            __m128i vectors[VECTOR_COUNT];
+            __m128i accumulateKey[VECTOR_COUNT];
+            __m128i scrambleKey[VECTOR_COUNT];
+            for (std::size_t i = 0; i < VECTOR_COUNT; i++)
+            {
+                vectors[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulators.data() + i * 2));
+                accumulateKey[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(ACCUMULATE_KEY.data() + i * 2));
+                scrambleKey[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(SCRAMBLE_KEY.data() + i * 2));
+            }
+            const __m128i prime = _mm_set1_epi32(static_cast<int>(PRIME32_1));
+
+            for (; stripe < vectorStripeCount; stripe++)
+            {
+                const std::uint8_t* input = data + stripe * STRIPE_SIZE;
+                for (std::size_t i = 0; i < VECTOR_COUNT; i++)
+                {
+                    // same as AccumulateStripe, for two lanes: the high half of each keyed lane times its low half,
+                    // plus the other lane's data
+                    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+                    const __m128i keyed = _mm_xor_si128(value, accumulateKey[i]);
+                    const __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+                    const __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                    vectors[i] = _mm_add_epi64(vectors[i], _mm_add_epi64(product, swapped));
+                }
+
+                if ((stripe + 1) % STRIPES_PER_BLOCK == 0)
+                {
+                    for (std::size_t i = 0; i < VECTOR_COUNT; i++)
+                    {
+                        // a 64x32 bit multiply built from the two 32x32 bit halves
+                        __m128i accumulator = _mm_xor_si128(vectors[i], _mm_srli_epi64(vectors[i], 47));
+                        accumulator = _mm_xor_si128(accumulator, scrambleKey[i]);
+                        const __m128i low = _mm_mul_epu32(accumulator, prime);
+                        const __m128i high =
+                            _mm_mul_epu32(_mm_shuffle_epi32(accumulator, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+                        vectors[i] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+                    }
+                }
+            }
+
+            for (std::size_t i = 0; i < VECTOR_COUNT; i++)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulators.data() + i * 2), vectors[i]);
+            }
+#else
+            static_cast<void>(useSse2);
+#endif
+
+            for (; stripe < stripeCount; stripe++)
+            {
+                AccumulateStripe(accumulators, data + stripe * STRIPE_SIZE);
+                if ((stripe + 1) % STRIPES_PER_BLOCK == 0)
+                {
+                    Scramble(accumulators);
+                }
+            }
+        }
+
+        std::uint64_t HashPixels(std::span<const std::uint8_t> pixels, bool useSse2)
+        {
+            Lanes accumulators = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                                  PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+
+            const auto stripeCount = pixels.size() / STRIPE_SIZE;
+            AccumulateStripes(accumulators, pixels.data(), stripeCount, useSse2);
+
+            const auto remainder = pixels.size() % STRIPE_SIZE;
+            if (remainder != 0)
+            {
+                std::uint8_t lastStripe[STRIPE_SIZE] = {};
+                std::memcpy(lastStripe, pixels.data() + stripeCount * STRIPE_SIZE, remainder);
+                AccumulateStripe(accumulators, lastStripe);
+            }
+
+            std::uint64_t hash = pixels.size() * PRIME64_1;
+            for (std::size_t i = 0; i < LANE_COUNT; i++)
+            {
+                hash ^= Avalanche(accumulators[i] ^ SCRAMBLE_KEY[i]);
+                hash = RotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+            }
+            return Avalanche(hash);
+        }
+    }  // namespace
+
+    std::uint64_t HashFrame(std::span<const std::uint8_t> pixels)
+    {
+        return HashPixels(pixels, true);
+    }
+
+    std::uint64_t HashFrameScalar(std::span<const std::uint8_t> pixels)
+    {
+        return HashPixels(pixels, false);
+    }
+}  // namespace IWXMVM::Capture
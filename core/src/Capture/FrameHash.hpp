@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+namespace IWXMVM::Capture
+{
+    // Fast 64 bit hash for telling whether a frame is an exact repeat of the previous one. It uses the stripe
+    // accumulation of XXH3 (eight 64 bit lanes fed 64 bytes at a time with 32x32 bit multiplies, which SSE2 does two
+    // at a time), but with a fixed key and a simpler final mix, so it does not produce XXH3 values. The SSE2 and
+    // scalar paths give the same result.
+    std::uint64_t HashFrame(std::span<const std::uint8_t> pixels);
+
+    // the same hash without SSE2, to check that both paths agree
+    std::uint64_t HashFrameScalar(std::span<const std::uint8_t> pixels);
+}  // namespace IWXMVM::Capture
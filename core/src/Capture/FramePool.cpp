@@ -0,0 +1,31 @@
+#include "FramePool.hpp"
+
+namespace IWXMVM::Capture
+{
+    FramePool::FramePool(std::size_t frameByteSize, std::size_t capacity) : state(std::make_shared<State>())
+    {
+        for (std::size_t i = 0; i < capacity; i++)
+        {
+            auto frame = std::make_unique<CapturedFrame>();
+            frame->pixels.resize(frameByteSize);
+            state->freeFrames.push_back(std::move(frame));
+        }
+    }
+
+    std::shared_ptr<CapturedFrame> FramePool::Acquire()
+    {
+        std::unique_lock lock(state->mutex);
+        state->condition.wait(lock, [&]() { return !state->freeFrames.empty(); });
+
+        auto* frame = state->freeFrames.back().release();
+        state->freeFrames.pop_back();
+
+        return std::shared_ptr<CapturedFrame>(frame, [state = state](CapturedFrame* frame) {
+            {
+                std::lock_guard lock(state->mutex);
+                state->freeFrames.emplace_back(frame);
+            }
+            state->condition.notify_one();
+        });
+    }
+}  // namespace IWXMVM::Capture
@@ -0,0 +1,43 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace IWXMVM::Capture
+{
+    struct CapturedFrame
+    {
+        std::int32_t index = 0;  // output frame number, counted from the capture's start tick
+        std::vector<std::uint8_t> pixels;
+    };
+
+    // Frames are shared between every output of a capture and only ever read after being handed out
+    using SharedFrame = std::shared_ptr<const CapturedFrame>;
+
+    // Fixed set of frame buffers that are reference counted while in flight. A buffer goes back into the pool once the
+    // last output is done with it, and Acquire blocks while all of them are in use, which is what throttles the game
+    // to the speed of the slowest output.
+    class FramePool
+    {
+       public:
+        FramePool(std::size_t frameByteSize, std::size_t capacity);
+
+        FramePool(FramePool const&) = delete;
+        void operator=(FramePool const&) = delete;
+
+        std::shared_ptr<CapturedFrame> Acquire();
+
+       private:
+        // outlives the pool if frames are still referenced when it's destroyed
+        struct State
+        {
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::vector<std::unique_ptr<CapturedFrame>> freeFrames;
+        };
+
+        std::shared_ptr<State> state;
+    };
+}  // namespace IWXMVM::Capture
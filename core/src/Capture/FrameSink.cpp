@@ -0,0 +1,178 @@
+#include "FrameSink.hpp"
+
+#include <system_error>
+
+#include "ProcessPipe.hpp"
+
+namespace IWXMVM::Capture
+{
+    PipeSink::PipeSink(std::string command, CaptureStatistics* statistics)
+        : command(std::move(command)), statistics(statistics)
+    {
+    }
+
+    PipeSink::~PipeSink()
+    {
+        if (pipe)
+        {
+            CloseProcessPipe(pipe);
+        }
+    }
+
+    bool PipeSink::Open()
+    {
+        pipe = OpenProcessPipe(command);
+        if (!pipe)
+        {
+            error = "Failed to start " + command;
+            return false;
+        }
+        return true;
+    }
+
+    bool PipeSink::Write(const SharedFrame& frame)
+    {
+        ScopedStageTimer timer(statistics, CaptureStage::PipeWrite);
+        if (std::fwrite(frame->pixels.data(), frame->pixels.size(), 1, pipe) != 1)
+        {
+            error = "Failed to write frame " + std::to_string(frame->index);
+            return false;
+        }
+        return true;
+    }
+
+    bool PipeSink::Close()
+    {
+        if (!pipe)
+            return false;
+
+        const auto exitCode = CloseProcessPipe(pipe);
+        pipe = nullptr;
+
+        if (exitCode != 0)
+        {
+            error = "Process exited with code " + std::to_string(exitCode);
+            return false;
+        }
+        return true;
+    }
+
+    std::string PipeSink::GetError() const
+    {
+        return error;
+    }
+
+    ImageSequenceSink::ImageSequenceSink(std::string command, std::filesystem::path filePattern,
+                                         std::int32_t firstNumber, CaptureStatistics* statistics)
+        : pipe(std::move(command), statistics), filePattern(std::move(filePattern)), firstNumber(firstNumber)
+    {
+    }
+
+    bool ImageSequenceSink::Open()
+    {
+        writtenFrames.clear();
+        repeatedFrames.clear();
+        return pipe.Open();
+    }
+
+    bool ImageSequenceSink::Write(const SharedFrame& frame)
+    {
+        writtenFrames.push_back(frame->index);
+        return pipe.Write(frame);
+    }
+
+    bool ImageSequenceSink::WriteRepeat(std::int32_t frameIndex, const SharedFrame& previousFrame)
+    {
+        repeatedFrames.emplace_back(frameIndex, previousFrame->index);
+        return true;
+    }
+
+    bool ImageSequenceSink::Close()
+    {
+        if (!pipe.Close())
+            return false;
+
+        // the n-th file holds a frame with an index of at least n, so going backwards never renames a file onto one
+        // that is still waiting to be renamed
+        std::error_code errorCode;
+        for (auto i = static_cast<std::int32_t>(writtenFrames.size()) - 1; i >= 0; i--)
+        {
+            if (writtenFrames[i] == i)
+                continue;
+
+            std::filesystem::rename(GetFilePath(i), GetFilePath(writtenFrames[i]), errorCode);
+            if (errorCode)
+            {
+                error = "Failed to rename " + GetFilePath(i).string() + ": " + errorCode.message();
+                return false;
+            }
+        }
+
+        for (const auto& [frameIndex, repeatedIndex] : repeatedFrames)
+        {
+            const auto source = GetFilePath(repeatedIndex);
+            const auto destination = GetFilePath(frameIndex);
+
+            // a file left over from an earlier capture would make the link fail; not every file system supports
+            // hard links either (FAT32/exFAT don't), those get a copy
+            std::filesystem::remove(destination, errorCode);
+            std::filesystem::create_hard_link(source, destination, errorCode);
+            if (errorCode)
+            {
+                std::filesystem::copy_file(source, destination, std::filesystem::copy_options::overwrite_existing,
+                                           errorCode);
+            }
+            if (errorCode)
+            {
+                error = "Failed to write " + destination.string() + ": " + errorCode.message();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::string ImageSequenceSink::GetError() const
+    {
+        return error.empty() ? pipe.GetError() : error;
+    }
+
+    std::filesystem::path ImageSequenceSink::GetFilePath(std::int32_t frameIndex) const
+    {
+        char fileName[260];
+        std::snprintf(fileName, sizeof(fileName), filePattern.filename().string().c_str(), firstNumber + frameIndex);
+        return filePattern.parent_path() / fileName;
+    }
+
+    SegmentedSink::SegmentedSink(SegmentedEncoderSettings settings, std::filesystem::path outputPath)
+        : encoder(std::move(settings)), outputPath(std::move(outputPath))
+    {
+    }
+
+    bool SegmentedSink::Open()
+    {
+        return encoder.Open();
+    }
+
+    bool SegmentedSink::Write(const SharedFrame& frame)
+    {
+        // when resuming, the capture restarts at the earliest frame any output still needs
+        if (frame->index < encoder.GetResumeFrame())
+            return true;
+
+        return encoder.WriteFrame(frame);
+    }
+
+    bool SegmentedSink::WriteRepeat(std::int32_t frameIndex, const SharedFrame& previousFrame)
+    {
+        if (frameIndex < encoder.GetResumeFrame())
+            return true;
+
+        return encoder.WriteFrame(previousFrame);
+    }
+
+    bool SegmentedSink::Close()
+    {
+        return encoder.Finish(outputPath);
+    }
+}  // namespace IWXMVM::Capture
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CaptureStatistics.hpp"
+#include "FramePool.hpp"
+#include "SegmentedEncoder.hpp"
+
+namespace IWXMVM::Capture
+{
+    // One output of a capture. Sinks are driven by their own worker thread (see FrameFanOut), so Write may block
+    // for as long as the sink needs without holding up the game or other outputs.
+    class FrameSink
+    {
+       public:
+        virtual ~FrameSink() = default;
+
+        virtual bool Open() = 0;
+        virtual bool Write(const SharedFrame& frame) = 0;
+        // Called for a frame that is identical to the previous one, with that previous frame. Encoders simply get the
+        // frame again; sinks that can refer back to an earlier frame override this to avoid writing it twice.
+        virtual bool WriteRepeat([[maybe_unused]] std::int32_t frameIndex, const SharedFrame& previousFrame)
+        {
+            return Write(previousFrame);
+        }
+        // flushes everything and finishes the output; may take a while
+        virtual bool Close() = 0;
+
+        virtual std::string GetError() const = 0;
+    };
+
+    // Writes raw frames into the stdin of a single process
+    class PipeSink : public FrameSink
+    {
+       public:
+        PipeSink(std::string command, CaptureStatistics* statistics);
+        ~PipeSink() override;
+
+        bool Open() override;
+        bool Write(const SharedFrame& frame) override;
+        bool Close() override;
+
+        std::string GetError() const override;
+
+       private:
+        std::string command;
+        CaptureStatistics* statistics;
+        FILE* pipe = nullptr;
+        std::string error;
+    };
+
+    // Writes an image sequence through a process that numbers its files consecutively, like ffmpeg's image2 muxer.
+    // Repeated frames aren't sent to the process at all. Once it has exited, its files are renamed to the numbers of
+    // the frames they hold and every repeat becomes a hard link to the file it repeats, so freeze frames take up no
+    // extra space.
+    class ImageSequenceSink : public FrameSink
+    {
+       public:
+        // filePattern is the process' printf-style output pattern (e.g. output_%06d.tga), counting from firstNumber
+        ImageSequenceSink(std::string command, std::filesystem::path filePattern, std::int32_t firstNumber,
+                          CaptureStatistics* statistics);
+
+        bool Open() override;
+        bool Write(const SharedFrame& frame) override;
+        bool WriteRepeat(std::int32_t frameIndex, const SharedFrame& previousFrame) override;
+        bool Close() override;
+
+        std::string GetError() const override;
+
+       private:
+        std::filesystem::path GetFilePath(std::int32_t frameIndex) const;
+
+        PipeSink pipe;
+        std::filesystem::path filePattern;
+        std::int32_t firstNumber;
+
+        // frame index of every file the process wrote, in the order it wrote them
+        std::vector<std::int32_t> writtenFrames;
+        // repeated frame index and the index of the frame it repeats
+        std::vector<std::pair<std::int32_t, std::int32_t>> repeatedFrames;
+        std::string error;
+    };
+
+    // Writes raw frames into a SegmentedEncoder, skipping frames that a previous capture already encoded
+    class SegmentedSink : public FrameSink
+    {
+       public:
+        SegmentedSink(SegmentedEncoderSettings settings, std::filesystem::path outputPath);
+
+        bool Open() override;
+        bool Write(const SharedFrame& frame) override;
+        bool WriteRepeat(std::int32_t frameIndex, const SharedFrame& previousFrame) override;
+        bool Close() override;
+
+        std::string GetError() const override
+        {
+            return encoder.GetError();
+        }
+
+        std::int32_t GetResumeFrame() const
+        {
+            return encoder.GetResumeFrame();
+        }
+
+       private:
+        SegmentedEncoder encoder;
+        std::filesystem::path outputPath;
+    };
+}  // namespace IWXMVM::Capture
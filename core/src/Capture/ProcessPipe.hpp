@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdio>
+#include <string>
+
+namespace IWXMVM::Capture
+{
+    // Spawns a process (through the shell) whose stdin we can write raw frames into
+    inline FILE* OpenProcessPipe(const std::string& command)
+    {
+#ifdef _WIN32
+        return _popen(command.c_str(), "wb");
+#else
+        return popen(command.c_str(), "w");
+#endif
+    }
+
+    // Closes the pipe and waits for the process to exit. Returns the exit status, or -1 if it couldn't be retrieved.
+    inline int CloseProcessPipe(FILE* pipe)
+    {
+#ifdef _WIN32
+        return _pclose(pipe);
+#else
+        return pclose(pipe);
+#endif
+    }
+}  // namespace IWXMVM::Capture
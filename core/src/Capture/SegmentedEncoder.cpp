@@ -0,0 +1,291 @@
+#include "SegmentedEncoder.hpp"
+
+#include "ProcessPipe.hpp"
+
+#include <cstdio>
+#include <utility>
+
+namespace IWXMVM::Capture
+{
+    constexpr auto MANIFEST_FILE = "manifest.txt";
+    constexpr auto CONCAT_LIST_FILE = "segments.txt";
+
+    SegmentedEncoder::SegmentedEncoder(SegmentedEncoderSettings settings) : settings(std::move(settings))
+    {
+    }
+
+    SegmentedEncoder::~SegmentedEncoder()
+    {
+        StopEncoders();
+    }
+
+    bool SegmentedEncoder::Open()
+    {
+        if (settings.segmentFrameCount <= 0 || settings.encoderCount <= 0)
+        {
+            SetError("Invalid segment length or encoder count");
+            return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(settings.segmentDirectory, ec);
+        if (ec)
+        {
+            SetError("Failed to create segment directory " + settings.segmentDirectory.string() + ": " + ec.message());
+            return false;
+        }
+
+        ReadManifest();
+
+        manifest.open(settings.segmentDirectory / MANIFEST_FILE, std::ios::trunc);
+        if (!manifest.is_open())
+        {
+            SetError("Failed to write segment manifest");
+            return false;
+        }
+
+        // segments past the first gap are encoded again, so only the contiguous prefix is carried over
+        manifest << settings.manifestKey << '\n';
+        for (std::int32_t segment = 0; segment < resumeSegment; segment++)
+        {
+            manifest << segment << '\n';
+        }
+        manifest.flush();
+
+        frameIndex = GetResumeFrame();
+
+        for (std::int32_t i = 0; i < settings.encoderCount; i++)
+        {
+            auto& encoder = encoders.emplace_back(std::make_unique<Encoder>());
+            encoder->thread = std::thread([this, &encoder = *encoder]() { RunEncoder(encoder); });
+        }
+
+        return true;
+    }
+
+    bool SegmentedEncoder::WriteFrame(SharedFrame frame)
+    {
+        if (failed)
+        {
+            return false;
+        }
+
+        const auto segment = frameIndex / settings.segmentFrameCount;
+        auto& encoder = GetEncoder(segment);
+
+        if (frameIndex % settings.segmentFrameCount == 0)
+        {
+            Push(encoder, Job{Job::Type::Open, segment, nullptr});
+        }
+
+        Push(encoder, Job{Job::Type::Frame, segment, std::move(frame)});
+
+        if (++frameIndex % settings.segmentFrameCount == 0)
+        {
+            Push(encoder, Job{Job::Type::Close, segment, nullptr});
+        }
+
+        return !failed;
+    }
+
+    bool SegmentedEncoder::Finish(const std::filesystem::path& outputPath)
+    {
+        if (encoders.empty())
+        {
+            return false;
+        }
+
+        if (frameIndex % settings.segmentFrameCount != 0)
+        {
+            const auto segment = frameIndex / settings.segmentFrameCount;
+            Push(GetEncoder(segment), Job{Job::Type::Close, segment, nullptr});
+        }
+
+        StopEncoders();
+        manifest.close();
+
+        if (failed)
+        {
+            return false;
+        }
+
+        const auto segmentCount = (frameIndex + settings.segmentFrameCount - 1) / settings.segmentFrameCount;
+        if (segmentCount == 0)
+        {
+            return true;
+        }
+
+        const auto listPath = settings.segmentDirectory / CONCAT_LIST_FILE;
+        {
+            std::ofstream list(listPath, std::ios::trunc);
+            for (std::int32_t segment = 0; segment < segmentCount; segment++)
+            {
+                if (!completedSegments.contains(segment))
+                {
+                    SetError("Segment " + std::to_string(segment) + " was not completed");
+                    return false;
+                }
+
+                list << "file '" << GetSegmentPath(segment).filename().string() << "'\n";
+            }
+        }
+
+        const auto concatCommand = settings.getConcatCommand(listPath, outputPath);
+        if (std::system(concatCommand.c_str()) != 0)
+        {
+            SetError("Failed to concatenate segments: " + concatCommand);
+            return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::remove_all(settings.segmentDirectory, ec);
+        return true;
+    }
+
+    std::string SegmentedEncoder::GetError() const
+    {
+        std::lock_guard lock(stateMutex);
+        return error;
+    }
+
+    void SegmentedEncoder::RunEncoder(Encoder& encoder)
+    {
+        FILE* pipe = nullptr;
+
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock lock(encoder.mutex);
+                encoder.condition.wait(lock, [&]() { return !encoder.jobs.empty(); });
+                job = std::move(encoder.jobs.front());
+                encoder.jobs.pop_front();
+            }
+
+            switch (job.type)
+            {
+                case Job::Type::Open:
+                    pipe = OpenProcessPipe(settings.getEncoderCommand(GetSegmentPath(job.segment)));
+                    if (!pipe)
+                    {
+                        SetError("Failed to start encoder for segment " + std::to_string(job.segment));
+                    }
+                    break;
+                case Job::Type::Frame:
+                    if (pipe && !failed)
+                    {
+                        ScopedStageTimer timer(settings.statistics, CaptureStage::PipeWrite);
+                        const auto& pixels = job.frame->pixels;
+                        if (std::fwrite(pixels.data(), pixels.size(), 1, pipe) != 1)
+                        {
+                            SetError("Failed to write to encoder for segment " + std::to_string(job.segment));
+                        }
+                    }
+                    job.frame.reset();
+                    break;
+                case Job::Type::Close:
+                    if (pipe)
+                    {
+                        const auto exitCode = CloseProcessPipe(std::exchange(pipe, nullptr));
+                        if (exitCode == 0)
+                        {
+                            MarkSegmentComplete(job.segment);
+                        }
+                        else
+                        {
+                            SetError("Encoder for segment " + std::to_string(job.segment) + " exited with code " +
+                                     std::to_string(exitCode));
+                        }
+                    }
+                    break;
+                case Job::Type::Quit:
+                    if (pipe)
+                    {
+                        CloseProcessPipe(pipe);
+                    }
+                    return;
+            }
+        }
+    }
+
+    void SegmentedEncoder::Push(Encoder& encoder, Job job)
+    {
+        {
+            std::lock_guard lock(encoder.mutex);
+            encoder.jobs.push_back(std::move(job));
+        }
+        encoder.condition.notify_one();
+    }
+
+    void SegmentedEncoder::StopEncoders()
+    {
+        for (auto& encoder : encoders)
+        {
+            if (encoder->thread.joinable())
+            {
+                Push(*encoder, Job{Job::Type::Quit, -1, nullptr});
+            }
+        }
+
+        for (auto& encoder : encoders)
+        {
+            if (encoder->thread.joinable())
+            {
+                encoder->thread.join();
+            }
+        }
+    }
+
+    void SegmentedEncoder::ReadManifest()
+    {
+        std::ifstream existingManifest(settings.segmentDirectory / MANIFEST_FILE);
+
+        std::string key;
+        if (existingManifest.is_open() && std::getline(existingManifest, key) && key == settings.manifestKey)
+        {
+            std::int32_t segment = 0;
+            while (existingManifest >> segment)
+            {
+                completedSegments.insert(segment);
+            }
+        }
+
+        while (completedSegments.contains(resumeSegment))
+        {
+            resumeSegment++;
+        }
+
+        completedSegments.erase(completedSegments.lower_bound(resumeSegment), completedSegments.end());
+    }
+
+    void SegmentedEncoder::MarkSegmentComplete(std::int32_t segment)
+    {
+        std::lock_guard lock(stateMutex);
+        completedSegments.insert(segment);
+
+        // flushed right away so the manifest survives the game crashing mid-capture
+        manifest << segment << '\n';
+        manifest.flush();
+    }
+
+    void SegmentedEncoder::SetError(std::string message)
+    {
+        std::lock_guard lock(stateMutex);
+        if (!failed.exchange(true))
+        {
+            error = std::move(message);
+        }
+    }
+
+    std::filesystem::path SegmentedEncoder::GetSegmentPath(std::int32_t segment) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "segment_%06d", segment);
+        return settings.segmentDirectory / (name + settings.segmentExtension);
+    }
+
+    SegmentedEncoder::Encoder& SegmentedEncoder::GetEncoder(std::int32_t segment)
+    {
+        return *encoders[segment % encoders.size()];
+    }
+}  // namespace IWXMVM::Capture
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CaptureStatistics.hpp"
+#include "FramePool.hpp"
+
+namespace IWXMVM::Capture
+{
+    struct SegmentedEncoderSettings
+    {
+        std::filesystem::path segmentDirectory;
+        std::string manifestKey;  // describes the capture; a manifest written for a different capture is discarded
+        std::string segmentExtension;
+        std::int32_t segmentFrameCount;
+        std::int32_t encoderCount;
+
+        // optional; receives pipe write timings
+        CaptureStatistics* statistics = nullptr;
+
+        // shell command for an encoder that reads raw frames from stdin and writes them to the given segment
+        std::function<std::string(const std::filesystem::path& segmentPath)> getEncoderCommand;
+        // shell command that losslessly joins the segments listed in a concat list into one file
+        std::function<std::string(const std::filesystem::path& listPath, const std::filesystem::path& outputPath)>
+            getConcatCommand;
+    };
+
+    // Splits a capture into fixed-length segments and feeds them round-robin to several encoder processes, each with
+    // its own pipe and writer thread. Frames are queued by reference, so memory use is bounded by the frame pool.
+    // Completed segments are recorded in a manifest inside the segment directory, so a capture that was interrupted
+    // can pick up at the first segment that was not finished.
+    class SegmentedEncoder
+    {
+       public:
+        explicit SegmentedEncoder(SegmentedEncoderSettings settings);
+        ~SegmentedEncoder();
+
+        SegmentedEncoder(SegmentedEncoder const&) = delete;
+        void operator=(SegmentedEncoder const&) = delete;
+
+        bool Open();
+        bool WriteFrame(SharedFrame frame);
+        bool Finish(const std::filesystem::path& outputPath);
+
+        // frames before this one were already encoded by a previous capture with the same settings
+        std::int32_t GetResumeFrame() const
+        {
+            return resumeSegment * settings.segmentFrameCount;
+        }
+
+        std::string GetError() const;
+
+       private:
+        struct Job
+        {
+            enum class Type
+            {
+                Open,
+                Frame,
+                Close,
+                Quit
+            };
+
+            Type type;
+            std::int32_t segment;
+            SharedFrame frame;
+        };
+
+        struct Encoder
+        {
+            std::thread thread;
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::deque<Job> jobs;
+        };
+
+        void RunEncoder(Encoder& encoder);
+        void Push(Encoder& encoder, Job job);
+        void StopEncoders();
+
+        void ReadManifest();
+        void MarkSegmentComplete(std::int32_t segment);
+        void SetError(std::string message);
+
+        std::filesystem::path GetSegmentPath(std::int32_t segment) const;
+        Encoder& GetEncoder(std::int32_t segment);
+
+        SegmentedEncoderSettings settings;
+        std::vector<std::unique_ptr<Encoder>> encoders;
+
+        mutable std::mutex stateMutex;
+        std::set<std::int32_t> completedSegments;
+        std::ofstream manifest;
+        std::string error;
+        std::atomic_bool failed = false;
+
+        std::int32_t resumeSegment = 0;
+        std::int32_t frameIndex = 0;
+    };
+}  // namespace IWXMVM::Capture
@@ -13,7 +13,7 @@ namespace IWXMVM::Components
     {
         positionOffset = glm::vec3(0, 10, 0);
 
-        Events::RegisterListener(EventType::PostDemoLoad, [&]() {
+        Events::RegisterListener<EventType::PostDemoLoad>("BoneCamera", [&]() {
             entityId = 0;
         });
     }
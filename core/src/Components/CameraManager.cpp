@@ -4,6 +4,7 @@
 #include "../Events.hpp"
 #include "../Input.hpp"
 #include "Mod.hpp"
+#include "Utilities/FrameProfiler.hpp"
 #include "Utilities/MathUtils.hpp"
 
 namespace IWXMVM::Components
@@ -41,6 +42,7 @@ namespace IWXMVM::Components
 
     void CameraManager::UpdateCameraFrame()
     {
+        IWXMVM_PROFILE_ZONE("CameraManager::UpdateCameraFrame");
         if (Mod::GetGameInterface()->GetGameState() != Types::GameState::InDemo)
         {
             return;
@@ -56,27 +58,31 @@ namespace IWXMVM::Components
             camera->Initialize();
         }
 
-        Events::RegisterListener(EventType::OnFrame, [&]() { UpdateCameraFrame(); });
+        // the cameras are moved before anything else looks at them in a frame
+        Events::RegisterListener<EventType::OnFrame>("CameraManager", [&]() { UpdateCameraFrame(); },
+                                                     Events::ListenerPriority::First);
 
-        Events::RegisterListener(EventType::PostDemoLoad, [&]() { SetActiveCamera(Camera::Mode::FirstPerson); });
+        Events::RegisterListener<EventType::PostDemoLoad>("CameraManager",
+                                                          [&]() { SetActiveCamera(Camera::Mode::FirstPerson); });
 
-        Events::RegisterListener(EventType::OnCameraChanged, [&]() {
-            auto& activeCamera = GetActiveCamera();
-            auto& previousActiveCamera = GetPreviousActiveCamera();
-            switch (activeCamera->GetMode())
+        Events::RegisterListener<EventType::OnCameraChanged>("CameraManager", [&](const Events::CameraChange& change) {
+            auto& activeCamera = change.activeCamera;
+            auto& previousActiveCamera = change.previousCamera;
+            switch (activeCamera.GetMode())
             {
                 case Camera::Mode::Free:
                 {
-                    if (previousActiveCamera->GetMode() == Camera::Mode::FirstPerson)
+                    if (previousActiveCamera.GetMode() == Camera::Mode::FirstPerson)
                     {
-                        activeCamera->GetPosition() = previousActiveCamera->GetPosition() - previousActiveCamera->GetForwardVector() * 100;
+                        activeCamera.GetPosition() =
+                            previousActiveCamera.GetPosition() - previousActiveCamera.GetForwardVector() * 100;
                     }
                     else
                     {
-                        activeCamera->GetPosition() = previousActiveCamera->GetPosition();
+                        activeCamera.GetPosition() = previousActiveCamera.GetPosition();
                     }
-                    activeCamera->GetRotation() = previousActiveCamera->GetRotation();
-                    activeCamera->GetFov() = previousActiveCamera->GetFov();
+                    activeCamera.GetRotation() = previousActiveCamera.GetRotation();
+                    activeCamera.GetFov() = previousActiveCamera.GetFov();
                     break;
                 }
                 default:
@@ -108,7 +114,8 @@ namespace IWXMVM::Components
                 {
                     previousActiveCameraIndex = activeCameraIndex;
                     activeCameraIndex = i;
-                    Events::Invoke(EventType::OnCameraChanged);
+                    Events::Invoke<EventType::OnCameraChanged>(
+                        Events::CameraChange{*cameras[activeCameraIndex], *cameras[previousActiveCameraIndex]});
                     return;
                 }
             }
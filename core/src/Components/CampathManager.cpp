@@ -6,11 +6,13 @@
 #include "../Events.hpp"
 #include "../Input.hpp"
 #include "Playback.hpp"
+#include "Utilities/FrameProfiler.hpp"
 
 namespace IWXMVM::Components
 {
     void CampathManager::Update()
     {
+        IWXMVM_PROFILE_ZONE("CampathManager::Update");
         if (Mod::GetGameInterface()->GetGameState() != Types::GameState::InDemo)
         {
             return;
@@ -101,6 +103,6 @@ namespace IWXMVM::Components
 
     void CampathManager::Initialize()
     {
-        Events::RegisterListener(EventType::OnFrame, [&]() { Update(); });
+        Events::RegisterListener<EventType::OnFrame>("CampathManager", [&]() { Update(); });
     }
 }  // namespace IWXMVM::Components
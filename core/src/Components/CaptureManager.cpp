@@ -3,8 +3,11 @@
 
 #include "Mod.hpp"
 #include "Configuration/PreferencesConfiguration.hpp"
+#include "Components/CameraManager.hpp"
+#include "Capture/FrameHash.hpp"
 #include "Components/Rewinding.hpp"
 #include "Components/Playback.hpp"
+#include "Utilities/FrameProfiler.hpp"
 #include "Utilities/PathUtils.hpp"
 #include "D3D9.hpp"
 #include "Events.hpp"
@@ -21,6 +24,8 @@ namespace IWXMVM::Components
                 return "Camera Data";
             case OutputFormat::ImageSequence:
                 return "Image Sequence";
+            case OutputFormat::EntityTracking:
+                return "Entity Tracking";
             default:
                 return "Unknown Output Format";
         }
@@ -40,11 +45,25 @@ namespace IWXMVM::Components
                 return "Prores 422";
             case VideoCodec::Prores422LT:
                 return "Prores 422 LT";
+            case VideoCodec::H264:
+                return "H.264";
             default:
                 return "Unknown Video Codec";
         }
     }
 
+    OutputSettings CaptureManager::GetDefaultOutputSettings() const
+    {
+        return {
+            OutputFormat::Video,
+            VideoCodec::Prores4444,
+            supportedResolutions[0],
+            std::clamp(GetMaxEncoderCount() / 2, 1, 4),
+            {"j_head"},
+            Capture::TrackingFormat::Csv
+        };
+    }
+
     void CaptureManager::Initialize()
     {
         // Set r_smp_backend to 0. 
@@ -93,10 +112,10 @@ namespace IWXMVM::Components
         captureSettings = {
             0,
             0,
-            OutputFormat::Video, 
-            VideoCodec::Prores4444,
-            gameResolution,
-            250
+            {GetDefaultOutputSettings()},
+            250,
+            {false, 4, 360.0f},
+            {false, {}}
         };
 
         auto& outputDirectory = PreferencesConfiguration::Get().captureOutputDirectory;
@@ -105,69 +124,265 @@ namespace IWXMVM::Components
             outputDirectory = std::filesystem::path(PathUtils::GetCurrentGameDirectory()) / "IWXMVM" / "recordings";
         }
 
-        Events::RegisterListener(EventType::OnDemoBoundsDetermined, [&]() {
-            if (captureSettings.startTick == 0 || captureSettings.endTick == 0)
-            {
-                auto endTick = Mod::GetGameInterface()->GetDemoInfo().endTick;
-                captureSettings.startTick = static_cast<int32_t>(endTick * 0.1);
-                captureSettings.endTick = static_cast<int32_t>(endTick * 0.9);
-            }
-        });
+        Events::RegisterListener<EventType::OnDemoBoundsDetermined>(
+            "CaptureManager", [&](const Events::DemoBounds& bounds) {
+                if (captureSettings.startTick == 0 || captureSettings.endTick == 0)
+                {
+                    auto endTick = bounds.endTick - bounds.startTick;
+                    captureSettings.startTick = static_cast<int32_t>(endTick * 0.1);
+                    captureSettings.endTick = static_cast<int32_t>(endTick * 0.9);
+                }
+            });
+
+        Events::RegisterListener<EventType::OnFrame>("CaptureManager", [&]() { OnRenderFrame(); });
+    }
 
-        Events::RegisterListener(EventType::OnFrame, [&]() { OnRenderFrame(); });
+    std::filesystem::path CaptureManager::GetOutputDirectory() const
+    {
+        return outputDirectoryOverride.value_or(PreferencesConfiguration::Get().captureOutputDirectory);
+    }
+
+    int32_t CaptureManager::GetSubFrameCount() const
+    {
+        return captureSettings.motionBlur.enabled ? captureSettings.motionBlur.subFrameCount : 1;
+    }
+
+    int32_t CaptureManager::GetOpenSubFrameCount() const
+    {
+        // sub-frames outside of the shutter interval are neither read back nor blended
+        const auto subFrameCount = GetSubFrameCount();
+        const auto openSubFrames =
+            static_cast<int32_t>(std::ceil(subFrameCount * captureSettings.motionBlur.shutterAngle / 360.0f));
+        return std::clamp(openSubFrames, 1, subFrameCount);
     }
 
     void CaptureManager::OnRenderFrame()
     {
+        IWXMVM_PROFILE_ZONE("CaptureManager::OnRenderFrame");
         if (!isCapturing || Rewinding::IsRewinding())
             return;
 
-        IDirect3DDevice9* device = D3D9::GetDevice();
-        if (FAILED(device->StretchRect(backBuffer, NULL, downsampledRenderTarget, NULL, D3DTEXF_NONE)))
+        const auto currentSubFrame = subFrameIndex;
+        subFrameIndex = (subFrameIndex + 1) % GetSubFrameCount();
+
+        // camera data is taken when the shutter opens
+        if (currentSubFrame == 0)
         {
-            LOG_ERROR("Failed to copy data from backbuffer to render target");
-            StopCapture();
-            return;
+            WriteCameraData();
+            WriteTrackingData();
+
+            if (!fanOut)
+            {
+                capturedFrameCount++;
+            }
         }
 
-        if (FAILED(device->GetRenderTargetData(downsampledRenderTarget, tempSurface)))
+        if (fanOut && currentSubFrame < GetOpenSubFrameCount())
         {
-            LOG_ERROR("Failed copy render target data to surface");
-            StopCapture();
-            return;
+            IDirect3DDevice9* device = D3D9::GetDevice();
+            HRESULT result = D3D_OK;
+            {
+                Capture::ScopedStageTimer timer(&statistics, Capture::CaptureStage::StretchRect);
+                result = device->StretchRect(backBuffer, NULL, downsampledRenderTarget, NULL, D3DTEXF_NONE);
+            }
+            if (FAILED(result))
+            {
+                LOG_ERROR("Failed to copy data from backbuffer to render target");
+                StopCapture();
+                return;
+            }
+
+            {
+                // this stalls until the GPU has finished the frame, so it's usually the most expensive stage
+                Capture::ScopedStageTimer timer(&statistics, Capture::CaptureStage::Readback);
+                result = device->GetRenderTargetData(downsampledRenderTarget, tempSurface);
+            }
+            if (FAILED(result))
+            {
+                LOG_ERROR("Failed copy render target data to surface");
+                StopCapture();
+                return;
+            }
+
+            const auto lockStart = Capture::CaptureStatistics::Clock::now();
+            D3DLOCKED_RECT lockedRect = {};
+            if (FAILED(tempSurface->LockRect(&lockedRect, nullptr, 0)))
+            {
+                LOG_ERROR("Failed to lock surface");
+                StopCapture();
+                return;
+            }
+
+            const auto surfaceByteSize = screenDimensions.width * screenDimensions.height * 4;
+            const auto surface =
+                std::span{reinterpret_cast<const std::uint8_t*>(lockedRect.pBits), std::size_t(surfaceByteSize)};
+
+            std::span<const std::uint8_t> outputFrame;
+            if (GetSubFrameCount() == 1)
+            {
+                outputFrame = surface;
+            }
+            else
+            {
+                frameAccumulator.Accumulate(surface);
+
+                if (frameAccumulator.GetSampleCount() == GetOpenSubFrameCount())
+                {
+                    frameAccumulator.Resolve(blendedFrame);
+                    outputFrame = blendedFrame;
+                }
+            }
+            statistics.Record(Capture::CaptureStage::LockCopy, Capture::CaptureStatistics::Clock::now() - lockStart);
+
+            const bool frameWritten = outputFrame.empty() || WriteFrame(outputFrame);
+
+            if (FAILED(tempSurface->UnlockRect()))
+            {
+                LOG_ERROR("Failed to unlock surface");
+                StopCapture();
+                return;
+            }
+
+            if (!frameWritten)
+            {
+                LOG_ERROR("Failed to write frame {0}: {1}", capturedFrameCount, fanOut->GetError());
+                StopCapture();
+                return;
+            }
         }
 
-        D3DLOCKED_RECT lockedRect = {};
-        if (FAILED(tempSurface->LockRect(&lockedRect, nullptr, 0)))
+        const auto currentTick = Playback::GetTimelineTick();
+        if (!Rewinding::IsRewinding() && currentTick > captureSettings.endTick)
         {
-            LOG_ERROR("Failed to lock surface");
+            reachedEndTick = true;
             StopCapture();
-            return;
         }
 
-        const auto surfaceByteSize = screenDimensions.width * screenDimensions.height * 4;
-        std::fwrite(lockedRect.pBits, surfaceByteSize, 1, pipe);
+    }
 
-        capturedFrameCount++;
+    bool CaptureManager::WriteFrame(std::span<const std::uint8_t> frame)
+    {
+        // frames can only repeat while the game stands still, so regular playback isn't hashed at all
+        if (Playback::IsPaused() || Playback::IsGameFrozen())
+        {
+            std::uint64_t hash = 0;
+            {
+                Capture::ScopedStageTimer timer(&statistics, Capture::CaptureStage::FrameHash);
+                hash = Capture::HashFrame(frame);
+            }
 
-        if (FAILED(tempSurface->UnlockRect()))
+            if (lastFrameHash == hash)
+            {
+                statistics.AddRepeatedFrame();
+                return fanOut->WriteRepeat(capturedFrameCount++);
+            }
+            lastFrameHash = hash;
+        }
+        else
         {
-            LOG_ERROR("Failed to unlock surface");
-            StopCapture();
+            lastFrameHash.reset();
+        }
+
+        statistics.AddFrame(frame.size());
+        return fanOut->Write(capturedFrameCount++, frame);
+    }
+
+    void CaptureManager::WriteCameraData()
+    {
+        if (cameraDataFiles.empty())
             return;
+
+        const auto& camera = CameraManager::Get().GetActiveCamera();
+        const auto& position = camera->GetPosition();
+        const auto& rotation = camera->GetRotation();
+        auto cameraState = std::format("{},{},{},{},{},{},{},{}", Playback::GetTimelineTick(), position.x, position.y,
+                                       position.z, rotation.x, rotation.y, rotation.z, camera->GetFov());
+
+        // frames where neither the tick nor the camera moved are marked as repeats of the previous one
+        const bool isRepeat = cameraState == lastCameraState;
+        const auto line = std::format("{},{},{}\n", capturedFrameCount, cameraState, isRepeat ? 1 : 0);
+        lastCameraState = std::move(cameraState);
+
+        for (auto& file : cameraDataFiles)
+        {
+            file << line;
         }
+    }
 
-        const auto currentTick = Playback::GetTimelineTick();
-        if (!Rewinding::IsRewinding() && currentTick > captureSettings.endTick)
+    void CaptureManager::WriteTrackingData()
+    {
+        if (trackingOutputs.empty())
+            return;
+
+        Capture::ScopedStageTimer timer(&statistics, Capture::CaptureStage::EntityTracking);
+
+        const auto& camera = CameraManager::Get().GetActiveCamera();
+        const auto& position = camera->GetPosition();
+        const auto& rotation = camera->GetRotation();
+        const auto aspectRatio = static_cast<float>(screenDimensions.width) / screenDimensions.height;
+
+        auto gameInterface = Mod::GetGameInterface();
+        const auto entities = gameInterface->GetEntities();
+
+        auto& frame = *trackingFrame;
+        frame.frameIndex = capturedFrameCount;
+        frame.tick = Playback::GetTimelineTick();
+
+        for (auto& output : trackingOutputs)
         {
-            StopCapture();
+            const auto& header = output.writer->GetHeader();
+            const Capture::ScreenProjection projection({position.x, position.y, position.z},
+                                                       {rotation.x, rotation.y, rotation.z}, camera->GetFov(),
+                                                       aspectRatio, header.width, header.height);
+
+            // at most one entity per client, each with a fixed number of bones, so this is bounded even on full
+            // servers
+            frame.entityCount = 0;
+            for (const auto& entity : entities)
+            {
+                if (!entity.isValid || entity.type != Types::EntityType::Player)
+                    continue;
+                if (frame.entityCount == Capture::MAX_TRACKED_ENTITIES)
+                    break;
+
+                auto& trackedEntity = frame.entities[frame.entityCount++];
+                trackedEntity.entityId = entity.id;
+                trackedEntity.clientNum = entity.clientNum;
+                trackedEntity.origin.position = {entity.origin.x, entity.origin.y, entity.origin.z};
+                trackedEntity.origin.isValid = true;
+                projection.Project(trackedEntity.origin);
+
+                for (std::size_t i = 0; i < header.boneNames.size(); i++)
+                {
+                    const auto boneData = gameInterface->GetBoneData(entity.id, header.boneNames[i]);
+                    auto& bone = trackedEntity.bones[i];
+                    bone.position = {boneData.position.x, boneData.position.y, boneData.position.z};
+                    bone.isValid = boneData.id != -1;
+                    projection.Project(bone);
+                }
+            }
+
+            output.writer->Write(frame);
         }
+    }
+
+    void CaptureManager::WriteStatistics()
+    {
+        if (statistics.GetFrameCount() == 0)
+            return;
 
+        LOG_INFO("Capture ran at {:.1f} fps ({:.1f} MB/s)", statistics.GetFramesPerSecond(),
+                 statistics.GetMegabytesPerSecond());
+
+        if (!statistics.WriteCsv(statisticsPath))
+        {
+            LOG_ERROR("Failed to write capture statistics to {}", statisticsPath.string());
+        }
     }
 
     int32_t CaptureManager::OnGameFrame()
     {
-        return 1000 / GetCaptureSettings().framerate;
+        return 1000 / (GetCaptureSettings().framerate * GetSubFrameCount());
     }
 
     void CaptureManager::ToggleCapture()
@@ -188,96 +403,460 @@ namespace IWXMVM::Components
         return appdataPath / "codmvm_launcher" / "ffmpeg.exe";
     }
 
-    std::string GetFFmpegCommand(const Components::CaptureSettings& captureSettings, const std::filesystem::path& outputDirectory, const Resolution screenDimensions)
+    std::string GetFFmpegShortPath()
     {
         auto path = GetFFmpegPath();
         char shortPathBuf[MAX_PATH];
         GetShortPathName(path.string().c_str(), shortPathBuf, MAX_PATH);
-        std::string shortPath = shortPathBuf;
-        switch (captureSettings.outputFormat)
+        return shortPathBuf;
+    }
+
+    std::string GetVideoEncoderArguments(const OutputSettings& output)
+    {
+        std::int32_t profile = 0;
+        const char* pixelFormat = nullptr;
+        switch (output.videoCodec.value())
         {
-            case OutputFormat::ImageSequence:
-                return std::format(
-                    "{} -f rawvideo -pix_fmt bgra -s {}x{} -r {} -i - -q:v 0 "
-                    "-vf scale={}:{} -y \"{}\\output_%06d.tga\" > ffmpeg_log.txt 2>&1",
-                    shortPath,
-                    screenDimensions.width, screenDimensions.height, captureSettings.framerate,
-                    captureSettings.resolution.width, captureSettings.resolution.height, outputDirectory.string());
-            case OutputFormat::Video:
+            case VideoCodec::Prores4444XQ:
+                profile = 5;
+                pixelFormat = "yuv444p10le";
+                break;
+            case VideoCodec::Prores4444:
+                profile = 4;
+                pixelFormat = "yuv444p10le";
+                break;
+            case VideoCodec::Prores422HQ:
+                profile = 3;
+                pixelFormat = "yuv422p10le";
+                break;
+            case VideoCodec::Prores422:
+                profile = 2;
+                pixelFormat = "yuv422p10le";
+                break;
+            case VideoCodec::Prores422LT:
+                profile = 1;
+                pixelFormat = "yuv422p10le";
+                break;
+            case VideoCodec::H264:
+                return "-c:v libx264 -preset fast -crf 18 -pix_fmt yuv420p";
+            default:
+                profile = 4;
+                pixelFormat = "yuv444p10le";
+                LOG_ERROR("Unsupported video codec. Choosing default ({})",
+                          static_cast<std::int32_t>(VideoCodec::Prores4444));
+                break;
+        }
+
+        return std::format("-c:v prores -profile:v {} -q:v 1 -pix_fmt {}", profile, pixelFormat);
+    }
+
+    std::string_view GetVideoExtension(const OutputSettings& output)
+    {
+        return output.videoCodec == VideoCodec::H264 ? ".mp4" : ".mov";
+    }
+
+    // outputs of the same capture are created asynchronously, so the names already handed out are passed in as well
+    std::filesystem::path GetUniqueOutputPath(const std::filesystem::path& outputDirectory, std::string_view name,
+                                              std::string_view extension,
+                                              const std::vector<std::filesystem::path>& reservedPaths)
+    {
+        auto path = outputDirectory / std::format("{}{}", name, extension);
+        auto i = 0;
+        while (std::filesystem::exists(path) ||
+               std::find(reservedPaths.begin(), reservedPaths.end(), path) != reservedPaths.end())
+        {
+            path = outputDirectory / std::format("{}{}{}", name, ++i, extension);
+        }
+        return path;
+    }
+
+    std::string GetFFmpegInputArguments(const CaptureSettings& captureSettings, const Resolution screenDimensions)
+    {
+        return std::format("-f rawvideo -pix_fmt bgra -s {}x{} -r {}", screenDimensions.width,
+                           screenDimensions.height, captureSettings.framerate);
+    }
+
+    std::unique_ptr<Capture::FrameSink> CaptureManager::CreateVideoSink(const OutputSettings& output,
+                                                                        std::size_t outputIndex)
+    {
+        const auto outputDirectory = GetOutputDirectory();
+        const auto shortPath = GetFFmpegShortPath();
+        const auto logPath =
+            outputIndex == 0 ? std::string("ffmpeg_log.txt") : std::format("ffmpeg_log{}.txt", outputIndex);
+
+        if (output.format == OutputFormat::ImageSequence)
+        {
+            const auto pattern =
+                outputIndex == 0 ? std::string("output_%06d.tga") : std::format("output{}_%06d.tga", outputIndex);
+            const auto command = std::format("{} {} -i - -q:v 0 -vf scale={}:{} -y \"{}\" > {} 2>&1", shortPath,
+                                             GetFFmpegInputArguments(captureSettings, screenDimensions),
+                                             output.resolution.width, output.resolution.height,
+                                             (outputDirectory / pattern).string(), logPath);
+            LOG_DEBUG("ffmpeg command: {}", command);
+
+            return std::make_unique<Capture::ImageSequenceSink>(command, outputDirectory / pattern, 1, &statistics);
+        }
+
+        const auto outputPath =
+            GetUniqueOutputPath(outputDirectory, "output", GetVideoExtension(output), reservedOutputPaths);
+        reservedOutputPaths.push_back(outputPath);
+
+        const auto encoderArguments = GetVideoEncoderArguments(output);
+        if (output.encoderCount <= 1)
+        {
+            const auto command = std::format("{} {} -i - {} -vf scale={}:{} -y \"{}\" > {} 2>&1", shortPath,
+                                             GetFFmpegInputArguments(captureSettings, screenDimensions),
+                                             encoderArguments, output.resolution.width, output.resolution.height,
+                                             outputPath.string(), logPath);
+            LOG_DEBUG("ffmpeg command: {}", command);
+
+            return std::make_unique<Capture::PipeSink>(command, &statistics);
+        }
+
+        // every segment is a new ffmpeg process that starts on a key frame, which long-GOP codecs pay for if it
+        // happens often, so segments are a fixed length of time and never shorter than a typical GOP
+        constexpr std::int32_t SEGMENT_DURATION_SECONDS = 4;
+        constexpr std::int32_t MIN_SEGMENT_FRAME_COUNT = 250;
+        const auto segmentFrameCount =
+            std::max(captureSettings.framerate * SEGMENT_DURATION_SECONDS, MIN_SEGMENT_FRAME_COUNT);
+
+        // Each encoder queues raw frames inside ffmpeg (see -thread_queue_size), which is what lets the other encoders
+        // get ahead while it's busy. The encoders share one budget for these queues, so that adding encoders doesn't
+        // add memory; where a queue can't hold a whole segment, the encoders just overlap less.
+        constexpr std::size_t THREAD_QUEUE_BUDGET_BYTES = 2048ull * 1024 * 1024;
+        constexpr std::int32_t MIN_THREAD_QUEUE_FRAME_COUNT = 8;
+        const auto frameByteSize = static_cast<std::size_t>(screenDimensions.width) * screenDimensions.height * 4;
+        const auto threadQueueFrameCount = std::clamp(
+            static_cast<std::int32_t>(THREAD_QUEUE_BUDGET_BYTES / static_cast<std::size_t>(output.encoderCount) /
+                                      frameByteSize),
+            MIN_THREAD_QUEUE_FRAME_COUNT, segmentFrameCount);
+
+        // the segments are cut at arbitrary frames and joined without re-encoding, which works because every
+        // encoder starts its segment on a key frame
+        Capture::SegmentedEncoderSettings settings;
+        settings.segmentDirectory = outputDirectory / std::format("capture_{}-{}_{}fps_{}.segments",
+                                                                  captureSettings.startTick, captureSettings.endTick,
+                                                                  captureSettings.framerate, outputIndex);
+        const auto& colorGrading = captureSettings.colorGrading;
+        settings.manifestKey = std::format(
+            "{}-{} {} {}fps {} {} {} {}:{}:{} {} {}", captureSettings.startTick, captureSettings.endTick,
+            screenDimensions.ToString(), captureSettings.framerate, output.resolution.ToString(),
+            GetVideoCodecLabel(output.videoCodec.value()), Mod::GetGameInterface()->GetDemoInfo().name,
+            captureSettings.motionBlur.enabled, GetSubFrameCount(), GetOpenSubFrameCount(), segmentFrameCount,
+            colorGrading.enabled ? colorGrading.lutPath.string() : "ungraded");
+        settings.segmentExtension = GetVideoExtension(output);
+        settings.segmentFrameCount = segmentFrameCount;
+        settings.encoderCount = output.encoderCount;
+        settings.statistics = &statistics;
+
+        settings.getEncoderCommand = [shortPath, encoderArguments, threadQueueFrameCount, output,
+                                      inputArguments = GetFFmpegInputArguments(captureSettings, screenDimensions)](
+                                         const std::filesystem::path& segmentPath) {
+            return std::format("{} {} -thread_queue_size {} -i - {} -vf scale={}:{} -y \"{}\" > \"{}.log\" 2>&1",
+                               shortPath, inputArguments, threadQueueFrameCount, encoderArguments,
+                               output.resolution.width, output.resolution.height, segmentPath.string(),
+                               segmentPath.string());
+        };
+        settings.getConcatCommand = [shortPath](const std::filesystem::path& listPath,
+                                                const std::filesystem::path& outputPath) {
+            return std::format("{} -f concat -safe 0 -i \"{}\" -c copy -y \"{}\" > \"{}\" 2>&1", shortPath,
+                               listPath.string(), outputPath.string(),
+                               (listPath.parent_path() / "concat_log.txt").string());
+        };
+
+        auto sink = std::make_unique<Capture::SegmentedSink>(std::move(settings), outputPath);
+        segmentedSinks.push_back(sink.get());
+        return sink;
+    }
+
+    bool CaptureManager::OpenOutputs()
+    {
+        const auto outputDirectory = GetOutputDirectory();
+        reservedOutputPaths.clear();
+        segmentedSinks.clear();
+
+        std::int32_t maxEncoderCount = 1;
+
+        std::vector<std::unique_ptr<Capture::FrameSink>> sinks;
+        for (std::size_t i = 0; i < captureSettings.outputs.size(); i++)
+        {
+            const auto& output = captureSettings.outputs[i];
+            LOG_INFO("Output {0}: {1} at {2}", i + 1, GetOutputFormatLabel(output.format),
+                     output.resolution.ToString());
+
+            if (output.format == OutputFormat::CameraData)
             {
-                std::int32_t profile = 0;
-                const char* pixelFormat = nullptr;
-                switch (captureSettings.videoCodec.value())
+                const auto path = GetUniqueOutputPath(outputDirectory, "camera", ".csv", reservedOutputPaths);
+                reservedOutputPaths.push_back(path);
+
+                auto& file = cameraDataFiles.emplace_back(path);
+                if (!file.is_open())
                 {
-                    case VideoCodec::Prores4444XQ:
-                        profile = 5;
-                        pixelFormat = "yuv444p10le";
-                        break;
-                    case VideoCodec::Prores4444:
-                        profile = 4;
-                        pixelFormat = "yuv444p10le";
-                        break;
-                    case VideoCodec::Prores422HQ:
-                        profile = 3;
-                        pixelFormat = "yuv422p10le";
-                        break;
-                    case VideoCodec::Prores422:
-                        profile = 2;
-                        pixelFormat = "yuv422p10le";
-                        break;
-                    case VideoCodec::Prores422LT:
-                        profile = 1;
-                        pixelFormat = "yuv422p10le";
-                        break;
-                    default:
-                        profile = 4;
-                        pixelFormat = "yuv444p10le";
-                        LOG_ERROR("Unsupported video codec. Choosing default ({})",
-                                  static_cast<std::int32_t>(VideoCodec::Prores4444));
-                        break;
+                    LOG_ERROR("Failed to open {} for writing", path.string());
+                    return false;
                 }
+                file << "frame,tick,x,y,z,rotation_x,rotation_y,rotation_z,fov,repeat\n";
+                continue;
+            }
+
+            if (output.format == OutputFormat::EntityTracking)
+            {
+                if (!OpenTrackingOutput(output))
+                    return false;
+                continue;
+            }
+
+            sinks.push_back(CreateVideoSink(output, i));
+            if (output.format == OutputFormat::Video)
+            {
+                maxEncoderCount = std::max(maxEncoderCount, output.encoderCount);
+            }
+        }
+
+        capturedFrameCount = 0;
+        lastFrameHash.reset();
+        lastCameraState.clear();
+        if (sinks.empty())
+        {
+            return true;
+        }
+
+        // every encoder gets a couple of frames to work on while the game renders the next one; once all of them
+        // are in flight the game waits for the slowest output. One more buffer holds the last frame for repeats.
+        const auto frameByteSize = static_cast<std::size_t>(screenDimensions.width * screenDimensions.height * 4);
+        fanOut = std::make_unique<Capture::FrameFanOut>(frameByteSize, static_cast<std::size_t>(maxEncoderCount) + 3,
+                                                        &statistics);
+        for (auto& sink : sinks)
+        {
+            fanOut->AddSink(std::move(sink));
+        }
+
+        if (!OpenColorGrading())
+        {
+            fanOut.reset();
+            return false;
+        }
+
+        if (!fanOut->Open())
+        {
+            LOG_ERROR("Failed to open capture output: {}", fanOut->GetError());
+            fanOut->Close();
+            fanOut.reset();
+            return false;
+        }
+
+        // a previous capture can only be resumed if every output supports it, and then only from the earliest
+        // frame any of them still needs
+        if (segmentedSinks.size() == captureSettings.outputs.size())
+        {
+            capturedFrameCount = std::numeric_limits<std::int32_t>::max();
+            for (auto* sink : segmentedSinks)
+            {
+                capturedFrameCount = std::min(capturedFrameCount, sink->GetResumeFrame());
+            }
+        }
+        segmentedSinks.clear();
+
+        return true;
+    }
+
+    bool CaptureManager::OpenColorGrading()
+    {
+        const auto& colorGrading = captureSettings.colorGrading;
+        if (!colorGrading.enabled)
+            return true;
+
+        if (colorGrading.lutPath.empty())
+        {
+            LOG_ERROR("Color grading is enabled, but no LUT is selected");
+            return false;
+        }
+
+        auto lut = std::make_shared<Capture::ColorLut>();
+        if (!lut->Load(colorGrading.lutPath))
+        {
+            LOG_ERROR("Failed to load LUT {}: {}", colorGrading.lutPath.string(), lut->GetError());
+            return false;
+        }
+
+        // the frame is graded before the game thread can continue, so it gets a good share of the cores; the rest
+        // is left to the encoders
+        const auto threadCount = std::clamp(static_cast<int32_t>(std::thread::hardware_concurrency() / 2), 1, 8);
+        const auto lutSize = lut->GetSize();
+
+        auto stage = std::make_unique<Capture::ColorGradingStage>(std::move(lut), screenDimensions.width,
+                                                                  screenDimensions.height, threadCount);
+        LOG_INFO("Grading frames with {0} ({1}^3, {2} on {3} threads)", colorGrading.lutPath.filename().string(),
+                 lutSize, Capture::ColorLut::GetKernelLabel(stage->GetKernel()), stage->GetThreadCount());
+
+        fanOut->SetColorGrading(std::move(stage));
+        return true;
+    }
+
+    bool CaptureManager::OpenTrackingOutput(const OutputSettings& output)
+    {
+        const auto outputDirectory = GetOutputDirectory();
+
+        TrackingOutput trackingOutput;
+        trackingOutput.format = output.trackingFormat;
+        trackingOutput.path = GetUniqueOutputPath(outputDirectory, "tracking",
+                                                  Capture::GetTrackingFormatExtension(output.trackingFormat),
+                                                  reservedOutputPaths);
+        reservedOutputPaths.push_back(trackingOutput.path);
+
+        // text formats are converted from the binary stream at the end, which keeps the per-frame cost down
+        trackingOutput.streamPath = trackingOutput.path;
+        if (output.trackingFormat != Capture::TrackingFormat::Binary)
+        {
+            trackingOutput.streamPath += Capture::GetTrackingFormatExtension(Capture::TrackingFormat::Binary);
+        }
+
+        trackingOutput.writer = std::make_unique<Capture::TrackingWriter>();
+        if (!trackingOutput.writer->Open(trackingOutput.streamPath, {captureSettings.framerate, output.resolution.width,
+                                                                     output.resolution.height, output.trackedBones}))
+        {
+            LOG_ERROR("Failed to open entity tracking output: {}", trackingOutput.writer->GetError());
+            return false;
+        }
 
-                std::string filename = "output.mov";
-                auto i = 0;
-                while (std::filesystem::exists(outputDirectory / filename))
+        if (!trackingFrame)
+        {
+            trackingFrame = std::make_unique<Capture::TrackingFrame>();
+        }
+        trackingOutputs.push_back(std::move(trackingOutput));
+        return true;
+    }
+
+    bool CaptureManager::FinishTrackingOutput(TrackingOutput& output)
+    {
+        if (!output.writer->Close())
+        {
+            LOG_ERROR("Failed to write entity tracking data: {}", output.writer->GetError());
+            return false;
+        }
+
+        if (output.streamPath != output.path)
+        {
+            std::string error;
+            if (!Capture::ConvertTrackingData(output.streamPath, output.path, output.format, error))
+            {
+                LOG_ERROR("Failed to convert entity tracking data to {}: {}",
+                          Capture::GetTrackingFormatLabel(output.format), error);
+                return false;
+            }
+
+            std::error_code errorCode;
+            std::filesystem::remove(output.streamPath, errorCode);
+        }
+
+        LOG_INFO("Wrote entity tracking data to {}", output.path.string());
+        return true;
+    }
+
+    void CaptureManager::FinalizeOutputs()
+    {
+        cameraDataFiles.clear();
+
+        if (!fanOut && trackingOutputs.empty())
+        {
+            WriteStatistics();
+            return;
+        }
+
+        // closing waits for every encoder to finish and joins segmented outputs, which takes a while for long
+        // captures, so it's done off the game thread
+        isFinalizing.store(true);
+        finalizeThread = std::thread([this, fanOut = std::move(fanOut),
+                                      trackingOutputs = std::move(trackingOutputs)]() mutable {
+            if (fanOut)
+            {
+                if (fanOut->Close())
+                {
+                    LOG_INFO("Finished writing {} capture output(s)", fanOut->GetSinkCount());
+                }
+                else
                 {
-                    filename = std::format("output{0}.mov", ++i);
+                    LOG_ERROR("Failed to finish capture: {}", fanOut->GetError());
+                    outputsFailed.store(true);
                 }
+            }
 
-                return std::format(
-                    "{} -f rawvideo -pix_fmt bgra -s {}x{} -r {} -i - -c:v prores -profile:v {} -q:v 1 "
-                    "-pix_fmt {} -vf scale={}:{} -y \"{}\\{}\" > ffmpeg_log.txt 2>&1",
-                    shortPath, screenDimensions.width, screenDimensions.height, captureSettings.framerate, profile,
-                    pixelFormat, captureSettings.resolution.width, captureSettings.resolution.height, outputDirectory.string(), filename);
+            for (auto& output : trackingOutputs)
+            {
+                if (!FinishTrackingOutput(output))
+                {
+                    outputsFailed.store(true);
+                }
             }
-            default:
-                LOG_ERROR("Output format not supported");
-                return "";
-        }
+
+            WriteStatistics();
+            isFinalizing.store(false);
+        });
+    }
+
+    void CaptureManager::Shutdown()
+    {
+        // the finalizing thread runs the mod's code and logs until it is done, so it has to finish before the logger
+        // is shut down and the mod is unloaded
+        if (finalizeThread.joinable())
+            finalizeThread.join();
     }
 
     void CaptureManager::StartCapture()
     {
+        if (isFinalizing)
+        {
+            LOG_ERROR("Cannot start capture while the previous capture is being finalized");
+            return;
+        }
+
+        // the previous capture was finalized, but its thread may not have returned yet
+        if (finalizeThread.joinable())
+            finalizeThread.join();
+
+        reachedEndTick = false;
+        outputsFailed.store(false);
+
         if (captureSettings.startTick >= captureSettings.endTick)
         {
             LOG_ERROR("Start tick must be less than end tick");
             return;
         }
 
+        if (captureSettings.motionBlur.enabled)
+        {
+            const auto& supportedSubFrameCounts = GetSupportedSubFrameCounts(captureSettings.framerate);
+            if (std::find(supportedSubFrameCounts.begin(), supportedSubFrameCounts.end(),
+                          captureSettings.motionBlur.subFrameCount) == supportedSubFrameCounts.end())
+            {
+                LOG_ERROR("{} sub-frames are not supported at {} fps", captureSettings.motionBlur.subFrameCount,
+                          captureSettings.framerate);
+                return;
+            }
+        }
+
         // ensure output directory exists
-        const auto& outputDirectory = PreferencesConfiguration::Get().captureOutputDirectory;
+        const auto outputDirectory = GetOutputDirectory();
         if (!std::filesystem::exists(outputDirectory))
         {
             std::filesystem::create_directories(outputDirectory);
         }
 
-        // skip to start tick
-        auto currentTick = Playback::GetTimelineTick();
-        Playback::SetTickDelta(captureSettings.startTick - currentTick, true);
+        if (captureSettings.outputs.empty())
+        {
+            LOG_ERROR("No capture outputs configured");
+            return;
+        }
 
         capturedFrameCount = 0;
+        subFrameIndex = 0;
 
-        LOG_INFO("Starting capture at {0} ({1} fps)", captureSettings.resolution.ToString(), captureSettings.framerate);
+        LOG_INFO("Starting capture ({0} fps)", captureSettings.framerate);
+        if (GetSubFrameCount() > 1)
+        {
+            LOG_INFO("Blending {0} of {1} sub-frames per frame (shutter angle {2})", GetOpenSubFrameCount(),
+                     GetSubFrameCount(), captureSettings.motionBlur.shutterAngle);
+        }
 
         IDirect3DDevice9* device = D3D9::GetDevice();
 
@@ -314,7 +893,13 @@ namespace IWXMVM::Components
         screenDimensions.width = static_cast<std::int32_t>(bbDesc.Width);
         screenDimensions.height = static_cast<std::int32_t>(bbDesc.Height);
 
-        std::string ffmpegCommand = GetFFmpegCommand(captureSettings, outputDirectory, screenDimensions);
+        if (GetSubFrameCount() > 1)
+        {
+            const auto surfaceByteSize = static_cast<std::size_t>(screenDimensions.width * screenDimensions.height * 4);
+            frameAccumulator.Reset(surfaceByteSize);
+            blendedFrame.resize(surfaceByteSize);
+        }
+
         if (!std::filesystem::exists(GetFFmpegPath()))
         {
             LOG_ERROR("ffmpeg is not present in the game directory");
@@ -324,29 +909,47 @@ namespace IWXMVM::Components
         }
         ffmpegNotFound = false;
 
-        LOG_DEBUG("ffmpeg command: {}", ffmpegCommand);
-        pipe = _popen(ffmpegCommand.c_str(), "wb");
-        if (!pipe)
+        if (!OpenOutputs())
         {
-            LOG_ERROR("ffmpeg pipe open error");
             StopCapture();
             return;
         }
 
+        if (capturedFrameCount > 0)
+        {
+            LOG_INFO("Resuming previous capture at frame {0}", capturedFrameCount);
+        }
+
+        statisticsPath = outputDirectory / std::format("capture_{}-{}_{}fps_stats.csv", captureSettings.startTick,
+                                                       captureSettings.endTick, captureSettings.framerate);
+        statistics.Start();
+
+        // skip to start tick, or to the first frame a previous capture didn't get to encode
+        auto currentTick = Playback::GetTimelineTick();
+        const auto resumeTick = captureSettings.startTick + capturedFrameCount * (1000 / captureSettings.framerate);
+        Playback::SetTickDelta(resumeTick - currentTick, true);
+
         isCapturing.store(true);
     }
 
     void CaptureManager::StopCapture()
     {
         LOG_INFO("Stopped capture (wrote {0} frames)", capturedFrameCount);
-        isCapturing.store(false);
+        const bool wasCapturing = isCapturing.exchange(false);
+        statistics.Stop();
 
-        if (pipe)
+        // the statistics are written once the outputs have drained their queues
+        if (wasCapturing)
+        {
+            FinalizeOutputs();
+        }
+        else if (fanOut)
         {
-            fflush(pipe);
-            fclose(pipe);
-            pipe = nullptr;
+            fanOut->Close();
+            fanOut.reset();
         }
+        cameraDataFiles.clear();
+        trackingOutputs.clear();
 
         if (tempSurface)
         {
@@ -365,5 +968,8 @@ namespace IWXMVM::Components
             downsampledRenderTarget->Release();
             downsampledRenderTarget = nullptr;
         }
+
+        frameAccumulator.Reset(0);
+        blendedFrame = {};
     }
 }
\ No newline at end of file
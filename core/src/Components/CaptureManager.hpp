@@ -1,5 +1,9 @@
 #pragma once
 #include "Camera.hpp"
+#include "Capture/CaptureStatistics.hpp"
+#include "Capture/EntityTracking.hpp"
+#include "Capture/FrameAccumulator.hpp"
+#include "Capture/FrameFanOut.hpp"
 
 namespace IWXMVM::Components
 {
@@ -8,6 +12,7 @@ namespace IWXMVM::Components
         Video,
         CameraData,
         ImageSequence,
+        EntityTracking,
 
         Count
     };
@@ -34,19 +39,48 @@ namespace IWXMVM::Components
         Prores422HQ,
         Prores422,
         Prores422LT,
+        H264,
 
         Count
     };
 
+    struct MotionBlurSettings
+    {
+        bool enabled;
+        int32_t subFrameCount;  // number of rendered sub-frames per output frame
+        float shutterAngle;     // 360 blends every sub-frame, 180 only those in the first half of the frame interval
+    };
+
+    struct ColorGradingSettings
+    {
+        bool enabled;
+        std::filesystem::path lutPath;  // .cube 3D LUT, applied to every output that gets the rendered frames
+    };
+
+    struct OutputSettings
+    {
+        OutputFormat format;
+        std::optional<VideoCodec> videoCodec;
+        Resolution resolution;
+
+        int32_t encoderCount;  // video outputs are split into segments that are encoded by this many ffmpeg processes
+
+        // entity tracking outputs record the origin of every player, and these bones
+        std::vector<std::string> trackedBones;
+        Capture::TrackingFormat trackingFormat;
+    };
+
     struct CaptureSettings
     {
         uint32_t startTick, endTick;
-        
-        OutputFormat outputFormat;
-        std::optional<VideoCodec> videoCodec;
 
-        Resolution resolution;
+        // every output is written from the same playthrough
+        std::vector<OutputSettings> outputs;
+
         int32_t framerate;
+
+        MotionBlurSettings motionBlur;
+        ColorGradingSettings colorGrading;
     };
 
     class CaptureManager
@@ -62,12 +96,17 @@ namespace IWXMVM::Components
         void operator=(CaptureManager const&) = delete;
 
         void Initialize();
+        // waits for the outputs of the last capture to be finalized, before the mod is unloaded
+        void Shutdown();
         void ToggleCapture();
         void StartCapture();
         void StopCapture();
 
         std::string_view GetOutputFormatLabel(OutputFormat outputFormat);
         std::string_view GetVideoCodecLabel(VideoCodec codec);
+
+        static constexpr std::size_t MAX_OUTPUTS = 4;
+        OutputSettings GetDefaultOutputSettings() const;
         
         CaptureSettings& GetCaptureSettings()
         {
@@ -94,21 +133,66 @@ namespace IWXMVM::Components
             return { 50, 100, 125, 250, 500, 1000 };
         }
 
+        // game time advances in whole milliseconds, so only sub-frame counts that evenly divide the frame interval work
+        std::vector<int32_t> GetSupportedSubFrameCounts(int32_t framerate) const
+        {
+            std::vector<int32_t> subFrameCounts;
+            for (int32_t count = 2; count <= Capture::FrameAccumulator::MAX_SAMPLES && framerate * count <= 1000; count++)
+            {
+                if (1000 % (framerate * count) == 0)
+                    subFrameCounts.push_back(count);
+            }
+            return subFrameCounts;
+        }
+
+        int32_t GetMaxEncoderCount() const
+        {
+            return std::clamp(static_cast<int32_t>(std::thread::hardware_concurrency()) / 2, 1, 8);
+        }
+
         bool IsCapturing() const
         {
             return isCapturing;
         }
 
+        // outputs of the last capture are still being flushed, or their segments joined
+        bool IsFinalizing() const
+        {
+            return isFinalizing;
+        }
+
         bool IsFFmpegPresent() const
         {
             return !ffmpegNotFound;
         }
 
+        // the last capture ran up to its end tick and every output was finished without errors; only meaningful
+        // once it has stopped and finalized
+        bool DidLastCaptureSucceed() const
+        {
+            return reachedEndTick && !outputsFailed;
+        }
+
+        // outputs go to the directory from the preferences unless this is overridden, like the render queue does
+        // to give every job its own directory
+        void SetOutputDirectory(std::optional<std::filesystem::path> directory)
+        {
+            outputDirectoryOverride = std::move(directory);
+        }
+
+        std::filesystem::path GetOutputDirectory() const;
+
         std::int32_t GetCapturedFrameCount() const
 		{
 			return capturedFrameCount;
 		}
 
+        // timings of the running capture, or of the last one once it has stopped
+        const Capture::CaptureStatistics& GetStatistics() const
+        {
+            return statistics;
+        }
+
         int32_t OnGameFrame();
 
        private:
@@ -116,13 +200,34 @@ namespace IWXMVM::Components
         {
         }
 
+        struct TrackingOutput
+        {
+            std::unique_ptr<Capture::TrackingWriter> writer;
+            std::filesystem::path streamPath;
+            std::filesystem::path path;  // the stream is converted to this once the capture has finished
+            Capture::TrackingFormat format;
+        };
+
         void OnRenderFrame();
+        bool WriteFrame(std::span<const std::uint8_t> frame);
+        void WriteCameraData();
+        void WriteTrackingData();
+        void WriteStatistics();
+
+        bool OpenOutputs();
+        bool OpenColorGrading();
+        std::unique_ptr<Capture::FrameSink> CreateVideoSink(const OutputSettings& output, std::size_t outputIndex);
+        bool OpenTrackingOutput(const OutputSettings& output);
+        bool FinishTrackingOutput(TrackingOutput& output);
+        void FinalizeOutputs();
+
+        int32_t GetSubFrameCount() const;
+        int32_t GetOpenSubFrameCount() const;
 
         std::array<Resolution, 4> supportedResolutions;
         CaptureSettings captureSettings;
 
         // internal capture state
-        FILE* pipe = nullptr;
         Resolution screenDimensions = Resolution(0, 0);
         IDirect3DSurface9* backBuffer = nullptr;
         IDirect3DSurface9* downsampledRenderTarget = nullptr;
@@ -130,5 +235,30 @@ namespace IWXMVM::Components
         std::atomic_bool isCapturing = false;
         std::int32_t capturedFrameCount = 0;
         bool ffmpegNotFound = false;
+        bool reachedEndTick = false;
+        std::atomic_bool outputsFailed = false;
+        std::optional<std::filesystem::path> outputDirectoryOverride;
+
+        Capture::CaptureStatistics statistics;
+        std::filesystem::path statisticsPath;
+
+        // output state; the fan-out only exists if at least one output needs the rendered frames
+        std::unique_ptr<Capture::FrameFanOut> fanOut;
+        std::vector<std::ofstream> cameraDataFiles;
+        std::vector<TrackingOutput> trackingOutputs;
+        std::unique_ptr<Capture::TrackingFrame> trackingFrame;
+        std::vector<std::filesystem::path> reservedOutputPaths;
+        std::vector<Capture::SegmentedSink*> segmentedSinks;
+
+        // used to pass on frames that didn't change as repeats
+        std::optional<std::uint64_t> lastFrameHash;
+        std::string lastCameraState;
+        std::atomic_bool isFinalizing = false;
+        std::thread finalizeThread;
+
+        // motion blur state
+        Capture::FrameAccumulator frameAccumulator;
+        std::vector<std::uint8_t> blendedFrame;
+        std::int32_t subFrameIndex = 0;
     };
 }  // namespace IWXMVM::Components
\ No newline at end of file
@@ -21,7 +21,7 @@ namespace IWXMVM::Components
 
     void FreeCamera::Initialize()
     {
-        Events::RegisterListener(EventType::OnRenderGameView, [&]() {
+        Events::RegisterListener<EventType::OnRenderGameView>("FreeCamera", [&]() {
 
             if (CameraManager::Get().GetActiveCamera()->GetMode() != Camera::Mode::Free)
                 return;
@@ -149,14 +149,14 @@ namespace IWXMVM::Components
 
         static bool justLoadedDemo = false;
 
-        Events::RegisterListener(EventType::PostDemoLoad, [&]() { 
+        Events::RegisterListener<EventType::PostDemoLoad>("KeyframeManager", [&]() { 
             ClearKeyframes();
             actionHistory.clear();
             undidActionHistory.clear();
             justLoadedDemo = true;
         });
 
-        Events::RegisterListener(EventType::OnFrame, [&]() { 
+        Events::RegisterListener<EventType::OnFrame>("KeyframeManager", [&]() { 
             HandleInput(); 
 
             if (IWXMVM::Mod::GetGameInterface()->GetGameState() == Types::GameState::InDemo && justLoadedDemo)
@@ -280,14 +280,14 @@ namespace IWXMVM::Components
 
     void KeyframeManager::BeginModifyingKeyframeTick(Types::Keyframe& keyframeToModify)
     {
-        LOG_DEBUG("Begin Modifying Tick " + std::to_string(keyframeToModify.id));
+        LOG_CATEGORY_DEBUG(Keyframes, "Begin Modifying Tick {}", keyframeToModify.id);
         beginningTickMap[keyframeToModify.id] = keyframeToModify.tick;
     }
 
     void KeyframeManager::EndModifyingKeyframeTick(Types::KeyframeableProperty property,
                                                    Types::Keyframe& keyframeToModify)
     {
-        LOG_DEBUG("End Modifying Tick " + std::to_string(keyframeToModify.id));
+        LOG_CATEGORY_DEBUG(Keyframes, "End Modifying Tick {}", keyframeToModify.id);
         std::shared_ptr<ModifyTickAction> modifyAction = std::make_shared<ModifyTickAction>(
             property, beginningTickMap[keyframeToModify.id], keyframeToModify.tick, keyframeToModify.id);
         AddActionToHistory(modifyAction);
@@ -301,14 +301,14 @@ namespace IWXMVM::Components
 
     void KeyframeManager::BeginModifyingKeyframeValue(Types::Keyframe& keyframeToModify)
     {
-        LOG_DEBUG("Begin Modifying Value " + std::to_string(keyframeToModify.id));
+        LOG_CATEGORY_DEBUG(Keyframes, "Begin Modifying Value {}", keyframeToModify.id);
         beginningValueMap[keyframeToModify.id] = keyframeToModify.value;
     }
 
     void KeyframeManager::EndModifyingKeyframeValue(Types::KeyframeableProperty property,
                                                    Types::Keyframe& keyframeToModify)
     {
-        LOG_DEBUG("End Modifying Value " + std::to_string(keyframeToModify.id));
+        LOG_CATEGORY_DEBUG(Keyframes, "End Modifying Value {}", keyframeToModify.id);
         std::shared_ptr<ModifyValueAction> modifyAction = std::make_shared<ModifyValueAction>(
             property, beginningValueMap[keyframeToModify.id], keyframeToModify.value, keyframeToModify.id);
         AddActionToHistory(modifyAction);
@@ -318,7 +318,7 @@ namespace IWXMVM::Components
     void KeyframeManager::EndModifyingKeyframeTickAndValue(Types::KeyframeableProperty property,
                                                     Types::Keyframe& keyframeToModify)
     {
-        LOG_DEBUG("End Modifying Tick & Value " + std::to_string(keyframeToModify.id));
+        LOG_CATEGORY_DEBUG(Keyframes, "End Modifying Tick & Value {}", keyframeToModify.id);
         
         std::shared_ptr<ModifyTickAndValueAction> modifyAction = std::make_shared<ModifyTickAndValueAction>(
             property, beginningTickMap[keyframeToModify.id], keyframeToModify.tick,
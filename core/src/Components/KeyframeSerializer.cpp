@@ -103,7 +103,7 @@ namespace IWXMVM::Components
         }
     }
 
-    void KeyframeSerializer::Read(std::filesystem::path path, bool requireDemoMatch)
+    bool KeyframeSerializer::Read(std::filesystem::path path, bool requireDemoMatch)
     {
         using json = nlohmann::json;
 
@@ -111,7 +111,7 @@ namespace IWXMVM::Components
         if (!file.is_open())
         {
             LOG_ERROR("Failed to read keyframe file at {}", path.string());
-            return;
+            return false;
         }
 
         try
@@ -128,13 +128,13 @@ namespace IWXMVM::Components
             }
 
             auto demoName = rootNode[NODE_DEMO_NAME].get<std::string>();
-            auto currentDemoName = Mod::GetGameInterface()->GetDemoInfo().name;
+            const auto& currentDemoName = Mod::GetGameInterface()->GetDemoInfo().name;
             if (demoName.compare(currentDemoName) != 0)
             {
                 if (requireDemoMatch)
                 {
                     LOG_INFO("Not loading keyframes since this demo is not the previous demo");
-                    return;
+                    return false;
                 }
 
                 LOG_WARN("Demo names dont match {0} vs {1}", demoName, currentDemoName);
@@ -182,7 +182,10 @@ namespace IWXMVM::Components
         catch (const std::exception& e)
         {
             LOG_ERROR("Failed to parse keyframe file ({})", e.what());
+            return false;
         }
+
+        return true;
     }
 
     std::filesystem::path GetRecentKeyframesPath()
@@ -192,7 +195,7 @@ namespace IWXMVM::Components
 
     auto GetDemoNameHash()
     {
-        auto demoName = Mod::GetGameInterface()->GetDemoInfo().name;
+        const auto& demoName = Mod::GetGameInterface()->GetDemoInfo().name;
         return std::hash<std::string>{}(demoName);
     }
 
@@ -5,7 +5,8 @@ namespace IWXMVM::Components
     namespace KeyframeSerializer
     {
         void Write(std::filesystem::path path);
-        void Read(std::filesystem::path path, bool requireDemoMatch = false);
+        // returns false if the file could not be read, or belongs to another demo while requireDemoMatch is set
+        bool Read(std::filesystem::path path, bool requireDemoMatch = false);
 
         void WriteRecent();
         void ReadRecent();
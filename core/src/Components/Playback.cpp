@@ -1,6 +1,7 @@
 #include "StdInclude.hpp"
 #include "Playback.hpp"
 
+#include "DvarHandle.hpp"
 #include "Mod.hpp"
 #include "Rewinding.hpp"
 
@@ -24,7 +25,7 @@ namespace IWXMVM::Components::Playback
     {
         if (!frozenTick.has_value())
         {
-            timelineTick = Mod::GetGameInterface()->GetDemoInfo().gameTick;
+            timelineTick = Mod::GetGameInterface()->GetDemoTick();
         }
 
         return timelineTick;
@@ -73,7 +74,7 @@ namespace IWXMVM::Components::Playback
         auto addresses = Mod::GetGameInterface()->GetPlaybackDataAddresses();
         auto realtime = reinterpret_cast<int32_t*>(addresses.cls.realtime);
         *realtime = *realtime + ticks;
-        LOG_DEBUG("Skipping forward {} ticks, realtime: {}", ticks, *realtime);
+        LOG_CATEGORY_DEBUG(Playback, "Skipping forward {} ticks, realtime: {}", ticks, *realtime);
     }
 
     void SetTickDelta(int32_t value, bool ignoreDeadzone)
@@ -86,7 +87,7 @@ namespace IWXMVM::Components::Playback
 
     void HandleImportedFrozenTickLogic(std::optional<std::uint32_t> importedFrozenTick)
     {
-        const auto demoInfo = Mod::GetGameInterface()->GetDemoInfo();
+        const auto demoTick = Mod::GetGameInterface()->GetDemoTick();
         
         if (frozenTick.has_value())
         {
@@ -101,7 +102,7 @@ namespace IWXMVM::Components::Playback
         }
         
         // set actual tick
-        Playback::SetTickDelta(importedFrozenTick.value() - demoInfo.gameTick, true);
+        Playback::SetTickDelta(importedFrozenTick.value() - demoTick, true);
         
         // (re)enable frozen tick with specified value
         frozenTick.emplace(importedFrozenTick.value());
@@ -174,50 +175,51 @@ namespace IWXMVM::Components::Playback
             return 0;
         }
 
-        const std::optional<Types::Dvar> timescale = Mod::GetGameInterface()->GetDvar("timescale");
+        static DvarHandle<float> timescaleDvar("timescale");
+        static DvarHandle<std::int32_t> maxFpsDvar("com_maxfps");
+
+        const auto timescale = timescaleDvar.Get();
 
         // we can use the original msec value when its value is greater than 1, and/or when timescale is equal or
         // greater than 1.0
-        if (gameMsec > 1 || !timescale.has_value() || timescale.value().value->floating_point >= 1.0f)
+        if (gameMsec > 1 || !timescale || *timescale >= 1.0f)
             return gameMsec;
 
-        const std::optional<Types::Dvar> com_maxfps = Mod::GetGameInterface()->GetDvar("com_maxfps");
-        if (!com_maxfps.has_value())
+        const auto com_maxfps = maxFpsDvar.Get();
+        if (!com_maxfps)
             return gameMsec;
 
-        static float lastTimeScale = timescale.value().value->floating_point;
-        static std::int32_t lastMaxFps = com_maxfps.value().value->int32;
+        static float lastTimeScale = *timescale;
+        static std::int32_t lastMaxFps = *com_maxfps;
         static std::array<std::uint8_t, 1000> pattern{};
         static std::size_t patternIndex = 0;
 
         // below we're going to generate a pattern of interleaved 0s and 1s based on (imgui) frame times
         // we generate a new pattern each second, or whenever timescale or com_maxfps values changes
 
-        if (lastTimeScale != timescale.value().value->floating_point || lastMaxFps != com_maxfps.value().value->int32)
+        if (lastTimeScale != *timescale || lastMaxFps != *com_maxfps)
         {
             // this branch ensures that any change to the timescale or max fps immediately changes the pattern
             float frameRate;
 
-            if (lastMaxFps >
-                com_maxfps.value().value->int32)  // max fps was decreased, imgui fps is potentially too high
-                frameRate = std::min(ImGui::GetIO().Framerate, static_cast<float>(com_maxfps.value().value->int32));
-            else if (lastMaxFps <
-                     com_maxfps.value().value->int32)  // max fps was increased, imgui fps is potentially too low
-                frameRate = std::max(ImGui::GetIO().Framerate, static_cast<float>(com_maxfps.value().value->int32));
+            if (lastMaxFps > *com_maxfps)  // max fps was decreased, imgui fps is potentially too high
+                frameRate = std::min(ImGui::GetIO().Framerate, static_cast<float>(*com_maxfps));
+            else if (lastMaxFps < *com_maxfps)  // max fps was increased, imgui fps is potentially too low
+                frameRate = std::max(ImGui::GetIO().Framerate, static_cast<float>(*com_maxfps));
             else
             {
-                assert(lastTimeScale != timescale.value().value->floating_point);
+                assert(lastTimeScale != *timescale);
                 frameRate = ImGui::GetIO().Framerate;
             }
 
-            lastTimeScale = timescale.value().value->floating_point;
-            lastMaxFps = com_maxfps.value().value->int32;
+            lastTimeScale = *timescale;
+            lastMaxFps = *com_maxfps;
             patternIndex = 0;
 
-            GeneratePattern(pattern, frameRate, timescale.value().value->floating_point);
+            GeneratePattern(pattern, frameRate, *timescale);
         }
         else if (patternIndex % 1000 == 0)
-            GeneratePattern(pattern, ImGui::GetIO().Framerate, timescale.value().value->floating_point);
+            GeneratePattern(pattern, ImGui::GetIO().Framerate, *timescale);
 
         // advance (1ms) or pause(0ms) based on the pattern
         return pattern[patternIndex++ % 1000];
@@ -0,0 +1,688 @@
+#include "StdInclude.hpp"
+#include "RenderQueue.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include "Mod.hpp"
+#include "Events.hpp"
+#include "Configuration/PreferencesConfiguration.hpp"
+#include "Utilities/FrameProfiler.hpp"
+#include "Utilities/PathUtils.hpp"
+#include "CameraManager.hpp"
+#include "KeyframeManager.hpp"
+#include "KeyframeSerializer.hpp"
+#include "Playback.hpp"
+
+namespace IWXMVM::Components
+{
+    constexpr std::string_view NODE_START_ON_LAUNCH = "startOnLaunch";
+    constexpr std::string_view NODE_NEXT_JOB_NUMBER = "nextJobNumber";
+    constexpr std::string_view NODE_JOBS = "jobs";
+    constexpr std::string_view NODE_NAME = "name";
+    constexpr std::string_view NODE_DEMO = "demo";
+    constexpr std::string_view NODE_KEYFRAMES = "keyframes";
+    constexpr std::string_view NODE_TICK_RANGES = "tickRanges";
+    constexpr std::string_view NODE_CAMERA_MODE = "cameraMode";
+    constexpr std::string_view NODE_FRAMERATE = "framerate";
+    constexpr std::string_view NODE_MOTION_BLUR = "motionBlur";
+    constexpr std::string_view NODE_ENABLED = "enabled";
+    constexpr std::string_view NODE_SUB_FRAME_COUNT = "subFrameCount";
+    constexpr std::string_view NODE_SHUTTER_ANGLE = "shutterAngle";
+    constexpr std::string_view NODE_COLOR_GRADING = "colorGrading";
+    constexpr std::string_view NODE_LUT_PATH = "lutPath";
+    constexpr std::string_view NODE_OUTPUTS = "outputs";
+    constexpr std::string_view NODE_FORMAT = "format";
+    constexpr std::string_view NODE_VIDEO_CODEC = "videoCodec";
+    constexpr std::string_view NODE_WIDTH = "width";
+    constexpr std::string_view NODE_HEIGHT = "height";
+    constexpr std::string_view NODE_ENCODER_COUNT = "encoderCount";
+    constexpr std::string_view NODE_TRACKED_BONES = "trackedBones";
+    constexpr std::string_view NODE_TRACKING_FORMAT = "trackingFormat";
+    constexpr std::string_view NODE_STATUS = "status";
+    constexpr std::string_view NODE_ERROR = "error";
+
+    // demos take a while to load, but one that hasn't after this long won't
+    constexpr auto DEMO_LOAD_TIMEOUT = std::chrono::seconds(120);
+    // a capture whose frame count doesn't move for this long is stuck, e.g. because the range ends after the demo
+    constexpr auto CAPTURE_STALL_TIMEOUT = std::chrono::seconds(60);
+
+    std::filesystem::path GetQueuePath()
+    {
+        return PathUtils::GetIWXMVMPath() / "render_queue.json";
+    }
+
+    // demos and keyframes are copied here when a job is added, so the job doesn't depend on files that may change
+    std::filesystem::path GetQueueDirectory()
+    {
+        return PathUtils::GetIWXMVMPath() / "render_queue";
+    }
+
+    template <typename T>
+    T ReadEnum(const nlohmann::json& node, std::string_view name)
+    {
+        const auto value = magic_enum::enum_cast<T>(node.at(name).get<std::string>());
+        if (!value.has_value())
+        {
+            throw std::runtime_error(std::format("Unknown {} \"{}\"", name, node.at(name).get<std::string>()));
+        }
+        return value.value();
+    }
+
+    nlohmann::json WriteJob(const RenderJob& job)
+    {
+        using json = nlohmann::json;
+
+        json jobNode;
+        jobNode[NODE_NAME] = job.name;
+        jobNode[NODE_DEMO] = job.demoPath;
+        jobNode[NODE_KEYFRAMES] = job.keyframePath;
+
+        jobNode[NODE_TICK_RANGES] = json::array();
+        for (const auto& range : job.tickRanges)
+        {
+            jobNode[NODE_TICK_RANGES].push_back(json::array({range.startTick, range.endTick}));
+        }
+
+        const auto& captureSettings = job.captureSettings;
+        jobNode[NODE_CAMERA_MODE] = magic_enum::enum_name(job.cameraMode);
+        jobNode[NODE_FRAMERATE] = captureSettings.framerate;
+        jobNode[NODE_MOTION_BLUR][NODE_ENABLED] = captureSettings.motionBlur.enabled;
+        jobNode[NODE_MOTION_BLUR][NODE_SUB_FRAME_COUNT] = captureSettings.motionBlur.subFrameCount;
+        jobNode[NODE_MOTION_BLUR][NODE_SHUTTER_ANGLE] = captureSettings.motionBlur.shutterAngle;
+        jobNode[NODE_COLOR_GRADING][NODE_ENABLED] = captureSettings.colorGrading.enabled;
+        jobNode[NODE_COLOR_GRADING][NODE_LUT_PATH] = captureSettings.colorGrading.lutPath;
+
+        jobNode[NODE_OUTPUTS] = json::array();
+        for (const auto& output : captureSettings.outputs)
+        {
+            json outputNode;
+            outputNode[NODE_FORMAT] = magic_enum::enum_name(output.format);
+            if (output.videoCodec.has_value())
+            {
+                outputNode[NODE_VIDEO_CODEC] = magic_enum::enum_name(output.videoCodec.value());
+            }
+            outputNode[NODE_WIDTH] = output.resolution.width;
+            outputNode[NODE_HEIGHT] = output.resolution.height;
+            outputNode[NODE_ENCODER_COUNT] = output.encoderCount;
+            outputNode[NODE_TRACKED_BONES] = output.trackedBones;
+            outputNode[NODE_TRACKING_FORMAT] = magic_enum::enum_name(output.trackingFormat);
+            jobNode[NODE_OUTPUTS].push_back(outputNode);
+        }
+
+        jobNode[NODE_STATUS] = magic_enum::enum_name(job.status);
+        jobNode[NODE_ERROR] = job.error;
+        return jobNode;
+    }
+
+    RenderJob ReadJob(const nlohmann::json& jobNode)
+    {
+        RenderJob job = {};
+        job.name = jobNode.at(NODE_NAME).get<std::string>();
+        job.demoPath = jobNode.at(NODE_DEMO).get<std::filesystem::path>();
+        job.keyframePath = jobNode.at(NODE_KEYFRAMES).get<std::filesystem::path>();
+
+        for (const auto& rangeNode : jobNode.at(NODE_TICK_RANGES))
+        {
+            job.tickRanges.push_back({rangeNode.at(0).get<uint32_t>(), rangeNode.at(1).get<uint32_t>()});
+        }
+
+        auto& captureSettings = job.captureSettings;
+        job.cameraMode = ReadEnum<Camera::Mode>(jobNode, NODE_CAMERA_MODE);
+        captureSettings.framerate = jobNode.at(NODE_FRAMERATE).get<int32_t>();
+        const auto& motionBlurNode = jobNode.at(NODE_MOTION_BLUR);
+        captureSettings.motionBlur = {motionBlurNode.at(NODE_ENABLED).get<bool>(),
+                                      motionBlurNode.at(NODE_SUB_FRAME_COUNT).get<int32_t>(),
+                                      motionBlurNode.at(NODE_SHUTTER_ANGLE).get<float>()};
+        const auto& colorGradingNode = jobNode.at(NODE_COLOR_GRADING);
+        captureSettings.colorGrading = {colorGradingNode.at(NODE_ENABLED).get<bool>(),
+                                        colorGradingNode.at(NODE_LUT_PATH).get<std::filesystem::path>()};
+
+        for (const auto& outputNode : jobNode.at(NODE_OUTPUTS))
+        {
+            OutputSettings output = CaptureManager::Get().GetDefaultOutputSettings();
+            output.format = ReadEnum<OutputFormat>(outputNode, NODE_FORMAT);
+            output.videoCodec = outputNode.contains(NODE_VIDEO_CODEC)
+                                    ? std::optional{ReadEnum<VideoCodec>(outputNode, NODE_VIDEO_CODEC)}
+                                    : std::nullopt;
+            output.resolution = {outputNode.at(NODE_WIDTH).get<int32_t>(), outputNode.at(NODE_HEIGHT).get<int32_t>()};
+            output.encoderCount = outputNode.at(NODE_ENCODER_COUNT).get<int32_t>();
+            output.trackedBones = outputNode.at(NODE_TRACKED_BONES).get<std::vector<std::string>>();
+            output.trackingFormat = ReadEnum<Capture::TrackingFormat>(outputNode, NODE_TRACKING_FORMAT);
+            captureSettings.outputs.push_back(std::move(output));
+        }
+
+        job.status = ReadEnum<RenderJobStatus>(jobNode, NODE_STATUS);
+        job.error = jobNode.at(NODE_ERROR).get<std::string>();
+        return job;
+    }
+
+    void RenderQueue::Initialize()
+    {
+        Load();
+
+        Events::RegisterListener<EventType::OnDemoBoundsDetermined>("RenderQueue",
+                                                                    [&]() { demoBoundsDetermined = true; });
+        Events::RegisterListener<EventType::OnFrame>("RenderQueue", [&]() { OnFrame(); });
+    }
+
+    std::string_view RenderQueue::GetStatusLabel(RenderJobStatus status) const
+    {
+        switch (status)
+        {
+            case RenderJobStatus::Pending:
+                return "Pending";
+            case RenderJobStatus::Running:
+                return "Running";
+            case RenderJobStatus::Done:
+                return "Done";
+            case RenderJobStatus::Failed:
+                return "Failed";
+            default:
+                return "Unknown Status";
+        }
+    }
+
+    bool RenderQueue::AddCurrentSetup()
+    {
+        auto gameInterface = Mod::GetGameInterface();
+        if (gameInterface->GetGameState() != Types::GameState::InDemo)
+        {
+            LOG_ERROR("A demo has to be playing to add it to the render queue");
+            return false;
+        }
+
+        const auto& captureSettings = CaptureManager::Get().GetCaptureSettings();
+        if (captureSettings.startTick >= captureSettings.endTick)
+        {
+            LOG_ERROR("Start tick must be less than end tick");
+            return false;
+        }
+
+        const auto& demoInfo = gameInterface->GetDemoInfo();
+        const auto demoPath = std::filesystem::path(demoInfo.path);
+
+        RenderJob job = {};
+        job.name = std::format("{:03}_{}", nextJobNumber, demoPath.stem().string());
+        job.demoPath = GetQueueDirectory() / std::format("{}{}", job.name, demoPath.extension().string());
+        job.keyframePath = GetQueueDirectory() / std::format("{}.json", job.name);
+        job.tickRanges = {{captureSettings.startTick, captureSettings.endTick}};
+        job.cameraMode = CameraManager::Get().GetActiveCamera()->GetMode();
+        job.captureSettings = captureSettings;
+        job.status = RenderJobStatus::Pending;
+
+        // the playing demo is a temporary copy that is replaced once another demo is loaded
+        std::error_code errorCode;
+        std::filesystem::create_directories(GetQueueDirectory(), errorCode);
+        std::filesystem::copy_file(demoPath, job.demoPath, std::filesystem::copy_options::overwrite_existing,
+                                   errorCode);
+        if (errorCode)
+        {
+            LOG_ERROR("Failed to copy demo {} into the render queue: {}", demoPath.string(), errorCode.message());
+            return false;
+        }
+        KeyframeSerializer::Write(job.keyframePath);
+
+        LOG_INFO("Added {} to the render queue (ticks {} to {})", job.name, captureSettings.startTick,
+                 captureSettings.endTick);
+
+        nextJobNumber++;
+        jobs.push_back(std::move(job));
+        Save();
+        return true;
+    }
+
+    void RenderQueue::RemoveJob(std::size_t index)
+    {
+        if (index >= jobs.size() || activeJob == index)
+            return;
+
+        // only the copies made for the job are deleted, never files the queue file was edited to point at
+        const auto& job = jobs[index];
+        for (const auto& path : {job.demoPath, job.keyframePath})
+        {
+            if (path.parent_path() == GetQueueDirectory())
+            {
+                std::error_code errorCode;
+                std::filesystem::remove(path, errorCode);
+            }
+        }
+
+        jobs.erase(jobs.begin() + index);
+        if (activeJob.has_value() && activeJob.value() > index)
+        {
+            activeJob = activeJob.value() - 1;
+        }
+        Save();
+    }
+
+    void RenderQueue::ResetJob(std::size_t index)
+    {
+        if (index >= jobs.size() || activeJob == index)
+            return;
+
+        jobs[index].status = RenderJobStatus::Pending;
+        jobs[index].error.clear();
+        Save();
+    }
+
+    void RenderQueue::Start()
+    {
+        if (isRunning)
+            return;
+
+        auto& captureManager = CaptureManager::Get();
+        if (captureManager.IsCapturing() || captureManager.IsFinalizing())
+        {
+            LOG_ERROR("Cannot start the render queue while a capture is running");
+            return;
+        }
+
+        LOG_INFO("Starting render queue");
+        userCaptureSettings = captureManager.GetCaptureSettings();
+        isRunning = true;
+        stage = Stage::Idle;
+    }
+
+    void RenderQueue::Stop()
+    {
+        if (!isRunning)
+            return;
+
+        isRunning = false;
+        if (activeJob.has_value())
+        {
+            auto& captureManager = CaptureManager::Get();
+            if (captureManager.IsCapturing())
+            {
+                captureManager.StopCapture();
+            }
+
+            // an interrupted job is rendered again from the start on the next run
+            auto& job = jobs[activeJob.value()];
+            job.status = RenderJobStatus::Pending;
+            LOG_INFO("Stopped render queue, {} will be rendered again", job.name);
+
+            if (jobLog)
+            {
+                Logger::DetachSink(jobLog);
+                jobLog.reset();
+            }
+            captureManager.SetOutputDirectory(std::nullopt);
+            activeJob.reset();
+        }
+        else
+        {
+            LOG_INFO("Stopped render queue");
+        }
+
+        stage = Stage::Idle;
+        RestoreCaptureSettings();
+        Save();
+    }
+
+    void RenderQueue::RestoreCaptureSettings()
+    {
+        if (userCaptureSettings.has_value())
+        {
+            CaptureManager::Get().GetCaptureSettings() = std::move(userCaptureSettings.value());
+            userCaptureSettings.reset();
+        }
+    }
+
+    void RenderQueue::OnFrame()
+    {
+        IWXMVM_PROFILE_ZONE("RenderQueue::OnFrame");
+        if (!hasLaunched)
+        {
+            // render boxes start the game with a filled queue and leave it alone
+            hasLaunched = true;
+            const bool hasPendingJobs = std::any_of(jobs.begin(), jobs.end(), [](const auto& job) {
+                return job.status == RenderJobStatus::Pending;
+            });
+            if (startOnLaunch && hasPendingJobs &&
+                Mod::GetGameInterface()->GetGameState() != Types::GameState::InGame)
+            {
+                Start();
+            }
+        }
+
+        if (!isRunning)
+            return;
+
+        switch (stage)
+        {
+            case Stage::Idle:
+                StartNextJob();
+                break;
+            case Stage::LoadingDemo:
+                UpdateLoadingDemo();
+                break;
+            case Stage::Capturing:
+                UpdateCapturing();
+                break;
+            case Stage::Finalizing:
+                UpdateFinalizing();
+                break;
+        }
+    }
+
+    void RenderQueue::StartNextJob()
+    {
+        const auto job = std::find_if(jobs.begin(), jobs.end(),
+                                      [](const auto& job) { return job.status == RenderJobStatus::Pending; });
+        if (job == jobs.end())
+        {
+            const auto doneCount = std::count_if(jobs.begin(), jobs.end(),
+                                                 [](const auto& job) { return job.status == RenderJobStatus::Done; });
+            LOG_INFO("Render queue finished ({} of {} jobs done)", doneCount, jobs.size());
+            isRunning = false;
+            RestoreCaptureSettings();
+            return;
+        }
+
+        activeJob = static_cast<std::size_t>(std::distance(jobs.begin(), job));
+        job->status = RenderJobStatus::Running;
+        job->error.clear();
+        Save();
+
+        const auto jobDirectory = GetJobDirectory(*job);
+        std::error_code errorCode;
+        std::filesystem::create_directories(jobDirectory, errorCode);
+        try
+        {
+            jobLog = std::make_shared<spdlog::sinks::basic_file_sink_mt>((jobDirectory / "job.log").string(), true);
+            Logger::AttachSink(jobLog);
+        }
+        catch (const spdlog::spdlog_ex& e)
+        {
+            LOG_WARN("Failed to create log for render job {}: {}", job->name, e.what());
+        }
+
+        LOG_INFO("Starting render job {} ({} tick range(s) of {})", job->name, job->tickRanges.size(),
+                 job->demoPath.filename().string());
+
+        jobStartTime = Clock::now();
+        rangeIndex = 0;
+        rangeReports.clear();
+        demoLoadSeconds = 0.0;
+
+        if (job->tickRanges.empty())
+        {
+            FinishJob("Job has no tick ranges");
+            return;
+        }
+
+        if (!std::filesystem::is_regular_file(job->demoPath))
+        {
+            FinishJob(std::format("Demo {} does not exist", job->demoPath.string()));
+            return;
+        }
+
+        demoBoundsDetermined = false;
+        stage = Stage::LoadingDemo;
+        stageStartTime = Clock::now();
+        Mod::GetGameInterface()->PlayDemo(job->demoPath);
+    }
+
+    void RenderQueue::UpdateLoadingDemo()
+    {
+        const auto now = Clock::now();
+        if (now - stageStartTime > DEMO_LOAD_TIMEOUT)
+        {
+            FinishJob("Timed out waiting for the demo to load");
+            return;
+        }
+
+        // the previous job's outputs may still be finishing, which has to be done before the next capture starts
+        auto gameInterface = Mod::GetGameInterface();
+        if (!demoBoundsDetermined || gameInterface->GetGameState() != Types::GameState::InDemo ||
+            CaptureManager::Get().IsFinalizing())
+            return;
+
+        demoLoadSeconds = std::chrono::duration<double>(now - stageStartTime).count();
+        if (gameInterface->GetDemoInfo().endTick == 0)
+        {
+            FinishJob("Could not determine the length of the demo");
+            return;
+        }
+
+        // this runs after the keyframes of the last session with this demo were restored, so they are replaced
+        const auto& job = jobs[activeJob.value()];
+        KeyframeManager::Get().ClearKeyframes();
+        if (!KeyframeSerializer::Read(job.keyframePath))
+        {
+            FinishJob(std::format("Failed to read keyframes from {}", job.keyframePath.string()));
+            return;
+        }
+        CameraManager::Get().SetActiveCamera(job.cameraMode);
+
+        LOG_INFO("Loaded demo in {:.1f} s", demoLoadSeconds);
+        StartRange();
+    }
+
+    void RenderQueue::StartRange()
+    {
+        const auto& job = jobs[activeJob.value()];
+        auto range = job.tickRanges[rangeIndex];
+
+        // the capture only stops once the tick passes the end of the range, which never happens past the demo's end
+        const auto demoEndTick = Mod::GetGameInterface()->GetDemoInfo().endTick;
+        if (range.endTick >= demoEndTick)
+        {
+            LOG_WARN("Tick range {} ends after the demo, capturing up to tick {} instead", rangeIndex + 1,
+                     demoEndTick - 1);
+            range.endTick = demoEndTick - 1;
+        }
+
+        auto& captureManager = CaptureManager::Get();
+        auto& captureSettings = captureManager.GetCaptureSettings();
+        captureSettings = job.captureSettings;
+        captureSettings.startTick = range.startTick;
+        captureSettings.endTick = range.endTick;
+        captureManager.SetOutputDirectory(GetJobDirectory(job));
+
+        if (Playback::IsPaused())
+        {
+            Playback::TogglePaused();
+        }
+
+        LOG_INFO("Capturing tick range {} of {} ({} to {})", rangeIndex + 1, job.tickRanges.size(), range.startTick,
+                 range.endTick);
+        captureManager.StartCapture();
+        if (!captureManager.IsCapturing())
+        {
+            FinishJob(std::format("Capture of ticks {} to {} did not start", range.startTick, range.endTick));
+            return;
+        }
+
+        rangeReport = {range, 0, 0.0, 0.0, false};
+        stage = Stage::Capturing;
+        stageStartTime = lastProgressTime = Clock::now();
+        lastCapturedFrameCount = captureManager.GetCapturedFrameCount();
+    }
+
+    void RenderQueue::UpdateCapturing()
+    {
+        auto& captureManager = CaptureManager::Get();
+        const auto now = Clock::now();
+
+        if (captureManager.IsCapturing())
+        {
+            const auto capturedFrameCount = captureManager.GetCapturedFrameCount();
+            if (capturedFrameCount != lastCapturedFrameCount)
+            {
+                lastCapturedFrameCount = capturedFrameCount;
+                lastProgressTime = now;
+            }
+            else if (now - lastProgressTime > CAPTURE_STALL_TIMEOUT)
+            {
+                LOG_ERROR("Capture made no progress for {} seconds, stopping it", CAPTURE_STALL_TIMEOUT.count());
+                captureManager.StopCapture();
+            }
+            return;
+        }
+
+        rangeReport.frameCount = captureManager.GetCapturedFrameCount();
+        rangeReport.captureSeconds = std::chrono::duration<double>(now - stageStartTime).count();
+        stage = Stage::Finalizing;
+        stageStartTime = now;
+    }
+
+    void RenderQueue::UpdateFinalizing()
+    {
+        auto& captureManager = CaptureManager::Get();
+        if (captureManager.IsFinalizing())
+            return;
+
+        rangeReport.finalizeSeconds = std::chrono::duration<double>(Clock::now() - stageStartTime).count();
+        rangeReport.succeeded = captureManager.DidLastCaptureSucceed();
+        rangeReports.push_back(rangeReport);
+
+        LOG_INFO("Captured {} frames in {:.1f} s, finalized in {:.1f} s", rangeReport.frameCount,
+                 rangeReport.captureSeconds, rangeReport.finalizeSeconds);
+
+        if (!rangeReport.succeeded)
+        {
+            FinishJob(std::format("Capture of ticks {} to {} failed", rangeReport.range.startTick,
+                                  rangeReport.range.endTick));
+            return;
+        }
+
+        // the next range is captured from the same demo, the capture seeks to its start by itself
+        if (++rangeIndex < jobs[activeJob.value()].tickRanges.size())
+        {
+            StartRange();
+            return;
+        }
+
+        FinishJob(std::nullopt);
+    }
+
+    void RenderQueue::FinishJob(std::optional<std::string> error)
+    {
+        auto& job = jobs[activeJob.value()];
+        job.status = error.has_value() ? RenderJobStatus::Failed : RenderJobStatus::Done;
+        job.error = error.value_or("");
+
+        const auto jobSeconds = std::chrono::duration<double>(Clock::now() - jobStartTime).count();
+        if (error.has_value())
+        {
+            LOG_ERROR("Render job {} failed after {:.1f} s: {}", job.name, jobSeconds, error.value());
+        }
+        else
+        {
+            LOG_INFO("Render job {} finished in {:.1f} s", job.name, jobSeconds);
+        }
+
+        WriteReport();
+        if (jobLog)
+        {
+            Logger::DetachSink(jobLog);
+            jobLog.reset();
+        }
+
+        CaptureManager::Get().SetOutputDirectory(std::nullopt);
+        activeJob.reset();
+        stage = Stage::Idle;
+        Save();
+    }
+
+    void RenderQueue::WriteReport() const
+    {
+        const auto& job = jobs[activeJob.value()];
+        const auto path = GetJobDirectory(job) / "report.csv";
+
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Failed to write render job report to {}", path.string());
+            return;
+        }
+
+        file << "stage,start_tick,end_tick,frames,seconds,finalize_seconds,fps,result\n";
+        file << std::format("load,,,,{:.3f},,,{}\n", demoLoadSeconds, demoLoadSeconds > 0.0 ? "ok" : "failed");
+
+        int64_t totalFrameCount = 0;
+        for (std::size_t i = 0; i < rangeReports.size(); i++)
+        {
+            const auto& report = rangeReports[i];
+            const auto framesPerSecond = report.captureSeconds > 0.0 ? report.frameCount / report.captureSeconds : 0.0;
+            file << std::format("range {},{},{},{},{:.3f},{:.3f},{:.1f},{}\n", i + 1, report.range.startTick,
+                                report.range.endTick, report.frameCount, report.captureSeconds,
+                                report.finalizeSeconds, framesPerSecond, report.succeeded ? "ok" : "failed");
+            totalFrameCount += report.frameCount;
+        }
+
+        const auto jobSeconds = std::chrono::duration<double>(Clock::now() - jobStartTime).count();
+        file << std::format("total,,,{},{:.3f},,,{}\n", totalFrameCount, jobSeconds,
+                            GetStatusLabel(job.status));
+    }
+
+    std::filesystem::path RenderQueue::GetJobDirectory(const RenderJob& job) const
+    {
+        return PreferencesConfiguration::Get().captureOutputDirectory / job.name;
+    }
+
+    void RenderQueue::Load()
+    {
+        using json = nlohmann::json;
+
+        std::ifstream file(GetQueuePath());
+        if (!file.is_open())
+            return;
+
+        try
+        {
+            json rootNode = json::parse(file);
+            Configuration::ReadValueInto<bool>(rootNode, NODE_START_ON_LAUNCH, startOnLaunch);
+            Configuration::ReadValueInto<int32_t>(rootNode, NODE_NEXT_JOB_NUMBER, nextJobNumber);
+
+            for (const auto& jobNode : rootNode.at(NODE_JOBS))
+            {
+                try
+                {
+                    auto& job = jobs.emplace_back(ReadJob(jobNode));
+
+                    // the game went down in the middle of this job; it isn't retried, since it may well do so again
+                    if (job.status == RenderJobStatus::Running)
+                    {
+                        job.status = RenderJobStatus::Failed;
+                        job.error = "Interrupted";
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    LOG_ERROR("Skipping render queue job ({})", e.what());
+                }
+            }
+
+            LOG_INFO("Loaded {} render queue job(s)", jobs.size());
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR("Failed to parse render queue ({})", e.what());
+        }
+    }
+
+    void RenderQueue::Save() const
+    {
+        using json = nlohmann::json;
+
+        json rootNode;
+        rootNode[NODE_START_ON_LAUNCH] = startOnLaunch;
+        rootNode[NODE_NEXT_JOB_NUMBER] = nextJobNumber;
+        rootNode[NODE_JOBS] = json::array();
+        for (const auto& job : jobs)
+        {
+            rootNode[NODE_JOBS].push_back(WriteJob(job));
+        }
+
+        std::ofstream file(GetQueuePath());
+        if (!file.is_open())
+        {
+            LOG_ERROR("Failed to write render queue to {}", GetQueuePath().string());
+            return;
+        }
+        file << rootNode.dump(4);
+    }
+}  // namespace IWXMVM::Components
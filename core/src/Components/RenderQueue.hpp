@@ -0,0 +1,149 @@
+#pragma once
+#include "Camera.hpp"
+#include "CaptureManager.hpp"
+
+namespace IWXMVM::Components
+{
+    struct TickRange
+    {
+        uint32_t startTick, endTick;
+    };
+
+    enum class RenderJobStatus
+    {
+        Pending,
+        Running,
+        Done,
+        Failed,
+
+        Count
+    };
+
+    struct RenderJob
+    {
+        std::string name;  // also the name of the job's output directory
+        std::filesystem::path demoPath;
+        std::filesystem::path keyframePath;  // keyframe project, as written by KeyframeSerializer
+        std::vector<TickRange> tickRanges;   // every range is captured separately, into the same directory
+        Camera::Mode cameraMode;
+        CaptureSettings captureSettings;  // start and end tick are taken from the tick ranges
+
+        RenderJobStatus status;
+        std::string error;
+    };
+
+    // Persistent queue of captures that are run back to back without anyone touching the game: every job loads its
+    // demo and keyframes, captures its tick ranges into its own directory, and leaves a log and timing report there.
+    // The queue is saved whenever it changes, so it survives restarts.
+    class RenderQueue
+    {
+       public:
+        static RenderQueue& Get()
+        {
+            static RenderQueue instance;
+            return instance;
+        }
+
+        RenderQueue(RenderQueue const&) = delete;
+        void operator=(RenderQueue const&) = delete;
+
+        void Initialize();
+
+        // snapshots the loaded demo, its keyframes, the capture settings and the active camera into a new job
+        bool AddCurrentSetup();
+        void RemoveJob(std::size_t index);
+        void ResetJob(std::size_t index);
+
+        const std::vector<RenderJob>& GetJobs() const
+        {
+            return jobs;
+        }
+
+        void Start();
+        void Stop();
+
+        bool IsRunning() const
+        {
+            return isRunning;
+        }
+
+        // the job being rendered while the queue runs
+        std::optional<std::size_t> GetActiveJobIndex() const
+        {
+            return activeJob;
+        }
+
+        std::size_t GetActiveRangeIndex() const
+        {
+            return rangeIndex;
+        }
+
+        bool& GetStartOnLaunch()
+        {
+            return startOnLaunch;
+        }
+
+        std::string_view GetStatusLabel(RenderJobStatus status) const;
+
+        void Save() const;
+
+       private:
+        RenderQueue()
+        {
+        }
+
+        enum class Stage
+        {
+            Idle,
+            LoadingDemo,
+            Capturing,
+            Finalizing,
+        };
+
+        using Clock = std::chrono::steady_clock;
+
+        struct RangeReport
+        {
+            TickRange range;
+            int32_t frameCount;
+            double captureSeconds;
+            double finalizeSeconds;
+            bool succeeded;
+        };
+
+        void OnFrame();
+        void StartNextJob();
+        void UpdateLoadingDemo();
+        void UpdateCapturing();
+        void UpdateFinalizing();
+        void StartRange();
+        void FinishJob(std::optional<std::string> error);
+        void WriteReport() const;
+        void RestoreCaptureSettings();
+
+        void Load();
+        std::filesystem::path GetJobDirectory(const RenderJob& job) const;
+
+        std::vector<RenderJob> jobs;
+        int32_t nextJobNumber = 1;
+        bool startOnLaunch = false;
+
+        // state of the running queue
+        bool isRunning = false;
+        bool hasLaunched = false;
+        Stage stage = Stage::Idle;
+        std::optional<std::size_t> activeJob;
+        std::size_t rangeIndex = 0;
+        bool demoBoundsDetermined = false;
+        std::shared_ptr<spdlog::sinks::basic_file_sink_mt> jobLog;
+        std::optional<CaptureSettings> userCaptureSettings;  // put back once the queue stops
+
+        Clock::time_point jobStartTime;
+        Clock::time_point stageStartTime;
+        Clock::time_point lastProgressTime;
+        int32_t lastCapturedFrameCount = 0;
+        double demoLoadSeconds = 0.0;
+        RangeReport rangeReport = {};
+        std::vector<RangeReport> rangeReports;
+    };
+}  // namespace IWXMVM::Components
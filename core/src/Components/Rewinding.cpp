@@ -44,7 +44,7 @@ namespace IWXMVM::Components::Rewinding
 
     void ResetRewindData()
     {
-        LOG_DEBUG("Closing file handle and resetting rewind data");
+        LOG_CATEGORY_DEBUG(Playback, "Closing file handle and resetting rewind data");
         filestreamState = FilestreamState::Uninitialized;
         if (demoFile.is_open())
         {
@@ -66,7 +66,7 @@ namespace IWXMVM::Components::Rewinding
         {
             auto addresses = Mod::GetGameInterface()->GetPlaybackDataAddresses();
 
-            LOG_DEBUG("Reached the footer / end of the demo, rewinding and pausing now");
+            LOG_CATEGORY_DEBUG(Playback, "Reached the footer / end of the demo, rewinding and pausing now");
             rewindTo.store(*reinterpret_cast<int*>(addresses.cl.snap_serverTime) - 1000);
 
             if (!Components::Playback::IsPaused())
@@ -85,15 +85,15 @@ namespace IWXMVM::Components::Rewinding
         if (latestRewindTo - initialGamestate->serverTime <= 0)
         {
             // not sure why this happens yet, but this is an invalid value!
-            LOG_DEBUG("Cannot rewind past first tick: {}, instead rewinding to: {}",
-                        latestRewindTo, initialGamestate->serverTime);
+            LOG_CATEGORY_DEBUG(Playback, "Cannot rewind past first tick: {}, instead rewinding to: {}",
+                               latestRewindTo, initialGamestate->serverTime);
             latestRewindTo = initialGamestate->serverTime;
         }
 
         Mod::GetGameInterface()->ResetClientData(initialGamestate->serverTime);
         Mod::GetGameInterface()->CL_FirstSnapshot();
 
-        LOG_DEBUG("Rewound and time is now: {}", initialGamestate->serverTime);
+        LOG_CATEGORY_DEBUG(Playback, "Rewound and time is now: {}", initialGamestate->serverTime);
         demoFileOffset = initialGamestate->fileOffset;
         demoFile.seekg(demoFileOffset);
 
@@ -206,7 +206,7 @@ namespace IWXMVM::Components::Rewinding
 
         if (ticks >= SKIPPING_FORWARD)
         {
-            LOG_DEBUG("Cannot rewind invalid tick value {}", ticks);
+            LOG_CATEGORY_DEBUG(Playback, "Cannot rewind invalid tick value {}", ticks);
             return;
         }
 
@@ -217,11 +217,11 @@ namespace IWXMVM::Components::Rewinding
         if (curRewindTo != NOT_IN_USE ||
             !rewindTo.compare_exchange_strong(curRewindTo, *reinterpret_cast<int*>(addresses.cl.serverTime) + ticks))
         {
-            LOG_DEBUG("Attempted to rewind back {} ticks", ticks);
+            LOG_CATEGORY_DEBUG(Playback, "Attempted to rewind back {} ticks", ticks);
             return;
         }
 
-        LOG_DEBUG("Rewinding back {} ticks", ticks);
+        LOG_CATEGORY_DEBUG(Playback, "Rewinding back {} ticks", ticks);
     }
 
     int FS_Read(void* buffer, int len)
@@ -242,7 +242,7 @@ namespace IWXMVM::Components::Rewinding
                 demoFile.seekg(0, std::ios::beg);
 
                 filestreamState = FilestreamState::Initialized;
-                LOG_DEBUG("Opened file stream for demo file: {}", demoPath);
+                LOG_CATEGORY_DEBUG(Playback, "Opened file stream for demo file: {}", demoPath);
             }
         }
 
@@ -275,6 +275,6 @@ namespace IWXMVM::Components::Rewinding
 
     void Initialize()
     {
-        Events::RegisterListener(EventType::PreDemoLoad, ResetRewindData);
+        Events::RegisterListener<EventType::PreDemoLoad>("Rewinding", ResetRewindData);
     }
 }  // namespace IWXMVM::Components::Rewinding
@@ -23,6 +23,20 @@ namespace IWXMVM
         Configuration::ReadValueInto<std::filesystem::path>(j, NODE_CAPTURE_OUTPUT_DIRECTORY, captureOutputDirectory);
         Configuration::ReadValueInto<std::vector<std::filesystem::path>>(j, NODE_ADDITIONAL_DEMO_SEARCH_DIRECTORIES,
                                                                          additionalDemoSearchDirectories);
+
+        std::map<std::string, std::string> logLevels;
+        Configuration::ReadValueInto<std::map<std::string, std::string>>(j, NODE_LOG_LEVELS, logLevels);
+        for (const auto& [categoryName, levelName] : logLevels)
+        {
+            const auto category = magic_enum::enum_cast<LogCategory>(categoryName);
+            const auto level = spdlog::level::from_str(levelName);
+            // from_str falls back to off for names it doesn't know
+            if (category.has_value() && category != LogCategory::Count &&
+                (level != spdlog::level::off || levelName == "off"))
+            {
+                Logger::SetCategoryLevel(category.value(), level);
+            }
+        }
     }
 
     void PreferencesConfiguration::Serialize(nlohmann::json& j) const
@@ -40,5 +54,13 @@ namespace IWXMVM
         {
 			j[NODE_ADDITIONAL_DEMO_SEARCH_DIRECTORIES].push_back(dir);
         }
+
+        j[NODE_LOG_LEVELS] = nlohmann::json::object();
+        for (std::size_t i = 0; i < static_cast<std::size_t>(LogCategory::Count); i++)
+        {
+            const auto category = static_cast<LogCategory>(i);
+            const auto level = spdlog::level::to_string_view(Logger::GetCategoryLevel(category));
+            j[NODE_LOG_LEVELS][magic_enum::enum_name(category)] = std::string(level.data(), level.size());
+        }
     }
 }  // namespace IWXMVM
\ No newline at end of file
@@ -32,6 +32,8 @@ namespace IWXMVM
 
         std::vector<std::filesystem::path> additionalDemoSearchDirectories;  // Directories added by the user, to be searched
 
+        // the log levels per category are kept by the Logger, which needs them before the preferences are loaded
+
        private:
         PreferencesConfiguration();
 
@@ -43,6 +45,7 @@ namespace IWXMVM
         const std::string_view NODE_ORBIT_ZOOM_SPEED = "orbitZoomSpeed";
         const std::string_view NODE_CAPTURE_OUTPUT_DIRECTORY = "captureOutputDirectory";
         const std::string_view NODE_ADDITIONAL_DEMO_SEARCH_DIRECTORIES = "additionalDemoSearchDirectories";
+        const std::string_view NODE_LOG_LEVELS = "logLevels";
 
     };
 }  // namespace IWXMVM
\ No newline at end of file
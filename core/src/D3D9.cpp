@@ -5,6 +5,7 @@
 
 #include "Events.hpp"
 #include "Graphics/Graphics.hpp"
+#include "Utilities/FrameProfiler.hpp"
 #include "Utilities/HookManager.hpp"
 #include "Utilities/PathUtils.hpp"
 #include "Mod.hpp"
@@ -105,6 +106,10 @@ namespace IWXMVM::D3D9
             return EndScene(pDevice);
         }
 
+        // a frame of the profiler runs from one EndScene to the next
+        IWXMVM_PROFILE_BEGIN_FRAME();
+        IWXMVM_PROFILE_ZONE("EndScene_Hook");
+
         if (!UI::UIManager::Get().IsInitialized())
         {
             device = pDevice;
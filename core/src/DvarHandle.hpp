@@ -0,0 +1,87 @@
+#pragma once
+#include "Mod.hpp"
+
+namespace IWXMVM
+{
+    // A dvar that is looked up by name the first time it is used, and again only after the game invalidated its dvars
+    // (see GameInterface::InvalidateDvars). Handles are meant to be static or members of long lived objects, so that
+    // reading a dvar every frame costs a comparison instead of a lookup. A dvar that isn't found is looked up again
+    // after the next invalidation, or once a second until then, since some are only registered when a demo loads.
+    // Like the dvars themselves, handles are not synchronized.
+    template <typename T>
+    class DvarHandle
+    {
+        static_assert(std::is_same_v<T, bool> || std::is_same_v<T, std::int32_t> || std::is_same_v<T, float> ||
+                          std::is_same_v<T, glm::vec4> || std::is_same_v<T, const char*>,
+                      "A dvar's value is a bool, an integer, a float, a vector or a string");
+
+       public:
+        explicit DvarHandle(const char* name) : name(name)
+        {
+        }
+
+        DvarHandle(DvarHandle const&) = delete;
+        void operator=(DvarHandle const&) = delete;
+
+        // the dvar's current value, or nullptr if the game has no dvar of this name (yet)
+        T* Get()
+        {
+            return Resolve() ? reinterpret_cast<T*>(dvar.value) : nullptr;
+        }
+
+        // the dvar's current value, for dvars the game always has; throws if it doesn't have this one
+        T& Value()
+        {
+            if (!Resolve())
+                throw std::runtime_error(std::format("Dvar {} not found", name));
+
+            return *reinterpret_cast<T*>(dvar.value);
+        }
+
+        // false if the game has no dvar of this name (yet), which leaves it at that
+        bool Set(const T& value)
+        {
+            if (!Resolve())
+                return false;
+
+            *reinterpret_cast<T*>(dvar.value) = value;
+            return true;
+        }
+
+        void MarkModified()
+        {
+            if (Resolve() && dvar.modified)
+                *dvar.modified = true;
+        }
+
+        const char* GetName() const
+        {
+            return name;
+        }
+
+       private:
+        static constexpr auto MISSING_DVAR_RETRY_INTERVAL = std::chrono::seconds(1);
+
+        bool Resolve()
+        {
+            auto* gameInterface = Mod::GetGameInterface();
+            const auto generation = gameInterface->GetDvarGeneration();
+            if (resolvedGeneration == generation &&
+                (dvar.value != nullptr || std::chrono::steady_clock::now() < retryTime))
+            {
+                return dvar.value != nullptr;
+            }
+
+            dvar = gameInterface->GetDvar(name).value_or(Types::Dvar{});
+            resolvedGeneration = generation;
+            if (dvar.value == nullptr)
+                retryTime = std::chrono::steady_clock::now() + MISSING_DVAR_RETRY_INTERVAL;
+            return dvar.value != nullptr;
+        }
+
+        const char* name;
+        Types::Dvar dvar = {};
+        std::uint32_t resolvedGeneration = 0;
+        std::chrono::steady_clock::time_point retryTime;
+    };
+}  // namespace IWXMVM
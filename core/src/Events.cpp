@@ -1,20 +1,62 @@
-#include "StdInclude.hpp"
 #include "Events.hpp"
 
+#include <array>
+
 namespace IWXMVM::Events
 {
-    std::map<EventType, std::vector<std::function<void()>>> listeners;
+    namespace Detail
+    {
+        namespace
+        {
+            template <std::size_t... Indices>
+            std::array<ListenerListBase*, sizeof...(Indices)> MakeListenerTable(std::index_sequence<Indices...>)
+            {
+                return {&GetListenerList<static_cast<EventType>(Indices)>()...};
+            }
+        }  // namespace
+
+        ListenerListBase& GetListenerList(EventType eventType)
+        {
+            static const auto table =
+                MakeListenerTable(std::make_index_sequence<static_cast<std::size_t>(EventType::Count)>());
+            return *table[static_cast<std::size_t>(eventType)];
+        }
+    }  // namespace Detail
+
+    bool UnregisterListener(ListenerHandle handle)
+    {
+        if (handle.id == 0 || handle.eventType >= EventType::Count)
+            return false;
+
+        return Detail::GetListenerList(handle.eventType).Remove(handle.id);
+    }
 
-    void Invoke(const EventType eventType)
+    void SetTimingEnabled(bool isEnabled)
     {
-        for (const auto& function : listeners[eventType])
+        Detail::isTimingEnabled.store(isEnabled, std::memory_order_relaxed);
+    }
+
+    bool IsTimingEnabled()
+    {
+        return Detail::isTimingEnabled.load(std::memory_order_relaxed);
+    }
+
+    std::vector<ListenerTiming> GetListenerTimings()
+    {
+        std::vector<ListenerTiming> timings;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(EventType::Count); i++)
         {
-            function();
+            const auto eventType = static_cast<EventType>(i);
+            Detail::GetListenerList(eventType).AppendTimings(eventType, timings);
         }
+        return timings;
     }
 
-    void RegisterListener(const EventType eventType, const std::function<void()> function)
+    void ResetListenerTimings()
     {
-        listeners[eventType].push_back(function);
+        for (std::size_t i = 0; i < static_cast<std::size_t>(EventType::Count); i++)
+        {
+            Detail::GetListenerList(static_cast<EventType>(i)).ResetTimings();
+        }
     }
-}  // namespace IWXMVM::Events
\ No newline at end of file
+}  // namespace IWXMVM::Events
@@ -1,7 +1,21 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace IWXMVM
 {
+    namespace Components
+    {
+        class Camera;
+    }  // namespace Components
+
     enum class EventType
     {
         OnFrame, // once per rendered frame
@@ -10,11 +24,343 @@ namespace IWXMVM
         OnDemoBoundsDetermined,
         OnCameraChanged,
         OnRenderGameView,
+
+        Count
     };
 
     namespace Events
     {
-        void Invoke(EventType eventType);
-        void RegisterListener(EventType eventType, std::function<void()> function);
+        struct DemoBounds
+        {
+            // server times of the first and the last tick, both 0 if they could not be determined
+            std::uint32_t startTick;
+            std::uint32_t endTick;
+        };
+
+        struct CameraChange
+        {
+            Components::Camera& activeCamera;
+            Components::Camera& previousCamera;
+        };
+
+        // what an event passes to its listeners
+        template <EventType Type>
+        struct EventTraits
+        {
+            using Signature = void();
+        };
+
+        template <>
+        struct EventTraits<EventType::PreDemoLoad>
+        {
+            using Signature = void(const std::filesystem::path& demoPath);
+        };
+
+        template <>
+        struct EventTraits<EventType::OnDemoBoundsDetermined>
+        {
+            using Signature = void(const DemoBounds& bounds);
+        };
+
+        template <>
+        struct EventTraits<EventType::OnCameraChanged>
+        {
+            using Signature = void(const CameraChange& change);
+        };
+
+        // listeners of the same priority are called in the order they were registered in
+        enum class ListenerPriority : std::int32_t
+        {
+            First = -1,
+            Normal = 0,
+            Last = 1,
+        };
+
+        struct ListenerHandle
+        {
+            EventType eventType;
+            std::uint32_t id;  // 0 for no listener
+        };
+
+        struct ListenerTiming
+        {
+            EventType eventType;
+            const char* name;
+            std::uint64_t callCount;
+            std::chrono::nanoseconds totalTime;
+            std::chrono::nanoseconds longestTime;
+        };
+
+        namespace Detail
+        {
+            using Clock = std::chrono::steady_clock;
+
+            // timing costs two clock reads per listener call, so it is off until someone looks at the timings
+            inline std::atomic<bool> isTimingEnabled = false;
+            inline std::atomic<std::uint32_t> nextListenerId = 1;
+
+            class ListenerListBase
+            {
+               public:
+                virtual ~ListenerListBase() = default;
+
+                virtual bool Remove(std::uint32_t id) = 0;
+                virtual void AppendTimings(EventType eventType, std::vector<ListenerTiming>& timings) const = 0;
+                virtual void ResetTimings() = 0;
+            };
+
+            template <EventType Type, typename Signature = typename EventTraits<Type>::Signature>
+            class ListenerList;
+
+            // A dispatch is a loop over a single contiguous array of plain function pointers and the listeners they
+            // call, with everything else about the listeners kept apart. Listeners that are added or removed while
+            // the event is dispatched are only added or erased once the dispatch is done, so that the loop never sees
+            // the array change, and a listener that removes itself is not destroyed while it runs.
+            template <EventType Type, typename... Args>
+            class ListenerList<Type, void(Args...)> final : public ListenerListBase
+            {
+               public:
+                template <typename F>
+                ListenerHandle Add(const char* name, F&& function, ListenerPriority priority)
+                {
+                    using Target = std::decay_t<F>;
+                    auto* target = new Target(std::forward<F>(function));
+
+                    const auto id = nextListenerId.fetch_add(1, std::memory_order_relaxed);
+                    Listener listener = {id, priority, name, TargetPointer(target, &Delete<Target>)};
+                    const Slot slot = {&Call<Target>, target};
+                    if (dispatchDepth > 0)
+                    {
+                        pendingListeners.push_back(std::move(listener));
+                        pendingSlots.push_back(slot);
+                        hasChanges = true;
+                    }
+                    else
+                    {
+                        Insert(std::move(listener), slot);
+                    }
+                    return {Type, id};
+                }
+
+                bool Remove(std::uint32_t id) final
+                {
+                    for (std::size_t i = 0; i < listeners.size(); i++)
+                    {
+                        if (listeners[i].id != id || listeners[i].isRemoved)
+                            continue;
+
+                        if (dispatchDepth > 0)
+                        {
+                            // the listener itself lives on until the dispatch is done
+                            slots[i].call = &Skip;
+                            listeners[i].isRemoved = true;
+                            hasChanges = true;
+                        }
+                        else
+                        {
+                            listeners.erase(listeners.begin() + i);
+                            slots.erase(slots.begin() + i);
+                        }
+                        return true;
+                    }
+
+                    for (std::size_t i = 0; i < pendingListeners.size(); i++)
+                    {
+                        if (pendingListeners[i].id == id)
+                        {
+                            pendingListeners.erase(pendingListeners.begin() + i);
+                            pendingSlots.erase(pendingSlots.begin() + i);
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                void Invoke(Args... args)
+                {
+                    dispatchDepth++;
+                    const auto count = slots.size();
+                    if (!isTimingEnabled.load(std::memory_order_relaxed))
+                    {
+                        for (std::size_t i = 0; i < count; i++)
+                        {
+                            slots[i].call(slots[i].target, args...);
+                        }
+                    }
+                    else
+                    {
+                        for (std::size_t i = 0; i < count; i++)
+                        {
+                            const auto start = Clock::now();
+                            slots[i].call(slots[i].target, args...);
+                            listeners[i].Record(Clock::now() - start);
+                        }
+                    }
+
+                    if (--dispatchDepth == 0 && hasChanges)
+                        ApplyChanges();
+                }
+
+                void AppendTimings(EventType eventType, std::vector<ListenerTiming>& timings) const final
+                {
+                    for (const auto& listener : listeners)
+                    {
+                        if (listener.isRemoved)
+                            continue;
+
+                        timings.push_back({eventType, listener.name, listener.callCount,
+                                           std::chrono::duration_cast<std::chrono::nanoseconds>(listener.totalTime),
+                                           std::chrono::duration_cast<std::chrono::nanoseconds>(listener.longestTime)});
+                    }
+                }
+
+                void ResetTimings() final
+                {
+                    for (auto& listener : listeners)
+                    {
+                        listener.callCount = 0;
+                        listener.totalTime = {};
+                        listener.longestTime = {};
+                    }
+                }
+
+               private:
+                using TargetPointer = std::unique_ptr<void, void (*)(void*)>;
+
+                struct Slot
+                {
+                    void (*call)(void* target, Args... args);
+                    void* target;
+                };
+
+                struct Listener
+                {
+                    std::uint32_t id;
+                    ListenerPriority priority;
+                    const char* name;
+                    TargetPointer target;  // owns what the slot calls
+                    bool isRemoved = false;
+
+                    std::uint64_t callCount = 0;
+                    Clock::duration totalTime = {};
+                    Clock::duration longestTime = {};
+
+                    void Record(Clock::duration time)
+                    {
+                        callCount++;
+                        totalTime += time;
+                        longestTime = std::max(longestTime, time);
+                    }
+                };
+
+                template <typename Target>
+                static void Call(void* target, Args... args)
+                {
+                    (*static_cast<Target*>(target))(args...);
+                }
+
+                template <typename Target>
+                static void Delete(void* target)
+                {
+                    delete static_cast<Target*>(target);
+                }
+
+                static void Skip(void*, Args...)
+                {
+                }
+
+                void Insert(Listener listener, Slot slot)
+                {
+                    const auto it = std::upper_bound(
+                        listeners.begin(), listeners.end(), listener.priority,
+                        [](ListenerPriority priority, const Listener& other) { return priority < other.priority; });
+                    slots.insert(slots.begin() + (it - listeners.begin()), slot);
+                    listeners.insert(it, std::move(listener));
+                }
+
+                void ApplyChanges()
+                {
+                    for (std::size_t i = listeners.size(); i-- > 0;)
+                    {
+                        if (listeners[i].isRemoved)
+                        {
+                            listeners.erase(listeners.begin() + i);
+                            slots.erase(slots.begin() + i);
+                        }
+                    }
+
+                    for (std::size_t i = 0; i < pendingListeners.size(); i++)
+                    {
+                        Insert(std::move(pendingListeners[i]), pendingSlots[i]);
+                    }
+                    pendingListeners.clear();
+                    pendingSlots.clear();
+                    hasChanges = false;
+                }
+
+                std::vector<Slot> slots;
+                std::vector<Listener> listeners;  // parallel to slots
+
+                std::vector<Listener> pendingListeners;
+                std::vector<Slot> pendingSlots;
+                std::uint32_t dispatchDepth = 0;
+                bool hasChanges = false;
+            };
+
+            template <EventType Type>
+            ListenerList<Type>& GetListenerList()
+            {
+                static ListenerList<Type> list;
+                return list;
+            }
+
+            ListenerListBase& GetListenerList(EventType eventType);
+
+            template <typename F, typename Signature>
+            struct IsInvocableAs;
+
+            template <typename F, typename... Args>
+            struct IsInvocableAs<F, void(Args...)> : std::is_invocable<F&, Args...>
+            {
+            };
+
+            template <EventType Type, typename F>
+            inline constexpr bool IsListenerOf = IsInvocableAs<F, typename EventTraits<Type>::Signature>::value;
+        }  // namespace Detail
+
+        // Events aren't synchronized: listeners are registered, unregistered and invoked from the game's thread, or
+        // during initialization before the hooks that invoke them are installed.
+        template <EventType Type>
+        void Invoke(auto&&... args)
+        {
+            Detail::GetListenerList<Type>().Invoke(std::forward<decltype(args)>(args)...);
+        }
+
+        // the function takes the event's arguments, or nothing if it doesn't need them. The name is what the listener
+        // is shown as with its timings.
+        template <EventType Type, typename F>
+        ListenerHandle RegisterListener(const char* name, F&& function,
+                                        ListenerPriority priority = ListenerPriority::Normal)
+        {
+            auto& list = Detail::GetListenerList<Type>();
+            if constexpr (Detail::IsListenerOf<Type, F>)
+            {
+                return list.Add(name, std::forward<F>(function), priority);
+            }
+            else
+            {
+                static_assert(std::is_invocable_v<F&>, "A listener has to take the event's arguments, or nothing");
+                return list.Add(
+                    name, [function = std::forward<F>(function)](auto&&...) mutable { function(); }, priority);
+            }
+        }
+
+        // also from within a listener, while its event is being dispatched
+        bool UnregisterListener(ListenerHandle handle);
+
+        void SetTimingEnabled(bool isEnabled);
+        bool IsTimingEnabled();
+        std::vector<ListenerTiming> GetListenerTimings();
+        void ResetListenerTimings();
     }  // namespace Events
-}  // namespace IWXMVM
\ No newline at end of file
+}  // namespace IWXMVM
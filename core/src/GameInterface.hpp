@@ -58,7 +58,9 @@ namespace IWXMVM
             return Types::Features_None;
         };
 
-        virtual Types::DemoInfo GetDemoInfo() = 0;
+        virtual const Types::DemoInfo& GetDemoInfo() = 0;
+        // the tick the demo is at, counted from its first one
+        virtual std::uint32_t GetDemoTick() = 0;
         virtual std::string_view GetDemoExtension() = 0;
 
         virtual void PlayDemo(std::filesystem::path demoPath) = 0;
@@ -67,8 +69,20 @@ namespace IWXMVM
         virtual bool IsConsoleOpen() = 0;
 
         // perhaps dvars shouldnt be exposed to core at all?
+        // this looks the dvar up by name; code that runs every frame should use a DvarHandle instead
         virtual std::optional<Types::Dvar> GetDvar(const std::string_view name) = 0;
 
+        // called whenever the game may have registered its dvars again, so that handles look them up again
+        void InvalidateDvars()
+        {
+            dvarGeneration.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::uint32_t GetDvarGeneration() const
+        {
+            return dvarGeneration.load(std::memory_order_relaxed);
+        }
+
         virtual void SetFov(float fov) = 0;
 
         virtual Types::Sun GetSun() = 0;
@@ -91,5 +105,6 @@ namespace IWXMVM
 
        private:
         Types::Game game;
+        std::atomic<std::uint32_t> dvarGeneration = 1;
     };
 }  // namespace IWXMVM
@@ -0,0 +1,274 @@
+#include "StdInclude.hpp"
+#include "Bvh.hpp"
+
+namespace IWXMVM::GFX
+{
+    constexpr std::uint32_t MAX_LEAF_SIZE = 4;
+    constexpr std::size_t MAX_TREE_DEPTH = 64;
+
+    // Splits the node at the median of its primitives' centers along the axis they spread the most on, until leaves
+    // hold few enough of them. order is rearranged so that every leaf refers to a contiguous range of it.
+    void Subdivide(std::vector<BvhNode>& nodes, std::size_t nodeIndex, std::vector<std::uint32_t>& order,
+                   const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs)
+    {
+        const auto first = nodes[nodeIndex].first;
+        const auto count = nodes[nodeIndex].count;
+
+        glm::vec3 min = mins[order[first]];
+        glm::vec3 max = maxs[order[first]];
+        glm::vec3 centerMin = (min + max) * 0.5f;
+        glm::vec3 centerMax = centerMin;
+        for (std::uint32_t i = first; i < first + count; i++)
+        {
+            const auto center = (mins[order[i]] + maxs[order[i]]) * 0.5f;
+            min = glm::min(min, mins[order[i]]);
+            max = glm::max(max, maxs[order[i]]);
+            centerMin = glm::min(centerMin, center);
+            centerMax = glm::max(centerMax, center);
+        }
+        nodes[nodeIndex].min = min;
+        nodes[nodeIndex].max = max;
+
+        const auto extent = centerMax - centerMin;
+        const auto axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        if (count <= MAX_LEAF_SIZE || extent[axis] <= 0.0f)
+        {
+            return;
+        }
+
+        const auto middle = first + count / 2;
+        std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + first + count,
+                         [&](std::uint32_t a, std::uint32_t b) {
+                             return mins[a][axis] + maxs[a][axis] < mins[b][axis] + maxs[b][axis];
+                         });
+
+        const auto left = static_cast<std::uint32_t>(nodes.size());
+        nodes.push_back(BvhNode{{}, {}, first, middle - first});
+        nodes.push_back(BvhNode{{}, {}, middle, first + count - middle});
+        nodes[nodeIndex].first = left;
+        nodes[nodeIndex].count = 0;
+
+        Subdivide(nodes, left, order, mins, maxs);
+        Subdivide(nodes, left + 1, order, mins, maxs);
+    }
+
+    void BuildTree(std::vector<BvhNode>& nodes, std::vector<std::uint32_t>& order, const std::vector<glm::vec3>& mins,
+                   const std::vector<glm::vec3>& maxs)
+    {
+        nodes.clear();
+        order.resize(mins.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (order.empty())
+        {
+            return;
+        }
+
+        nodes.reserve(mins.size() * 2 / MAX_LEAF_SIZE + 1);
+        nodes.push_back(BvhNode{{}, {}, 0, static_cast<std::uint32_t>(order.size())});
+        Subdivide(nodes, 0, order, mins, maxs);
+    }
+
+    // Distance along the ray to where it enters the node's bounds, if it does before maxDistance
+    std::optional<float> IntersectBounds(const Ray& ray, const glm::vec3& inverseDirection, const BvhNode& node,
+                                         float maxDistance)
+    {
+        const auto t0 = (node.min - ray.origin) * inverseDirection;
+        const auto t1 = (node.max - ray.origin) * inverseDirection;
+        const auto entries = glm::min(t0, t1);
+        const auto exits = glm::max(t0, t1);
+        const auto enter = std::max({entries.x, entries.y, entries.z, 0.0f});
+        const auto exit = std::min({exits.x, exits.y, exits.z, maxDistance});
+        if (enter > exit)
+        {
+            return std::nullopt;
+        }
+        return enter;
+    }
+
+    // Visits every leaf whose bounds the ray enters before closestDistance, nearer children first so that the leaf
+    // test can shorten closestDistance and the farther ones can be skipped
+    template <typename LeafTest>
+    void Traverse(const std::vector<BvhNode>& nodes, const Ray& ray, float& closestDistance, LeafTest testLeaf)
+    {
+        if (nodes.empty())
+        {
+            return;
+        }
+
+        // keeps axis-parallel rays from producing 0 * infinity
+        const auto inverseComponent = [](float value) {
+            return 1.0f / (value != 0.0f ? value : std::numeric_limits<float>::min());
+        };
+        const glm::vec3 inverseDirection = {inverseComponent(ray.direction.x), inverseComponent(ray.direction.y),
+                                            inverseComponent(ray.direction.z)};
+
+        std::array<std::uint32_t, MAX_TREE_DEPTH * 2> stack;
+        std::size_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0)
+        {
+            const auto& node = nodes[stack[--stackSize]];
+            if (!IntersectBounds(ray, inverseDirection, node, closestDistance).has_value())
+            {
+                continue;
+            }
+
+            if (node.count > 0)
+            {
+                testLeaf(node);
+                continue;
+            }
+
+            const auto leftDistance = IntersectBounds(ray, inverseDirection, nodes[node.first], closestDistance);
+            const auto rightDistance = IntersectBounds(ray, inverseDirection, nodes[node.first + 1], closestDistance);
+            if (leftDistance.has_value() && rightDistance.has_value())
+            {
+                const bool isLeftNearer = leftDistance.value() <= rightDistance.value();
+                stack[stackSize++] = isLeftNearer ? node.first + 1 : node.first;
+                stack[stackSize++] = isLeftNearer ? node.first : node.first + 1;
+            }
+            else if (leftDistance.has_value())
+            {
+                stack[stackSize++] = node.first;
+            }
+            else if (rightDistance.has_value())
+            {
+                stack[stackSize++] = node.first + 1;
+            }
+        }
+    }
+
+    void MeshBvh::Build(const std::vector<Types::Vertex>& vertices, const std::vector<Types::Index>& indices)
+    {
+        const auto triangleCount = indices.size() / 3;
+        std::vector<glm::vec3> mins(triangleCount);
+        std::vector<glm::vec3> maxs(triangleCount);
+        for (std::size_t i = 0; i < triangleCount; i++)
+        {
+            const auto& a = vertices[indices[i * 3]].pos;
+            const auto& b = vertices[indices[i * 3 + 1]].pos;
+            const auto& c = vertices[indices[i * 3 + 2]].pos;
+            mins[i] = glm::min(a, glm::min(b, c));
+            maxs[i] = glm::max(a, glm::max(b, c));
+        }
+
+        std::vector<std::uint32_t> order;
+        BuildTree(nodes, order, mins, maxs);
+
+        triangles.resize(triangleCount);
+        for (std::size_t i = 0; i < triangleCount; i++)
+        {
+            const auto triangle = order[i];
+            triangles[i] = {vertices[indices[triangle * 3]].pos, vertices[indices[triangle * 3 + 1]].pos,
+                            vertices[indices[triangle * 3 + 2]].pos};
+        }
+    }
+
+    std::optional<float> MeshBvh::Intersect(const Ray& ray) const
+    {
+        auto closestDistance = std::numeric_limits<float>::max();
+        bool isHit = false;
+        Traverse(nodes, ray, closestDistance, [&](const BvhNode& leaf) {
+            for (std::uint32_t i = leaf.first; i < leaf.first + leaf.count; i++)
+            {
+                const auto& triangle = triangles[i];
+                glm::vec2 baryPosition;
+                float distance = 0;
+                if (glm::intersectRayTriangle(ray.origin, ray.direction, triangle[0], triangle[1], triangle[2],
+                                              baryPosition, distance) &&
+                    distance < closestDistance)
+                {
+                    closestDistance = distance;
+                    isHit = true;
+                }
+            }
+        });
+
+        if (!isHit)
+        {
+            return std::nullopt;
+        }
+        return closestDistance;
+    }
+
+    void SphereBvh::Update(std::span<const glm::vec3> centers, float radius)
+    {
+        const bool hasSameCount = centers.size() == spheres.size() && radius == sphereRadius;
+        if (hasSameCount && std::equal(centers.begin(), centers.end(), spheres.begin()))
+        {
+            return;
+        }
+
+        spheres.assign(centers.begin(), centers.end());
+        sphereRadius = radius;
+        if (hasSameCount)
+        {
+            Refit();
+        }
+        else
+        {
+            Build();
+        }
+    }
+
+    void SphereBvh::Build()
+    {
+        std::vector<glm::vec3> mins(spheres.size());
+        std::vector<glm::vec3> maxs(spheres.size());
+        for (std::size_t i = 0; i < spheres.size(); i++)
+        {
+            mins[i] = spheres[i] - glm::vec3(sphereRadius);
+            maxs[i] = spheres[i] + glm::vec3(sphereRadius);
+        }
+
+        BuildTree(nodes, order, mins, maxs);
+    }
+
+    void SphereBvh::Refit()
+    {
+        // children always come after their parent, so walking backwards updates them first
+        for (auto node = nodes.rbegin(); node != nodes.rend(); ++node)
+        {
+            if (node->count > 0)
+            {
+                node->min = spheres[order[node->first]];
+                node->max = node->min;
+                for (std::uint32_t i = node->first; i < node->first + node->count; i++)
+                {
+                    node->min = glm::min(node->min, spheres[order[i]]);
+                    node->max = glm::max(node->max, spheres[order[i]]);
+                }
+                node->min -= glm::vec3(sphereRadius);
+                node->max += glm::vec3(sphereRadius);
+            }
+            else
+            {
+                node->min = glm::min(nodes[node->first].min, nodes[node->first + 1].min);
+                node->max = glm::max(nodes[node->first].max, nodes[node->first + 1].max);
+            }
+        }
+    }
+
+    std::optional<std::size_t> SphereBvh::Intersect(const Ray& ray) const
+    {
+        const auto direction = glm::normalize(ray.direction);
+        const auto directionScale = glm::length(ray.direction);
+
+        auto closestDistance = std::numeric_limits<float>::max();
+        std::optional<std::size_t> closestSphere;
+        Traverse(nodes, ray, closestDistance, [&](const BvhNode& leaf) {
+            for (std::uint32_t i = leaf.first; i < leaf.first + leaf.count; i++)
+            {
+                float distance = 0;
+                if (glm::intersectRaySphere(ray.origin, direction, spheres[order[i]], sphereRadius * sphereRadius,
+                                            distance) &&
+                    distance / directionScale < closestDistance)
+                {
+                    closestDistance = distance / directionScale;
+                    closestSphere = order[i];
+                }
+            }
+        });
+        return closestSphere;
+    }
+}  // namespace IWXMVM::GFX
@@ -0,0 +1,60 @@
+#pragma once
+#include "StdInclude.hpp"
+
+#include "Types/Vertex.hpp"
+
+namespace IWXMVM::GFX
+{
+    struct Ray
+    {
+        glm::vec3 origin;
+        glm::vec3 direction;  // distances along the ray are in multiples of its length
+
+        Ray Transform(const glm::mat4& matrix) const
+        {
+            return Ray{glm::vec3(matrix * glm::vec4(origin, 1.0f)), glm::vec3(matrix * glm::vec4(direction, 0.0f))};
+        }
+    };
+
+    struct BvhNode
+    {
+        glm::vec3 min, max;
+        std::uint32_t first;  // first primitive of a leaf, or the left child of an inner node (the right one follows)
+        std::uint32_t count;  // number of primitives, 0 for inner nodes
+    };
+
+    // Bounding volume hierarchy over the triangles of a mesh, built once in model space. Rays are transformed into
+    // model space instead of transforming every vertex into world space.
+    class MeshBvh
+    {
+       public:
+        void Build(const std::vector<Types::Vertex>& vertices, const std::vector<Types::Index>& indices);
+
+        // distance along the ray to the closest triangle it hits
+        std::optional<float> Intersect(const Ray& ray) const;
+
+       private:
+        std::vector<BvhNode> nodes;
+        std::vector<std::array<glm::vec3, 3>> triangles;  // in the order the leaves refer to them
+    };
+
+    // Bounding volume hierarchy over spheres of the same size that move around, like campath nodes. Moving spheres
+    // only refits the bounds; the tree is built again when spheres are added or removed.
+    class SphereBvh
+    {
+       public:
+        void Update(std::span<const glm::vec3> centers, float radius);
+
+        // index of the closest sphere the ray hits, in the order the centers were given
+        std::optional<std::size_t> Intersect(const Ray& ray) const;
+
+       private:
+        void Build();
+        void Refit();
+
+        std::vector<BvhNode> nodes;
+        std::vector<std::uint32_t> order;  // sphere indices in the order the leaves refer to them
+        std::vector<glm::vec3> spheres;
+        float sphereRadius = 0.0f;
+    };
+}  // namespace IWXMVM::GFX
@@ -0,0 +1,74 @@
+#include "DrawBatch.hpp"
+
+#include <algorithm>
+
+namespace IWXMVM::GFX
+{
+    void DrawBatcher::Submit(std::size_t meshIndex, DrawPass pass, const InstanceData& instance)
+    {
+        const auto lookupIndex = meshIndex * static_cast<std::size_t>(DrawPass::Count) + static_cast<std::size_t>(pass);
+        if (lookupIndex >= batchLookup.size())
+        {
+            batchLookup.resize(lookupIndex + 1, -1);
+        }
+
+        auto& batch = batchLookup[lookupIndex];
+        if (batch < 0)
+        {
+            batch = static_cast<std::int32_t>(unsortedBatches.size());
+            unsortedBatches.push_back(DrawBatch{meshIndex, 0, 0});
+            batchPasses.push_back(pass);
+        }
+
+        unsortedBatches[batch].instanceCount++;
+        submissions.push_back(Submission{static_cast<std::uint32_t>(batch), instance});
+    }
+
+    void DrawBatcher::Build()
+    {
+        for (auto& passBatches : batches)
+        {
+            passBatches.clear();
+        }
+
+        // lay the batches out pass by pass, then put every instance into the next free slot of its batch
+        std::size_t instanceCount = 0;
+        for (std::size_t pass = 0; pass < batches.size(); pass++)
+        {
+            for (std::size_t i = 0; i < unsortedBatches.size(); i++)
+            {
+                if (static_cast<std::size_t>(batchPasses[i]) != pass)
+                    continue;
+
+                unsortedBatches[i].firstInstance = instanceCount;
+                instanceCount += unsortedBatches[i].instanceCount;
+                batches[pass].push_back(unsortedBatches[i]);
+            }
+        }
+
+        instances.resize(instanceCount);
+        std::vector<std::size_t> nextInstance(unsortedBatches.size());
+        for (std::size_t i = 0; i < unsortedBatches.size(); i++)
+        {
+            nextInstance[i] = unsortedBatches[i].firstInstance;
+        }
+
+        for (const auto& submission : submissions)
+        {
+            instances[nextInstance[submission.batch]++] = submission.instance;
+        }
+    }
+
+    void DrawBatcher::Clear()
+    {
+        submissions.clear();
+        std::fill(batchLookup.begin(), batchLookup.end(), -1);
+        batchPasses.clear();
+        unsortedBatches.clear();
+        for (auto& passBatches : batches)
+        {
+            passBatches.clear();
+        }
+        instances.clear();
+    }
+}  // namespace IWXMVM::GFX
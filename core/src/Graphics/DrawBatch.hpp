@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace IWXMVM::GFX
+{
+    enum class DrawPass
+    {
+        Scene,    // depth tested
+        Overlay,  // drawn last and on top of everything, like gizmos
+
+        Count
+    };
+
+    // What the vertex shader reads per instance from the second vertex stream
+    struct InstanceData
+    {
+        std::array<float, 16> model;  // column major, as laid out by glm
+        std::uint32_t color;          // D3DCOLOR the mesh's vertex colors are multiplied with
+        float ignoreLighting;         // 1 to draw the colors as they are
+    };
+    static_assert(sizeof(InstanceData) == 72, "InstanceData has to match the instance vertex declaration");
+
+    struct DrawBatch
+    {
+        std::size_t meshIndex;
+        std::size_t firstInstance;
+        std::size_t instanceCount;
+    };
+
+    // Collects the draws of a frame and sorts them into one batch per mesh and pass, so that every batch can be drawn
+    // with a single instanced call. Within a pass, batches are in the order their meshes were first submitted, and
+    // instances in the order they were submitted. Nothing here touches the device.
+    class DrawBatcher
+    {
+       public:
+        void Submit(std::size_t meshIndex, DrawPass pass, const InstanceData& instance);
+
+        // sorts what was submitted since the last Clear into batches
+        void Build();
+        void Clear();
+
+        std::span<const DrawBatch> GetBatches(DrawPass pass) const
+        {
+            return batches[static_cast<std::size_t>(pass)];
+        }
+
+        // the instances of every batch, contiguous from its firstInstance
+        std::span<const InstanceData> GetInstances() const
+        {
+            return instances;
+        }
+
+        std::size_t GetSubmittedCount() const
+        {
+            return submissions.size();
+        }
+
+       private:
+        struct Submission
+        {
+            std::uint32_t batch;
+            InstanceData instance;
+        };
+
+        std::vector<Submission> submissions;
+        std::vector<std::int32_t> batchLookup;  // batch of every mesh and pass, -1 if nothing was submitted for it
+        std::vector<DrawPass> batchPasses;
+        std::vector<DrawBatch> unsortedBatches;  // in the order they were first submitted
+
+        std::array<std::vector<DrawBatch>, static_cast<std::size_t>(DrawPass::Count)> batches;
+        std::vector<InstanceData> instances;
+    };
+}  // namespace IWXMVM::GFX
@@ -5,63 +5,105 @@
 #include "UI/UIManager.hpp"
 #include "Components/CameraManager.hpp"
 #include "Components/CampathManager.hpp"
+#include "DvarHandle.hpp"
 #include "Graphics/Resource.hpp"
 #include "Input.hpp"
 #include "Mod.hpp"
 #include "Types/Vertex.hpp"
+#include "Utilities/FrameProfiler.hpp"
 #include "Utilities/MathUtils.hpp"
+#include "Utilities/PathUtils.hpp"
 
 INCBIN_EXTERN(VERTEX_SHADER);
 INCBIN_EXTERN(PIXEL_SHADER);
 
 namespace IWXMVM::GFX
 {
+    constexpr DWORD SHADER_COMPILE_FLAGS = 0;
+
+    const ShaderCache::Bytecode* GraphicsManager::GetShaderBytecode(const uint8_t source[], uint32_t size,
+                                                                    const char* profile)
+    {
+        const ShaderKey key = {std::string_view(reinterpret_cast<const char*>(source), size), "main", profile,
+                               SHADER_COMPILE_FLAGS, D3DX_SDK_VERSION};
+        return shaderCache.GetOrCompile(key, [&]() -> std::optional<ShaderCache::Bytecode> {
+            ID3DXBuffer* shaderBuffer = nullptr;
+            ID3DXBuffer* errorMessageBuffer = nullptr;
+            HRESULT result = D3DXCompileShader(key.source.data(), static_cast<UINT>(key.source.size()), nullptr,
+                                               nullptr, "main", profile, SHADER_COMPILE_FLAGS, &shaderBuffer,
+                                               &errorMessageBuffer, nullptr);
+            if (result != D3D_OK)
+            {
+                LOG_ERROR("Failed to compile {} shader: {}", profile,
+                          errorMessageBuffer != nullptr
+                              ? reinterpret_cast<const char*>(errorMessageBuffer->GetBufferPointer())
+                              : "");
+                if (errorMessageBuffer != nullptr)
+                    errorMessageBuffer->Release();
+                return std::nullopt;
+            }
+
+            const auto* bytecode = reinterpret_cast<const std::uint8_t*>(shaderBuffer->GetBufferPointer());
+            ShaderCache::Bytecode compiled(bytecode, bytecode + shaderBuffer->GetBufferSize());
+            shaderBuffer->Release();
+            return compiled;
+        });
+    }
+
     void GraphicsManager::Initialize()
     {
         IDirect3DDevice9* device = D3D9::GetDevice();
-        ID3DXBuffer* errorMessageBuffer = nullptr;
 
-        ID3DXBuffer* vertexShaderBuffer = nullptr;
-        HRESULT result = D3DXCompileShader((LPCSTR)VERTEX_SHADER_data, VERTEX_SHADER_size, nullptr, NULL, "main",
-                                           "vs_3_0",
-                                           NULL,
-                                   &vertexShaderBuffer, &errorMessageBuffer, nullptr);
-        if (result != D3D_OK)
+        // compiled shaders are kept across sessions and only compiled again once the source or the flags change
+        shaderCache.SetDirectory(PathUtils::GetIWXMVMPath() / "shaders");
+        const auto compiles = shaderCache.GetStatistics().compiles;
+
+        const auto* vertexShaderBytecode = GetShaderBytecode(VERTEX_SHADER_data, VERTEX_SHADER_size, "vs_3_0");
+        if (vertexShaderBytecode == nullptr)
         {
-            LOG_ERROR("Failed to compile vertex shader: {}",
-                      reinterpret_cast<const char*>(errorMessageBuffer->GetBufferPointer()));
-            errorMessageBuffer->Release();
             return;
         }
 
-        result = device->CreateVertexShader(reinterpret_cast<const DWORD*>(vertexShaderBuffer->GetBufferPointer()),
-                                            &vertexShader);
+        HRESULT result =
+            device->CreateVertexShader(reinterpret_cast<const DWORD*>(vertexShaderBytecode->data()), &vertexShader);
         if (result != D3D_OK)
         {
             LOG_ERROR("Failed to create vertex shader");
         }
 
-        ID3DXBuffer* pixelShaderBuffer = nullptr;
-        result = D3DXCompileShader((LPCSTR)PIXEL_SHADER_data, PIXEL_SHADER_size, nullptr, NULL, "main", "ps_3_0",
-                                           NULL, &pixelShaderBuffer, &errorMessageBuffer, nullptr);
-        if (result != D3D_OK)
+        const auto* pixelShaderBytecode = GetShaderBytecode(PIXEL_SHADER_data, PIXEL_SHADER_size, "ps_3_0");
+        if (pixelShaderBytecode == nullptr)
         {
-            LOG_ERROR("Failed to compile pixel shader: {}",
-                      reinterpret_cast<const char*>(errorMessageBuffer->GetBufferPointer()));
-            errorMessageBuffer->Release();
             return;
         }
-        result = device->CreatePixelShader(reinterpret_cast<const DWORD*>(pixelShaderBuffer->GetBufferPointer()),
-                                           &pixelShader);
+
+        result = device->CreatePixelShader(reinterpret_cast<const DWORD*>(pixelShaderBytecode->data()), &pixelShader);
         if (result != D3D_OK)
         {
             LOG_ERROR("Failed to create pixel shader");
         }
 
+        if (shaderCache.GetStatistics().compiles != compiles)
+        {
+            LOG_DEBUG("Compiled {} shaders", shaderCache.GetStatistics().compiles - compiles);
+        }
+        if (shaderCache.GetStatistics().failedWrites > 0)
+        {
+            LOG_WARN("Failed to save {} compiled shaders", shaderCache.GetStatistics().failedWrites);
+        }
+
         D3DVERTEXELEMENT9 decl[] = {
             {0, offsetof(Types::Vertex, pos), D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0},
             {0, offsetof(Types::Vertex, normal), D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_NORMAL, 0},
             {0, offsetof(Types::Vertex, col), D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR, 0},
+            // the model matrix column by column, the tint and whether to light, once per instance
+            {1, 0, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 1},
+            {1, 16, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 2},
+            {1, 32, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 3},
+            {1, 48, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 4},
+            {1, offsetof(InstanceData, color), D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR, 1},
+            {1, offsetof(InstanceData, ignoreLighting), D3DDECLTYPE_FLOAT1, D3DDECLMETHOD_DEFAULT,
+             D3DDECLUSAGE_TEXCOORD, 5},
             D3DDECL_END(),
         };
         result = device->CreateVertexDeclaration(decl, &vertexDeclaration);
@@ -76,25 +118,17 @@ namespace IWXMVM::GFX
         BufferManager::Get().AddMesh(&camera);
         BufferManager::Get().AddMesh(&icosphere);
 
-        for (size_t i = 0; i < gizmo_translate_x.vertices.size(); i++)
+        for (auto& vertex : gizmo_translate.vertices)
         {
-            gizmo_translate_x.vertices[i].col = D3DCOLOR_COLORVALUE(1, 0, 0, 1);
-            gizmo_translate_y.vertices[i].col = D3DCOLOR_COLORVALUE(0, 1, 0, 1);
-            gizmo_translate_z.vertices[i].col = D3DCOLOR_COLORVALUE(0, 0, 1, 1);
+            vertex.col = D3DCOLOR_COLORVALUE(1, 1, 1, 1);
         }
-        BufferManager::Get().AddMesh(&gizmo_translate_x);
-        BufferManager::Get().AddMesh(&gizmo_translate_y);
-        BufferManager::Get().AddMesh(&gizmo_translate_z);
+        BufferManager::Get().AddMesh(&gizmo_translate);
 
-        for (size_t i = 0; i < gizmo_rotate_x.vertices.size(); i++)
+        for (auto& vertex : gizmo_rotate.vertices)
         {
-            gizmo_rotate_x.vertices[i].col = D3DCOLOR_COLORVALUE(1, 0, 0, 1);
-            gizmo_rotate_y.vertices[i].col = D3DCOLOR_COLORVALUE(0, 1, 0, 1);
-            gizmo_rotate_z.vertices[i].col = D3DCOLOR_COLORVALUE(0, 0, 1, 1);
+            vertex.col = D3DCOLOR_COLORVALUE(1, 1, 1, 1);
         }
-        BufferManager::Get().AddMesh(&gizmo_rotate_x);
-        BufferManager::Get().AddMesh(&gizmo_rotate_y);
-        BufferManager::Get().AddMesh(&gizmo_rotate_z);
+        BufferManager::Get().AddMesh(&gizmo_rotate);
     }
 
     void GraphicsManager::Uninitialize()
@@ -115,6 +149,9 @@ namespace IWXMVM::GFX
             vertexShader = nullptr;
         }
         BufferManager::Get().Uninitialize();
+
+        // the buffers are gone, so the campath mesh has to be uploaded again
+        isCampathUploaded = false;
     }
 
     glm::mat4 GetViewMatrix()
@@ -154,7 +191,8 @@ namespace IWXMVM::GFX
         const auto tanHalfFovX = glm::tan(glm::radians(camera->GetFov()) * 0.5f);
         const auto tanHalfFovY = tanHalfFovX * (1.0f / aspectRatio);
         const auto fovY = glm::atan(tanHalfFovY) * 2.0f;
-        const auto znear = Mod::GetGameInterface()->GetDvar("r_znear").value().value->floating_point;
+        static DvarHandle<float> znearDvar("r_znear");
+        const auto znear = znearDvar.Value();
 
         return glm::perspectiveLH_ZO(fovY, aspectRatio, znear, 100000.0f);
     }
@@ -256,45 +294,13 @@ namespace IWXMVM::GFX
         return -mouseRayDirection;
     }
 
-    bool GraphicsManager::MouseIntersects(ImVec2 mousePos, Mesh& mesh, glm::mat4 model)
+    bool GraphicsManager::MouseIntersects(const Mesh& mesh, const glm::mat4& model) const
     {
-        auto& camera = Components::CameraManager::Get().GetActiveCamera();
-        const auto view = GetViewMatrix();
-        const auto projection = GetProjectionMatrix();
-        const auto mouseRayDirection = GetMouseRay(mousePos, projection, view);
-
-        for (size_t i = 0; i < mesh.indices.size(); i += 3)
-        {
-            const auto i1 = mesh.indices[i];
-            const auto i2 = mesh.indices[i+1];
-            const auto i3 = mesh.indices[i+2];
-            const auto a = glm::vec3(model * glm::vec4(mesh.vertices[i1].pos, 1.0f));
-            const auto b = glm::vec3(model * glm::vec4(mesh.vertices[i2].pos, 1.0f));
-            const auto c = glm::vec3(model * glm::vec4(mesh.vertices[i3].pos, 1.0f));
-            
-            glm::vec2 baryPosition;
-            float distance = 0;
-            if (glm::intersectRayTriangle(camera->GetPosition(), glm::normalize(mouseRayDirection), a, b, c,
-                                          baryPosition, distance))
-            {
-                return true;
-            }
-        }
-        return false;
+        // bring the ray into model space, where the mesh's tree was built
+        return mesh.bvh.Intersect(mouseRay.Transform(glm::inverse(model))).has_value();
     }
 
-    bool GraphicsManager::MouseIntersectsSphereAt(ImVec2 mousePos, glm::vec3 pos, float radius)
-    {
-        auto& camera = Components::CameraManager::Get().GetActiveCamera();
-        const auto view = GetViewMatrix();
-        const auto projection = GetProjectionMatrix();
-        const auto mouseRayDirection = GetMouseRay(mousePos, projection, view);
-
-        float distance;
-        return glm::intersectRaySphere(camera->GetPosition(), glm::normalize(mouseRayDirection), pos, radius * radius, distance);
-    }
-    
-    void GraphicsManager::DrawGizmoComponent(Mesh& mesh, glm::mat4 model, int32_t axisIndex)
+    void GraphicsManager::DrawGizmoComponent(const Mesh& mesh, glm::mat4 model, int32_t axisIndex, D3DCOLOR color)
     {
         if (heldAxis.has_value() && heldAxis.value().axisIndex != axisIndex)
         {
@@ -303,7 +309,7 @@ namespace IWXMVM::GFX
         
         if (!objectHoveredThisFrame)
         {
-            bool mouseIntersects = MouseIntersects(ImGui::GetIO().MousePos, mesh, model);
+            bool mouseIntersects = MouseIntersects(mesh, model);
             objectHoveredThisFrame |= mouseIntersects;
             if (mouseIntersects && Input::KeyDown(ImGuiKey_MouseLeft))
             {
@@ -311,10 +317,7 @@ namespace IWXMVM::GFX
             }
         }
 
-        IDirect3DDevice9* device = D3D9::GetDevice();
-        device->SetRenderState(D3DRS_ZENABLE, D3DZB_FALSE);
-        BufferManager::Get().DrawMesh(mesh, model, true);
-        device->SetRenderState(D3DRS_ZENABLE, D3DZB_TRUE);
+        batcher.Submit(mesh.index, DrawPass::Overlay, MakeInstanceData(model, true, color));
     }
 
     
@@ -346,13 +349,13 @@ namespace IWXMVM::GFX
         }
 
         const bool isHeld = heldAxis.has_value();
-        DrawGizmoComponent(gizmo_translate_x, scaledModel, 0);
+        DrawGizmoComponent(gizmo_translate, scaledModel, 0, D3DCOLOR_COLORVALUE(1, 0, 0, 1));
 
         auto rotatedY = glm::rotate(scaledModel, glm::radians(90.0f), glm::vec3(0, 0, 1));
-        DrawGizmoComponent(gizmo_translate_y, rotatedY, 1);
+        DrawGizmoComponent(gizmo_translate, rotatedY, 1, D3DCOLOR_COLORVALUE(0, 1, 0, 1));
 
         auto rotatedZ = glm::rotate(scaledModel, glm::radians(-90.0f), glm::vec3(0, 1, 0));
-        DrawGizmoComponent(gizmo_translate_z, rotatedZ, 2);
+        DrawGizmoComponent(gizmo_translate, rotatedZ, 2, D3DCOLOR_COLORVALUE(0, 0, 1, 1));
 
         if (heldAxis.has_value())
         {
@@ -415,12 +418,12 @@ namespace IWXMVM::GFX
         }
 
         auto rotatedX = glm::rotate(scaledModel, glm::radians(-90.0f), glm::vec3(0, 0, 1));
-        DrawGizmoComponent(gizmo_rotate_x, rotatedX, 0);
+        DrawGizmoComponent(gizmo_rotate, rotatedX, 0, D3DCOLOR_COLORVALUE(1, 0, 0, 1));
 
-        DrawGizmoComponent(gizmo_rotate_y, scaledModel, 2);
+        DrawGizmoComponent(gizmo_rotate, scaledModel, 2, D3DCOLOR_COLORVALUE(0, 1, 0, 1));
 
         auto rotatedZ = glm::rotate(scaledModel, glm::radians(90.0f), glm::vec3(1, 0, 0));
-        DrawGizmoComponent(gizmo_rotate_z, rotatedZ, 1);
+        DrawGizmoComponent(gizmo_rotate, rotatedZ, 1, D3DCOLOR_COLORVALUE(0, 0, 1, 1));
 
         if (heldAxis.has_value())
         {
@@ -444,106 +447,466 @@ namespace IWXMVM::GFX
         }
     }
 
-    void GraphicsManager::BuildCampathMesh()
+    constexpr auto CAMPATH_LINE_WIDTH = 5.0f;
+    constexpr auto CAMPATH_COLOR = D3DCOLOR_COLORVALUE(1, 0.8f, 0, 1);
+    constexpr std::size_t CAMPATH_VERTICES_PER_SAMPLE = 4;
+    constexpr std::size_t CAMPATH_INDICES_PER_SAMPLE = 24;
+
+    // Segments are subdivided until the tube strays less than this many pixels from the path and doesn't bend by more
+    // than the angle at any sample, unless the piece is too short on screen to tell
+    constexpr float CAMPATH_MAX_SCREEN_ERROR = 0.5f;
+    constexpr float CAMPATH_MAX_ANGLE = 0.14f;  // about 8 degrees
+    constexpr float CAMPATH_MIN_SCREEN_LENGTH = 4.0f;
+    // Samples are split evenly between the segments when the path would need more; along with the room segments get
+    // to grow, this keeps the campath well within the dynamic buffers as they are created. A segment needs at least its
+    // two ends, so the segments beyond half of this aren't drawn at all.
+    constexpr std::size_t CAMPATH_MAX_SAMPLES =
+        std::min(INITIAL_VERTEX_CAPACITY / CAMPATH_VERTICES_PER_SAMPLE,
+                 INITIAL_INDEX_CAPACITY / CAMPATH_INDICES_PER_SAMPLE) / 2;
+    // a segment is subdivided again once the camera got this much closer to it or further away from it
+    constexpr float CAMPATH_RESAMPLE_SCALE = 2.0f;
+
+    // Moving a node changes the cubic spline everywhere, but the change shrinks to about a quarter with every node it
+    // passes. While a node is being edited, only the segments this many nodes around it are rebuilt; the rest follow
+    // once the edit is done.
+    constexpr std::size_t CAMPATH_SPLINE_REACH = 4;
+
+    // How many pixels a unit of world space covers on screen, depending on where it is
+    struct CampathView
     {
-        constexpr auto lineWidth = 5.0f;
-        constexpr auto lineColor = D3DCOLOR_COLORVALUE(1, 0.8f, 0, 1);
+        glm::vec3 cameraPosition;
+        float pixelScale;  // pixels per unit at a distance of one unit
 
-        constexpr float samplesPerUnit = 0.05f;  // Changes how many models are placed inbetween each node
+        float GetPixelsPerUnit(glm::vec3 position, float radius = 0.0f) const
+        {
+            return pixelScale / std::max(glm::distance(cameraPosition, position) - radius, 1.0f);
+        }
+    };
 
-        auto& keyframeManager = Components::KeyframeManager::Get();
-        const auto& property = keyframeManager.GetProperty(Types::KeyframeablePropertyType::CampathCamera);
-        auto& nodes = keyframeManager.GetKeyframes(property);
+    struct CampathInterval
+    {
+        float t0, t1;
+        glm::vec3 p0, p1, midpoint;
+        float error;  // split while this is above 1
 
-        campath.vertices.clear();
-        campath.indices.clear();
+        bool operator<(const CampathInterval& other) const
+        {
+            return error < other.error;
+        }
+    };
 
-        for (std::size_t i = 0; i < nodes.size() - 1; i++)
+    // Subdivides the piece of path between t = 0 and t = 1 where it is needed most, until it looks smooth from where
+    // the camera is or maxSamples is reached
+    void SubdivideCampathSegment(std::vector<glm::vec3>& samples, std::size_t maxSamples, const CampathView& view,
+                                 const std::function<glm::vec3(float)>& samplePosition)
+    {
+        samples.clear();
+        if (maxSamples < 3)
         {
-            const auto distance =
-                glm::distance(nodes[i].value.cameraData.position, nodes[i + 1].value.cameraData.position);
-            for (float t = 0.0f; t <= 1.0f; t += 1.0f / (distance * samplesPerUnit))
+            if (maxSamples == 2)
+                samples = {samplePosition(0.0f), samplePosition(1.0f)};
+            return;
+        }
+
+        const auto makeInterval = [&](float t0, float t1, glm::vec3 p0, glm::vec3 p1) {
+            CampathInterval interval = {t0, t1, p0, p1, samplePosition((t0 + t1) * 0.5f), 0.0f};
+
+            const auto chord = p1 - p0;
+            const auto chordLength = glm::length(chord);
+            const auto deviation = chordLength > 0.0f
+                                       ? glm::length(glm::cross(interval.midpoint - p0, chord)) / chordLength
+                                       : glm::distance(interval.midpoint, p0);
+            const auto pixelsPerUnit = view.GetPixelsPerUnit(interval.midpoint);
+            interval.error = deviation * pixelsPerUnit / CAMPATH_MAX_SCREEN_ERROR;
+
+            const auto first = interval.midpoint - p0;
+            const auto second = p1 - interval.midpoint;
+            if (chordLength * pixelsPerUnit > CAMPATH_MIN_SCREEN_LENGTH && glm::length(first) > 0.0f &&
+                glm::length(second) > 0.0f)
             {
-                const float interpTick = nodes[i + 1].tick * t + nodes[i].tick * (1.0f - t);
-                const auto interpValue = keyframeManager.Get().Interpolate(property, interpTick);
-
-                campath.vertices.push_back(
-                    Types::Vertex{
-                        .pos = interpValue.cameraData.position - glm::vec3(lineWidth / 2, 0, 0),
-                        .normal = glm::vec3(0, 0, 1),
-                        .col = lineColor
-                    }
-                );
+                const auto cosAngle = glm::clamp(glm::dot(glm::normalize(first), glm::normalize(second)), -1.0f, 1.0f);
+                interval.error = std::max(interval.error, std::acos(cosAngle) / CAMPATH_MAX_ANGLE);
+            }
+            return interval;
+        };
 
-                campath.vertices.push_back(
-                    Types::Vertex{
-                        .pos = interpValue.cameraData.position + glm::vec3(lineWidth / 2, 0, 0),
-                        .normal = glm::vec3(0, 0, 1),
-                        .col = lineColor
-                    }
-                );
+        // start with two halves, so that an S-shaped segment isn't mistaken for a straight one
+        const auto start = samplePosition(0.0f);
+        const auto middle = samplePosition(0.5f);
+        const auto end = samplePosition(1.0f);
+        std::vector<CampathInterval> intervals = {makeInterval(0.0f, 0.5f, start, middle),
+                                                  makeInterval(0.5f, 1.0f, middle, end)};
+        std::make_heap(intervals.begin(), intervals.end());
 
-                campath.vertices.push_back(
-                    Types::Vertex{
-                        .pos = interpValue.cameraData.position - glm::vec3(0, 0, lineWidth / 4),
-                        .normal = glm::vec3(1, 1, 0),
-                        .col = lineColor
-                    }
-                );
+        while (intervals.size() + 1 < maxSamples && intervals.front().error > 1.0f)
+        {
+            std::pop_heap(intervals.begin(), intervals.end());
+            const auto interval = intervals.back();
+            intervals.pop_back();
+
+            const auto t = (interval.t0 + interval.t1) * 0.5f;
+            intervals.push_back(makeInterval(interval.t0, t, interval.p0, interval.midpoint));
+            std::push_heap(intervals.begin(), intervals.end());
+            intervals.push_back(makeInterval(t, interval.t1, interval.midpoint, interval.p1));
+            std::push_heap(intervals.begin(), intervals.end());
+        }
 
-                campath.vertices.push_back(
-                    Types::Vertex{
-                        .pos = interpValue.cameraData.position + glm::vec3(0, 0, lineWidth / 4),
-                        .normal = glm::vec3(1, 1, 0),
-                        .col = lineColor
-                    }
-                );
+        std::sort(intervals.begin(), intervals.end(),
+                  [](const auto& a, const auto& b) { return a.t0 < b.t0; });
+        for (const auto& interval : intervals)
+        {
+            samples.push_back(interval.p0);
+        }
+        samples.push_back(end);
+    }
 
-                if (campath.vertices.size() > 4)
+    void GraphicsManager::UpdateCampathMesh()
+    {
+        auto& keyframeManager = Components::KeyframeManager::Get();
+        const auto& property = keyframeManager.GetProperty(Types::KeyframeablePropertyType::CampathCamera);
+        const auto& nodes = keyframeManager.GetKeyframes(property);
+
+        // with fewer nodes Interpolate is linear, so a node only affects the two segments it bounds
+        const bool isCubic = nodes.size() >= 4;
+        const std::size_t reach = isCubic ? CAMPATH_SPLINE_REACH : 1;
+        const std::size_t segmentCount = nodes.size() > 1 ? nodes.size() - 1 : 0;
+        const std::size_t drawnSegmentCount = std::min(segmentCount, CAMPATH_MAX_SAMPLES / 2);
+        const std::size_t maxSegmentSamples = drawnSegmentCount > 0 ? CAMPATH_MAX_SAMPLES / drawnSegmentCount : 0;
+        const auto getSampleBudget = [&](std::size_t segment) {
+            return segment < drawnSegmentCount ? maxSegmentSamples : 0;
+        };
+
+        // the error is measured in pixels of the game view, since that is what the campath is drawn into
+        const auto& camera = Components::CameraManager::Get().GetActiveCamera();
+        const auto gameViewWidth = UI::UIManager::Get().GetUIComponent(UI::Component::GameView)->GetSize().x;
+        const CampathView view = {camera->GetPosition(),
+                                  gameViewWidth / (2.0f * glm::tan(glm::radians(camera->GetFov()) * 0.5f))};
+
+        // find the nodes that were moved, retimed, added or got different neighbours since the mesh was last built
+        std::vector<std::size_t> changedNodes;
+        const bool hasSameNodes =
+            nodes.size() == campathNodes.size() &&
+            std::equal(nodes.begin(), nodes.end(), campathNodes.begin(),
+                       [](const auto& node, const auto& previousNode) { return node.id == previousNode.id; });
+        if (hasSameNodes)
+        {
+            for (std::size_t i = 0; i < nodes.size(); i++)
+            {
+                if (nodes[i].tick != campathNodes[i].tick ||
+                    nodes[i].value.cameraData.position != campathNodes[i].position)
                 {
-                    // We create two perpendicular planes with the vertices like so:
-                    //    2
-                    // 0     1
-                    //    3
-                    // The next node would then have the vertices:
-                    //    6
-                    // 4     5
-                    //    7
-                    // and so on, which means we need these indices to create the triangles between the left/right vertices:
-                    // 0 1 4
-                    // 1 5 4
-                    // 0 4 1
-                    // 1 4 5
-                    // and these for the up/down vertices:
-                    // 2 3 6
-                    // 3 7 6
-                    // 2 6 3
-                    // 3 6 7
-
-                    std::vector<Types::Index> newIndices{
-                        0, 1, 4,
-                        1, 5, 4,
-                        0, 4, 1,
-                        1, 4, 5,
-                        2, 3, 6,
-                        3, 7, 6,
-                        2, 6, 3,
-                        3, 6, 7
-                    };
-
-                    for (auto& index : newIndices)
-                    {
-                        index = campath.vertices.size() - (8 - index);
-                    }
+                    changedNodes.push_back(i);
+                }
+            }
+        }
+        else
+        {
+            std::unordered_map<std::int32_t, std::size_t> previousIndices;
+            for (std::size_t i = 0; i < campathNodes.size(); i++)
+            {
+                previousIndices[campathNodes[i].id] = i;
+            }
 
-                    campath.indices.insert(campath.indices.end(), newIndices.begin(), newIndices.end());
+            for (std::size_t i = 0; i < nodes.size(); i++)
+            {
+                const auto it = previousIndices.find(nodes[i].id);
+                bool isSame = it != previousIndices.end();
+                if (isSame)
+                {
+                    const auto p = it->second;
+                    isSame = campathNodes[p].tick == nodes[i].tick &&
+                             campathNodes[p].position == nodes[i].value.cameraData.position;
+                    isSame = isSame && (i == 0 ? p == 0 : p > 0 && campathNodes[p - 1].id == nodes[i - 1].id);
+                    isSame = isSame && (i == nodes.size() - 1 ? p == campathNodes.size() - 1
+                                                              : p + 1 < campathNodes.size() &&
+                                                                    campathNodes[p + 1].id == nodes[i + 1].id);
                 }
+
+                if (!isSame)
+                {
+                    changedNodes.push_back(i);
+                }
+            }
+        }
+
+        const bool rebuildAll = !isCampathUploaded || isCubic != isCampathCubic;
+        const bool isEditing = heldAxis.has_value() || keyframeManager.AreKeyframesBeingModified();
+        const bool settle = changedNodes.empty() && !isCampathSettled && !isEditing;
+
+        // segments the camera got much closer to need more detail, the ones it moved away from less
+        bool isAnySegmentStale = false;
+        for (auto& segment : campathSegments)
+        {
+            const auto scale = view.GetPixelsPerUnit(segment.center, segment.radius) / segment.pixelsPerUnit;
+            if (scale > CAMPATH_RESAMPLE_SCALE || scale < 1.0f / CAMPATH_RESAMPLE_SCALE)
+            {
+                segment.isDirty = true;
+                isAnySegmentStale = true;
+            }
+        }
+
+        if (changedNodes.empty() && !rebuildAll && !settle && !isAnySegmentStale &&
+            segmentCount == campathSegments.size())
+        {
+            return;
+        }
+
+        // keep the segments between nodes that are still neighbours, wherever they are now
+        std::vector<CampathSegment> segments(segmentCount);
+        std::unordered_map<std::uint64_t, std::size_t> previousSegments;
+        if (!hasSameNodes)
+        {
+            for (std::size_t i = 0; i < campathSegments.size(); i++)
+            {
+                const auto& segment = campathSegments[i];
+                previousSegments[static_cast<std::uint64_t>(static_cast<std::uint32_t>(segment.startNodeId)) << 32 |
+                                 static_cast<std::uint32_t>(segment.endNodeId)] = i;
+            }
+        }
+
+        bool needsLayout = rebuildAll || !hasSameNodes;
+        for (std::size_t i = 0; i < segmentCount; i++)
+        {
+            std::optional<std::size_t> previousSegment;
+            if (hasSameNodes)
+            {
+                previousSegment = i;
+            }
+            else
+            {
+                const auto it = previousSegments.find(
+                    static_cast<std::uint64_t>(static_cast<std::uint32_t>(nodes[i].id)) << 32 |
+                    static_cast<std::uint32_t>(nodes[i + 1].id));
+                if (it != previousSegments.end())
+                    previousSegment = it->second;
+            }
+
+            if (previousSegment.has_value())
+            {
+                segments[i] = std::move(campathSegments[previousSegment.value()]);
+                // a segment moved out of or back into the budget is resampled as well
+                const auto sampleCount = segments[i].samples.size();
+                segments[i].isDirty |= rebuildAll || settle || sampleCount > getSampleBudget(i) ||
+                                       (sampleCount == 0 && getSampleBudget(i) > 0);
+            }
+            else
+            {
+                segments[i] = CampathSegment{nodes[i].id, nodes[i + 1].id, {}, {}, 0.0f, 0.0f, 0, 0, true};
+            }
+        }
+
+        for (const auto node : changedNodes)
+        {
+            const auto first = node >= reach ? node - reach : 0;
+            const auto last = std::min(node + reach, segmentCount);
+            for (std::size_t i = first; i < last; i++)
+            {
+                segments[i].isDirty = true;
+            }
+        }
+
+        // the spline is solved once here instead of once per sample, as Interpolate would
+        std::array<std::vector<float>, 3> secondDerivatives;
+        bool isSplineSolved = isCubic;
+        for (std::uint32_t axis = 0; axis < 3 && isSplineSolved; axis++)
+        {
+            isSplineSolved = MathUtils::SolveCubicSpline(nodes, axis, secondDerivatives[axis]);
+        }
+
+        for (std::size_t i = 0; i < segmentCount; i++)
+        {
+            auto& segment = segments[i];
+            if (!segment.isDirty)
+                continue;
+
+            const auto& start = nodes[i];
+            const auto& end = nodes[i + 1];
+            SubdivideCampathSegment(segment.samples, getSampleBudget(i), view, [&](float t) {
+                const float interpTick = end.tick * t + start.tick * (1.0f - t);
+                if (!isSplineSolved)
+                    return keyframeManager.Interpolate(property, interpTick).cameraData.position;
+
+                return glm::vec3(MathUtils::EvaluateCubicSpline(nodes, secondDerivatives[0], 0, i, interpTick),
+                                 MathUtils::EvaluateCubicSpline(nodes, secondDerivatives[1], 1, i, interpTick),
+                                 MathUtils::EvaluateCubicSpline(nodes, secondDerivatives[2], 2, i, interpTick));
+            });
+
+            glm::vec3 min = segment.samples.empty() ? start.value.cameraData.position : segment.samples.front();
+            glm::vec3 max = min;
+            for (const auto& sample : segment.samples)
+            {
+                min = glm::min(min, sample);
+                max = glm::max(max, sample);
+            }
+            segment.center = (min + max) * 0.5f;
+            segment.radius = glm::distance(min, max) * 0.5f;
+            segment.pixelsPerUnit = view.GetPixelsPerUnit(segment.center, segment.radius);
+
+            needsLayout |= segment.samples.size() > segment.sampleCapacity;
+        }
+
+        campathSegments = std::move(segments);
+        if (needsLayout)
+        {
+            LayoutCampathMesh();
+        }
+        else
+        {
+            // patch the dirty segments in place, everything else in the buffers stays as it is
+            for (const auto& segment : campathSegments)
+            {
+                if (!segment.isDirty)
+                    continue;
+
+                WriteCampathSegment(segment);
+                BufferManager::Get().UpdateMesh(
+                    campath, segment.firstSample * CAMPATH_VERTICES_PER_SAMPLE,
+                    segment.samples.size() * CAMPATH_VERTICES_PER_SAMPLE,
+                    segment.firstSample * CAMPATH_INDICES_PER_SAMPLE,
+                    segment.sampleCapacity * CAMPATH_INDICES_PER_SAMPLE);
+            }
+        }
+
+        for (auto& segment : campathSegments)
+        {
+            segment.isDirty = false;
+        }
+
+        campathNodes.resize(nodes.size());
+        for (std::size_t i = 0; i < nodes.size(); i++)
+        {
+            campathNodes[i] = CampathNode{nodes[i].id, nodes[i].tick, nodes[i].value.cameraData.position};
+        }
+
+        if (rebuildAll || settle)
+            isCampathSettled = true;
+        else if (isCubic && !changedNodes.empty())
+            isCampathSettled = false;
+
+        isCampathCubic = isCubic;
+        isCampathUploaded = true;
+    }
+
+    void GraphicsManager::LayoutCampathMesh()
+    {
+        const auto getRoomToGrow = [](const CampathSegment& segment) { return segment.samples.size() / 4 + 2; };
+
+        // segments only get room to grow as long as the path still fits into the buffers with it
+        std::size_t sampleCount = 0;
+        std::size_t roomToGrow = 0;
+        for (const auto& segment : campathSegments)
+        {
+            sampleCount += segment.samples.size();
+            roomToGrow += getRoomToGrow(segment);
+        }
+        const bool canGrow = sampleCount + roomToGrow <= CAMPATH_MAX_SAMPLES * 2;
+
+        sampleCount = 0;
+        for (auto& segment : campathSegments)
+        {
+            segment.firstSample = sampleCount;
+            segment.sampleCapacity = segment.samples.size() + (canGrow ? getRoomToGrow(segment) : 0);
+            sampleCount += segment.sampleCapacity;
+        }
+
+        campath.vertices.resize(sampleCount * CAMPATH_VERTICES_PER_SAMPLE);
+        campath.indices.resize(sampleCount * CAMPATH_INDICES_PER_SAMPLE);
+        for (const auto& segment : campathSegments)
+        {
+            WriteCampathSegment(segment);
+        }
+
+        BufferManager::Get().AddMesh(&campath, BufferType::Dynamic);
+    }
+
+    void GraphicsManager::WriteCampathSegment(const CampathSegment& segment)
+    {
+        auto vertex = campath.vertices.begin() + segment.firstSample * CAMPATH_VERTICES_PER_SAMPLE;
+        for (const auto& sample : segment.samples)
+        {
+            *vertex++ = Types::Vertex{
+                .pos = sample - glm::vec3(CAMPATH_LINE_WIDTH / 2, 0, 0),
+                .normal = glm::vec3(0, 0, 1),
+                .col = CAMPATH_COLOR
+            };
+            *vertex++ = Types::Vertex{
+                .pos = sample + glm::vec3(CAMPATH_LINE_WIDTH / 2, 0, 0),
+                .normal = glm::vec3(0, 0, 1),
+                .col = CAMPATH_COLOR
+            };
+            *vertex++ = Types::Vertex{
+                .pos = sample - glm::vec3(0, 0, CAMPATH_LINE_WIDTH / 4),
+                .normal = glm::vec3(1, 1, 0),
+                .col = CAMPATH_COLOR
+            };
+            *vertex++ = Types::Vertex{
+                .pos = sample + glm::vec3(0, 0, CAMPATH_LINE_WIDTH / 4),
+                .normal = glm::vec3(1, 1, 0),
+                .col = CAMPATH_COLOR
+            };
+        }
+
+        // We create two perpendicular planes with the vertices like so:
+        //    2
+        // 0     1
+        //    3
+        // The next sample would then have the vertices:
+        //    6
+        // 4     5
+        //    7
+        // and so on, which means we need these indices to create the triangles between the left/right vertices:
+        // 0 1 4
+        // 1 5 4
+        // 0 4 1
+        // 1 4 5
+        // and these for the up/down vertices:
+        // 2 3 6
+        // 3 7 6
+        // 2 6 3
+        // 3 6 7
+        constexpr std::array<Types::Index, CAMPATH_INDICES_PER_SAMPLE> sampleIndices{
+            0, 1, 4,
+            1, 5, 4,
+            0, 4, 1,
+            1, 4, 5,
+            2, 3, 6,
+            3, 7, 6,
+            2, 6, 3,
+            3, 6, 7
+        };
+
+        const auto firstVertex = static_cast<Types::Index>(segment.firstSample * CAMPATH_VERTICES_PER_SAMPLE);
+        auto index = campath.indices.begin() + segment.firstSample * CAMPATH_INDICES_PER_SAMPLE;
+        for (std::size_t i = 1; i < segment.samples.size(); i++)
+        {
+            const auto previousVertex = firstVertex + static_cast<Types::Index>((i - 1) * CAMPATH_VERTICES_PER_SAMPLE);
+            for (const auto sampleIndex : sampleIndices)
+            {
+                *index++ = previousVertex + sampleIndex;
             }
         }
+
+        // the rest of the segment's room is filled with degenerate triangles, which draw nothing
+        const auto end =
+            campath.indices.begin() + (segment.firstSample + segment.sampleCapacity) * CAMPATH_INDICES_PER_SAMPLE;
+        std::fill(index, end, firstVertex);
+    }
+
+    void GraphicsManager::DrawBatches(DrawPass pass) noexcept
+    {
+        const auto instances = batcher.GetInstances();
+        for (const auto& batch : batcher.GetBatches(pass))
+        {
+            BufferManager::Get().DrawInstances(batch.meshIndex,
+                                               instances.subspan(batch.firstInstance, batch.instanceCount));
+        }
     }
 
+    constexpr float NODE_PICK_RADIUS = 20.0f;
+
     void GraphicsManager::Render()
     {
+        IWXMVM_PROFILE_ZONE("GraphicsManager::Render");
         if (ImGui::GetMainViewport()->Size.x == 0.0f || ImGui::GetMainViewport()->Size.y == 0.0f)
         {
             return;
@@ -570,11 +933,13 @@ namespace IWXMVM::GFX
 
         SetupRenderState();
 
-        BufferManager::Get().BindBuffers(BufferType::Static);
-
         objectHoveredThisFrame = false;
+        batcher.Clear();
+        bool drawCampath = false;
 
         const auto& activeCam = Components::CameraManager::Get().GetActiveCamera();
+        mouseRay = Ray{activeCam->GetPosition(),
+                       GetMouseRay(ImGui::GetIO().MousePos, GetProjectionMatrix(), GetViewMatrix())};
         const auto currentCameraMode = activeCam->GetMode();
         if (currentCameraMode == Components::Camera::Mode::Bone)
         {
@@ -588,7 +953,8 @@ namespace IWXMVM::GFX
 
                 const auto translate = glm::translate(boneData.position);
                 const auto scale = glm::scale(glm::vec3(1, 1, 1) * 1.1f);
-                BufferManager::Get().DrawMesh(axis, translate * glm::mat4x4(boneData.rotation) * scale, true);
+                batcher.Submit(axis.index, DrawPass::Scene,
+                               MakeInstanceData(translate * glm::mat4x4(boneData.rotation) * scale, true));
             }
         }
 
@@ -603,29 +969,38 @@ namespace IWXMVM::GFX
                 const auto translate = glm::translate(orbitCam->GetOrigin());
                 const auto scale = glm::scale(glm::vec3(1, 1, 1) * glm::distance(activeCam->GetPosition(), orbitCam->GetOrigin()) / 45.0f);
 
-                device->SetRenderState(D3DRS_ZENABLE, D3DZB_FALSE); // Disable depth test
-                BufferManager::Get().DrawMesh(axis, translate * scale);
-                device->SetRenderState(D3DRS_ZENABLE, D3DZB_TRUE);
+                batcher.Submit(axis.index, DrawPass::Overlay, MakeInstanceData(translate * scale, false));
             }
 
             auto& keyframeManager = Components::KeyframeManager::Get();
             const auto& property = keyframeManager.GetProperty(Types::KeyframeablePropertyType::CampathCamera);
             auto& nodes = keyframeManager.GetKeyframes(property);
 
+            // only the node closest to the camera is hovered when several are under the mouse
+            nodePositions.resize(nodes.size());
+            for (std::size_t i = 0; i < nodes.size(); i++)
+            {
+                nodePositions[i] = nodes[i].value.cameraData.position;
+            }
+            nodeBvh.Update(nodePositions, NODE_PICK_RADIUS);
+            const auto hoveredNode = nodeBvh.Intersect(mouseRay);
+
             // Iterate through all nodes and draw the camera model
-            for (auto& node : nodes)
+            for (std::size_t i = 0; i < nodes.size(); i++)
             {
+                auto& node = nodes[i];
                 const auto translate = glm::translate(node.value.cameraData.position);
                 const auto rotate = glm::eulerAngleZYX(glm::radians(node.value.cameraData.rotation.y),
                                                        glm::radians(node.value.cameraData.rotation.x),
                                                        glm::radians(node.value.cameraData.rotation.z));
                 auto scale = glm::scale(glm::vec3(1, 1, 1));
                 
-                bool mouseIntersects = MouseIntersectsSphereAt(ImGui::GetIO().MousePos, node.value.cameraData.position, 20);
+                bool mouseIntersects = hoveredNode == i;
                 objectHoveredThisFrame |= mouseIntersects;
                 if (mouseIntersects && !heldAxis.has_value())
                    scale = glm::scale(glm::vec3(1, 1, 1) * 1.1f);
-                BufferManager::Get().DrawMesh(camera, translate * rotate * scale, mouseIntersects);
+                batcher.Submit(camera.index, DrawPass::Scene,
+                               MakeInstanceData(translate * rotate * scale, mouseIntersects));
 
                 if (mouseIntersects && Input::KeyDown(ImGuiKey_MouseLeft) && selectedNodeId != node.id)
                 {
@@ -655,19 +1030,31 @@ namespace IWXMVM::GFX
                 }
             }
 
-            // Drawing the path
             if (!nodes.empty())
             {
-                BuildCampathMesh();
-
-                BufferManager::Get().ClearDynamicBuffers();
-                BufferManager::Get().AddMesh(&campath, BufferType::Dynamic);
-                BufferManager::Get().BindBuffers(BufferType::Dynamic);
-                
-                BufferManager::Get().DrawMesh(campath, glm::identity<glm::mat4>(), true);
+                UpdateCampathMesh();
+                drawCampath = !campath.indices.empty();
             }
         }
 
+        // one instanced call per mesh and pass, however many nodes there are
+        batcher.Build();
+
+        BufferManager::Get().BindBuffers(BufferType::Static);
+        DrawBatches(DrawPass::Scene);
+
+        // Drawing the path
+        if (drawCampath)
+        {
+            BufferManager::Get().BindBuffers(BufferType::Dynamic);
+            BufferManager::Get().DrawMesh(campath, glm::identity<glm::mat4>(), true);
+            BufferManager::Get().BindBuffers(BufferType::Static);
+        }
+
+        device->SetRenderState(D3DRS_ZENABLE, D3DZB_FALSE);  // Disable depth test
+        DrawBatches(DrawPass::Overlay);
+        device->SetRenderState(D3DRS_ZENABLE, D3DZB_TRUE);
+
         // Restore the DX9 transform
         device->SetTransform(D3DTS_WORLD, &last_world);
         device->SetTransform(D3DTS_VIEW, &last_view);
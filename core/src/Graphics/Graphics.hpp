@@ -1,7 +1,10 @@
 #pragma once
 #include "StdInclude.hpp"
 
+#include "Graphics/Bvh.hpp"
+#include "Graphics/DrawBatch.hpp"
 #include "Graphics/Resource.hpp"
+#include "Graphics/ShaderCache.hpp"
 #include "Resources.hpp"
 #include "Types/Keyframe.hpp"
 
@@ -27,6 +30,27 @@ namespace IWXMVM::GFX
         glm::vec3 objectOffset{};
     };
 
+    // What the campath mesh was last built from, to tell which nodes changed since
+    struct CampathNode
+    {
+        std::int32_t id;
+        std::uint32_t tick;
+        glm::vec3 position;
+    };
+
+    // The part of the campath mesh between two neighbouring nodes, rebuilt only when a change reaches it
+    struct CampathSegment
+    {
+        std::int32_t startNodeId, endNodeId;
+        std::vector<glm::vec3> samples;
+        glm::vec3 center;
+        float radius;                // center and radius bound the samples
+        float pixelsPerUnit;         // how close the camera was to the segment when it was subdivided
+        std::size_t firstSample;     // where the segment starts in the campath mesh
+        std::size_t sampleCapacity;  // room to grow, so that most edits don't move the segments after it
+        bool isDirty;
+    };
+
     class GraphicsManager
     {
        public:
@@ -61,40 +85,48 @@ namespace IWXMVM::GFX
             : axis(AXIS_MODEL_data, AXIS_MODEL_size),
               camera(CAMERA_MODEL_data, CAMERA_MODEL_size),
               icosphere(ICOSPHERE_MODEL_data, ICOSPHERE_MODEL_size),
-              gizmo_translate_x(GIZMO_TRANSLATE_MODEL_data, GIZMO_TRANSLATE_MODEL_size),
-              gizmo_translate_y(GIZMO_TRANSLATE_MODEL_data, GIZMO_TRANSLATE_MODEL_size),
-              gizmo_translate_z(GIZMO_TRANSLATE_MODEL_data, GIZMO_TRANSLATE_MODEL_size),
-              gizmo_rotate_x(GIZMO_ROTATE_MODEL_data, GIZMO_ROTATE_MODEL_size),
-              gizmo_rotate_y(GIZMO_ROTATE_MODEL_data, GIZMO_ROTATE_MODEL_size),
-              gizmo_rotate_z(GIZMO_ROTATE_MODEL_data, GIZMO_ROTATE_MODEL_size),
+              gizmo_translate(GIZMO_TRANSLATE_MODEL_data, GIZMO_TRANSLATE_MODEL_size),
+              gizmo_rotate(GIZMO_ROTATE_MODEL_data, GIZMO_ROTATE_MODEL_size),
               campath()
         {
         }
 
-        bool MouseIntersects(ImVec2 mousePos, Mesh& mesh, glm::mat4 model);
-        bool MouseIntersectsSphereAt(ImVec2 mousePos, glm::vec3 pos, float radius);
-        void DrawGizmoComponent(Mesh& mesh, glm::mat4 model, int32_t axisIndex);
+        bool MouseIntersects(const Mesh& mesh, const glm::mat4& model) const;
+        void DrawGizmoComponent(const Mesh& mesh, glm::mat4 model, int32_t axisIndex, D3DCOLOR color);
         void DrawTranslationGizmo(glm::vec3& position, glm::mat4 translation, glm::mat4 rotation);
         void DrawRotationGizmo(glm::vec3& rotation, glm::mat4 translation);
 
-        void BuildCampathMesh();
+        void UpdateCampathMesh();
+        void LayoutCampathMesh();
+        void WriteCampathSegment(const CampathSegment& segment);
+        const ShaderCache::Bytecode* GetShaderBytecode(const uint8_t source[], uint32_t size, const char* profile);
         void SetupRenderState() const noexcept;
+        void DrawBatches(DrawPass pass) noexcept;
 
         IDirect3DPixelShader9* pixelShader = nullptr;
         IDirect3DVertexShader9* vertexShader = nullptr;
         IDirect3DVertexDeclaration9* vertexDeclaration = nullptr;
+        ShaderCache shaderCache;  // outlives the device, so resets don't compile the shaders again
 
         Mesh axis;
         Mesh camera;
         Mesh icosphere;
-        Mesh gizmo_translate_x;
-        Mesh gizmo_translate_y;
-        Mesh gizmo_translate_z;
-        Mesh gizmo_rotate_x;
-        Mesh gizmo_rotate_y;
-        Mesh gizmo_rotate_z;
+        Mesh gizmo_translate;  // white, tinted per axis when drawn
+        Mesh gizmo_rotate;
         Mesh campath;
 
+        DrawBatcher batcher;  // the static meshes drawn this frame, drawn instanced once everything was submitted
+
+        std::vector<CampathNode> campathNodes;
+        std::vector<CampathSegment> campathSegments;
+        bool isCampathUploaded = false;
+        bool isCampathCubic = false;
+        bool isCampathSettled = true;  // false while the segments a change doesn't reach may be a little off
+
+        Ray mouseRay = {};  // from the camera through the mouse, updated every frame
+        SphereBvh nodeBvh;
+        std::vector<glm::vec3> nodePositions;
+
         std::optional<int32_t> selectedNodeId = std::nullopt;
         std::optional<TranslationGizmoData> heldAxis = std::nullopt;
         bool objectHoveredThisFrame = false;
@@ -0,0 +1,60 @@
+#include "MeshBlob.hpp"
+
+#include <cstring>
+
+namespace IWXMVM::GFX
+{
+    namespace
+    {
+        constexpr std::uint32_t MESH_BLOB_MAGIC = 0x4D585749;  // "IWXM"
+        constexpr std::uint32_t MESH_BLOB_VERSION = 1;
+
+        struct MeshBlobHeader
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t vertexCount;
+            std::uint32_t indexCount;
+        };
+    }  // namespace
+
+    std::optional<MeshBlob> ParseMeshBlob(std::span<const std::uint8_t> data)
+    {
+        MeshBlobHeader header = {};
+        if (data.size() < sizeof(header))
+        {
+            return std::nullopt;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        const auto vertexByteSize = static_cast<std::size_t>(header.vertexCount) * sizeof(BakedVertex);
+        const auto indexByteSize = static_cast<std::size_t>(header.indexCount) * sizeof(std::uint32_t);
+        if (header.magic != MESH_BLOB_MAGIC || header.version != MESH_BLOB_VERSION ||
+            data.size() != sizeof(header) + vertexByteSize + indexByteSize)
+        {
+            return std::nullopt;
+        }
+
+        return MeshBlob{data.subspan(sizeof(header), vertexByteSize),
+                        data.subspan(sizeof(header) + vertexByteSize, indexByteSize)};
+    }
+
+    std::vector<std::uint8_t> WriteMeshBlob(std::span<const BakedVertex> vertices,
+                                            std::span<const std::uint32_t> indices)
+    {
+        const MeshBlobHeader header = {MESH_BLOB_MAGIC, MESH_BLOB_VERSION, static_cast<std::uint32_t>(vertices.size()),
+                                       static_cast<std::uint32_t>(indices.size())};
+
+        std::vector<std::uint8_t> data(sizeof(header) + vertices.size_bytes() + indices.size_bytes());
+        std::memcpy(data.data(), &header, sizeof(header));
+        if (!vertices.empty())
+        {
+            std::memcpy(data.data() + sizeof(header), vertices.data(), vertices.size_bytes());
+        }
+        if (!indices.empty())
+        {
+            std::memcpy(data.data() + sizeof(header) + vertices.size_bytes(), indices.data(), indices.size_bytes());
+        }
+        return data;
+    }
+}  // namespace IWXMVM::GFX
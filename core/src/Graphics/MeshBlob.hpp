@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace IWXMVM::GFX
+{
+    // Laid out like Types::Vertex, which can't be used here without D3D9 and glm
+    struct BakedVertex
+    {
+        float position[3];
+        float normal[3];
+        std::uint32_t color;  // D3DCOLOR
+    };
+    static_assert(sizeof(BakedVertex) == 28);
+
+    // A mesh as the mesh baker writes it at build time: a header followed by the vertices and the indices, so that it
+    // can be copied into a mesh as it is instead of parsing the model it was made from.
+    struct MeshBlob
+    {
+        std::span<const std::uint8_t> vertexBytes;
+        std::span<const std::uint8_t> indexBytes;
+
+        std::size_t GetVertexCount() const
+        {
+            return vertexBytes.size() / sizeof(BakedVertex);
+        }
+
+        std::size_t GetIndexCount() const
+        {
+            return indexBytes.size() / sizeof(std::uint32_t);
+        }
+    };
+
+    // nothing if the data is not a mesh blob of this version or is cut short
+    std::optional<MeshBlob> ParseMeshBlob(std::span<const std::uint8_t> data);
+    std::vector<std::uint8_t> WriteMeshBlob(std::span<const BakedVertex> vertices,
+                                            std::span<const std::uint32_t> indices);
+}  // namespace IWXMVM::GFX
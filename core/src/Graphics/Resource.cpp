@@ -3,96 +3,50 @@
 #include "Graphics/Resource.hpp"
 
 #include "D3D9.hpp"
+#include "Graphics/MeshBlob.hpp"
 #include "Types/Vertex.hpp"
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
-
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
-
-namespace std
-{
-    template <>
-    struct hash<IWXMVM::Types::Vertex>
-    {
-        size_t operator()(IWXMVM::Types::Vertex const& vertex) const
-        {
-            return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.normal) << 1)) >> 1) ^
-                   (hash<D3DCOLOR>()(vertex.col) << 1);
-        }
-    };
-}  // namespace std
-
 namespace IWXMVM::GFX
 {
-    constexpr std::size_t MAX_VERTICES = 50000;
-    constexpr std::size_t MAX_INDICES = MAX_VERTICES * 5;
+    static_assert(sizeof(Types::Vertex) == sizeof(BakedVertex) &&
+                      offsetof(Types::Vertex, normal) == offsetof(BakedVertex, normal) &&
+                      offsetof(Types::Vertex, col) == offsetof(BakedVertex, color),
+                  "Baked vertices have to be laid out like the ones that are drawn");
 
     Mesh::Mesh(const uint8_t data[], uint32_t size)
     {
-        std::string_view dataStringView(reinterpret_cast<const char*>(data), size);
-        std::string dataString(dataStringView);
-
-        tinyobj::ObjReader reader;
-
-        if (!reader.ParseFromString(dataString, ""))
+        // the models were turned into blobs by the mesh baker when building, so they only have to be copied here
+        const auto blob = ParseMeshBlob(std::span(data, size));
+        if (!blob.has_value())
         {
-            if (!reader.Error().empty())
-            {
-                LOG_ERROR("TinyObjReader: {}", reader.Error());
-            }
+            LOG_ERROR("Embedded mesh is not a mesh blob of this version");
             return;
         }
 
-        if (!reader.Warning().empty())
-        {
-            LOG_WARN("TinyObjReader: {}", reader.Warning());
-        }
+        vertices.resize(blob->GetVertexCount());
+        std::memcpy(vertices.data(), blob->vertexBytes.data(), blob->vertexBytes.size());
+        indices.resize(blob->GetIndexCount());
+        std::memcpy(indices.data(), blob->indexBytes.data(), blob->indexBytes.size());
 
-        auto& attrib = reader.GetAttrib();
-        auto& shapes = reader.GetShapes();
-
-        vertices.reserve(attrib.vertices.size() / 3);
+        bvh.Build(vertices, indices);
+    }
 
-        // Loop over shapes
-        std::unordered_map<Types::Vertex, std::uint32_t> uniqueVertices;
-        for (const auto& shape : shapes)
-        {
-            for (const auto& index : shape.mesh.indices)
-            {
-                Types::Vertex vertex = {};
-                vertex.pos = {
-                    attrib.vertices[index.vertex_index * 3 + 0],
-                    attrib.vertices[index.vertex_index * 3 + 1],
-                    attrib.vertices[index.vertex_index * 3 + 2],
-                };
-                vertex.normal = {
-                    attrib.normals[index.normal_index * 3 + 0],
-                    attrib.normals[index.normal_index * 3 + 1],
-                    attrib.normals[index.normal_index * 3 + 2],
-                };
-                vertex.col = D3DCOLOR_COLORVALUE(attrib.colors[index.vertex_index * 3 + 0],
-                                                 attrib.colors[index.vertex_index * 3 + 1],
-                                                 attrib.colors[index.vertex_index * 3 + 2], 1.0f);
-                
-                if (uniqueVertices.count(vertex) == 0)
-                {
-                    uniqueVertices[vertex] = static_cast<std::uint32_t>(vertices.size());
-                    vertices.push_back(vertex);
-                }
-
-                indices.push_back(uniqueVertices[vertex]);
-            }
-        }
+    InstanceData MakeInstanceData(const glm::mat4& model, bool ignoreLighting, D3DCOLOR color)
+    {
+        InstanceData instance = {};
+        std::memcpy(instance.model.data(), glm::value_ptr(model), sizeof(instance.model));
+        instance.color = color;
+        instance.ignoreLighting = ignoreLighting ? 1.0f : 0.0f;
+        return instance;
     }
 
     void BufferManager::Initialize()
     {
-        staticIndexBuffer.Initialize(false);
-        staticVertexBuffer.Initialize(false);
-        dynamicIndexBuffer.Initialize(true);
-        dynamicVertexBuffer.Initialize(true);
+        staticIndexBuffer.Initialize(BufferType::Static, INITIAL_INDEX_CAPACITY);
+        staticVertexBuffer.Initialize(BufferType::Static, INITIAL_VERTEX_CAPACITY);
+        dynamicIndexBuffer.Initialize(BufferType::Dynamic, INITIAL_INDEX_CAPACITY);
+        dynamicVertexBuffer.Initialize(BufferType::Dynamic, INITIAL_VERTEX_CAPACITY);
+        instanceBuffer.Initialize(BufferType::Dynamic, INITIAL_INSTANCE_CAPACITY);
     }
 
     void BufferManager::Uninitialize()
@@ -101,340 +55,328 @@ namespace IWXMVM::GFX
         staticVertexBuffer.Release();
         dynamicIndexBuffer.Release();
         dynamicVertexBuffer.Release();
+        instanceBuffer.Release();
         meshCount = 0;
     }
 
     void BufferManager::AddMesh(Mesh* mesh, BufferType bufferType)
     {
-        auto& vertexBuffer = bufferType == BufferType::Static ? staticVertexBuffer : dynamicVertexBuffer;
-        auto& indexBuffer = bufferType == BufferType::Static ? staticIndexBuffer : dynamicIndexBuffer;
-
-        MeshMetadata metadata = {
-            .ptr = mesh,
-            .indexBufferOffset = indexBuffer.GetElementCount(),
-            .vertexBufferOffset = vertexBuffer.GetElementCount()
-        };
-        indexBuffer.Add(mesh->indices);
-        vertexBuffer.Add(mesh->vertices);
-
-        if (bufferType == BufferType::Dynamic && mesh->index != 0)
+        // a dynamic mesh that is added again keeps its index
+        const bool isAdded = bufferType == BufferType::Dynamic && mesh->index != 0 && mesh->index < meshCount &&
+                             meshes[mesh->index].ptr == mesh;
+        if (!isAdded)
         {
-            meshes[mesh->index] = metadata;
-            return;
+            if (meshCount == MAX_MESHES)
+            {
+                LOG_ERROR("Cannot add more than {} meshes", MAX_MESHES);
+                return;
+            }
+            mesh->index = meshCount++;
         }
 
-        meshes[meshCount++] = metadata;
-
-        // meshCount is always strictly greater than 0 here so this is safe
-        mesh->index = meshCount - 1;
-    }
-
-    void BufferManager::DrawMesh(const Mesh& mesh, const glm::mat4& model, bool ignoreLighting) const noexcept
-    {
-        IDirect3DDevice9* device = D3D9::GetDevice();
-
-        HRESULT result = D3D_OK;
-
-        device->SetVertexShaderConstantF(4, reinterpret_cast<const float*>(&model), 4);
-        device->SetPixelShaderConstantB(0, reinterpret_cast<BOOL*>(&ignoreLighting), 1);
-
-        result = device->DrawIndexedPrimitive(
-            D3DPT_TRIANGLELIST, meshes[mesh.index].vertexBufferOffset, 0, static_cast<UINT>(mesh.indices.size()),
-            meshes[mesh.index].indexBufferOffset, static_cast<UINT>(mesh.indices.size() / 3));
-
-        if (FAILED(result))
+        auto& metadata = meshes[mesh->index];
+        metadata = MeshMetadata{.ptr = mesh, .bufferType = bufferType};
+        if (!TryUpload(metadata))
         {
-            LOG_WARN("Failed to issue draw mesh with index {}", mesh.index);
+            Repack(bufferType);
         }
     }
 
-    void BufferManager::BindBuffers(BufferType bufferType) const noexcept
+    bool BufferManager::TryUpload(MeshMetadata& metadata) noexcept
     {
-        IDirect3DDevice9* device = D3D9::GetDevice();
-
-        auto vertexBufferHandle =
-            bufferType == BufferType::Static ? staticVertexBuffer.GetHandle() : dynamicVertexBuffer.GetHandle();
-
-        HRESULT result = device->SetStreamSource(0, vertexBufferHandle, 0, sizeof(Types::Vertex));
-        if (FAILED(result))
+        auto& vertexBuffer = GetVertexBuffer(metadata.bufferType);
+        auto& indexBuffer = GetIndexBuffer(metadata.bufferType);
+        if (!vertexBuffer.HasRoomFor(metadata.ptr->vertices.size()) ||
+            !indexBuffer.HasRoomFor(metadata.ptr->indices.size()))
         {
-            LOG_WARN("Failed to bind vertex buffer");
+            return false;
         }
 
-        auto indexBufferHandle =
-            bufferType == BufferType::Static ? staticIndexBuffer.GetHandle() : dynamicIndexBuffer.GetHandle();
-
-        result = device->SetIndices(indexBufferHandle);
-        if (FAILED(result))
+        const auto vertexBufferOffset = vertexBuffer.Append(metadata.ptr->vertices);
+        const auto indexBufferOffset = indexBuffer.Append(metadata.ptr->indices);
+        if (!vertexBufferOffset.has_value() || !indexBufferOffset.has_value())
         {
-            LOG_WARN("Failed to bind index buffer");
+            return false;
         }
-    }
 
-    void BufferManager::ClearBuffers() noexcept
-    {
-        staticVertexBuffer.Clear();
-        staticIndexBuffer.Clear();
-        dynamicVertexBuffer.Clear();
-        dynamicIndexBuffer.Clear();
-        meshCount = 0;
-    }
-
-    void BufferManager::ClearDynamicBuffers() noexcept
-    {
-        dynamicVertexBuffer.Clear();
-        dynamicIndexBuffer.Clear();
+        metadata.vertexBufferOffset = vertexBufferOffset.value();
+        metadata.indexBufferOffset = indexBufferOffset.value();
+        return true;
     }
 
-    void BufferManager::IndexBuffer::Initialize(bool map)
+    void BufferManager::Repack(BufferType bufferType) noexcept
     {
-        IDirect3DDevice9* device = D3D9::GetDevice();
-        constexpr std::size_t byteSize = MAX_INDICES * sizeof(Types::Index);
+        std::size_t vertexCount = 0;
+        std::size_t indexCount = 0;
+        for (std::size_t i = 0; i < meshCount; i++)
+        {
+            if (meshes[i].ptr != nullptr && meshes[i].bufferType == bufferType)
+            {
+                vertexCount += meshes[i].ptr->vertices.size();
+                indexCount += meshes[i].ptr->indices.size();
+            }
+        }
 
-        HRESULT result = device->CreateIndexBuffer(static_cast<UINT>(byteSize), D3DUSAGE_WRITEONLY, D3DFMT_INDEX32,
-                                           D3DPOOL_DEFAULT, &handle, nullptr);
-        if (FAILED(result))
+        // start over with only the meshes that are still in use, in bigger buffers if they don't fit otherwise
+        auto& vertexBuffer = GetVertexBuffer(bufferType);
+        auto& indexBuffer = GetIndexBuffer(bufferType);
+        if (vertexCount <= vertexBuffer.GetStatistics().capacity || !vertexBuffer.Grow(vertexCount))
         {
-            throw std::runtime_error("Failed to create index buffer");
+            vertexBuffer.Restart();
+        }
+        if (indexCount <= indexBuffer.GetStatistics().capacity || !indexBuffer.Grow(indexCount))
+        {
+            indexBuffer.Restart();
         }
 
-        if (map)
+        for (std::size_t i = 0; i < meshCount; i++)
         {
-            void* tmp = nullptr;
-            result = handle->Lock(0, static_cast<UINT>(byteSize), &tmp, 0);
-            if (FAILED(result))
+            if (meshes[i].ptr != nullptr && meshes[i].bufferType == bufferType && !TryUpload(meshes[i]))
             {
-                throw std::runtime_error("Failed to lock index buffer");
+                LOG_ERROR("Failed to upload mesh with index {}", i);
             }
-
-            data = tmp;
         }
     }
 
-    void BufferManager::IndexBuffer::Release()
+    void BufferManager::UpdateMesh(const Mesh& mesh, std::size_t firstVertex, std::size_t vertexCount,
+                                   std::size_t firstIndex, std::size_t indexCount) noexcept
     {
-        if (data.has_value())
-        {
-            data.reset();
-            handle->Unlock();
-        }
+        const auto& metadata = meshes[mesh.index];
+        dynamicVertexBuffer.Write(metadata.vertexBufferOffset + firstVertex,
+                                  std::span(mesh.vertices).subspan(firstVertex, vertexCount));
+        dynamicIndexBuffer.Write(metadata.indexBufferOffset + firstIndex,
+                                 std::span(mesh.indices).subspan(firstIndex, indexCount));
+    }
 
-        if (handle != nullptr)
-        {
-            handle->Release();
-            handle = nullptr;
-        }
+    void BufferManager::DrawMesh(const Mesh& mesh, const glm::mat4& model, bool ignoreLighting) noexcept
+    {
+        const auto instance = MakeInstanceData(model, ignoreLighting);
+        DrawInstances(mesh.index, std::span(&instance, 1));
     }
 
-    void BufferManager::IndexBuffer::Add(std::span<Types::Index> elems)
+    void BufferManager::DrawInstances(std::size_t meshIndex, std::span<const InstanceData> instances) noexcept
     {
-        if (elems.empty())
+        if (instances.empty())
         {
             return;
         }
 
-        const std::size_t totalBufferByteSize = MAX_INDICES * sizeof(elems[0]);
-        const std::size_t bufferByteSize = elemCount * sizeof(elems[0]);
-        const std::size_t elemsByteSize = elems.size() * sizeof(elems[0]);
+        if (!instanceBuffer.HasRoomFor(instances.size()))
+        {
+            if (instances.size() <= instanceBuffer.GetStatistics().capacity || !instanceBuffer.Grow(instances.size()))
+            {
+                instanceBuffer.Restart();
+            }
+        }
 
-        if (bufferByteSize + elemsByteSize > totalBufferByteSize)
+        const auto firstInstance = instanceBuffer.Append(instances);
+        if (!firstInstance.has_value())
         {
-            LOG_WARN("D3D9 index buffer will overflow, ignoring 'Add' call");
+            LOG_WARN("Failed to upload instances for mesh with index {}", meshIndex);
             return;
         }
 
-        const bool mapped = data.has_value();
-        if (!mapped)
-        {
-            void* tmp = nullptr;
-            HRESULT result = handle->Lock(bufferByteSize, static_cast<UINT>(elemsByteSize), &tmp, 0);
-            if (FAILED(result))
-            {
-                throw std::runtime_error("Failed to lock index buffer");
-            }
+        IDirect3DDevice9* device = D3D9::GetDevice();
+        device->SetStreamSource(1, instanceBuffer.GetHandle(),
+                                static_cast<UINT>(firstInstance.value() * sizeof(InstanceData)), sizeof(InstanceData));
+        device->SetStreamSourceFreq(0, D3DSTREAMSOURCE_INDEXEDDATA | static_cast<UINT>(instances.size()));
+        device->SetStreamSourceFreq(1, D3DSTREAMSOURCE_INSTANCEDATA | 1);
 
-            std::memcpy(tmp, elems.data(), static_cast<UINT>(elemsByteSize));
+        const auto& metadata = meshes[meshIndex];
+        const auto indexCount = static_cast<UINT>(metadata.ptr->indices.size());
+        HRESULT result =
+            device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, static_cast<INT>(metadata.vertexBufferOffset), 0,
+                                         indexCount, static_cast<UINT>(metadata.indexBufferOffset), indexCount / 3);
 
-            handle->Unlock();
-        }
-        else
+        // the game draws without instancing
+        device->SetStreamSourceFreq(0, 1);
+        device->SetStreamSourceFreq(1, 1);
+
+        if (FAILED(result))
         {
-            std::memcpy(reinterpret_cast<std::uint8_t*>(data.value()) + bufferByteSize, elems.data(),
-                        static_cast<UINT>(elemsByteSize));
+            LOG_WARN("Failed to issue draw mesh with index {}", meshIndex);
         }
-
-        elemCount += elems.size();
     }
 
-    void BufferManager::IndexBuffer::Overwrite(std::span<Types::Index> elems)
+    void BufferManager::BindBuffers(BufferType bufferType) const noexcept
     {
-        if (elems.empty())
-        {
-            return;
-        }
+        IDirect3DDevice9* device = D3D9::GetDevice();
 
-        const std::size_t totalBufferByteSize = MAX_INDICES * sizeof(elems[0]);
-        const std::size_t elemsByteSize = elems.size() * sizeof(elems[0]);
+        auto vertexBufferHandle =
+            bufferType == BufferType::Static ? staticVertexBuffer.GetHandle() : dynamicVertexBuffer.GetHandle();
 
-        if (elemsByteSize > totalBufferByteSize)
+        HRESULT result = device->SetStreamSource(0, vertexBufferHandle, 0, sizeof(Types::Vertex));
+        if (FAILED(result))
         {
-            LOG_WARN("D3D9 index buffer will overflow, ignoring 'Overwrite' call");
-            return;
+            LOG_WARN("Failed to bind vertex buffer");
         }
 
-        const bool mapped = data.has_value();
-        if (!mapped)
-        {
-            void* tmp = nullptr;
-            HRESULT result = handle->Lock(0, static_cast<UINT>(elemsByteSize), &tmp, 0);
-            if (FAILED(result))
-            {
-                throw std::runtime_error("Failed to lock index buffer");
-            }
+        auto indexBufferHandle =
+            bufferType == BufferType::Static ? staticIndexBuffer.GetHandle() : dynamicIndexBuffer.GetHandle();
 
-            data = tmp;
+        result = device->SetIndices(indexBufferHandle);
+        if (FAILED(result))
+        {
+            LOG_WARN("Failed to bind index buffer");
         }
+    }
 
-        std::memcpy(data.value(), elems.data(), static_cast<UINT>(elemsByteSize));
+    void BufferManager::ClearBuffers() noexcept
+    {
+        staticVertexBuffer.Restart();
+        staticIndexBuffer.Restart();
+        dynamicVertexBuffer.Restart();
+        dynamicIndexBuffer.Restart();
+        meshCount = 0;
+    }
 
-        if (!mapped)
+    template <typename T>
+    void BufferManager::DeviceBuffer<T>::Initialize(BufferType type, std::size_t capacity)
+    {
+        bufferType = type;
+        handle = Create(capacity);
+        if (handle == nullptr)
         {
-            data.reset();
-            handle->Unlock();
+            throw std::runtime_error("Failed to create buffer");
         }
 
-        elemCount += elems.size();
+        statistics = BufferStatistics{.capacity = capacity};
+        isDiscardPending = false;
     }
 
-    void BufferManager::IndexBuffer::Clear() noexcept
+    template <typename T>
+    void BufferManager::DeviceBuffer<T>::Release() noexcept
     {
-        elemCount = 0;
+        if (handle != nullptr)
+        {
+            handle->Release();
+            handle = nullptr;
+        }
     }
 
-    void BufferManager::VertexBuffer::Initialize(bool map)
+    template <typename T>
+    typename BufferManager::DeviceBuffer<T>::Handle* BufferManager::DeviceBuffer<T>::Create(
+        std::size_t capacity) const noexcept
     {
         IDirect3DDevice9* device = D3D9::GetDevice();
-        constexpr std::size_t byteSize = MAX_VERTICES * sizeof(Types::Vertex);
+        const auto byteSize = static_cast<UINT>(capacity * sizeof(T));
+        const DWORD usage =
+            bufferType == BufferType::Dynamic ? D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY : D3DUSAGE_WRITEONLY;
 
+        Handle* buffer = nullptr;
         HRESULT result = D3D_OK;
-        result = device->CreateVertexBuffer(static_cast<UINT>(byteSize), D3DUSAGE_WRITEONLY,
-                                            D3DFVF_XYZ | D3DFVF_DIFFUSE, D3DPOOL_DEFAULT, &handle, nullptr);
-
-        if (FAILED(result))
-        {
-            throw std::runtime_error("Failed to create vertex buffer");
-        }
-
-        if (map)
+        if constexpr (std::is_same_v<T, Types::Index>)
         {
-            void* tmp = nullptr;
-            result = handle->Lock(0, static_cast<UINT>(byteSize), &tmp, 0);
-            if (FAILED(result))
-            {
-                throw std::runtime_error("Failed to lock vertex buffer");
-            }
-
-            data = tmp;
+            result = device->CreateIndexBuffer(byteSize, usage, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &buffer, nullptr);
         }
-    }
-
-    void BufferManager::VertexBuffer::Release()
-    {
-        if (data.has_value())
+        else
         {
-            data.reset();
-            handle->Unlock();
+            result = device->CreateVertexBuffer(byteSize, usage, 0, D3DPOOL_DEFAULT, &buffer, nullptr);
         }
 
-        if (handle != nullptr)
+        if (FAILED(result))
         {
-            handle->Release();
-            handle = nullptr;
+            return nullptr;
         }
+        return buffer;
     }
 
-    void BufferManager::VertexBuffer::Add(std::span<Types::Vertex> elems)
+    template <typename T>
+    std::optional<std::size_t> BufferManager::DeviceBuffer<T>::Append(std::span<const T> elems) noexcept
     {
+        const auto offset = statistics.used;
         if (elems.empty())
         {
-            return;
+            return offset;
         }
 
-        constexpr std::size_t totalBufferByteSize = MAX_VERTICES * sizeof(elems[0]);
-        const std::size_t bufferByteSize = elemCount * sizeof(elems[0]);
-        const std::size_t elemsByteSize = elems.size() * sizeof(elems[0]);
-
-        if (bufferByteSize + elemsByteSize > totalBufferByteSize)
+        if (!HasRoomFor(elems.size()))
         {
-            LOG_WARN("D3D9 vertex buffer will overflow, ignoring 'Add' call");
-            return;
+            return std::nullopt;
         }
 
-        const bool mapped = data.has_value();
-        if (!mapped)
+        DWORD lockFlags = 0;
+        if (bufferType == BufferType::Dynamic)
         {
-            void* tmp = nullptr;
-            HRESULT result = handle->Lock(bufferByteSize, static_cast<UINT>(elemsByteSize), &tmp, 0);
-            if (FAILED(result))
-            {
-                throw std::runtime_error("Failed to lock index buffer");
-            }
-
-            std::memcpy(tmp, elems.data(), static_cast<UINT>(elemsByteSize));
-
-            handle->Unlock();
+            lockFlags = isDiscardPending ? D3DLOCK_DISCARD : D3DLOCK_NOOVERWRITE;
         }
-        else
+
+        void* data = nullptr;
+        HRESULT result = handle->Lock(static_cast<UINT>(offset * sizeof(T)), static_cast<UINT>(elems.size_bytes()),
+                                      &data, lockFlags);
+        if (FAILED(result))
         {
-            std::memcpy(reinterpret_cast<std::uint8_t*>(data.value()) + bufferByteSize, elems.data(),
-                        static_cast<UINT>(elemsByteSize));
+            LOG_WARN("Failed to lock buffer");
+            return std::nullopt;
         }
+        std::memcpy(data, elems.data(), elems.size_bytes());
+        handle->Unlock();
 
-        elemCount += elems.size();
+        isDiscardPending = false;
+        statistics.used += elems.size();
+        statistics.highWaterMark = std::max(statistics.highWaterMark, statistics.used);
+        return offset;
     }
 
-    void BufferManager::VertexBuffer::Overwrite(std::span<Types::Vertex> elems)
+    template <typename T>
+    void BufferManager::DeviceBuffer<T>::Write(std::size_t offset, std::span<const T> elems) noexcept
     {
         if (elems.empty())
         {
             return;
         }
 
-        constexpr std::size_t totalBufferByteSize = MAX_VERTICES * sizeof(elems[0]);
-        const std::size_t elemsByteSize = elems.size() * sizeof(elems[0]);
-
-        if (elemsByteSize > totalBufferByteSize)
+        // only what was appended before can be written to
+        if (offset + elems.size() > statistics.used)
         {
-            LOG_WARN("D3D9 vertex buffer will overflow, ignoring 'Overwrite' call");
+            LOG_WARN("Buffer write is out of range, ignoring 'Write' call");
             return;
         }
 
-        const bool mapped = data.has_value();
-        if (!mapped)
+        // the elements may still be read by a frame the gpu hasn't finished, so unlike Append this can't promise
+        // NOOVERWRITE and locks without flags, which waits for the gpu if it has to
+        void* data = nullptr;
+        HRESULT result =
+            handle->Lock(static_cast<UINT>(offset * sizeof(T)), static_cast<UINT>(elems.size_bytes()), &data, 0);
+        if (FAILED(result))
         {
-            void* tmp = nullptr;
-            HRESULT result = handle->Lock(0, static_cast<UINT>(elemsByteSize), &tmp, 0);
-            if (FAILED(result))
-            {
-                throw std::runtime_error("Failed to lock vertex buffer");
-            }
-
-            data = tmp;
+            LOG_WARN("Failed to lock buffer");
+            return;
         }
+        std::memcpy(data, elems.data(), elems.size_bytes());
+        handle->Unlock();
+    }
 
-        std::memcpy(data.value(), elems.data(), static_cast<UINT>(elemsByteSize));
-
-        if (!mapped)
+    template <typename T>
+    void BufferManager::DeviceBuffer<T>::Restart() noexcept
+    {
+        if (bufferType == BufferType::Dynamic && statistics.used > 0)
         {
-            data.reset();
-            handle->Unlock();
+            isDiscardPending = true;
+            statistics.discardCount++;
         }
-
-        elemCount = elems.size();
+        statistics.used = 0;
     }
 
-    void BufferManager::VertexBuffer::Clear() noexcept
+    template <typename T>
+    bool BufferManager::DeviceBuffer<T>::Grow(std::size_t capacity) noexcept
     {
-        elemCount = 0;
+        // grow geometrically, so that a path that keeps getting longer doesn't reallocate every time
+        capacity = std::max(capacity, statistics.capacity * 2);
+
+        auto* buffer = Create(capacity);
+        if (buffer == nullptr)
+        {
+            LOG_ERROR("Failed to grow buffer to {} elements", capacity);
+            return false;
+        }
+
+        Release();
+        handle = buffer;
+        statistics.capacity = capacity;
+        statistics.used = 0;
+        statistics.growCount++;
+        isDiscardPending = false;
+        return true;
     }
 }  // namespace IWXMVM::GFX
\ No newline at end of file
@@ -1,21 +1,28 @@
 #pragma once
 #include "StdInclude.hpp"
 
+#include "Graphics/Bvh.hpp"
+#include "Graphics/DrawBatch.hpp"
 #include "Types/Vertex.hpp"
 
 namespace IWXMVM::GFX
 {
     inline constexpr std::size_t MAX_MESHES = 100;
+    // What the buffers are created with. They grow when more has to fit, so these only need to cover the usual case.
+    inline constexpr std::size_t INITIAL_VERTEX_CAPACITY = 50000;
+    inline constexpr std::size_t INITIAL_INDEX_CAPACITY = INITIAL_VERTEX_CAPACITY * 5;
+    inline constexpr std::size_t INITIAL_INSTANCE_CAPACITY = 4096;
 
     struct Mesh
     {
-        Mesh(const uint8_t data[], uint32_t size);  // For use with incbin
+        Mesh(const uint8_t data[], uint32_t size);  // For mesh blobs embedded with incbin
         Mesh(){};
 
         std::vector<Types::Index> indices;
         std::vector<Types::Vertex> vertices;
         std::size_t index = 0; // Unique index returned by the buffer manager
         DWORD fillMode = D3DFILL_SOLID;
+        MeshBvh bvh;  // for picking, only built for meshes loaded from models
     };
 
     enum class BufferType
@@ -23,6 +30,18 @@ namespace IWXMVM::GFX
         Static, Dynamic
     };
 
+    struct BufferStatistics
+    {
+        std::size_t capacity = 0;        // in elements
+        std::size_t used = 0;            // elements written since the buffer last started over
+        std::size_t highWaterMark = 0;   // the most elements that were ever used at once
+        std::uint32_t discardCount = 0;  // times a dynamic buffer wrapped around
+        std::uint32_t growCount = 0;     // times the buffer was reallocated because something didn't fit
+    };
+
+    InstanceData MakeInstanceData(const glm::mat4& model, bool ignoreLighting,
+                                  D3DCOLOR color = D3DCOLOR_COLORVALUE(1, 1, 1, 1));
+
     class BufferManager
     {
        public:
@@ -38,78 +57,111 @@ namespace IWXMVM::GFX
         void Initialize();
         void Uninitialize();
 
+        // Meshes that don't fit are never dropped: dynamic buffers wrap around and copy what they hold to their front,
+        // and buffers that are too small are reallocated. Adding a dynamic mesh again moves it to new space.
         void AddMesh(Mesh* mesh, BufferType bufferType = BufferType::Static);
-        void DrawMesh(const Mesh& mesh, const glm::mat4& model, bool ignoreLighting = false) const noexcept;
+        // copies ranges of a dynamic mesh that was changed in place to where the mesh is in the buffers
+        void UpdateMesh(const Mesh& mesh, std::size_t firstVertex, std::size_t vertexCount, std::size_t firstIndex,
+                        std::size_t indexCount) noexcept;
+        void DrawMesh(const Mesh& mesh, const glm::mat4& model, bool ignoreLighting = false) noexcept;
+        // draws the mesh once per instance with a single call, from whichever buffers are bound
+        void DrawInstances(std::size_t meshIndex, std::span<const InstanceData> instances) noexcept;
         void BindBuffers(BufferType bufferType) const noexcept;
         void ClearBuffers() noexcept;
-        void ClearDynamicBuffers() noexcept;
+
+        const BufferStatistics& GetVertexStatistics(BufferType bufferType) const noexcept
+        {
+            return bufferType == BufferType::Static ? staticVertexBuffer.GetStatistics()
+                                                    : dynamicVertexBuffer.GetStatistics();
+        }
+
+        const BufferStatistics& GetIndexStatistics(BufferType bufferType) const noexcept
+        {
+            return bufferType == BufferType::Static ? staticIndexBuffer.GetStatistics()
+                                                    : dynamicIndexBuffer.GetStatistics();
+        }
+
+        const BufferStatistics& GetInstanceStatistics() const noexcept
+        {
+            return instanceBuffer.GetStatistics();
+        }
 
        private:
         BufferManager()
         {
         }
 
-        class IndexBuffer
+        // Elements are appended front to back. A static buffer is locked without flags; a dynamic one is appended to
+        // with NOOVERWRITE and discarded when it starts over, so appending never has to wait for the gpu.
+        template <typename T>
+        class DeviceBuffer
         {
            public:
-            void Initialize(bool map);
-            void Release();
-            void Add(std::span<Types::Index> elems);
-            void Overwrite(std::span<Types::Index> elems);
-            void Clear() noexcept;
+            using Handle =
+                std::conditional_t<std::is_same_v<T, Types::Index>, IDirect3DIndexBuffer9, IDirect3DVertexBuffer9>;
 
-            IDirect3DIndexBuffer9* GetHandle() const noexcept
-            {
-                return handle;
-            }
+            void Initialize(BufferType bufferType, std::size_t capacity);
+            void Release() noexcept;
 
-            std::size_t GetElementCount() const noexcept
+            bool HasRoomFor(std::size_t count) const noexcept
             {
-                return elemCount;
+                return statistics.used + count <= statistics.capacity;
             }
 
-           private:
-            IDirect3DIndexBuffer9* handle = nullptr;
-            std::size_t elemCount = 0;
-            std::optional<void*> data;  // has value while the buffer is mapped to cpu accessible memory
-        };
+            // where the elements start in the buffer, nothing if they don't fit or the buffer couldn't be locked
+            std::optional<std::size_t> Append(std::span<const T> elems) noexcept;
+            // overwrites elements that were appended before, waiting for the gpu to be done with them
+            void Write(std::size_t offset, std::span<const T> elems) noexcept;
+            // the next append goes to the front again, everything appended so far has to be appended again
+            void Restart() noexcept;
+            // reallocates the buffer with room for at least capacity elements, which loses what it held
+            bool Grow(std::size_t capacity) noexcept;
 
-        class VertexBuffer
-        {
-           public:
-            void Initialize(bool map);
-            void Release();
-            void Add(std::span<Types::Vertex> elems);
-            void Overwrite(std::span<Types::Vertex> elems);
-            void Clear() noexcept;
-
-            IDirect3DVertexBuffer9* GetHandle() const noexcept
+            Handle* GetHandle() const noexcept
             {
                 return handle;
             }
 
-            std::size_t GetElementCount() const noexcept
+            const BufferStatistics& GetStatistics() const noexcept
             {
-                return elemCount;
+                return statistics;
             }
 
            private:
-            IDirect3DVertexBuffer9* handle = nullptr;
-            std::size_t elemCount = 0;
-            std::optional<void*> data;  // has value while the buffer is mapped to cpu accessible memory
+            Handle* Create(std::size_t capacity) const noexcept;
+
+            Handle* handle = nullptr;
+            BufferType bufferType = BufferType::Static;
+            bool isDiscardPending = false;
+            BufferStatistics statistics;
         };
 
         struct MeshMetadata
         {
             Mesh* ptr = nullptr;
+            BufferType bufferType = BufferType::Static;
             std::size_t indexBufferOffset = 0;
             std::size_t vertexBufferOffset = 0;
         };
 
-        IndexBuffer staticIndexBuffer;
-        VertexBuffer staticVertexBuffer;
-        IndexBuffer dynamicIndexBuffer;
-        VertexBuffer dynamicVertexBuffer;
+        DeviceBuffer<Types::Vertex>& GetVertexBuffer(BufferType bufferType) noexcept
+        {
+            return bufferType == BufferType::Static ? staticVertexBuffer : dynamicVertexBuffer;
+        }
+
+        DeviceBuffer<Types::Index>& GetIndexBuffer(BufferType bufferType) noexcept
+        {
+            return bufferType == BufferType::Static ? staticIndexBuffer : dynamicIndexBuffer;
+        }
+
+        bool TryUpload(MeshMetadata& metadata) noexcept;
+        void Repack(BufferType bufferType) noexcept;
+
+        DeviceBuffer<Types::Index> staticIndexBuffer;
+        DeviceBuffer<Types::Vertex> staticVertexBuffer;
+        DeviceBuffer<Types::Index> dynamicIndexBuffer;
+        DeviceBuffer<Types::Vertex> dynamicVertexBuffer;
+        DeviceBuffer<InstanceData> instanceBuffer;  // the instances of recent draws, discarded once full
         std::array<MeshMetadata, MAX_MESHES> meshes;
         std::size_t meshCount = 0;
     };
@@ -0,0 +1,173 @@
+#include "ShaderCache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+namespace IWXMVM::GFX
+{
+    namespace
+    {
+        constexpr std::uint32_t CACHE_FILE_MAGIC = 0x53585749;  // "IWXS"
+        constexpr std::uint32_t CACHE_FILE_VERSION = 1;
+
+        // stored in front of the bytecode, so that files from other versions or that were cut short are not loaded
+        struct CacheFileHeader
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint64_t keyHash;
+            std::uint64_t size;
+            std::uint64_t checksum;
+        };
+
+        constexpr std::uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325;
+        constexpr std::uint64_t FNV_PRIME = 0x100000001B3;
+
+        std::uint64_t Hash(std::uint64_t hash, const void* data, std::size_t size)
+        {
+            const auto* bytes = static_cast<const std::uint8_t*>(data);
+            for (std::size_t i = 0; i < size; i++)
+            {
+                hash = (hash ^ bytes[i]) * FNV_PRIME;
+            }
+            return hash;
+        }
+
+        // the length goes in first, so that moving characters from one string to the next changes the hash
+        std::uint64_t Hash(std::uint64_t hash, std::string_view text)
+        {
+            const std::uint64_t length = text.size();
+            hash = Hash(hash, &length, sizeof(length));
+            return Hash(hash, text.data(), text.size());
+        }
+    }  // namespace
+
+    std::uint64_t HashShaderKey(const ShaderKey& key)
+    {
+        auto hash = Hash(FNV_OFFSET_BASIS, &CACHE_FILE_VERSION, sizeof(CACHE_FILE_VERSION));
+        hash = Hash(hash, key.source);
+        hash = Hash(hash, key.entryPoint);
+        hash = Hash(hash, key.profile);
+        hash = Hash(hash, &key.flags, sizeof(key.flags));
+        return Hash(hash, &key.compilerVersion, sizeof(key.compilerVersion));
+    }
+
+    void ShaderCache::SetDirectory(std::filesystem::path cacheDirectory)
+    {
+        directory = std::move(cacheDirectory);
+    }
+
+    const ShaderCache::Bytecode* ShaderCache::GetOrCompile(const ShaderKey& key, const Compiler& compile)
+    {
+        const auto hash = HashShaderKey(key);
+        if (const auto it = entries.find(hash); it != entries.end())
+        {
+            statistics.memoryHits++;
+            return &it->second;
+        }
+
+        if (auto bytecode = Load(hash); bytecode.has_value())
+        {
+            statistics.diskHits++;
+            return &entries.emplace(hash, std::move(bytecode.value())).first->second;
+        }
+
+        auto bytecode = compile();
+        if (!bytecode.has_value() || bytecode->empty())
+        {
+            return nullptr;
+        }
+
+        statistics.compiles++;
+        if (!Store(hash, bytecode.value()))
+        {
+            statistics.failedWrites++;
+        }
+        return &entries.emplace(hash, std::move(bytecode.value())).first->second;
+    }
+
+    std::filesystem::path ShaderCache::GetFilePath(std::uint64_t hash) const
+    {
+        char fileName[32];
+        std::snprintf(fileName, sizeof(fileName), "%016llX.cso", static_cast<unsigned long long>(hash));
+        return directory / fileName;
+    }
+
+    std::optional<ShaderCache::Bytecode> ShaderCache::Load(std::uint64_t hash) const
+    {
+        if (directory.empty())
+        {
+            return std::nullopt;
+        }
+
+        std::ifstream file(GetFilePath(hash), std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            return std::nullopt;
+        }
+
+        const auto fileSize = static_cast<std::streamoff>(file.tellg());
+        file.seekg(0);
+        if (fileSize < static_cast<std::streamoff>(sizeof(CacheFileHeader)))
+        {
+            return std::nullopt;
+        }
+
+        // the size has to be what follows the header in the file before anything is allocated for it, since a damaged
+        // size could ask for more than the game's 32-bit address space has
+        CacheFileHeader header = {};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CACHE_FILE_MAGIC ||
+            header.version != CACHE_FILE_VERSION || header.keyHash != hash || header.size == 0 ||
+            header.size != static_cast<std::uint64_t>(fileSize) - sizeof(header))
+        {
+            return std::nullopt;
+        }
+
+        Bytecode bytecode(static_cast<std::size_t>(header.size));
+        if (!file.read(reinterpret_cast<char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size())) ||
+            Hash(FNV_OFFSET_BASIS, bytecode.data(), bytecode.size()) != header.checksum)
+        {
+            return std::nullopt;
+        }
+
+        return bytecode;
+    }
+
+    bool ShaderCache::Store(std::uint64_t hash, const Bytecode& bytecode) const
+    {
+        if (directory.empty())
+        {
+            return true;
+        }
+
+        std::error_code errorCode;
+        std::filesystem::create_directories(directory, errorCode);
+
+        // written next to where it goes and renamed, so that a game that is closed halfway never leaves half a file
+        const auto path = GetFilePath(hash);
+        auto temporaryPath = path;
+        temporaryPath += ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            const CacheFileHeader header = {CACHE_FILE_MAGIC, CACHE_FILE_VERSION, hash, bytecode.size(),
+                                            Hash(FNV_OFFSET_BASIS, bytecode.data(), bytecode.size())};
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+            if (!file.flush())
+            {
+                file.close();
+                std::filesystem::remove(temporaryPath, errorCode);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, path, errorCode);
+        if (errorCode)
+        {
+            std::filesystem::remove(temporaryPath, errorCode);
+            return false;
+        }
+        return true;
+    }
+}  // namespace IWXMVM::GFX
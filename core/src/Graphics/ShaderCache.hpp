@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace IWXMVM::GFX
+{
+    // Everything that decides what the compiler makes of a shader
+    struct ShaderKey
+    {
+        std::string_view source;
+        std::string_view entryPoint;
+        std::string_view profile;
+        std::uint32_t flags;
+        std::uint32_t compilerVersion;
+    };
+
+    std::uint64_t HashShaderKey(const ShaderKey& key);
+
+    // Keeps compiled shader bytecode in memory for the session and in a directory across sessions, so that a shader is
+    // only compiled again when its source, the compiler flags or the compiler change. Nothing here touches the device.
+    class ShaderCache
+    {
+       public:
+        using Bytecode = std::vector<std::uint8_t>;
+        using Compiler = std::function<std::optional<Bytecode>()>;
+
+        struct Statistics
+        {
+            std::uint32_t memoryHits = 0;
+            std::uint32_t diskHits = 0;
+            std::uint32_t compiles = 0;
+            std::uint32_t failedWrites = 0;  // compiled shaders that couldn't be saved, and are compiled again next run
+        };
+
+        // empty to only keep shaders in memory
+        void SetDirectory(std::filesystem::path cacheDirectory);
+
+        // The bytecode for the key from memory or disk, or what compile returns for it, which is cached then. Stays
+        // valid as long as the cache does.
+        const Bytecode* GetOrCompile(const ShaderKey& key, const Compiler& compile);
+
+        const Statistics& GetStatistics() const
+        {
+            return statistics;
+        }
+
+       private:
+        std::filesystem::path GetFilePath(std::uint64_t hash) const;
+        std::optional<Bytecode> Load(std::uint64_t hash) const;
+        bool Store(std::uint64_t hash, const Bytecode& bytecode) const;
+
+        std::filesystem::path directory;
+        std::unordered_map<std::uint64_t, Bytecode> entries;
+        Statistics statistics;
+    };
+}  // namespace IWXMVM::GFX
@@ -1,27 +1,193 @@
 #include "StdInclude.hpp"
 #include "Logger.hpp"
 
+#include <charconv>
+#include <deque>
+#include <future>
+#include <mutex>
+
 namespace IWXMVM
 {
     constexpr auto LOGGER_NAME = "IWXMVM";
     constexpr auto LOG_FILE = "IWXMVM.log";
+    constexpr auto LOG_PATTERN = "[%d.%m.%C %H:%M:%S] [%n] [%^%l%$] %v";
+
+    // messages are formatted on the calling thread and written by a single logging thread. The queue is allocated up
+    // front, and when it is full the oldest messages are dropped, so that logging never makes a frame wait on the disk.
+    constexpr std::size_t LOG_QUEUE_SIZE = 4096;
+    constexpr auto LOG_FLUSH_INTERVAL = std::chrono::seconds(1);
+    // like any message, the one a flush waits for is dropped when the queue overflows, and is then only taken care of
+    // along with the next one
+    constexpr auto LOG_FLUSH_TIMEOUT = std::chrono::seconds(1);
+
+    constexpr auto DEFAULT_LOG_LEVEL = IWXMVM_LOG_DEBUG_ENABLED ? spdlog::level::debug : spdlog::level::info;
+
+    namespace
+    {
+        // Runs actions on the logging thread once what was logged before them has been written. Every action is
+        // queued along with a message carrying its number; when that message comes up, the action runs along with any
+        // before it whose message was dropped.
+        class ActionSink : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+        {
+           public:
+            void Post(spdlog::logger& logger, std::function<void()> action)
+            {
+                // the messages have to be queued in the order of their numbers
+                std::lock_guard postLock(postMutex);
+                std::uint64_t number;
+                {
+                    std::lock_guard lock(actionMutex);
+                    number = ++lastNumber;
+                    actions.emplace_back(number, std::move(action));
+                }
+                logger.log(spdlog::level::info, "{}", number);
+            }
+
+           protected:
+            void sink_it_(const spdlog::details::log_msg& message) override
+            {
+                std::uint64_t number = 0;
+                std::from_chars(message.payload.data(), message.payload.data() + message.payload.size(), number);
+
+                std::vector<std::function<void()>> dueActions;
+                {
+                    std::lock_guard lock(actionMutex);
+                    while (!actions.empty() && actions.front().first <= number)
+                    {
+                        dueActions.push_back(std::move(actions.front().second));
+                        actions.pop_front();
+                    }
+                }
+                for (const auto& action : dueActions)
+                {
+                    action();
+                }
+            }
+
+            void flush_() override
+            {
+            }
+
+           private:
+            std::mutex postMutex;
+            std::mutex actionMutex;
+            std::uint64_t lastNumber = 0;
+            std::deque<std::pair<std::uint64_t, std::function<void()>>> actions;
+        };
+
+        std::shared_ptr<ActionSink> actionSink;
+        // shares the queue and the thread with the internal logger, but waits for room instead of dropping messages
+        std::shared_ptr<spdlog::logger> actionLogger;
+    }  // namespace
 
+    std::shared_ptr<spdlog::details::thread_pool> Logger::threadPool;
     std::shared_ptr<spdlog::logger> Logger::internalLogger;
+    std::shared_ptr<spdlog::sinks::dist_sink_mt> Logger::attachedSinks;
+    std::array<std::atomic<spdlog::level::level_enum>, static_cast<std::size_t>(LogCategory::Count)>
+        Logger::categoryLevels;
 
     void Logger::Initialize()
     {
+        for (auto& level : categoryLevels)
+        {
+            level.store(DEFAULT_LOG_LEVEL, std::memory_order_relaxed);
+        }
+
         std::vector<spdlog::sink_ptr> sinks;
         sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>(spdlog::color_mode::always));
         sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(LOG_FILE, (size_t)5e6, 1));
-        internalLogger = std::make_shared<spdlog::logger>(LOGGER_NAME, sinks.begin(), sinks.end());
-        internalLogger->set_pattern("[%d.%m.%C %H:%M:%S] [%n] [%^%l%$] %v");
-        internalLogger->flush_on(spdlog::level::trace);
-        internalLogger->set_level(spdlog::level::debug);
+        attachedSinks = std::make_shared<spdlog::sinks::dist_sink_mt>();
+        sinks.push_back(attachedSinks);
+
+        threadPool = std::make_shared<spdlog::details::thread_pool>(LOG_QUEUE_SIZE, 1);
+        internalLogger = std::make_shared<spdlog::async_logger>(LOGGER_NAME, sinks.begin(), sinks.end(), threadPool,
+                                                                spdlog::async_overflow_policy::overrun_oldest);
+        internalLogger->set_pattern(LOG_PATTERN);
+        // the categories decide what is logged, before anything is formatted
+        internalLogger->set_level(spdlog::level::trace);
+        internalLogger->flush_on(spdlog::level::warn);
+        spdlog::register_logger(internalLogger);
+
+        actionSink = std::make_shared<ActionSink>();
+        actionLogger = std::make_shared<spdlog::async_logger>(std::string(LOGGER_NAME) + " actions", actionSink,
+                                                              threadPool, spdlog::async_overflow_policy::block);
+        actionLogger->set_level(spdlog::level::trace);
+        spdlog::flush_every(LOG_FLUSH_INTERVAL);
         LOG_INFO("Initialized Logger");
     }
 
+    void Logger::Shutdown()
+    {
+        Flush();
+        for (auto& level : categoryLevels)
+        {
+            level.store(spdlog::level::off, std::memory_order_relaxed);
+        }
+
+        // joins the flushing thread, and the logging thread with the last reference to the pool
+        spdlog::shutdown();
+        actionLogger.reset();
+        actionSink.reset();
+        threadPool.reset();
+    }
+
     std::shared_ptr<spdlog::logger> Logger::GetInternalLogger()
     {
         return internalLogger;
     }
-}  // namespace IWXMVM
\ No newline at end of file
+
+    spdlog::level::level_enum Logger::GetCategoryLevel(LogCategory category)
+    {
+        return categoryLevels[static_cast<std::size_t>(category)].load(std::memory_order_relaxed);
+    }
+
+    void Logger::SetCategoryLevel(LogCategory category, spdlog::level::level_enum level)
+    {
+        categoryLevels[static_cast<std::size_t>(category)].store(level, std::memory_order_relaxed);
+    }
+
+    void Logger::Flush()
+    {
+        if (!threadPool)
+            return;
+
+        // the promise outlives the wait, in case the action only runs after it timed out
+        auto flushed = std::make_shared<std::promise<void>>();
+        auto future = flushed->get_future();
+        RunOnLoggingThread([flushed]() {
+            for (const auto& sink : internalLogger->sinks())
+            {
+                sink->flush();
+            }
+            flushed->set_value();
+        });
+        future.wait_for(LOG_FLUSH_TIMEOUT);
+    }
+
+    void Logger::RunOnLoggingThread(std::function<void()> action)
+    {
+        actionSink->Post(*actionLogger, std::move(action));
+    }
+
+    void Logger::AttachSink(spdlog::sink_ptr sink)
+    {
+        sink->set_pattern(LOG_PATTERN);
+        attachedSinks->add_sink(std::move(sink));
+    }
+
+    void Logger::DetachSink(spdlog::sink_ptr sink)
+    {
+        if (!threadPool)
+        {
+            attachedSinks->remove_sink(sink);
+            return;
+        }
+
+        // the sink still gets what was logged while it was attached, but is waiting in the queue, so it is removed by
+        // the logging thread once that was written
+        RunOnLoggingThread([sink]() {
+            attachedSinks->remove_sink(sink);
+            sink->flush();
+        });
+    }
+}  // namespace IWXMVM
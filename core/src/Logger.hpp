@@ -2,26 +2,93 @@
 
 #pragma warning(push, 0)
 #include "spdlog/spdlog.h"
+#include "spdlog/async.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/sinks/rotating_file_sink.h"
+#include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/dist_sink.h"
 #pragma warning(pop)
 
-#define LOG_INFO(...) Logger::GetInternalLogger()->info(__VA_ARGS__)
-#define LOG_WARN(...) Logger::GetInternalLogger()->warn(__VA_ARGS__)
-#define LOG_DEBUG(...) Logger::GetInternalLogger()->debug(__VA_ARGS__)
-#define LOG_ERROR(...) Logger::GetInternalLogger()->error(__VA_ARGS__)
-#define LOG_CRITICAL(...) Logger::GetInternalLogger()->critical(__VA_ARGS__)
+// debug messages are compiled out of release builds, unless this is defined as 1
+#ifndef IWXMVM_LOG_DEBUG_ENABLED
+#ifdef NDEBUG
+#define IWXMVM_LOG_DEBUG_ENABLED 0
+#else
+#define IWXMVM_LOG_DEBUG_ENABLED 1
+#endif
+#endif
+
+// the arguments are only evaluated and formatted when the category logs messages of that level
+#define IWXMVM_LOG(category, level, ...)                                          \
+    do                                                                            \
+    {                                                                             \
+        if (::IWXMVM::Logger::ShouldLog(category, level))                         \
+            ::IWXMVM::Logger::GetInternalLogger()->log(level, __VA_ARGS__);       \
+    } while (false)
+#define IWXMVM_LOG_DEBUG(category, ...)                                           \
+    do                                                                            \
+    {                                                                             \
+        if constexpr (IWXMVM_LOG_DEBUG_ENABLED)                                   \
+            IWXMVM_LOG(category, ::spdlog::level::debug, __VA_ARGS__);            \
+    } while (false)
+
+#define LOG_INFO(...) IWXMVM_LOG(::IWXMVM::LogCategory::General, ::spdlog::level::info, __VA_ARGS__)
+#define LOG_WARN(...) IWXMVM_LOG(::IWXMVM::LogCategory::General, ::spdlog::level::warn, __VA_ARGS__)
+#define LOG_DEBUG(...) IWXMVM_LOG_DEBUG(::IWXMVM::LogCategory::General, __VA_ARGS__)
+#define LOG_ERROR(...) IWXMVM_LOG(::IWXMVM::LogCategory::General, ::spdlog::level::err, __VA_ARGS__)
+#define LOG_CRITICAL(...) IWXMVM_LOG(::IWXMVM::LogCategory::General, ::spdlog::level::critical, __VA_ARGS__)
+
+// for messages on hot paths, whose level can be set per category in the preferences
+#define LOG_CATEGORY_INFO(category, ...) \
+    IWXMVM_LOG(::IWXMVM::LogCategory::category, ::spdlog::level::info, __VA_ARGS__)
+#define LOG_CATEGORY_WARN(category, ...) \
+    IWXMVM_LOG(::IWXMVM::LogCategory::category, ::spdlog::level::warn, __VA_ARGS__)
+#define LOG_CATEGORY_DEBUG(category, ...) IWXMVM_LOG_DEBUG(::IWXMVM::LogCategory::category, __VA_ARGS__)
 
 namespace IWXMVM
 {
+    enum class LogCategory
+    {
+        General,
+        Playback,  // skipping and rewinding through the demo
+        Commands,  // commands sent to the game's console
+        Keyframes,
+
+        Count
+    };
 
     class Logger
     {
        public:
         static void Initialize();
+        // writes out what is still queued and stops the logging thread, before the module is unloaded
+        static void Shutdown();
         static std::shared_ptr<spdlog::logger> GetInternalLogger();
 
+        static bool ShouldLog(LogCategory category, spdlog::level::level_enum level)
+        {
+            return level >= categoryLevels[static_cast<std::size_t>(category)].load(std::memory_order_relaxed);
+        }
+
+        static spdlog::level::level_enum GetCategoryLevel(LogCategory category);
+        static void SetCategoryLevel(LogCategory category, spdlog::level::level_enum level);
+
+        // blocks until everything logged so far was written to the sinks, unless that takes longer than a second
+        static void Flush();
+
+        // additional sinks that receive everything logged while they are attached, e.g. a log file per render job.
+        // Detaching doesn't wait for the sink to get what is still queued for it; it is let go of once it has.
+        static void AttachSink(spdlog::sink_ptr sink);
+        static void DetachSink(spdlog::sink_ptr sink);
+
        private:
+        // runs the action on the logging thread, after everything logged so far was written
+        static void RunOnLoggingThread(std::function<void()> action);
+
+        static std::shared_ptr<spdlog::details::thread_pool> threadPool;
         static std::shared_ptr<spdlog::logger> internalLogger;
+        static std::shared_ptr<spdlog::sinks::dist_sink_mt> attachedSinks;
+        static std::array<std::atomic<spdlog::level::level_enum>, static_cast<std::size_t>(LogCategory::Count)>
+            categoryLevels;
     };
-}  // namespace IWXMVM
\ No newline at end of file
+}  // namespace IWXMVM
@@ -8,14 +8,47 @@
 #include "Utilities/HookManager.hpp"
 #include "Utilities/PathUtils.hpp"
 #include "Utilities/MemoryUtils.hpp"
+#include "Utilities/Tracer.hpp"
 #include "UI/UIManager.hpp"
 #include "Configuration/Configuration.hpp"
 #include "Graphics/Graphics.hpp"
+#include "Components/CaptureManager.hpp"
 
 namespace IWXMVM
 {
     GameInterface* Mod::internalGameInterface = nullptr;
     std::atomic<bool> Mod::ejectRequested = false;
+    std::unique_ptr<TaskPool> Mod::startupTasks;
+
+    namespace
+    {
+        constexpr std::uint32_t MAX_STARTUP_THREADS = 4;
+
+        double GetMillisecondsSince(Tracing::Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Tracing::Clock::now() - start).count();
+        }
+
+        // calls the function when it goes out of scope, however the scope is left
+        template <typename F>
+        class ScopeExit
+        {
+           public:
+            explicit ScopeExit(F function) : function(std::move(function))
+            {
+            }
+            ~ScopeExit()
+            {
+                function();
+            }
+
+            ScopeExit(const ScopeExit&) = delete;
+            ScopeExit& operator=(const ScopeExit&) = delete;
+
+           private:
+            F function;
+        };
+    }  // namespace
 
     HMODULE GetCurrentModule()
     {
@@ -36,31 +69,69 @@ namespace IWXMVM
     {
         try
         {
+            const auto injectionTime = Tracing::Clock::now();
             internalGameInterface = gameInterface;
 
-            WindowsConsole::Open();
-            Logger::Initialize();
+            {
+                IWXMVM_TRACE_ZONE("Open console and log");
+                WindowsConsole::Open();
+                Logger::Initialize();
+            }
 
             LOG_INFO("Loading IWXMVM {}", IWXMVM_VERSION);
             LOG_INFO("Game: {}", magic_enum::enum_name(gameInterface->GetGame()));
             LOG_INFO("Game Path: {}", PathUtils::GetCurrentExecutablePath());
 
+            // the steps that don't need the game run beside the signature scan, which splits the modules up on the
+            // same threads
+            startupTasks = std::make_unique<TaskPool>(
+                std::clamp(std::thread::hardware_concurrency(), 2u, MAX_STARTUP_THREADS));
+            // if anything below throws, the threads are joined before the error is handled, instead of being left
+            // running with the tasks still referring to the game
+            const ScopeExit joinStartupTasks([]() { startupTasks.reset(); });
+            auto configuration = startupTasks->Submit([]() {
+                IWXMVM_TRACE_ZONE("Load configuration");
+                Configuration::Get().Initialize();
+            });
+            auto meshes = startupTasks->Submit([]() {
+                IWXMVM_TRACE_ZONE("Prepare meshes");
+                GFX::GraphicsManager::Get();
+            });
+
             LOG_DEBUG("Scanning signatures...");
-            gameInterface->InitializeGameAddresses();
+            {
+                IWXMVM_TRACE_ZONE("Resolve signatures");
+                gameInterface->InitializeGameAddresses();
+            }
+            const auto signatureMilliseconds = GetMillisecondsSince(injectionTime);
+
+            {
+                IWXMVM_TRACE_ZONE("Wait for startup tasks");
+                configuration.get();
+                meshes.get();
+                startupTasks.reset();
+            }
 
             LOG_DEBUG("Initializing components...");
-            Configuration::Get().Initialize();
-            Components::CameraManager::Get().Initialize();
-            Components::CampathManager::Get().Initialize();
-            Components::KeyframeManager::Get().Initialize();
-            Components::Rewinding::Initialize();
+            {
+                IWXMVM_TRACE_ZONE("Initialize components");
+                Components::CameraManager::Get().Initialize();
+                Components::CampathManager::Get().Initialize();
+                Components::KeyframeManager::Get().Initialize();
+                Components::Rewinding::Initialize();
+            }
 
             LOG_DEBUG("Installing game hooks and patches...");
-            D3D9::Initialize();
-            gameInterface->InstallHooksAndPatches();
-            gameInterface->SetupEventListeners();
+            {
+                IWXMVM_TRACE_ZONE("Install hooks and patches");
+                D3D9::Initialize();
+                gameInterface->InstallHooksAndPatches();
+                gameInterface->SetupEventListeners();
+            }
 
-            LOG_INFO("Initialized IWXMVM!");
+            Tracing::Tracer::Get().Record("Initialize IWXMVM", injectionTime, Tracing::Clock::now());
+            LOG_INFO("Initialized IWXMVM in {:.1f} ms (signatures after {:.1f} ms)", GetMillisecondsSince(injectionTime),
+                     signatureMilliseconds);
 
             while (!ejectRequested.load())
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -74,7 +145,10 @@ namespace IWXMVM
             LOG_DEBUG("Released UI and graphic resources");
             UI::UIManager::Get().ShutdownImGui();
             LOG_DEBUG("ImGui successfully shutdown");
+            Components::CaptureManager::Get().Shutdown();
+            LOG_DEBUG("Finished finalizing capture outputs");
 
+            Logger::Shutdown();
             WindowsConsole::Close();
             ::FreeLibraryAndExitThread(GetCurrentModule(), 0);
         }
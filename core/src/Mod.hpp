@@ -5,6 +5,7 @@
 #include "Components/KeyframeManager.hpp"
 #include "Components/CaptureManager.hpp"
 #include "Components/Rewinding.hpp"
+#include "Utilities/TaskPool.hpp"
 
 namespace IWXMVM
 {
@@ -20,8 +21,15 @@ namespace IWXMVM
 
         static void RequestEject();
 
+        // only there while initializing, for splitting up work that has to be done before the hooks are installed
+        static TaskPool* GetStartupTasks()
+        {
+            return startupTasks.get();
+        }
+
        private:
         static GameInterface* internalGameInterface;
+        static std::unique_ptr<TaskPool> startupTasks;
 
         static std::atomic<bool> ejectRequested;
     };
@@ -11,11 +11,11 @@ namespace IWXMVM::Resources
     INCBIN(WORK_SANS_FONT, "resources/WorkSans-Regular.ttf");
     INCBIN(FA_ICONS_FONT, "resources/fa-solid-900.ttf");
 
-    INCBIN(AXIS_MODEL, "resources/axis.obj");
-    INCBIN(CAMERA_MODEL, "resources/camera.obj");
-    INCBIN(ICOSPHERE_MODEL, "resources/icosphere.obj");
-    INCBIN(GIZMO_TRANSLATE_MODEL, "resources/gizmo_translate.obj");
-    INCBIN(GIZMO_ROTATE_MODEL, "resources/gizmo_rotate.obj");
+    INCBIN(AXIS_MODEL, "resources/baked/axis.mesh");
+    INCBIN(CAMERA_MODEL, "resources/baked/camera.mesh");
+    INCBIN(ICOSPHERE_MODEL, "resources/baked/icosphere.mesh");
+    INCBIN(GIZMO_TRANSLATE_MODEL, "resources/baked/gizmo_translate.mesh");
+    INCBIN(GIZMO_ROTATE_MODEL, "resources/baked/gizmo_rotate.mesh");
 
     INCBIN(VERTEX_SHADER, "resources/shaders/vertex.hlsl");
     INCBIN(PIXEL_SHADER, "resources/shaders/pixel.hlsl");
@@ -2,12 +2,12 @@
 
 namespace IWXMVM::Types
 {
+    // what only changes when a demo is loaded; the current tick is GameInterface::GetDemoTick
     struct DemoInfo
     {
         std::string name;
         std::string path;
 
-        uint32_t gameTick;
         uint32_t endTick;
     };
 }  // namespace IWXMVM::Types
\ No newline at end of file
@@ -20,6 +20,7 @@ namespace IWXMVM::Types
             const char* string;
             uint8_t color[4];
         }* value;
+        bool* modified;  // makes the game apply values it only reads when they changed
     };
 
 }  // namespace IWXMVM::Types
\ No newline at end of file
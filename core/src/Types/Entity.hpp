@@ -20,6 +20,7 @@ namespace IWXMVM::Types
         EntityType type;
         int32_t clientNum; // associated client number
         bool isValid;
+        glm::vec3 origin;  // interpolated position of the current frame
 
         std::string ToString()
         {
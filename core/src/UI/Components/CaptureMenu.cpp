@@ -6,12 +6,163 @@
 #include "UI/UIManager.hpp"
 #include "Components/CaptureManager.hpp"
 #include "Components/CameraManager.hpp"
+#include "Components/RenderQueue.hpp"
 #include "Utilities/PathUtils.hpp"
 #include "Configuration/PreferencesConfiguration.hpp"
 #include "UI/TaskbarProgress.hpp"
 
 namespace IWXMVM::UI
 {
+    void DrawCaptureStatistics()
+    {
+        using namespace Capture;
+
+        const auto& statistics = Components::CaptureManager::Get().GetStatistics();
+        ImGui::Text("%.1f fps, %.1f MB/s", statistics.GetFramesPerSecond(), statistics.GetMegabytesPerSecond());
+        if (statistics.GetRepeatedFrameCount() > 0)
+        {
+            ImGui::Text("%llu of %llu frames repeated", statistics.GetRepeatedFrameCount(), statistics.GetFrameCount());
+        }
+
+        if (ImGui::BeginTable("##captureStatisticsTable", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Stage");
+            ImGui::TableSetupColumn("Mean (ms)");
+            ImGui::TableSetupColumn("p50 (ms)");
+            ImGui::TableSetupColumn("p99 (ms)");
+            ImGui::TableSetupColumn("Max (ms)");
+            ImGui::TableHeadersRow();
+
+            for (auto stage = 0; stage < (int)CaptureStage::Count; stage++)
+            {
+                const auto& histogram = statistics.GetHistogram((CaptureStage)stage);
+                if (histogram.GetCount() == 0)
+                    continue;
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text(GetCaptureStageLabel((CaptureStage)stage).data());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", histogram.GetMeanMicroseconds() / 1000.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", histogram.GetPercentileMicroseconds(50) / 1000.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", histogram.GetPercentileMicroseconds(99) / 1000.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", histogram.GetMaxMicroseconds() / 1000.0);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    void DrawRenderQueue()
+    {
+        using namespace Components;
+
+        auto& renderQueue = RenderQueue::Get();
+        const auto& jobs = renderQueue.GetJobs();
+
+        ImGui::Dummy(ImVec2(0, ImGui::GetStyle().ItemSpacing.y * 4));
+        ImGui::PushFont(UIManager::Get().GetBoldFont());
+        ImGui::Text("Render Queue");
+        ImGui::PopFont();
+
+        ImGui::BeginDisabled(renderQueue.IsRunning() ||
+                             Mod::GetGameInterface()->GetGameState() != Types::GameState::InDemo);
+        if (ImGui::Button(ICON_FA_PLUS " Add Current Setup"))
+        {
+            renderQueue.AddCurrentSetup();
+        }
+        ImGui::EndDisabled();
+
+        ImGui::SameLine();
+
+        if (renderQueue.IsRunning())
+        {
+            if (ImGui::Button(ICON_FA_STOP " Stop Queue"))
+            {
+                renderQueue.Stop();
+            }
+        }
+        else
+        {
+            ImGui::BeginDisabled(jobs.empty() || CaptureManager::Get().IsCapturing());
+            if (ImGui::Button(ICON_FA_PLAY " Start Queue"))
+            {
+                renderQueue.Start();
+            }
+            ImGui::EndDisabled();
+        }
+
+        if (ImGui::Checkbox("Start queue on launch", &renderQueue.GetStartOnLaunch()))
+        {
+            renderQueue.Save();
+        }
+
+        if (jobs.empty())
+            return;
+
+        std::optional<std::size_t> removedJob;
+        std::optional<std::size_t> resetJob;
+        if (ImGui::BeginTable("##renderQueueTable", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Job", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Ranges");
+            ImGui::TableSetupColumn("Status");
+            ImGui::TableSetupColumn("");
+            ImGui::TableHeadersRow();
+
+            for (std::size_t i = 0; i < jobs.size(); i++)
+            {
+                const auto& job = jobs[i];
+                const bool isActive = renderQueue.GetActiveJobIndex() == i;
+                ImGui::PushID(static_cast<int>(i));
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text(job.name.c_str());
+                ImGui::TableNextColumn();
+                if (isActive)
+                    ImGui::Text("%d of %d", static_cast<int>(renderQueue.GetActiveRangeIndex() + 1),
+                                static_cast<int>(job.tickRanges.size()));
+                else
+                    ImGui::Text("%d", static_cast<int>(job.tickRanges.size()));
+                ImGui::TableNextColumn();
+                ImGui::Text(renderQueue.GetStatusLabel(job.status).data());
+                if (!job.error.empty() && ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip(job.error.c_str());
+                }
+                ImGui::TableNextColumn();
+
+                ImGui::BeginDisabled(isActive);
+                if (job.status != RenderJobStatus::Pending)
+                {
+                    if (ImGui::SmallButton(ICON_FA_ARROW_ROTATE_RIGHT))
+                        resetJob = i;
+                    ImGui::SameLine();
+                }
+                if (ImGui::SmallButton(ICON_FA_XMARK))
+                {
+                    removedJob = i;
+                }
+                ImGui::EndDisabled();
+
+                ImGui::PopID();
+            }
+            ImGui::EndTable();
+        }
+
+        if (resetJob.has_value())
+        {
+            renderQueue.ResetJob(resetJob.value());
+        }
+        if (removedJob.has_value())
+        {
+            renderQueue.RemoveJob(removedJob.value());
+        }
+    }
+
     void CaptureMenu::Initialize()
     {
     }
@@ -26,6 +177,7 @@ namespace IWXMVM::UI
             if (Mod::GetGameInterface()->GetGameState() != Types::GameState::InDemo)
             {
                 UI::DrawInaccessibleTabWarning();
+                DrawRenderQueue();
                 ImGui::End();
                 return;
             }
@@ -33,10 +185,12 @@ namespace IWXMVM::UI
             auto& cameraManager = CameraManager::Get();
             auto& captureManager = CaptureManager::Get();
             auto& captureSettings = captureManager.GetCaptureSettings();
+            // while the queue runs, the settings are those of its current job
+            const bool isQueueRunning = RenderQueue::Get().IsRunning();
 
             const auto fieldLayoutPercentage = 0.4f;
 
-            ImGui::BeginDisabled(captureManager.IsCapturing());
+            ImGui::BeginDisabled(captureManager.IsCapturing() || isQueueRunning);
 
             ImGui::PushFont(UIManager::Get().GetBoldFont());
             ImGui::Text("Capture Settings");
@@ -58,21 +212,20 @@ namespace IWXMVM::UI
             ImGui::DragInt("##endTickInput", (int32_t*)&captureSettings.endTick, 10, captureSettings.startTick, endTick);
 
             ImGui::AlignTextToFramePadding();
-            ImGui::Text("Output Format");
+            ImGui::Text("Framerate");
             ImGui::SameLine();
             ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
             ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
                                     ImGui::GetStyle().WindowPadding.x);
-            if (ImGui::BeginCombo("##captureMenuOutputFormatCombo",
-                                  captureManager.GetOutputFormatLabel(captureSettings.outputFormat).data()))
+            if (ImGui::BeginCombo("##captureMenuFramerateCombo", std::format("{0}", captureSettings.framerate).c_str()))
             {
-                for (auto outputFormat = 0; outputFormat < (int)OutputFormat::Count; outputFormat++)
+                for (auto framerate : captureManager.GetSupportedFramerates())
                 {
-                    bool isSelected = captureSettings.outputFormat == (OutputFormat)outputFormat;
-                    if (ImGui::Selectable(captureManager.GetOutputFormatLabel((OutputFormat)outputFormat).data(),
-                            captureSettings.outputFormat == (OutputFormat)outputFormat))
+                    bool isSelected = captureSettings.framerate == framerate;
+                    if (ImGui::Selectable(std::format("{0}", framerate).c_str(),
+                                          captureSettings.framerate == framerate))
                     {
-                        captureSettings.outputFormat = (OutputFormat)outputFormat;
+                        captureSettings.framerate = framerate;
                     }
 
                     if (isSelected)
@@ -83,25 +236,44 @@ namespace IWXMVM::UI
                 ImGui::EndCombo();
             }
 
-            if (captureSettings.outputFormat == OutputFormat::Video)
+            const auto subFrameCounts = captureManager.GetSupportedSubFrameCounts(captureSettings.framerate);
+            auto& motionBlur = captureSettings.motionBlur;
+
+            ImGui::AlignTextToFramePadding();
+            ImGui::Text("Motion Blur");
+            ImGui::SameLine();
+            ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
+            ImGui::BeginDisabled(subFrameCounts.empty());
+            ImGui::Checkbox("##captureMenuMotionBlurCheckbox", &motionBlur.enabled);
+            ImGui::EndDisabled();
+
+            if (subFrameCounts.empty())
+            {
+                motionBlur.enabled = false;
+            }
+            else if (std::find(subFrameCounts.begin(), subFrameCounts.end(), motionBlur.subFrameCount) ==
+                     subFrameCounts.end())
+            {
+                motionBlur.subFrameCount = subFrameCounts.back();
+            }
+
+            if (motionBlur.enabled)
             {
                 ImGui::AlignTextToFramePadding();
-                ImGui::Text("Video Codec");
+                ImGui::Text("Sub-Frames");
                 ImGui::SameLine();
                 ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
                 ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
-                                                        ImGui::GetStyle().WindowPadding.x);
-                if (ImGui::BeginCombo("##captureMenuVideoCodecCombo",
-                                        captureManager.GetVideoCodecLabel(captureSettings.videoCodec.value())
-                                            .data()))
+                                        ImGui::GetStyle().WindowPadding.x);
+                if (ImGui::BeginCombo("##captureMenuSubFramesCombo",
+                                      std::format("{0}", motionBlur.subFrameCount).c_str()))
                 {
-                    for (auto videoCodec = 0; videoCodec < (int)VideoCodec::Count; videoCodec++)
+                    for (auto subFrameCount : subFrameCounts)
                     {
-                        bool isSelected = captureSettings.videoCodec == (VideoCodec)videoCodec;
-                        if (ImGui::Selectable(captureManager.GetVideoCodecLabel((VideoCodec)videoCodec).data(),
-                                captureSettings.videoCodec == (VideoCodec)videoCodec))
+                        bool isSelected = motionBlur.subFrameCount == subFrameCount;
+                        if (ImGui::Selectable(std::format("{0}", subFrameCount).c_str(), isSelected))
                         {
-                            captureSettings.videoCodec = (VideoCodec)videoCodec;
+                            motionBlur.subFrameCount = subFrameCount;
                         }
 
                         if (isSelected)
@@ -111,62 +283,246 @@ namespace IWXMVM::UI
                     }
                     ImGui::EndCombo();
                 }
+
+                ImGui::AlignTextToFramePadding();
+                ImGui::Text("Shutter Angle");
+                ImGui::SameLine();
+                ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
+                ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
+                                        ImGui::GetStyle().WindowPadding.x);
+                ImGui::SliderFloat("##captureMenuShutterAngleSlider", &motionBlur.shutterAngle, 1.0f, 360.0f,
+                                   "%.0f deg");
             }
-            
+
+            auto& colorGrading = captureSettings.colorGrading;
+
             ImGui::AlignTextToFramePadding();
-            ImGui::Text("Resolution");
+            ImGui::Text("Color Grading");
             ImGui::SameLine();
             ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
-            ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
-                                    ImGui::GetStyle().WindowPadding.x);
-            if (ImGui::BeginCombo("##captureMenuResolutionCombo", captureSettings.resolution.ToString().c_str()))
+            ImGui::Checkbox("##captureMenuColorGradingCheckbox", &colorGrading.enabled);
+
+            if (colorGrading.enabled)
             {
-                for (auto resolution : captureManager.GetSupportedResolutions())
+                ImGui::AlignTextToFramePadding();
+                ImGui::Text("LUT");
+                ImGui::SameLine();
+                ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
+
+                const auto lutLabel = std::format(
+                    "{} {}##captureMenuLutButton", ICON_FA_FOLDER_OPEN,
+                    colorGrading.lutPath.empty() ? "Select .cube file" : colorGrading.lutPath.filename().string());
+                if (ImGui::Button(lutLabel.c_str(), ImVec2(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
+                                                               ImGui::GetStyle().WindowPadding.x,
+                                                           0)))
                 {
-                    bool isSelected = captureSettings.resolution == resolution;
-                    if (ImGui::Selectable(resolution.ToString().c_str(),
-                                          captureSettings.resolution == resolution))
+                    auto path = PathUtils::OpenFileDialog(false, OFN_EXPLORER | OFN_FILEMUSTEXIST,
+                                                          "3D LUT (*.cube)\0*.cube\0", "cube");
+                    if (path.has_value())
                     {
-                        captureSettings.resolution = resolution;
+                        colorGrading.lutPath = path.value();
                     }
+                }
 
-                    if (isSelected)
-                    {
-                        ImGui::SetItemDefaultFocus();
-                    }
+                if (!colorGrading.lutPath.empty() && ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip("%s", colorGrading.lutPath.string().c_str());
                 }
-                ImGui::EndCombo();
             }
 
-            ImGui::AlignTextToFramePadding();
-            ImGui::Text("Framerate");
-            ImGui::SameLine();
-            ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
-            ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
-                                    ImGui::GetStyle().WindowPadding.x);
-            if (ImGui::BeginCombo("##captureMenuFramerateCombo", std::format("{0}", captureSettings.framerate).c_str()))
+            ImGui::Dummy(ImVec2(0, ImGui::GetStyle().ItemSpacing.y * 2));
+            ImGui::PushFont(UIManager::Get().GetBoldFont());
+            ImGui::Text("Outputs");
+            ImGui::PopFont();
+
+            std::optional<std::size_t> removedOutput;
+            for (std::size_t i = 0; i < captureSettings.outputs.size(); i++)
             {
-                for (auto framerate : captureManager.GetSupportedFramerates())
+                auto& output = captureSettings.outputs[i];
+                ImGui::PushID(static_cast<int>(i));
+
+                ImGui::AlignTextToFramePadding();
+                ImGui::Text("Output %d", static_cast<int>(i + 1));
+                if (captureSettings.outputs.size() > 1)
                 {
-                    bool isSelected = captureSettings.framerate == framerate;
-                    if (ImGui::Selectable(std::format("{0}", framerate).c_str(),
-                                          captureSettings.framerate == framerate))
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton(ICON_FA_XMARK))
                     {
-                        captureSettings.framerate = framerate;
+                        removedOutput = i;
                     }
+                }
 
-                    if (isSelected)
+                ImGui::AlignTextToFramePadding();
+                ImGui::Text("Output Format");
+                ImGui::SameLine();
+                ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
+                ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
+                                        ImGui::GetStyle().WindowPadding.x);
+                if (ImGui::BeginCombo("##captureMenuOutputFormatCombo",
+                                      captureManager.GetOutputFormatLabel(output.format).data()))
+                {
+                    for (auto outputFormat = 0; outputFormat < (int)OutputFormat::Count; outputFormat++)
                     {
-                        ImGui::SetItemDefaultFocus();
+                        bool isSelected = output.format == (OutputFormat)outputFormat;
+                        if (ImGui::Selectable(captureManager.GetOutputFormatLabel((OutputFormat)outputFormat).data(),
+                                output.format == (OutputFormat)outputFormat))
+                        {
+                            output.format = (OutputFormat)outputFormat;
+                        }
+
+                        if (isSelected)
+                        {
+                            ImGui::SetItemDefaultFocus();
+                        }
                     }
+                    ImGui::EndCombo();
                 }
-                ImGui::EndCombo();
+
+                if (output.format == OutputFormat::Video)
+                {
+                    ImGui::AlignTextToFramePadding();
+                    ImGui::Text("Video Codec");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
+                    ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
+                                                            ImGui::GetStyle().WindowPadding.x);
+                    if (ImGui::BeginCombo("##captureMenuVideoCodecCombo",
+                                            captureManager.GetVideoCodecLabel(output.videoCodec.value())
+                                                .data()))
+                    {
+                        for (auto videoCodec = 0; videoCodec < (int)VideoCodec::Count; videoCodec++)
+                        {
+                            bool isSelected = output.videoCodec == (VideoCodec)videoCodec;
+                            if (ImGui::Selectable(captureManager.GetVideoCodecLabel((VideoCodec)videoCodec).data(),
+                                    output.videoCodec == (VideoCodec)videoCodec))
+                            {
+                                output.videoCodec = (VideoCodec)videoCodec;
+                            }
+
+                            if (isSelected)
+                            {
+                                ImGui::SetItemDefaultFocus();
+                            }
+                        }
+                        ImGui::EndCombo();
+                    }
+
+                    ImGui::AlignTextToFramePadding();
+                    ImGui::Text("Encoders");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
+                    ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
+                                            ImGui::GetStyle().WindowPadding.x);
+                    ImGui::SliderInt("##captureMenuEncoderCountSlider", &output.encoderCount, 1,
+                                     captureManager.GetMaxEncoderCount());
+                }
+
+                if (output.format != OutputFormat::CameraData)
+                {
+                    ImGui::AlignTextToFramePadding();
+                    ImGui::Text("Resolution");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
+                    ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
+                                            ImGui::GetStyle().WindowPadding.x);
+                    if (ImGui::BeginCombo("##captureMenuResolutionCombo", output.resolution.ToString().c_str()))
+                    {
+                        for (auto resolution : captureManager.GetSupportedResolutions())
+                        {
+                            bool isSelected = output.resolution == resolution;
+                            if (ImGui::Selectable(resolution.ToString().c_str(),
+                                                  output.resolution == resolution))
+                            {
+                                output.resolution = resolution;
+                            }
+
+                            if (isSelected)
+                            {
+                                ImGui::SetItemDefaultFocus();
+                            }
+                        }
+                        ImGui::EndCombo();
+                    }
+                }
+
+                if (output.format == OutputFormat::EntityTracking)
+                {
+                    ImGui::AlignTextToFramePadding();
+                    ImGui::Text("Tracking Format");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
+                    ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
+                                            ImGui::GetStyle().WindowPadding.x);
+                    if (ImGui::BeginCombo("##captureMenuTrackingFormatCombo",
+                                          Capture::GetTrackingFormatLabel(output.trackingFormat).data()))
+                    {
+                        for (auto format = 0; format < (int)Capture::TrackingFormat::Count; format++)
+                        {
+                            const auto trackingFormat = (Capture::TrackingFormat)format;
+                            bool isSelected = output.trackingFormat == trackingFormat;
+                            if (ImGui::Selectable(Capture::GetTrackingFormatLabel(trackingFormat).data(), isSelected))
+                            {
+                                output.trackingFormat = trackingFormat;
+                            }
+
+                            if (isSelected)
+                            {
+                                ImGui::SetItemDefaultFocus();
+                            }
+                        }
+                        ImGui::EndCombo();
+                    }
+
+                    ImGui::AlignTextToFramePadding();
+                    ImGui::Text("Tracked Bones");
+                    ImGui::SameLine();
+                    ImGui::SetCursorPosX(ImGui::GetWindowWidth() * fieldLayoutPercentage);
+                    ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * (1 - fieldLayoutPercentage) -
+                                            ImGui::GetStyle().WindowPadding.x);
+                    const auto trackedBonesLabel = std::format("{} of {}", output.trackedBones.size(),
+                                                               Capture::MAX_TRACKED_BONES);
+                    if (ImGui::BeginCombo("##captureMenuTrackedBonesCombo", trackedBonesLabel.c_str()))
+                    {
+                        for (const auto& boneName : Mod::GetGameInterface()->GetSupportedBoneNames())
+                        {
+                            auto it = std::find(output.trackedBones.begin(), output.trackedBones.end(), boneName);
+                            const bool isTracked = it != output.trackedBones.end();
+
+                            const bool isFull = output.trackedBones.size() >= Capture::MAX_TRACKED_BONES;
+
+                            ImGui::BeginDisabled(!isTracked && isFull);
+                            if (ImGui::Selectable(boneName.c_str(), isTracked, ImGuiSelectableFlags_DontClosePopups))
+                            {
+                                if (isTracked)
+                                    output.trackedBones.erase(it);
+                                else
+                                    output.trackedBones.push_back(boneName);
+                            }
+                            ImGui::EndDisabled();
+                        }
+                        ImGui::EndCombo();
+                    }
+                }
+
+                ImGui::PopID();
+            }
+
+            if (removedOutput.has_value())
+            {
+                captureSettings.outputs.erase(captureSettings.outputs.begin() + removedOutput.value());
+            }
+
+            if (captureSettings.outputs.size() < CaptureManager::MAX_OUTPUTS &&
+                ImGui::Button(ICON_FA_PLUS " Add Output"))
+            {
+                captureSettings.outputs.push_back(captureManager.GetDefaultOutputSettings());
             }
 
             ImGui::EndDisabled();
 
             ImGui::SetCursorPosY(ImGui::GetCursorPosY() + ImGui::GetStyle().ItemSpacing.y * 5);
             auto label = captureManager.IsCapturing() ? ICON_FA_STOP " Stop" : ICON_FA_CIRCLE " Capture";
+            ImGui::BeginDisabled(captureManager.IsFinalizing() || isQueueRunning);
             if (ImGui::Button(label, ImVec2(ImGui::GetFontSize() * 6, ImGui::GetFontSize() * 2)))
             {
                 if (captureManager.IsCapturing())
@@ -174,6 +530,7 @@ namespace IWXMVM::UI
                 else
                     captureManager.StartCapture();
             }
+            ImGui::EndDisabled();
 
             ImGui::SameLine();
 
@@ -207,7 +564,7 @@ namespace IWXMVM::UI
             ImGui::PushFont(UIManager::Get().GetBoldFont());
             ImGui::Text("Output Directory");
             ImGui::PopFont();
-            const auto& outputDirectory = PreferencesConfiguration::Get().captureOutputDirectory;
+            const auto outputDirectory = captureManager.GetOutputDirectory();
             ImGui::TextWrapped(outputDirectory.string().c_str());
 
             if (captureManager.IsCapturing())
@@ -224,12 +581,16 @@ namespace IWXMVM::UI
 
                 TaskbarProgress::SetProgressValue((int)captureManager.GetCapturedFrameCount(), (unsigned long long)totalFrames);
                 TaskbarProgress::SetProgressState(TBPF_NORMAL);
+
+                DrawCaptureStatistics();
             }
             else
             {
                 TaskbarProgress::SetProgressState(TBPF_NOPROGRESS);
             }
 
+            DrawRenderQueue();
+
             ImGui::End();
         }
     }
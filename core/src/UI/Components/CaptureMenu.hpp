@@ -12,4 +12,6 @@ namespace IWXMVM::UI
        private:
         void Initialize() final;
     };
+
+    void DrawCaptureStatistics();
 }  // namespace IWXMVM::UI
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "StdInclude.hpp"
 #include "ControlBar.hpp"
 
+#include "DvarHandle.hpp"
 #include "Mod.hpp"
 #include "Components/CameraManager.hpp"
 #include "Components/Playback.hpp"
@@ -15,7 +16,7 @@ namespace IWXMVM::UI
 {
     float playbackSpeed;
 
-    std::optional<Types::Dvar> timescale;
+    DvarHandle<float> timescale("timescale");
 
     void ControlBar::Initialize()
     {
@@ -90,7 +91,7 @@ namespace IWXMVM::UI
 
         if (Input::BindDown(Action::PlaybackFaster))
         {
-            float& fTimescale = timescale.value().value->floating_point;
+            float& fTimescale = timescale.Value();
 
             if (const auto it = std::upper_bound(TIMESCALE_STEPS.begin(), TIMESCALE_STEPS.end(), fTimescale);
                 it != TIMESCALE_STEPS.end())
@@ -99,7 +100,7 @@ namespace IWXMVM::UI
 
         if (Input::BindDown(Action::PlaybackSlower))
         {
-            float& fTimescale = timescale.value().value->floating_point;
+            float& fTimescale = timescale.Value();
 
             if (const auto it = std::upper_bound(TIMESCALE_STEPS.rbegin(), TIMESCALE_STEPS.rend(), fTimescale,
                                                  std::greater<float>());
@@ -315,11 +316,8 @@ namespace IWXMVM::UI
         if (Mod::GetGameInterface()->GetGameState() != Types::GameState::InDemo)
             return;
 
-        if (!timescale.has_value())
-        {
-            timescale = Mod::GetGameInterface()->GetDvar("timescale");
+        if (!timescale.Get())
             return;
-        }
 
         HandlePlaybackInput();
 
@@ -376,13 +374,13 @@ namespace IWXMVM::UI
             ImGui::SetNextItemWidth(playbackSpeedSliderWidth - buttonSize.x - ImGui::GetFontSize() * 0.8f);
             ImGui::SetCursorPosX(padding.x + 2 * buttonSize.x + 2 * ImGui::GetFontSize() * 0.8f);
             ImGui::SetCursorPosY(GetSize().y / 2 - buttonSize.y / 2);
-            ImGuiEx::TimescaleSlider("##1", &timescale.value().value->floating_point, 
+            ImGuiEx::TimescaleSlider("##1", timescale.Get(), 
                 Components::Playback::TIMESCALE_STEPS.front(),
                 Components::Playback::TIMESCALE_STEPS.back(),
                 "%.3f",
                 ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoInput);
 
-            const auto demoInfo = Mod::GetGameInterface()->GetDemoInfo();
+            const auto& demoInfo = Mod::GetGameInterface()->GetDemoInfo();
             const auto currentTick = Components::Playback::GetTimelineTick();
             if (currentTick < demoInfo.endTick)
             {
@@ -1,13 +1,212 @@
 #include "StdInclude.hpp"
 #include "DebugPanel.hpp"
 
+#include "UI/Components/CaptureMenu.hpp"
 #include "Components/Playback.hpp"
+#include "Events.hpp"
+#include "Graphics/Resource.hpp"
+#include "Utilities/FrameProfiler.hpp"
 #include "Utilities/HookManager.hpp"
+#include "Utilities/PathUtils.hpp"
+#include "Utilities/Tracer.hpp"
 #include "UI/UIManager.hpp"
 #include "Mod.hpp"
 
 namespace IWXMVM::UI
 {
+    void DrawBufferStatistics(const char* name, const GFX::BufferStatistics& statistics)
+    {
+        ImGui::Text("%s: %zu / %zu (peak %zu, discarded %u, grown %u)", name, statistics.used, statistics.capacity,
+                    statistics.highWaterMark, statistics.discardCount, statistics.growCount);
+    }
+
+    void DrawListenerTimings()
+    {
+        auto isTimingEnabled = Events::IsTimingEnabled();
+        if (ImGui::Checkbox("Time Listeners", &isTimingEnabled))
+            Events::SetTimingEnabled(isTimingEnabled);
+        ImGui::SameLine();
+        if (ImGui::Button("Reset"))
+            Events::ResetListenerTimings();
+
+        if (ImGui::BeginTable("##listenerTimings", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Event");
+            ImGui::TableSetupColumn("Listener");
+            ImGui::TableSetupColumn("Calls");
+            ImGui::TableSetupColumn("Average (us)");
+            ImGui::TableSetupColumn("Longest (us)");
+            ImGui::TableHeadersRow();
+
+            for (const auto& timing : Events::GetListenerTimings())
+            {
+                const auto averageTime =
+                    timing.callCount > 0 ? timing.totalTime.count() / 1000.0 / timing.callCount : 0.0;
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", magic_enum::enum_name(timing.eventType).data());
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", timing.name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(timing.callCount));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", averageTime);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", timing.longestTime.count() / 1000.0);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+#if IWXMVM_PROFILER_ENABLED
+    ImU32 GetZoneColor(const char* name)
+    {
+        // hashed from the name, so that a zone keeps its color from one frame to the next
+        std::uint32_t hash = 2166136261u;
+        for (; *name != '\0'; name++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+        }
+        return ImColor::HSV(static_cast<float>(hash % 360) / 360.0f, 0.5f, 0.8f);
+    }
+
+    void DrawFrameTimeline(const Profiling::ProfileFrame& frame)
+    {
+        constexpr float ROW_HEIGHT = 18.0f;
+        constexpr float MIN_WIDTH = 600.0f;
+
+        // a row for every nesting depth of every thread that recorded zones
+        std::vector<std::uint32_t> rows;
+        const auto getRowKey = [](const Profiling::ProfileZone& zone) {
+            return (static_cast<std::uint32_t>(zone.threadIndex) << 16) | zone.depth;
+        };
+        for (const auto& zone : frame.zones)
+        {
+            rows.push_back(getRowKey(zone));
+        }
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        const auto origin = ImGui::GetCursorScreenPos();
+        const auto size = ImVec2(std::max(ImGui::GetContentRegionAvail().x, MIN_WIDTH),
+                                 ROW_HEIGHT * static_cast<float>(std::max<std::size_t>(rows.size(), 1)));
+        ImGui::InvisibleButton("##frameTimeline", size);
+
+        auto* drawList = ImGui::GetWindowDrawList();
+        drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(30, 30, 30, 255));
+
+        const auto frameDuration = std::max(frame.end - frame.begin, Profiling::Clock::duration(1));
+        const auto toX = [&](Profiling::Clock::time_point time) {
+            const auto offset = std::clamp(time - frame.begin, Profiling::Clock::duration(0), frameDuration);
+            return origin.x + size.x * static_cast<float>(static_cast<double>(offset.count()) / frameDuration.count());
+        };
+
+        for (const auto& zone : frame.zones)
+        {
+            const auto row = std::lower_bound(rows.begin(), rows.end(), getRowKey(zone)) - rows.begin();
+            const auto min = ImVec2(toX(zone.begin), origin.y + ROW_HEIGHT * static_cast<float>(row));
+            const auto max = ImVec2(std::max(toX(zone.end), min.x + 1.0f), min.y + ROW_HEIGHT - 1.0f);
+            drawList->AddRectFilled(min, max, GetZoneColor(zone.name));
+
+            if (max.x - min.x > ImGui::CalcTextSize(zone.name).x + 4.0f)
+                drawList->AddText(ImVec2(min.x + 2.0f, min.y + 2.0f), IM_COL32(0, 0, 0, 255), zone.name);
+
+            if (ImGui::IsItemHovered() && ImGui::IsMouseHoveringRect(min, max))
+            {
+                const auto milliseconds = std::chrono::duration<double, std::milli>(zone.end - zone.begin).count();
+                ImGui::SetTooltip("%s\n%.3f ms (thread %u)", zone.name, milliseconds, zone.threadIndex);
+            }
+        }
+    }
+
+    void DrawZoneStatistics(const std::vector<Profiling::ZoneStatistics>& statistics)
+    {
+        if (ImGui::BeginTable("##zoneStatistics", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Zone");
+            ImGui::TableSetupColumn("Average (ms)");
+            ImGui::TableSetupColumn("Longest (ms)");
+            ImGui::TableSetupColumn("Calls per Frame");
+            ImGui::TableHeadersRow();
+
+            for (const auto& zone : statistics)
+            {
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", zone.name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", zone.averageMilliseconds);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", zone.longestMilliseconds);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", zone.callsPerFrame);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    void DrawFrameProfiler()
+    {
+        constexpr std::size_t PLOTTED_FRAMES = 240;
+        constexpr std::size_t STATISTICS_FRAMES = 120;
+        constexpr auto STATISTICS_INTERVAL = std::chrono::milliseconds(500);
+        // what the profiler keeps at the game's highest frame rate, unless the frames are unusually busy
+        constexpr auto TRACE_DURATION = std::chrono::seconds(10);
+
+        static std::int32_t selectedAge = 0;
+        static std::vector<Profiling::ZoneStatistics> statistics;
+        static std::chrono::steady_clock::time_point lastStatisticsUpdate;
+
+        auto& profiler = Profiling::FrameProfiler::Get();
+        auto isRecording = profiler.IsEnabled();
+        if (ImGui::Checkbox("Record", &isRecording))
+            profiler.SetEnabled(isRecording);
+        ImGui::SameLine();
+        if (ImGui::Button("Write Frame Trace"))
+        {
+            const auto tracePath = PathUtils::GetIWXMVMPath() / "frames.json";
+            if (profiler.WriteChromeTrace(tracePath, TRACE_DURATION))
+                LOG_INFO("Wrote the last frames to {}", tracePath.string());
+            else
+                LOG_ERROR("Failed to write the last frames to {}", tracePath.string());
+        }
+
+        const auto frameTimes = profiler.GetFrameTimes(PLOTTED_FRAMES);
+        if (frameTimes.empty())
+            return;
+
+        const auto longestFrameTime = *std::max_element(frameTimes.begin(), frameTimes.end());
+        ImGui::PlotLines("##frameTimes", frameTimes.data(), static_cast<int>(frameTimes.size()), 0, nullptr, 0.0f,
+                         longestFrameTime, ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+
+        // while recording, the selected frame moves along with the frames that come in
+        const auto frameCount = static_cast<std::int32_t>(profiler.GetFrameCount());
+        selectedAge = std::clamp(selectedAge, 0, frameCount - 1);
+        ImGui::SliderInt("Frames Ago", &selectedAge, 0, frameCount - 1);
+
+        if (const auto frame = profiler.GetFrame(selectedAge))
+        {
+            const auto milliseconds = std::chrono::duration<double, std::milli>(frame->end - frame->begin).count();
+            ImGui::Text("Frame %llu: %.3f ms, %zu zones", static_cast<unsigned long long>(frame->index), milliseconds,
+                        frame->zones.size());
+            if (frame->droppedZoneCount > 0)
+            {
+                ImGui::SameLine();
+                ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "(%u dropped)", frame->droppedZoneCount);
+            }
+            DrawFrameTimeline(*frame);
+        }
+
+        // averaging over many frames every frame would cost more than most of the zones
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastStatisticsUpdate > STATISTICS_INTERVAL)
+        {
+            statistics = profiler.GetZoneStatistics(STATISTICS_FRAMES);
+            lastStatisticsUpdate = now;
+        }
+        DrawZoneStatistics(statistics);
+    }
+#endif
+
     void DebugPanel::Initialize()
     {
     }
@@ -16,7 +215,7 @@ namespace IWXMVM::UI
     {
         if (ImGui::Begin("Debug", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
         {
-            const auto demoInfo = Mod::GetGameInterface()->GetDemoInfo();
+            const auto& demoInfo = Mod::GetGameInterface()->GetDemoInfo();
 
             ImGui::Text("Game State: %s", Types::ToString(Mod::GetGameInterface()->GetGameState()).data());
             ImGui::Text("Demo Name: %s", demoInfo.name.c_str());
@@ -33,6 +232,43 @@ namespace IWXMVM::UI
 
             auto& camera = Components::CameraManager::Get().GetActiveCamera();
             ImGui::Text("Camera: %f %f %f", camera->GetPosition().x, camera->GetPosition().y, camera->GetPosition().z);
+
+            if (ImGui::CollapsingHeader("Capture Statistics"))
+            {
+                DrawCaptureStatistics();
+            }
+
+            if (ImGui::CollapsingHeader("Buffer Statistics"))
+            {
+                const auto& bufferManager = GFX::BufferManager::Get();
+                DrawBufferStatistics("Static Vertices", bufferManager.GetVertexStatistics(GFX::BufferType::Static));
+                DrawBufferStatistics("Static Indices", bufferManager.GetIndexStatistics(GFX::BufferType::Static));
+                DrawBufferStatistics("Dynamic Vertices", bufferManager.GetVertexStatistics(GFX::BufferType::Dynamic));
+                DrawBufferStatistics("Dynamic Indices", bufferManager.GetIndexStatistics(GFX::BufferType::Dynamic));
+                DrawBufferStatistics("Instances", bufferManager.GetInstanceStatistics());
+            }
+
+            if (ImGui::CollapsingHeader("Event Listeners"))
+            {
+                DrawListenerTimings();
+            }
+
+#if IWXMVM_PROFILER_ENABLED
+            if (ImGui::CollapsingHeader("Frame Profiler"))
+            {
+                DrawFrameProfiler();
+            }
+#endif
+
+            if (ImGui::Button("Write Trace"))
+            {
+                const auto tracePath = PathUtils::GetIWXMVMPath() / "trace.json";
+                if (Tracing::Tracer::Get().WriteChromeTrace(tracePath))
+                    LOG_INFO("Wrote trace to {}", tracePath.string());
+                else
+                    LOG_ERROR("Failed to write trace to {}", tracePath.string());
+            }
+            ImGui::SameLine();
             if (ImGui::Button("Eject"))
                 Mod::RequestEject();
             ImGui::End();
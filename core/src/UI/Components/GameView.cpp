@@ -225,7 +225,7 @@ namespace IWXMVM::UI
         SetSize(ImGui::GetIO().DisplaySize.x * scaleFactor, ImGui::GetIO().DisplaySize.y * scaleFactor);
         LOG_DEBUG("Initializing GameView. size.x: {}; size.y: {}", GetSize().x, GetSize().y);
 
-        Events::RegisterListener(EventType::OnCameraChanged, [&]() {
+        Events::RegisterListener<EventType::OnCameraChanged>("GameView", [&]() {
             if (UIManager::Get().IsControllableCameraModeSelected())
             {
                 SetHasFocus(false);
@@ -272,7 +272,7 @@ namespace IWXMVM::UI
             ImGui::EndCombo();
         }
 
-        auto demoLabel = Mod::GetGameInterface()->GetDemoInfo().name;
+        const auto& demoLabel = Mod::GetGameInterface()->GetDemoInfo().name;
         ImGui::SameLine(GetSize().x - ImGui::CalcTextSize(demoLabel.c_str()).x - PADDING);
         ImGui::Text(demoLabel.c_str());
     }
@@ -396,7 +396,7 @@ namespace IWXMVM::UI
         this->viewportPosition = ImGui::GetCurrentWindow()->DC.CursorPos;
         this->viewportSize = textureSize;
         ImGui::Image((void*)texture, textureSize);
-        Events::Invoke(EventType::OnRenderGameView);
+        Events::Invoke<EventType::OnRenderGameView>();
         if (Mod::GetGameInterface()->GetGameState() == Types::GameState::InDemo)
         {
             DrawGizmoControls();
@@ -575,12 +575,13 @@ namespace IWXMVM::UI
 
     void KeyframeEditor::Initialize()
     {
-        Events::RegisterListener(EventType::OnDemoBoundsDetermined, [this]() {
-            displayStartTick = 0;
-            displayEndTick = Mod::GetGameInterface()->GetDemoInfo().endTick;
+        Events::RegisterListener<EventType::OnDemoBoundsDetermined>(
+            "KeyframeEditor", [this](const Events::DemoBounds& bounds) {
+                displayStartTick = 0;
+                displayEndTick = bounds.endTick - bounds.startTick;
 
-            LOG_DEBUG("Set initial keyframe editor zoom as {} to {}", displayStartTick, displayEndTick);
-        });
+                LOG_DEBUG("Set initial keyframe editor zoom as {} to {}", displayStartTick, displayEndTick);
+            });
 
         for (const auto& pair : Components::KeyframeManager::Get().GetKeyframes())
         {
@@ -595,7 +596,7 @@ namespace IWXMVM::UI
 
     bool KeyframeEditor::DrawKeyframeSlider(const Types::KeyframeableProperty& property)
     {
-        auto demoInfo = Mod::GetGameInterface()->GetDemoInfo();
+        const auto& demoInfo = Mod::GetGameInterface()->GetDemoInfo();
         auto currentTick = Components::Playback::GetTimelineTick();
         auto [displayStartTick, displayEndTick] = GetDisplayTickRange();
 
@@ -606,7 +607,7 @@ namespace IWXMVM::UI
 
     bool KeyframeEditor::DrawCurveEditor(const Types::KeyframeableProperty& property, const auto width)
     {
-        auto demoInfo = Mod::GetGameInterface()->GetDemoInfo();
+        const auto& demoInfo = Mod::GetGameInterface()->GetDemoInfo();
         auto currentTick = Components::Playback::GetTimelineTick();
         auto [displayStartTick, displayEndTick] = GetDisplayTickRange();
 
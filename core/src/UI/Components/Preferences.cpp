@@ -29,6 +29,29 @@ namespace IWXMVM::UI
         ImGui::SetCursorPosY(ImGui::GetCursorPosY() + 10);
     }
 
+    void DrawLoggingSection()
+    {
+        DrawHeading("Logging");
+
+        // spdlog's level names are string literals, so they are null terminated
+        std::array<const char*, spdlog::level::n_levels> levelLabels;
+        for (int level = 0; level < spdlog::level::n_levels; level++)
+        {
+            levelLabels[level] = spdlog::level::to_string_view(static_cast<spdlog::level::level_enum>(level)).data();
+        }
+
+        for (std::size_t i = 0; i < static_cast<std::size_t>(LogCategory::Count); i++)
+        {
+            const auto category = static_cast<LogCategory>(i);
+            const auto categoryName = std::string(magic_enum::enum_name(category));
+
+            auto level = static_cast<int>(Logger::GetCategoryLevel(category));
+            if (ImGui::Combo(categoryName.c_str(), &level, levelLabels.data(), static_cast<int>(levelLabels.size())))
+                Logger::SetCategoryLevel(category, static_cast<spdlog::level::level_enum>(level));
+        }
+        ImGui::SetCursorPosY(ImGui::GetCursorPosY() + 10);
+    }
+
     void DrawFreecamSection()
     {
         auto& preferences = PreferencesConfiguration::Get();
@@ -63,6 +86,7 @@ namespace IWXMVM::UI
             {
                 ImGui::TableNextColumn();
                 DrawMiscSection();
+                DrawLoggingSection();
                 
                 ImGui::TableNextColumn();
                 DrawFreecamSection();
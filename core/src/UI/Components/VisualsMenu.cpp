@@ -15,7 +15,7 @@ namespace IWXMVM::UI
         // TODO: Come up with a proper plan on when we want to initialize the UI values from the games values
         // TODO: Ideally we dont want to ever overwrite a users custom settings, but what if the map changes
 
-        Events::RegisterListener(EventType::PostDemoLoad, [&]() {
+        Events::RegisterListener<EventType::PostDemoLoad>("VisualsMenu", [&]() {
             if (visualsInitialized)
                 return;
 
@@ -46,7 +46,7 @@ namespace IWXMVM::UI
         });
 
         // This is a hack to get the keyframed visuals to update when the visual tab isnt selected
-        Events::RegisterListener(EventType::OnFrame, [&]() {
+        Events::RegisterListener<EventType::OnFrame>("VisualsMenu", [&]() {
             if (Mod::GetGameInterface()->GetGameState() != Types::GameState::InDemo)
                 return;
 
@@ -5,9 +5,11 @@
 #include "Utilities/HookManager.hpp"
 #include "Mod.hpp"
 #include "Events.hpp"
+#include "Utilities/FrameProfiler.hpp"
 #include "Resources.hpp"
 #include "Input.hpp"
 #include "Components/CameraManager.hpp"
+#include "Components/RenderQueue.hpp"
 #include "Utilities/MathUtils.hpp"
 #include "UI/TaskbarProgress.hpp"
 
@@ -35,6 +37,7 @@ namespace IWXMVM::UI
 
     void UIManager::RunImGuiFrame()
     {
+        IWXMVM_PROFILE_ZONE("UIManager::RunImGuiFrame");
         try
         {
             ImGui_ImplDX9_NewFrame();
@@ -88,7 +91,10 @@ namespace IWXMVM::UI
                 GetUIComponent(Component::DebugPanel)->Render();
             }
 
-            Events::Invoke(EventType::OnFrame);
+            {
+                IWXMVM_PROFILE_ZONE("OnFrame");
+                Events::Invoke<EventType::OnFrame>();
+            }
 
             ImGui::EndFrame();
             ImGui::Render();
@@ -249,6 +255,7 @@ namespace IWXMVM::UI
             isInitialized = true;
 
             Components::CaptureManager::Get().Initialize();
+            Components::RenderQueue::Get().Initialize();
             TaskbarProgress::Initialize(hwnd);
 
             LOG_INFO("Initialized UI");
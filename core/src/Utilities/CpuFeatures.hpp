@@ -0,0 +1,33 @@
+#pragma once
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+namespace IWXMVM::CpuFeatures
+{
+    // for the code paths that are compiled in for every x86 build and picked at runtime
+    inline bool IsAvx2Supported()
+    {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+        int info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        // the OS also has to save the upper halves of the ymm registers on context switches
+        __cpuid(info, 1);
+        const bool hasXsave = (info[2] & (1 << 27)) != 0;
+        const bool hasAvx = (info[2] & (1 << 28)) != 0;
+        if (!hasXsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif defined(__i386__) || defined(__x86_64__)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+}  // namespace IWXMVM::CpuFeatures
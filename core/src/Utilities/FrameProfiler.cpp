@@ -0,0 +1,196 @@
+#include "FrameProfiler.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+namespace IWXMVM::Profiling
+{
+    namespace
+    {
+        double ToMilliseconds(Clock::duration duration)
+        {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+    }  // namespace
+
+    FrameProfiler::FrameProfiler() : frames(FRAME_HISTORY), zones(ZONE_HISTORY)
+    {
+        frames[currentFrame].begin = Clock::now();
+    }
+
+    void FrameProfiler::BeginFrame()
+    {
+        const auto now = Clock::now();
+        std::lock_guard lock(mutex);
+
+        if (!IsEnabled())
+        {
+            // the history stays as it is, and recording starts over with a whole frame once it is enabled again
+            auto& frame = frames[currentFrame];
+            frame = {frame.index, now, now, frame.firstZone, 0, 0};
+            return;
+        }
+
+        frames[currentFrame].end = now;
+        // the frame in progress takes up one of the slots
+        completeFrameCount = std::min(completeFrameCount + 1, FRAME_HISTORY - 1);
+
+        const auto nextZone = frames[currentFrame].firstZone + frames[currentFrame].zoneCount;
+        currentFrame = (currentFrame + 1) % FRAME_HISTORY;
+        frames[currentFrame] = {++nextFrameIndex, now, now, nextZone, 0, 0};
+    }
+
+    void FrameProfiler::Record(const char* name, Clock::time_point begin, Clock::time_point end, std::uint32_t depth)
+    {
+        const auto threadIndex = static_cast<std::uint16_t>(Tracing::GetThreadIndex());
+        std::lock_guard lock(mutex);
+
+        auto& frame = frames[currentFrame];
+        if (frame.zoneCount >= MAX_ZONES_PER_FRAME)
+        {
+            frame.droppedZoneCount++;
+            return;
+        }
+        const auto zone = frame.firstZone + frame.zoneCount++;
+        zones[zone % ZONE_HISTORY] = {name, begin, end, threadIndex, static_cast<std::uint16_t>(depth)};
+
+        // the oldest frames whose zones were just written over
+        while (completeFrameCount > 0 && frames[GetSlotIndex(completeFrameCount - 1)].firstZone + ZONE_HISTORY <= zone)
+        {
+            completeFrameCount--;
+        }
+    }
+
+    std::size_t FrameProfiler::GetFrameCount() const
+    {
+        std::lock_guard lock(mutex);
+        return completeFrameCount;
+    }
+
+    std::size_t FrameProfiler::GetSlotIndex(std::size_t age) const
+    {
+        return (currentFrame + FRAME_HISTORY - 1 - age) % FRAME_HISTORY;
+    }
+
+    std::optional<ProfileFrame> FrameProfiler::GetFrame(std::size_t age) const
+    {
+        std::lock_guard lock(mutex);
+        if (age >= completeFrameCount)
+            return std::nullopt;
+
+        const auto slotIndex = GetSlotIndex(age);
+        const auto& slot = frames[slotIndex];
+        ProfileFrame frame = {slot.index, slot.begin, slot.end, {}, slot.droppedZoneCount};
+        frame.zones.reserve(slot.zoneCount);
+        for (std::size_t i = 0; i < slot.zoneCount; i++)
+        {
+            frame.zones.push_back(GetZone(slot, i));
+        }
+        return frame;
+    }
+
+    std::vector<float> FrameProfiler::GetFrameTimes(std::size_t frameCount) const
+    {
+        std::lock_guard lock(mutex);
+        frameCount = std::min(frameCount, completeFrameCount);
+
+        std::vector<float> frameTimes;
+        frameTimes.reserve(frameCount);
+        for (std::size_t age = frameCount; age-- > 0;)
+        {
+            const auto& slot = frames[GetSlotIndex(age)];
+            frameTimes.push_back(static_cast<float>(ToMilliseconds(slot.end - slot.begin)));
+        }
+        return frameTimes;
+    }
+
+    std::vector<ZoneStatistics> FrameProfiler::GetZoneStatistics(std::size_t frameCount) const
+    {
+        struct ZoneTotal
+        {
+            const char* name;
+            Clock::duration frameTime;
+            Clock::duration totalTime;
+            Clock::duration longestTime;
+            std::size_t callCount;
+        };
+
+        std::vector<ZoneTotal> totals;
+        {
+            std::lock_guard lock(mutex);
+            frameCount = std::min(frameCount, completeFrameCount);
+            for (std::size_t age = 0; age < frameCount; age++)
+            {
+                const auto& slot = frames[GetSlotIndex(age)];
+                for (auto& total : totals)
+                {
+                    total.frameTime = {};
+                }
+
+                for (std::size_t i = 0; i < slot.zoneCount; i++)
+                {
+                    const auto& zone = GetZone(slot, i);
+                    // the same name in different translation units is not always the same pointer
+                    auto total = std::find_if(totals.begin(), totals.end(), [&](const ZoneTotal& other) {
+                        return other.name == zone.name || std::string_view(other.name) == zone.name;
+                    });
+                    if (total == totals.end())
+                        total = totals.insert(totals.end(), {zone.name, {}, {}, {}, 0});
+
+                    total->frameTime += zone.end - zone.begin;
+                    total->callCount++;
+                }
+
+                for (auto& total : totals)
+                {
+                    total.totalTime += total.frameTime;
+                    total.longestTime = std::max(total.longestTime, total.frameTime);
+                }
+            }
+        }
+
+        std::vector<ZoneStatistics> statistics;
+        for (const auto& total : totals)
+        {
+            statistics.push_back({total.name, ToMilliseconds(total.totalTime) / frameCount,
+                                  ToMilliseconds(total.longestTime),
+                                  static_cast<double>(total.callCount) / frameCount});
+        }
+        std::sort(statistics.begin(), statistics.end(), [](const ZoneStatistics& a, const ZoneStatistics& b) {
+            return a.averageMilliseconds > b.averageMilliseconds;
+        });
+        return statistics;
+    }
+
+    bool FrameProfiler::WriteChromeTrace(const std::filesystem::path& path, Clock::duration duration) const
+    {
+        std::vector<Tracing::TraceEvent> events;
+        Clock::time_point origin;
+        {
+            std::lock_guard lock(mutex);
+            if (completeFrameCount == 0)
+                return false;
+
+            const auto latestEnd = frames[GetSlotIndex(0)].end;
+            for (std::size_t age = completeFrameCount; age-- > 0;)
+            {
+                const auto& slot = frames[GetSlotIndex(age)];
+                if (latestEnd - slot.end > duration)
+                    continue;
+
+                if (events.empty())
+                    origin = slot.begin;
+
+                // the frames get a row of their own, next to the threads
+                events.push_back({"Frame", 0, slot.begin, slot.end});
+                for (std::size_t i = 0; i < slot.zoneCount; i++)
+                {
+                    const auto& zone = GetZone(slot, i);
+                    events.push_back({zone.name, zone.threadIndex, zone.begin, zone.end});
+                }
+            }
+        }
+
+        return Tracing::WriteChromeTrace(path, events, origin);
+    }
+}  // namespace IWXMVM::Profiling
@@ -0,0 +1,162 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "Utilities/Tracer.hpp"
+
+// profiling zones are compiled out of release builds, unless this is defined as 1
+#ifndef IWXMVM_PROFILER_ENABLED
+#ifdef NDEBUG
+#define IWXMVM_PROFILER_ENABLED 0
+#else
+#define IWXMVM_PROFILER_ENABLED 1
+#endif
+#endif
+
+namespace IWXMVM::Profiling
+{
+    using Clock = Tracing::Clock;
+
+    struct ProfileZone
+    {
+        const char* name;  // not copied, so it has to be a string literal
+        Clock::time_point begin;
+        Clock::time_point end;
+        std::uint16_t threadIndex;
+        std::uint16_t depth;  // how many zones of the same thread it is nested in
+    };
+
+    struct ProfileFrame
+    {
+        std::uint64_t index;
+        Clock::time_point begin;
+        Clock::time_point end;
+        std::vector<ProfileZone> zones;  // in the order they ended
+        std::uint32_t droppedZoneCount;
+    };
+
+    struct ZoneStatistics
+    {
+        const char* name;
+        double averageMilliseconds;  // per frame, of all the zone's calls together
+        double longestMilliseconds;  // the most a single frame spent in it
+        double callsPerFrame;
+    };
+
+    // Keeps the zones of the last frames, each frame running from one BeginFrame to the next. Zones are recorded from
+    // any thread into memory that is allocated once, and a frame that fills up drops the rest of its zones. The frames
+    // share the memory for their zones, so once that wraps around, the oldest frames leave the history early.
+    class FrameProfiler
+    {
+       public:
+        // ten seconds at 1000 fps, the most the game runs at
+        static constexpr std::size_t FRAME_HISTORY = 10000;
+        static constexpr std::size_t MAX_ZONES_PER_FRAME = 256;
+        // ten seconds at 1000 fps of frames with about 26 zones each, longer with fewer
+        static constexpr std::size_t ZONE_HISTORY = 1 << 18;
+
+        static FrameProfiler& Get()
+        {
+            static FrameProfiler instance;
+            return instance;
+        }
+
+        FrameProfiler();
+        FrameProfiler(FrameProfiler const&) = delete;
+        void operator=(FrameProfiler const&) = delete;
+
+        void SetEnabled(bool isEnabled)
+        {
+            enabled.store(isEnabled, std::memory_order_relaxed);
+        }
+
+        bool IsEnabled() const
+        {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        // ends the current frame and starts the next one, or restarts the current one while disabled
+        void BeginFrame();
+        void Record(const char* name, Clock::time_point begin, Clock::time_point end, std::uint32_t depth);
+
+        // frames that ended and still have all their zones, at most FRAME_HISTORY
+        std::size_t GetFrameCount() const;
+        // 0 is the frame that ended last
+        std::optional<ProfileFrame> GetFrame(std::size_t age) const;
+        // in milliseconds, the oldest first
+        std::vector<float> GetFrameTimes(std::size_t frameCount) const;
+        std::vector<ZoneStatistics> GetZoneStatistics(std::size_t frameCount) const;
+
+        // the frames that ended within the duration, as a trace that chrome://tracing and Perfetto can open
+        bool WriteChromeTrace(const std::filesystem::path& path, Clock::duration duration) const;
+
+       private:
+        struct FrameSlot
+        {
+            std::uint64_t index = 0;
+            Clock::time_point begin;
+            Clock::time_point end;
+            std::uint64_t firstZone = 0;  // counting every zone recorded so far
+            std::uint32_t zoneCount = 0;
+            std::uint32_t droppedZoneCount = 0;
+        };
+
+        std::size_t GetSlotIndex(std::size_t age) const;
+        const ProfileZone& GetZone(const FrameSlot& slot, std::size_t index) const
+        {
+            return zones[(slot.firstZone + index) % ZONE_HISTORY];
+        }
+
+        mutable std::mutex mutex;
+        std::vector<FrameSlot> frames;
+        std::vector<ProfileZone> zones;  // a ring, the zones of every frame following the ones of the frame before
+        std::size_t currentFrame = 0;
+        std::size_t completeFrameCount = 0;
+        std::uint64_t nextFrameIndex = 0;
+        std::atomic<bool> enabled = true;
+    };
+
+    // Records its lifetime as a zone of the current frame; does nothing while the profiler is disabled
+    class ScopedProfileZone
+    {
+       public:
+        explicit ScopedProfileZone(const char* name)
+            : name(FrameProfiler::Get().IsEnabled() ? name : nullptr),
+              depth(this->name ? threadDepth++ : 0),
+              begin(this->name ? Clock::now() : Clock::time_point{})
+        {
+        }
+
+        ~ScopedProfileZone()
+        {
+            if (name)
+            {
+                threadDepth--;
+                FrameProfiler::Get().Record(name, begin, Clock::now(), depth);
+            }
+        }
+
+        ScopedProfileZone(ScopedProfileZone const&) = delete;
+        void operator=(ScopedProfileZone const&) = delete;
+
+       private:
+        static inline thread_local std::uint32_t threadDepth = 0;
+
+        const char* name;
+        std::uint32_t depth;
+        Clock::time_point begin;
+    };
+}  // namespace IWXMVM::Profiling
+
+#if IWXMVM_PROFILER_ENABLED
+#define IWXMVM_PROFILE_ZONE(name) \
+    ::IWXMVM::Profiling::ScopedProfileZone IWXMVM_TRACE_CONCAT(profileZone, __LINE__)(name)
+#define IWXMVM_PROFILE_BEGIN_FRAME() ::IWXMVM::Profiling::FrameProfiler::Get().BeginFrame()
+#else
+#define IWXMVM_PROFILE_ZONE(name) ((void)0)
+#define IWXMVM_PROFILE_BEGIN_FRAME() ((void)0)
+#endif
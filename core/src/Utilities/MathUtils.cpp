@@ -42,29 +42,9 @@ namespace IWXMVM::MathUtils
 
     // Copyright (c) by NUMERICAL RECIPES IN C: THE ART OF SCIENTIFIC COMPUTING (ISBN 0-521-43108-5)
     // Modified. Thank you to dtugend for finding this!
-    float MathUtils::InterpolateCubicSpline(const std::vector<Types::Keyframe>& keyframes, uint32_t valueIndex, float tick)
+    void SolveSecondDerivatives(const float* ticks, const float* values, size_t n, float* y2)
     {
-        const size_t n = keyframes.size();
-        if (n < 2)
-            throw std::exception("Not enough keyframes to interpolate");
-
-        constexpr int32_t MAX_NODES = 256;
-        if (keyframes.size() > MAX_NODES)
-        {
-            LOG_WARN("Exceeded maximum number of keyframes ({})", MAX_NODES);
-            return keyframes.back().value.GetByIndex(valueIndex);
-        }
-
-        float ticks[MAX_NODES];
-        float values[MAX_NODES];
-        for (size_t i = 0; i < n; i++)
-        {
-            ticks[i] = static_cast<float>(keyframes[i].tick);
-            values[i] = keyframes[i].value.GetByIndex(valueIndex);
-        }
-
-        float y2[MAX_NODES];  // second derivatives
-        float u[MAX_NODES];
+        float u[MAX_SPLINE_NODES];
 
         y2[0] = -0.5f;
         u[0] = (3.0f / (ticks[1] - ticks[0])) * ((values[1] - values[0]) / (ticks[1] - ticks[0]));
@@ -93,6 +73,39 @@ namespace IWXMVM::MathUtils
 
         for (int k = n - 2; k >= 0; k--)
             y2[k] = y2[k] * y2[k + 1] + u[k];
+    }
+
+    float EvaluateSplineSegment(float tickLo, float tickHi, float valueLo, float valueHi, float y2Lo, float y2Hi,
+                                float tick)
+    {
+        auto h = tickHi - tickLo;
+        auto a = (tickHi - tick) / h;
+        auto b = (tick - tickLo) / h;
+        return a * valueLo + b * valueHi + ((a * a * a - a) * y2Lo + (b * b * b - b) * y2Hi) * (h * h) / 6.0f;
+    }
+
+    float MathUtils::InterpolateCubicSpline(const std::vector<Types::Keyframe>& keyframes, uint32_t valueIndex, float tick)
+    {
+        const size_t n = keyframes.size();
+        if (n < 2)
+            throw std::exception("Not enough keyframes to interpolate");
+
+        if (keyframes.size() > MAX_SPLINE_NODES)
+        {
+            LOG_WARN("Exceeded maximum number of keyframes ({})", MAX_SPLINE_NODES);
+            return keyframes.back().value.GetByIndex(valueIndex);
+        }
+
+        float ticks[MAX_SPLINE_NODES];
+        float values[MAX_SPLINE_NODES];
+        for (size_t i = 0; i < n; i++)
+        {
+            ticks[i] = static_cast<float>(keyframes[i].tick);
+            values[i] = keyframes[i].value.GetByIndex(valueIndex);
+        }
+
+        float y2[MAX_SPLINE_NODES];  // second derivatives
+        SolveSecondDerivatives(ticks, values, n, y2);
 
         int klo = 0;
         int khi = n - 1;
@@ -104,11 +117,41 @@ namespace IWXMVM::MathUtils
             else
                 klo = k;
         }
-        auto h = ticks[khi] - ticks[klo];
-        auto a = (ticks[khi] - tick) / h;
-        auto b = (tick - ticks[klo]) / h;
-        return a * values[klo] + b * values[khi] +
-               ((a * a * a - a) * y2[klo] + (b * b * b - b) * y2[khi]) * (h * h) / 6.0f;
+        return EvaluateSplineSegment(ticks[klo], ticks[khi], values[klo], values[khi], y2[klo], y2[khi], tick);
+    }
+
+    bool SolveCubicSpline(const std::vector<Types::Keyframe>& keyframes, uint32_t valueIndex,
+                          std::vector<float>& secondDerivatives)
+    {
+        const size_t n = keyframes.size();
+        if (n < 2 || n > MAX_SPLINE_NODES)
+            return false;
+
+        float ticks[MAX_SPLINE_NODES];
+        float values[MAX_SPLINE_NODES];
+        for (size_t i = 0; i < n; i++)
+        {
+            ticks[i] = static_cast<float>(keyframes[i].tick);
+            values[i] = keyframes[i].value.GetByIndex(valueIndex);
+        }
+
+        secondDerivatives.resize(n);
+        SolveSecondDerivatives(ticks, values, n, secondDerivatives.data());
+        return true;
+    }
+
+    float EvaluateCubicSpline(const std::vector<Types::Keyframe>& keyframes,
+                              const std::vector<float>& secondDerivatives, uint32_t valueIndex, size_t segmentIndex,
+                              float tick)
+    {
+        const auto& lo = keyframes[segmentIndex];
+        const auto& hi = keyframes[segmentIndex + 1];
+        if (lo.tick == hi.tick)
+            return lo.value.GetByIndex(valueIndex);
+
+        return EvaluateSplineSegment(static_cast<float>(lo.tick), static_cast<float>(hi.tick),
+                                     lo.value.GetByIndex(valueIndex), hi.value.GetByIndex(valueIndex),
+                                     secondDerivatives[segmentIndex], secondDerivatives[segmentIndex + 1], tick);
     }
 
 }  // namespace IWXMVM::MathUtils
\ No newline at end of file
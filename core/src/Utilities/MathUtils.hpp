@@ -9,5 +9,16 @@ namespace IWXMVM::MathUtils
     glm::vec3 AnglesFromForwardVector(glm::vec3 forward);
 
     std::optional<ImVec2> WorldToScreenPoint(glm::vec3 point, Components::Camera& camera);
+    constexpr size_t MAX_SPLINE_NODES = 256;
+
     float InterpolateCubicSpline(const std::vector<Types::Keyframe>& keyframes, uint32_t valueIndex, float tick);
+
+    // Solves the spline that InterpolateCubicSpline evaluates, so that it can be evaluated at many ticks without
+    // solving it again. Fails if there are too few or too many keyframes.
+    bool SolveCubicSpline(const std::vector<Types::Keyframe>& keyframes, uint32_t valueIndex,
+                          std::vector<float>& secondDerivatives);
+    // evaluates a solved spline at a tick between the keyframes at segmentIndex and segmentIndex + 1
+    float EvaluateCubicSpline(const std::vector<Types::Keyframe>& keyframes,
+                              const std::vector<float>& secondDerivatives, uint32_t valueIndex, size_t segmentIndex,
+                              float tick);
 }  // namespace IWXMVM::MathUtils
\ No newline at end of file
@@ -0,0 +1,485 @@
+#include "PatternScanner.hpp"
+
+#include "Utilities/CpuFeatures.hpp"
+#include "Utilities/TaskPool.hpp"
+#include "Utilities/Tracer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define IWXMVM_SIGNATURES_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 is picked at runtime, so it's compiled in for every x86 build regardless of the baseline instruction set
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define IWXMVM_SIGNATURES_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define IWXMVM_SIGNATURES_AVX2_TARGET
+#else
+#define IWXMVM_SIGNATURES_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace IWXMVM::Signatures
+{
+    namespace
+    {
+        constexpr std::size_t VECTOR_SIZE = 16;
+
+        // below this, handing a chunk to another thread costs more than scanning it
+        constexpr std::size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+        // a module is several megabytes, so the byte frequencies are taken from chunks spread evenly over it
+        constexpr std::size_t SAMPLE_CHUNK_SIZE = 1024;
+        constexpr std::size_t SAMPLE_CHUNK_COUNT = 64;
+
+        std::array<std::uint32_t, 256> SampleByteFrequencies(std::span<const std::uint8_t> data)
+        {
+            std::array<std::uint32_t, 256> frequencies = {};
+            const auto countChunk = [&](std::size_t offset, std::size_t size) {
+                for (std::size_t i = offset; i < offset + size; i++)
+                {
+                    frequencies[data[i]]++;
+                }
+            };
+
+            if (data.size() <= SAMPLE_CHUNK_SIZE * SAMPLE_CHUNK_COUNT)
+            {
+                countChunk(0, data.size());
+                return frequencies;
+            }
+
+            const auto stride = (data.size() - SAMPLE_CHUNK_SIZE) / (SAMPLE_CHUNK_COUNT - 1);
+            for (std::size_t i = 0; i < SAMPLE_CHUNK_COUNT; i++)
+            {
+                countChunk(i * stride, SAMPLE_CHUNK_SIZE);
+            }
+            return frequencies;
+        }
+
+        // Tracks which patterns one scan still looks for, grouped by their anchor byte. The anchor is the byte of a
+        // pattern that is rarest in the data, and the next rarest one is checked before comparing the whole pattern.
+        class ScanState
+        {
+           public:
+            struct Anchors
+            {
+                std::size_t offset;
+                std::size_t checkOffset;
+                std::uint8_t checkValue;
+            };
+
+            template <typename Pattern>
+            ScanState(std::span<const Pattern> patterns, std::span<const std::uint8_t> data,
+                      std::span<std::optional<std::size_t>> results, bool vectorCompare)
+                : data(data), results(results), anchors(patterns.size()), vectorCompare(vectorCompare)
+            {
+                const auto frequencies = SampleByteFrequencies(data);
+                for (std::size_t i = 0; i < patterns.size(); i++)
+                {
+                    const auto& pattern = patterns[i];
+                    values.push_back(pattern.values.data());
+                    masks.push_back(pattern.masks.data());
+                    lengths.push_back(pattern.length);
+                    paddedLengths.push_back(pattern.values.size());
+
+                    std::optional<std::size_t> rarest, nextRarest;
+                    for (std::size_t j = 0; j < pattern.length; j++)
+                    {
+                        if (pattern.masks[j] == 0)
+                            continue;
+
+                        const auto frequency = frequencies[pattern.values[j]];
+                        if (!rarest.has_value() || frequency < frequencies[pattern.values[rarest.value()]])
+                        {
+                            nextRarest = rarest;
+                            rarest = j;
+                        }
+                        else if (!nextRarest.has_value() || frequency < frequencies[pattern.values[nextRarest.value()]])
+                        {
+                            nextRarest = j;
+                        }
+                    }
+
+                    // nothing to anchor on, so it matches wherever it fits
+                    if (!rarest.has_value())
+                    {
+                        if (pattern.length <= data.size())
+                            results[i] = 0;
+                        continue;
+                    }
+
+                    const auto checkOffset = nextRarest.value_or(rarest.value());
+                    anchors[i] = {rarest.value(), checkOffset, pattern.values[checkOffset]};
+                    buckets[pattern.values[rarest.value()]].push_back(static_cast<std::uint32_t>(i));
+                    remaining++;
+                }
+
+                for (std::size_t byte = 0; byte < buckets.size(); byte++)
+                {
+                    if (!buckets[byte].empty())
+                        anchorBytes.push_back(static_cast<std::uint8_t>(byte));
+                }
+            }
+
+            bool IsDone() const
+            {
+                return remaining == 0;
+            }
+
+            bool IsAnchor(std::uint8_t byte) const
+            {
+                return !buckets[byte].empty();
+            }
+
+            const std::vector<std::uint8_t>& GetAnchorBytes() const
+            {
+                return anchorBytes;
+            }
+
+            // checks the patterns anchored on the byte at position, and returns true if that made the set of anchor
+            // bytes change because the last pattern of one was found
+            bool Visit(std::size_t position)
+            {
+                auto& bucket = buckets[data[position]];
+                if (bucket.empty())
+                    return false;
+
+                for (std::size_t i = 0; i < bucket.size();)
+                {
+                    const auto patternIndex = bucket[i];
+                    const auto& anchor = anchors[patternIndex];
+                    if (position < anchor.offset || !Matches(patternIndex, position - anchor.offset))
+                    {
+                        i++;
+                        continue;
+                    }
+
+                    results[patternIndex] = position - anchor.offset;
+                    bucket[i] = bucket.back();
+                    bucket.pop_back();
+                    remaining--;
+                }
+
+                if (!bucket.empty())
+                    return false;
+
+                std::erase(anchorBytes, data[position]);
+                return true;
+            }
+
+           private:
+            bool Matches(std::size_t patternIndex, std::size_t start) const
+            {
+                const auto length = lengths[patternIndex];
+                const auto& anchor = anchors[patternIndex];
+                if (start + length > data.size() || data[start + anchor.checkOffset] != anchor.checkValue)
+                    return false;
+
+                const auto* bytes = data.data() + start;
+                const auto* patternValues = values[patternIndex];
+                const auto* patternMasks = masks[patternIndex];
+#ifdef IWXMVM_SIGNATURES_SSE2
+                // the padding is all wildcards, so reading past the end of the pattern only has to stay in the data
+                const auto paddedLength = paddedLengths[patternIndex];
+                if (vectorCompare && start + paddedLength <= data.size())
+                {
+                    for (std::size_t i = 0; i < paddedLength; i += VECTOR_SIZE)
+                    {
+                        const __m128i difference = _mm_and_si128(
+                            _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i)),
+                                          _mm_loadu_si128(reinterpret_cast<const __m128i*>(patternValues + i))),
+                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(patternMasks + i)));
+                        if (_mm_movemask_epi8(_mm_cmpeq_epi8(difference, _mm_setzero_si128())) != 0xFFFF)
+                            return false;
+                    }
+                    return true;
+                }
+#endif
+
+                for (std::size_t i = 0; i < length; i++)
+                {
+                    if (((bytes[i] ^ patternValues[i]) & patternMasks[i]) != 0)
+                        return false;
+                }
+                return true;
+            }
+
+            std::span<const std::uint8_t> data;
+            std::span<std::optional<std::size_t>> results;
+
+            std::vector<const std::uint8_t*> values;
+            std::vector<const std::uint8_t*> masks;
+            std::vector<std::size_t> lengths;
+            std::vector<std::size_t> paddedLengths;
+            std::vector<Anchors> anchors;
+
+            std::array<std::vector<std::uint32_t>, 256> buckets;
+            std::vector<std::uint8_t> anchorBytes;
+            std::size_t remaining = 0;
+            bool vectorCompare;
+        };
+
+        void ScanReference(ScanState& state, std::span<const std::uint8_t> data, std::size_t position)
+        {
+            for (; position < data.size() && !state.IsDone(); position++)
+            {
+                if (state.IsAnchor(data[position]))
+                    state.Visit(position);
+            }
+        }
+
+#ifdef IWXMVM_SIGNATURES_SSE2
+        // fills anchors with every anchor byte repeated over a whole vector, and returns how many there are
+        std::size_t LoadAnchorsSse2(const ScanState& state, __m128i* anchors)
+        {
+            const auto& anchorBytes = state.GetAnchorBytes();
+            for (std::size_t i = 0; i < anchorBytes.size(); i++)
+            {
+                anchors[i] = _mm_set1_epi8(static_cast<char>(anchorBytes[i]));
+            }
+            return anchorBytes.size();
+        }
+
+        void ScanSse2(ScanState& state, std::span<const std::uint8_t> data)
+        {
+            __m128i anchors[256];
+            auto anchorCount = LoadAnchorsSse2(state, anchors);
+
+            std::size_t position = 0;
+            for (; position + VECTOR_SIZE <= data.size() && !state.IsDone(); position += VECTOR_SIZE)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + position));
+                __m128i found = _mm_setzero_si128();
+                for (std::size_t i = 0; i < anchorCount; i++)
+                {
+                    found = _mm_or_si128(found, _mm_cmpeq_epi8(block, anchors[i]));
+                }
+
+                auto bits = static_cast<std::uint32_t>(_mm_movemask_epi8(found));
+                while (bits != 0)
+                {
+                    if (state.Visit(position + std::countr_zero(bits)))
+                        anchorCount = LoadAnchorsSse2(state, anchors);
+                    bits &= bits - 1;
+                }
+            }
+
+            ScanReference(state, data, position);
+        }
+#endif
+
+#ifdef IWXMVM_SIGNATURES_AVX2
+        IWXMVM_SIGNATURES_AVX2_TARGET std::size_t LoadAnchorsAvx2(const ScanState& state, __m256i* anchors)
+        {
+            const auto& anchorBytes = state.GetAnchorBytes();
+            for (std::size_t i = 0; i < anchorBytes.size(); i++)
+            {
+                anchors[i] = _mm256_set1_epi8(static_cast<char>(anchorBytes[i]));
+            }
+            return anchorBytes.size();
+        }
+
+        IWXMVM_SIGNATURES_AVX2_TARGET void ScanAvx2(ScanState& state, std::span<const std::uint8_t> data)
+        {
+            constexpr std::size_t BLOCK_SIZE = 32;
+
+            __m256i anchors[256];
+            auto anchorCount = LoadAnchorsAvx2(state, anchors);
+
+            std::size_t position = 0;
+            for (; position + BLOCK_SIZE <= data.size() && !state.IsDone(); position += BLOCK_SIZE)
+            {
+                const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data.data() + position));
+                __m256i found = _mm256_setzero_si256();
+                for (std::size_t i = 0; i < anchorCount; i++)
+                {
+                    found = _mm256_or_si256(found, _mm256_cmpeq_epi8(block, anchors[i]));
+                }
+
+                auto bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(found));
+                while (bits != 0)
+                {
+                    if (state.Visit(position + std::countr_zero(bits)))
+                        anchorCount = LoadAnchorsAvx2(state, anchors);
+                    bits &= bits - 1;
+                }
+            }
+
+            ScanReference(state, data, position);
+        }
+#endif
+    }  // namespace
+
+    std::size_t PatternScanner::AddPattern(std::span<const std::uint16_t> pattern)
+    {
+        const auto paddedLength = (pattern.size() + VECTOR_SIZE - 1) / VECTOR_SIZE * VECTOR_SIZE;
+
+        Pattern compiled = {std::vector<std::uint8_t>(paddedLength), std::vector<std::uint8_t>(paddedLength),
+                            pattern.size()};
+        for (std::size_t i = 0; i < pattern.size(); i++)
+        {
+            if (pattern[i] == maskValue)
+                continue;
+
+            compiled.values[i] = static_cast<std::uint8_t>(pattern[i]);
+            compiled.masks[i] = 0xFF;
+        }
+
+        patterns.push_back(std::move(compiled));
+        return patterns.size() - 1;
+    }
+
+    void PatternScanner::Clear()
+    {
+        patterns.clear();
+    }
+
+    std::vector<std::optional<std::size_t>> PatternScanner::Scan(std::span<const std::uint8_t> data) const
+    {
+        return Scan(data, GetFastestKernel());
+    }
+
+    std::vector<std::optional<std::size_t>> PatternScanner::Scan(std::span<const std::uint8_t> data,
+                                                                 Kernel kernel) const
+    {
+        std::vector<std::optional<std::size_t>> results(patterns.size());
+        if (!IsKernelSupported(kernel))
+        {
+            kernel = Kernel::Reference;
+        }
+
+        ScanState state(std::span<const Pattern>(patterns), data, results, kernel != Kernel::Reference);
+        switch (kernel)
+        {
+#ifdef IWXMVM_SIGNATURES_AVX2
+            case Kernel::Avx2:
+                ScanAvx2(state, data);
+                break;
+#endif
+#ifdef IWXMVM_SIGNATURES_SSE2
+            case Kernel::Sse2:
+                ScanSse2(state, data);
+                break;
+#endif
+            default:
+                ScanReference(state, data, 0);
+                break;
+        }
+        return results;
+    }
+
+    std::vector<std::optional<std::size_t>> PatternScanner::Scan(std::span<const std::uint8_t> data,
+                                                                 TaskPool& pool) const
+    {
+        const auto chunkCount = std::clamp<std::size_t>(data.size() / MIN_CHUNK_SIZE, 1, pool.GetThreadCount());
+        if (chunkCount == 1)
+            return Scan(data);
+
+        // chunks reach into the next one by the longest pattern, so that matches across the border are found too
+        std::size_t overlap = 0;
+        for (const auto& pattern : patterns)
+        {
+            overlap = std::max(overlap, pattern.length > 0 ? pattern.length - 1 : 0);
+        }
+
+        const auto chunkSize = (data.size() + chunkCount - 1) / chunkCount;
+        std::vector<std::pair<std::size_t, std::future<std::vector<std::optional<std::size_t>>>>> chunks;
+        for (std::size_t start = 0; start < data.size(); start += chunkSize)
+        {
+            const auto chunk = data.subspan(start, std::min(chunkSize + overlap, data.size() - start));
+            chunks.emplace_back(start, pool.Submit([this, chunk]() {
+                IWXMVM_TRACE_ZONE("Scan chunk");
+                return Scan(chunk);
+            }));
+        }
+
+        std::vector<std::optional<std::size_t>> results(patterns.size());
+        for (auto& [start, future] : chunks)
+        {
+            const auto chunkResults = future.get();
+            for (std::size_t i = 0; i < results.size(); i++)
+            {
+                if (chunkResults[i].has_value() && (!results[i].has_value() || start + *chunkResults[i] < *results[i]))
+                    results[i] = start + *chunkResults[i];
+            }
+        }
+        return results;
+    }
+
+    bool PatternScanner::IsKernelSupported(Kernel kernel)
+    {
+        static const bool isAvx2Supported = CpuFeatures::IsAvx2Supported();
+
+        switch (kernel)
+        {
+            case Kernel::Reference:
+                return true;
+            case Kernel::Sse2:
+#ifdef IWXMVM_SIGNATURES_SSE2
+                return true;
+#else
+                return false;
+#endif
+            case Kernel::Avx2:
+#ifdef IWXMVM_SIGNATURES_AVX2
+                return isAvx2Supported;
+#else
+                return false;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    PatternScanner::Kernel PatternScanner::GetFastestKernel()
+    {
+        if (IsKernelSupported(Kernel::Avx2))
+            return Kernel::Avx2;
+        if (IsKernelSupported(Kernel::Sse2))
+            return Kernel::Sse2;
+        return Kernel::Reference;
+    }
+
+    const char* PatternScanner::GetKernelLabel(Kernel kernel)
+    {
+        switch (kernel)
+        {
+            case Kernel::Reference:
+                return "Reference";
+            case Kernel::Sse2:
+                return "SSE2";
+            case Kernel::Avx2:
+                return "AVX2";
+            default:
+                return "Unknown Kernel";
+        }
+    }
+
+    bool MatchesAt(std::span<const std::uint8_t> data, std::size_t offset, std::span<const std::uint16_t> pattern)
+    {
+        if (offset > data.size() || pattern.size() > data.size() - offset)
+            return false;
+
+        for (std::size_t i = 0; i < pattern.size(); i++)
+        {
+            if (pattern[i] != maskValue && pattern[i] != data[offset + i])
+                return false;
+        }
+        return true;
+    }
+
+    std::optional<std::size_t> FindPattern(std::span<const std::uint8_t> data, std::span<const std::uint16_t> pattern)
+    {
+        for (std::size_t start = 0; start + pattern.size() <= data.size(); start++)
+        {
+            if (MatchesAt(data, start, pattern))
+                return start;
+        }
+        return std::nullopt;
+    }
+}  // namespace IWXMVM::Signatures
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace IWXMVM
+{
+    class TaskPool;
+}  // namespace IWXMVM
+
+namespace IWXMVM::Signatures
+{
+    // marks a byte of a pattern that matches any byte
+    inline constexpr std::uint16_t maskValue = UINT8_MAX + 1;
+
+    // Finds a whole set of byte patterns in a single pass over the data, instead of a pass per pattern. Every pattern
+    // is anchored on the byte of it that is rarest in the data, so that only the positions holding one of the anchor
+    // bytes are looked at more closely; those are found 16 or 32 bytes at a time, like memchr does for a single byte.
+    // Patterns that were found are dropped from the set, and the scan stops as soon as all of them were found.
+    class PatternScanner
+    {
+       public:
+        enum class Kernel
+        {
+            Reference,  // plain scalar code the other kernels are checked against
+            Sse2,
+            Avx2,
+        };
+
+        // takes bytes and maskValue for wildcards, and returns the index its result is reported under. A pattern
+        // needs at least one byte that is not a wildcard.
+        std::size_t AddPattern(std::span<const std::uint16_t> pattern);
+        void Clear();
+
+        std::size_t GetPatternCount() const
+        {
+            return patterns.size();
+        }
+
+        // the offset of the first match of every pattern, in the order they were added
+        std::vector<std::optional<std::size_t>> Scan(std::span<const std::uint8_t> data) const;
+        std::vector<std::optional<std::size_t>> Scan(std::span<const std::uint8_t> data, Kernel kernel) const;
+        // splits the data into overlapping chunks that are scanned on the pool, with the same results
+        std::vector<std::optional<std::size_t>> Scan(std::span<const std::uint8_t> data, TaskPool& pool) const;
+
+        static bool IsKernelSupported(Kernel kernel);
+        static Kernel GetFastestKernel();
+        static const char* GetKernelLabel(Kernel kernel);
+
+       private:
+        struct Pattern
+        {
+            // padded with wildcards to a multiple of 16 bytes, so that they can be compared a vector at a time
+            std::vector<std::uint8_t> values;
+            std::vector<std::uint8_t> masks;  // 0xFF where the byte has to match
+            std::size_t length;
+        };
+
+        std::vector<Pattern> patterns;
+    };
+
+    // whether the pattern matches the data at offset, to check a single place instead of scanning
+    bool MatchesAt(std::span<const std::uint8_t> data, std::size_t offset, std::span<const std::uint16_t> pattern);
+
+    // a naive scan for a single pattern, to check the scanner against
+    std::optional<std::size_t> FindPattern(std::span<const std::uint8_t> data, std::span<const std::uint16_t> pattern);
+}  // namespace IWXMVM::Signatures
@@ -0,0 +1,159 @@
+#include "SignatureCache.hpp"
+
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+namespace IWXMVM::Signatures
+{
+    namespace
+    {
+        constexpr std::uint32_t CACHE_FILE_MAGIC = 0x43585749;  // "IWXC"
+        constexpr std::uint32_t CACHE_FILE_VERSION = 1;
+
+        constexpr std::uint64_t FNV_PRIME = 0x100000001B3;
+
+        constexpr std::size_t SAMPLE_CHUNK_SIZE = 256;
+        constexpr std::size_t SAMPLE_CHUNK_COUNT = 64;
+
+        struct CacheFileHeader
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint64_t identity;
+            std::uint64_t entryCount;
+            std::uint64_t checksum;
+        };
+
+        struct CacheFileEntry
+        {
+            std::uint64_t key;
+            std::uint64_t matchAddress;
+            std::uint64_t address;
+        };
+    }  // namespace
+
+    std::uint64_t HashBytes(std::uint64_t hash, std::span<const std::uint8_t> bytes)
+    {
+        for (const auto byte : bytes)
+        {
+            hash = (hash ^ byte) * FNV_PRIME;
+        }
+        return hash;
+    }
+
+    std::uint64_t HashString(std::uint64_t hash, std::string_view text)
+    {
+        const std::uint64_t length = text.size();
+        hash = HashBytes(hash, std::span(reinterpret_cast<const std::uint8_t*>(&length), sizeof(length)));
+        return HashBytes(hash, std::span(reinterpret_cast<const std::uint8_t*>(text.data()), text.size()));
+    }
+
+    std::uint64_t HashSampledBytes(std::uint64_t hash, std::span<const std::uint8_t> region)
+    {
+        if (region.size() <= SAMPLE_CHUNK_SIZE * SAMPLE_CHUNK_COUNT)
+            return HashBytes(hash, region);
+
+        const auto stride = (region.size() - SAMPLE_CHUNK_SIZE) / (SAMPLE_CHUNK_COUNT - 1);
+        for (std::size_t i = 0; i < SAMPLE_CHUNK_COUNT; i++)
+        {
+            hash = HashBytes(hash, region.subspan(i * stride, SAMPLE_CHUNK_SIZE));
+        }
+        return hash;
+    }
+
+    void SignatureCache::Reset(std::uint64_t cacheIdentity)
+    {
+        identity = cacheIdentity;
+        entries.clear();
+    }
+
+    bool SignatureCache::Load(const std::filesystem::path& path, std::uint64_t cacheIdentity)
+    {
+        Reset(cacheIdentity);
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        CacheFileHeader header = {};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CACHE_FILE_MAGIC ||
+            header.version != CACHE_FILE_VERSION || header.identity != cacheIdentity)
+        {
+            return false;
+        }
+
+        // a few hundred signatures at most, anything beyond that is a damaged file
+        constexpr std::uint64_t MAX_ENTRIES = 65536;
+        if (header.entryCount > MAX_ENTRIES)
+            return false;
+
+        std::vector<CacheFileEntry> fileEntries(static_cast<std::size_t>(header.entryCount));
+        const std::span fileBytes(reinterpret_cast<const std::uint8_t*>(fileEntries.data()),
+                                  fileEntries.size() * sizeof(CacheFileEntry));
+        if (!file.read(reinterpret_cast<char*>(fileEntries.data()), static_cast<std::streamsize>(fileBytes.size())) ||
+            HashBytes(HASH_SEED, fileBytes) != header.checksum)
+        {
+            return false;
+        }
+
+        for (const auto& entry : fileEntries)
+        {
+            entries[entry.key] = {entry.matchAddress, entry.address};
+        }
+        return true;
+    }
+
+    bool SignatureCache::Save(const std::filesystem::path& path) const
+    {
+        std::vector<CacheFileEntry> fileEntries;
+        fileEntries.reserve(entries.size());
+        for (const auto& [key, entry] : entries)
+        {
+            fileEntries.push_back({key, entry.matchAddress, entry.address});
+        }
+
+        const std::span fileBytes(reinterpret_cast<const std::uint8_t*>(fileEntries.data()),
+                                  fileEntries.size() * sizeof(CacheFileEntry));
+        const CacheFileHeader header = {CACHE_FILE_MAGIC, CACHE_FILE_VERSION, identity, fileEntries.size(),
+                                        HashBytes(HASH_SEED, fileBytes)};
+
+        std::error_code errorCode;
+        std::filesystem::create_directories(path.parent_path(), errorCode);
+
+        // written next to where it goes and renamed, so that a game that is closed halfway never leaves half a file
+        auto temporaryPath = path;
+        temporaryPath += ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(fileBytes.data()), static_cast<std::streamsize>(fileBytes.size()));
+            if (!file.flush())
+            {
+                file.close();
+                std::filesystem::remove(temporaryPath, errorCode);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, path, errorCode);
+        if (errorCode)
+        {
+            std::filesystem::remove(temporaryPath, errorCode);
+            return false;
+        }
+        return true;
+    }
+
+    std::optional<SignatureCache::Entry> SignatureCache::Find(std::uint64_t key) const
+    {
+        if (const auto it = entries.find(key); it != entries.end())
+            return it->second;
+        return std::nullopt;
+    }
+
+    void SignatureCache::Store(std::uint64_t key, Entry entry)
+    {
+        entries[key] = entry;
+    }
+}  // namespace IWXMVM::Signatures
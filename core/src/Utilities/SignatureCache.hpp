@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+
+namespace IWXMVM::Signatures
+{
+    inline constexpr std::uint64_t HASH_SEED = 0xCBF29CE484222325;
+
+    std::uint64_t HashBytes(std::uint64_t hash, std::span<const std::uint8_t> bytes);
+    std::uint64_t HashString(std::uint64_t hash, std::string_view text);
+    // hashes chunks spread evenly over the region, so that it costs the same few kilobytes for any size
+    std::uint64_t HashSampledBytes(std::uint64_t hash, std::span<const std::uint8_t> region);
+
+    // Where signatures were found and the addresses they resolved to, saved between game launches. The cache belongs
+    // to one identity (a hash of the game modules and the mod build it was made with), and is dropped as a whole for
+    // any other, since the addresses only hold for that exact combination.
+    class SignatureCache
+    {
+       public:
+        struct Entry
+        {
+            std::uint64_t matchAddress;  // where the signature's bytes were found, to check them again
+            std::uint64_t address;       // after the offset and the callable were applied
+        };
+
+        void Reset(std::uint64_t cacheIdentity);
+        // fails if the file is missing, damaged, or belongs to another identity
+        bool Load(const std::filesystem::path& path, std::uint64_t cacheIdentity);
+        bool Save(const std::filesystem::path& path) const;
+
+        std::optional<Entry> Find(std::uint64_t key) const;
+        void Store(std::uint64_t key, Entry entry);
+
+        std::size_t GetEntryCount() const
+        {
+            return entries.size();
+        }
+
+       private:
+        std::uint64_t identity = 0;
+        std::unordered_map<std::uint64_t, Entry> entries;
+    };
+}  // namespace IWXMVM::Signatures
@@ -1,6 +1,10 @@
 #pragma once
 #include "StdInclude.hpp"
 #include "Mod.hpp"
+#include "Utilities/PathUtils.hpp"
+#include "Utilities/PatternScanner.hpp"
+#include "Utilities/SignatureCache.hpp"
+#include "Utilities/Tracer.hpp"
 
 namespace IWXMVM::Signatures
 {
@@ -35,8 +39,6 @@ namespace IWXMVM::Signatures
         };
     }  // namespace Lambdas
 
-    inline constexpr std::uint16_t maskValue = UINT8_MAX + 1;
-
     enum struct GameAddressType : std::uint8_t
     {
         Data = 4,
@@ -155,37 +157,6 @@ namespace IWXMVM::Signatures
         return bytes;
     }
 
-    inline std::uintptr_t SignatureScanner(const auto& signature, const auto& moduleHandles)
-    {
-        for (const auto handle : moduleHandles)
-        {
-            MODULEINFO process{};
-
-            if (!::GetModuleInformation(::GetCurrentProcess(), handle, &process, sizeof(process)) ||
-                !process.lpBaseOfDll)
-                return 0;
-
-            const std::uintptr_t endOfDll = reinterpret_cast<std::uintptr_t>(process.lpBaseOfDll) + process.SizeOfImage;
-
-            for (std::uintptr_t i = reinterpret_cast<std::uintptr_t>(process.lpBaseOfDll); i < endOfDll; ++i)
-            {
-                std::size_t j = signature._frontMaskCount;
-
-                for (; j < signature._bytes.size(); ++j)
-                {
-                    if (signature._bytes[j] != maskValue &&
-                        signature._bytes[j] != *reinterpret_cast<std::uint8_t*>(i + j))
-                        break;
-                }
-
-                if (j == signature._bytes.size())
-                    return i + signature._offset;
-            }
-        }
-
-        return 0;
-    }
-
     using callable_t = decltype([]() {});
 
     template <std::size_t size, typename Callable = callable_t>
@@ -204,36 +175,32 @@ namespace IWXMVM::Signatures
             static_assert(size > 0);
         }
 
-        auto Scan(const auto& moduleHandles) const
+        // applies the offset and the callable to where the signature was found
+        std::uintptr_t Resolve(std::uintptr_t match) const
         {
-            const std::uintptr_t address = SignatureScanner(*this, moduleHandles);
+            const std::uintptr_t address = match + _offset;
 
-            if (address == 0)
-                throw std::runtime_error(std::format("Failed to find signature:\n\t {}", _string.data()));
-            else
+            if constexpr (requires { std::declval<Callable>()(address); })
             {
-                if constexpr (requires { std::declval<Callable>()(address); })
+                try
                 {
-                    try
-                    {
-                        const std::uintptr_t newAddress = _callable(address);
-                        if (newAddress == 0)
-                            throw std::runtime_error(std::format(
-                                "Failed to find correct game address (1), signature:\n\t {}", _string.data()));
+                    const std::uintptr_t newAddress = _callable(address);
+                    if (newAddress == 0)
+                        throw std::runtime_error(std::format(
+                            "Failed to find correct game address (1), signature:\n\t {}", _string.data()));
 
-                        return newAddress;
-                    }
-                    catch (...)
-                    {
-                        throw std::runtime_error(
-                            std::format("Failed to find correct game address (2), signature:\n\t {}", _string.data()));
-                    }
-
-                    return std::uintptr_t{};
+                    return newAddress;
                 }
-                else
-                    return address;
+                catch (...)
+                {
+                    throw std::runtime_error(
+                        std::format("Failed to find correct game address (2), signature:\n\t {}", _string.data()));
+                }
+
+                return std::uintptr_t{};
             }
+            else
+                return address;
         }
 
         std::array<char, size> _string{};
@@ -243,13 +210,250 @@ namespace IWXMVM::Signatures
         Callable _callable;
     };
 
+    // A signature that was constructed but not scanned for yet. Signatures are collected while the address struct is
+    // constructed, so that ResolvePendingSignatures can scan every module once for all of them.
+    struct PendingSignature
+    {
+        std::span<const std::uint16_t> bytes;
+        const char* string;
+        Types::ModuleType moduleType;
+        std::uintptr_t* address;
+        std::uintptr_t (*resolve)(std::uintptr_t match);
+    };
+
+    inline std::vector<PendingSignature>& GetPendingSignatures()
+    {
+        static std::vector<PendingSignature> pendingSignatures;
+        return pendingSignatures;
+    }
+
+    // the loaded images of the modules, up to the first one that can't be queried
+    inline std::vector<std::span<const std::uint8_t>> GetModuleImages(std::span<HMODULE> handles)
+    {
+        std::vector<std::span<const std::uint8_t>> images;
+        for (const auto handle : handles)
+        {
+            MODULEINFO process{};
+
+            if (!::GetModuleInformation(::GetCurrentProcess(), handle, &process, sizeof(process)) ||
+                !process.lpBaseOfDll)
+                break;
+
+            images.emplace_back(static_cast<const std::uint8_t*>(process.lpBaseOfDll), process.SizeOfImage);
+        }
+        return images;
+    }
+
+    // Hashes where a game module is loaded, its size and link timestamp, and a sample of its headers and read-only
+    // sections. The cached addresses are absolute, so they only hold for the same load base. The signatures are checked
+    // again at their cached addresses, so a sample is enough to tell builds apart without reading the whole module.
+    inline std::uint64_t HashModuleImage(std::uint64_t hash, std::span<const std::uint8_t> image)
+    {
+        const auto* dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(image.data());
+        const auto* ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS*>(image.data() + dosHeader->e_lfanew);
+
+        const std::uint64_t identity[] = {reinterpret_cast<std::uintptr_t>(image.data()), image.size(),
+                                          ntHeaders->FileHeader.TimeDateStamp};
+        hash = HashBytes(hash, std::span(reinterpret_cast<const std::uint8_t*>(identity), sizeof(identity)));
+        hash = HashSampledBytes(hash, image.first(std::min<std::size_t>(ntHeaders->OptionalHeader.SizeOfHeaders,
+                                                                        image.size())));
+
+        const auto* section = IMAGE_FIRST_SECTION(ntHeaders);
+        for (std::size_t i = 0; i < ntHeaders->FileHeader.NumberOfSections; ++i, ++section)
+        {
+            if ((section->Characteristics & IMAGE_SCN_MEM_WRITE) != 0 || section->VirtualAddress >= image.size())
+                continue;
+
+            hash = HashSampledBytes(hash, image.subspan(section->VirtualAddress,
+                                                        std::min<std::size_t>(section->Misc.VirtualSize,
+                                                                              image.size() - section->VirtualAddress)));
+        }
+        return hash;
+    }
+
+    // Hashes the mod's link timestamp, image size and a sample of its file on disk. The mod is rebased by ASLR from
+    // one launch to the next, so unlike for the game modules, neither its load base nor its relocated sections can be
+    // part of this, or the cache would never survive a reboot.
+    inline std::uint64_t HashModFile(std::uint64_t hash, HMODULE module)
+    {
+        const auto* base = reinterpret_cast<const std::uint8_t*>(module);
+        const auto* dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(base);
+        const auto* ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS*>(base + dosHeader->e_lfanew);
+
+        std::vector<std::uint8_t> fileBytes;
+        wchar_t path[MAX_PATH] = {};
+        const auto pathLength = ::GetModuleFileNameW(module, path, MAX_PATH);
+        if (pathLength != 0 && pathLength < MAX_PATH)
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (file)
+            {
+                fileBytes.resize(static_cast<std::size_t>(file.tellg()));
+                file.seekg(0);
+                const auto size = static_cast<std::streamsize>(fileBytes.size());
+                if (!file.read(reinterpret_cast<char*>(fileBytes.data()), size))
+                    fileBytes.clear();
+            }
+        }
+
+        const std::uint64_t identity[] = {ntHeaders->FileHeader.TimeDateStamp, ntHeaders->OptionalHeader.SizeOfImage,
+                                          fileBytes.size()};
+        hash = HashBytes(hash, std::span(reinterpret_cast<const std::uint8_t*>(identity), sizeof(identity)));
+        return HashSampledBytes(hash, fileBytes);
+    }
+
+    inline bool IsInModuleImages(std::span<const std::span<const std::uint8_t>> images, std::uintptr_t address,
+                                 std::span<const std::uint16_t> bytes)
+    {
+        for (const auto image : images)
+        {
+            const auto base = reinterpret_cast<std::uintptr_t>(image.data());
+            if (address >= base && address < base + image.size())
+                return MatchesAt(image, address - base, bytes);
+        }
+        return false;
+    }
+
+    // Resolves all signatures that were constructed since the last call and writes their addresses. Throws for the
+    // first signature (in the order they were constructed) that is not found, like scanning them one by one did.
+    //
+    // Signatures are first checked at the addresses they had on the last launch, which are cached as long as the game
+    // modules and the mod are the same. Only the ones that are not there anymore are scanned for, with one scan per
+    // module for all of them, split up over the startup threads while there are any.
+    inline void ResolvePendingSignatures()
+    {
+        const auto pending = std::exchange(GetPendingSignatures(), {});
+        std::vector<std::optional<std::uintptr_t>> matches(pending.size());
+        std::vector<std::optional<std::uintptr_t>> cachedAddresses(pending.size());
+
+        // modules of types that the game doesn't have are left out, and their signatures keep address 0
+        std::map<Types::ModuleType, std::vector<std::span<const std::uint8_t>>> moduleImages;
+        for (const auto& signature : pending)
+        {
+            if (moduleImages.contains(signature.moduleType))
+                continue;
+
+            if (const auto modules = Mod::GetGameInterface()->GetModuleHandles(signature.moduleType);
+                modules.has_value())
+                moduleImages[signature.moduleType] = GetModuleImages(modules.value());
+        }
+
+        // the mod's own build is part of the identity, so that changed signatures or callables are never cached
+        HMODULE modModule = nullptr;
+        std::uint64_t identity = HASH_SEED;
+        if (::GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                 reinterpret_cast<LPCSTR>(&GetPendingSignatures), &modModule))
+        {
+            identity = HashModFile(identity, modModule);
+        }
+        for (const auto& [moduleType, images] : moduleImages)
+        {
+            identity = HashString(identity, magic_enum::enum_name(moduleType));
+            for (const auto image : images)
+                identity = HashModuleImage(identity, image);
+        }
+
+        // signatures with the same string are told apart by the order they were constructed in
+        std::vector<std::uint64_t> keys(pending.size());
+        std::map<std::uint64_t, std::uint32_t> keyCounts;
+        for (std::size_t i = 0; i < pending.size(); ++i)
+        {
+            const auto key =
+                HashString(HashString(HASH_SEED, magic_enum::enum_name(pending[i].moduleType)), pending[i].string);
+            const auto occurrence = keyCounts[key]++;
+            keys[i] = HashBytes(key, std::span(reinterpret_cast<const std::uint8_t*>(&occurrence), sizeof(occurrence)));
+        }
+
+        const auto cachePath = PathUtils::GetIWXMVMPath() / "signatures.cache";
+        SignatureCache cache;
+        bool isCacheChanged = !cache.Load(cachePath, identity);
+
+        std::size_t cachedCount = 0;
+        for (std::size_t i = 0; i < pending.size(); ++i)
+        {
+            IWXMVM_TRACE_ZONE(pending[i].string);
+            const auto images = moduleImages.find(pending[i].moduleType);
+            const auto entry = cache.Find(keys[i]);
+            if (images == moduleImages.end() || !entry.has_value())
+                continue;
+
+            const auto matchAddress = static_cast<std::uintptr_t>(entry->matchAddress);
+            if (IsInModuleImages(images->second, matchAddress, pending[i].bytes))
+            {
+                matches[i] = matchAddress;
+                cachedAddresses[i] = static_cast<std::uintptr_t>(entry->address);
+                ++cachedCount;
+            }
+        }
+
+        for (const auto& [moduleType, images] : moduleImages)
+        {
+            // signatures that are not found in a module are looked for in the next one
+            for (const auto image : images)
+            {
+                IWXMVM_TRACE_ZONE("Scan module");
+                PatternScanner scanner;
+                std::vector<std::size_t> scanned;
+                for (std::size_t i = 0; i < pending.size(); ++i)
+                {
+                    if (pending[i].moduleType == moduleType && !matches[i].has_value())
+                    {
+                        scanner.AddPattern(pending[i].bytes);
+                        scanned.push_back(i);
+                    }
+                }
+
+                if (scanned.empty())
+                    break;
+
+                const auto base = reinterpret_cast<std::uintptr_t>(image.data());
+                auto* tasks = Mod::GetStartupTasks();
+                const auto results = tasks != nullptr ? scanner.Scan(image, *tasks) : scanner.Scan(image);
+                for (std::size_t i = 0; i < scanned.size(); ++i)
+                {
+                    if (results[i].has_value())
+                        matches[scanned[i]] = base + results[i].value();
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < pending.size(); ++i)
+        {
+            if (!moduleImages.contains(pending[i].moduleType))
+                continue;
+
+            if (!matches[i].has_value())
+                throw std::runtime_error(std::format("Failed to find signature:\n\t {}", pending[i].string));
+
+            if (cachedAddresses[i].has_value())
+            {
+                *pending[i].address = cachedAddresses[i].value();
+                continue;
+            }
+
+            IWXMVM_TRACE_ZONE(pending[i].string);
+            *pending[i].address = pending[i].resolve(matches[i].value());
+            cache.Store(keys[i], {matches[i].value(), *pending[i].address});
+            isCacheChanged = true;
+        }
+
+        LOG_DEBUG("Resolved {} of {} signatures from the cache", cachedCount, pending.size());
+        if (isCacheChanged && !cache.Save(cachePath))
+            LOG_WARN("Failed to write signature cache to {}", cachePath.string());
+    }
+
     template <auto intSignature, Types::ModuleType type = Types::ModuleType::BaseModule>
     struct Signature
     {
-        constexpr Signature()
+        // only registers the signature, its address is written by ResolvePendingSignatures
+        Signature()
+        {
+            GetPendingSignatures().push_back({_signature._bytes, _signature._string.data(), type, &_address, &Resolve});
+        }
+
+        static std::uintptr_t Resolve(std::uintptr_t match)
         {
-            if (const auto modules = Mod::GetGameInterface()->GetModuleHandles(type); modules.has_value())
-                _address = _signature.Scan(modules.value());
+            return _signature.Resolve(match);
         }
 
         static constexpr auto _signature = intSignature;
@@ -0,0 +1,57 @@
+#include "TaskPool.hpp"
+
+#include <algorithm>
+
+namespace IWXMVM
+{
+    TaskPool::TaskPool(std::size_t threadCount)
+    {
+        threadCount = std::max<std::size_t>(threadCount, 1);
+        for (std::size_t i = 0; i < threadCount; i++)
+        {
+            workers.emplace_back([this]() { RunWorker(); });
+        }
+    }
+
+    TaskPool::~TaskPool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            isStopping = true;
+        }
+        condition.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void TaskPool::Enqueue(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        condition.notify_one();
+    }
+
+    void TaskPool::RunWorker()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [this]() { return isStopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+
+            task();
+        }
+    }
+}  // namespace IWXMVM
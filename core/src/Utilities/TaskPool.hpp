@@ -0,0 +1,53 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace IWXMVM
+{
+    // A few worker threads for splitting up work that would otherwise run one piece after the other, like the startup.
+    // Tasks start in the order they were submitted. A task must not wait for another one, since with all workers
+    // waiting nothing would be left to run it. Destroying the pool runs the tasks that are still queued first.
+    class TaskPool
+    {
+       public:
+        explicit TaskPool(std::size_t threadCount);
+        ~TaskPool();
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        // the future holds the result, or rethrows what the task threw
+        template <typename Function>
+        std::future<std::invoke_result_t<Function>> Submit(Function&& function)
+        {
+            using Result = std::invoke_result_t<Function>;
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+            auto future = task->get_future();
+            Enqueue([task]() { (*task)(); });
+            return future;
+        }
+
+        std::size_t GetThreadCount() const
+        {
+            return workers.size();
+        }
+
+       private:
+        void Enqueue(std::function<void()> task);
+        void RunWorker();
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<std::function<void()>> tasks;
+        bool isStopping = false;
+        std::vector<std::thread> workers;
+    };
+}  // namespace IWXMVM
@@ -0,0 +1,210 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace IWXMVM::Tracing
+{
+    using Clock = std::chrono::steady_clock;
+
+    // a small number per thread in the order threads first record something, which reads better in a trace viewer
+    // than the operating system's thread ids
+    inline std::uint32_t GetThreadIndex()
+    {
+        static std::atomic<std::uint32_t> nextIndex = 1;
+        thread_local const std::uint32_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    struct TraceEvent
+    {
+        const char* name;  // not copied, so it has to live as long as the tracer (a string literal, usually)
+        std::uint32_t threadIndex;
+        Clock::time_point begin;
+        Clock::time_point end;
+    };
+
+    namespace Detail
+    {
+        inline void AppendEscaped(std::string& json, const char* text)
+        {
+            for (; *text != '\0'; text++)
+            {
+                const auto character = static_cast<unsigned char>(*text);
+                if (character == '"' || character == '\\')
+                {
+                    json += '\\';
+                    json += *text;
+                }
+                else if (character < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", character);
+                    json += escaped;
+                }
+                else
+                {
+                    json += *text;
+                }
+            }
+        }
+    }  // namespace Detail
+
+    // complete events ("ph": "X") in microseconds since origin, for chrome://tracing and Perfetto
+    inline std::string ToChromeTraceJson(std::span<const TraceEvent> events, Clock::time_point origin)
+    {
+        const auto toMicroseconds = [](Clock::duration duration) {
+            return std::chrono::duration<double, std::micro>(duration).count();
+        };
+
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (std::size_t i = 0; i < events.size(); i++)
+        {
+            const auto& event = events[i];
+            if (i > 0)
+                json += ',';
+
+            json += "\n{\"name\":\"";
+            Detail::AppendEscaped(json, event.name);
+
+            char fields[128];
+            std::snprintf(fields, sizeof(fields), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                          event.threadIndex, toMicroseconds(event.begin - origin),
+                          toMicroseconds(event.end - event.begin));
+            json += fields;
+        }
+        json += "\n]}\n";
+        return json;
+    }
+
+    inline bool WriteChromeTrace(const std::filesystem::path& path, std::span<const TraceEvent> events,
+                                 Clock::time_point origin)
+    {
+        std::error_code errorCode;
+        std::filesystem::create_directories(path.parent_path(), errorCode);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        const auto json = ToChromeTraceJson(events, origin);
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        return static_cast<bool>(file.flush());
+    }
+
+    // Collects timed zones from any thread, to be written as a trace that chrome://tracing and Perfetto can open. A
+    // zone costs a lock and a push, so zones belong around work that takes at least microseconds, like the
+    // initialization phases.
+    class Tracer
+    {
+       public:
+        // beyond this, zones are dropped rather than growing without end when a zone ends up in per-frame code
+        static constexpr std::size_t MAX_EVENTS = 1 << 16;
+
+        static Tracer& Get()
+        {
+            static Tracer instance;
+            return instance;
+        }
+
+        Tracer() = default;
+        Tracer(Tracer const&) = delete;
+        void operator=(Tracer const&) = delete;
+
+        void SetEnabled(bool isEnabled)
+        {
+            enabled.store(isEnabled, std::memory_order_relaxed);
+        }
+
+        bool IsEnabled() const
+        {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        void Record(const char* name, Clock::time_point begin, Clock::time_point end)
+        {
+            const auto threadIndex = GetThreadIndex();
+            std::lock_guard lock(mutex);
+            if (events.size() >= MAX_EVENTS)
+            {
+                droppedCount++;
+                return;
+            }
+            events.push_back({name, threadIndex, begin, end});
+        }
+
+        std::vector<TraceEvent> GetEvents() const
+        {
+            std::lock_guard lock(mutex);
+            return events;
+        }
+
+        std::size_t GetDroppedCount() const
+        {
+            std::lock_guard lock(mutex);
+            return droppedCount;
+        }
+
+        void Clear()
+        {
+            std::lock_guard lock(mutex);
+            events.clear();
+            droppedCount = 0;
+        }
+
+        // complete events ("ph": "X") in microseconds since the tracer was created
+        std::string ToChromeTraceJson() const
+        {
+            return Tracing::ToChromeTraceJson(GetEvents(), origin);
+        }
+
+        bool WriteChromeTrace(const std::filesystem::path& path) const
+        {
+            return Tracing::WriteChromeTrace(path, GetEvents(), origin);
+        }
+
+       private:
+        mutable std::mutex mutex;
+        std::vector<TraceEvent> events;
+        std::size_t droppedCount = 0;
+        const Clock::time_point origin = Clock::now();
+        std::atomic<bool> enabled = true;
+    };
+
+    // Records its lifetime as a zone; does nothing while the tracer is disabled
+    class ScopedZone
+    {
+       public:
+        explicit ScopedZone(const char* name, Tracer& tracer = Tracer::Get())
+            : tracer(tracer),
+              name(tracer.IsEnabled() ? name : nullptr),
+              begin(this->name ? Clock::now() : Clock::time_point{})
+        {
+        }
+
+        ~ScopedZone()
+        {
+            if (name)
+            {
+                tracer.Record(name, begin, Clock::now());
+            }
+        }
+
+        ScopedZone(ScopedZone const&) = delete;
+        void operator=(ScopedZone const&) = delete;
+
+       private:
+        Tracer& tracer;
+        const char* name;
+        Clock::time_point begin;
+    };
+}  // namespace IWXMVM::Tracing
+
+#define IWXMVM_TRACE_CONCAT_INNER(a, b) a##b
+#define IWXMVM_TRACE_CONCAT(a, b) IWXMVM_TRACE_CONCAT_INNER(a, b)
+#define IWXMVM_TRACE_ZONE(name) ::IWXMVM::Tracing::ScopedZone IWXMVM_TRACE_CONCAT(traceZone, __LINE__)(name)
@@ -0,0 +1,139 @@
+// Turns the OBJ models in resources into mesh blobs before the build embeds them, so that the mod never parses OBJ
+// text. Vertices that are the same in position, normal and color are merged, like they were when the models were
+// parsed at startup.
+//
+// usage: MeshBaker <output directory> <model.obj>...
+//
+// Every model is written to <output directory>/<model>.mesh. Blobs that would not change are not written again, so
+// that the resources that embed them are not rebuilt every time.
+#include "Graphics/MeshBlob.hpp"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+    using namespace IWXMVM::GFX;
+
+    // D3DCOLOR_COLORVALUE without d3d9.h
+    std::uint32_t ToColor(float r, float g, float b, float a)
+    {
+        const auto channel = [](float value) { return static_cast<std::uint32_t>(value * 255.0f) & 0xFF; };
+        return channel(a) << 24 | channel(r) << 16 | channel(g) << 8 | channel(b);
+    }
+
+    struct VertexHash
+    {
+        std::size_t operator()(const BakedVertex& vertex) const
+        {
+            return std::hash<std::string_view>()(
+                std::string_view(reinterpret_cast<const char*>(&vertex), sizeof(vertex)));
+        }
+    };
+
+    struct VertexEqual
+    {
+        bool operator()(const BakedVertex& a, const BakedVertex& b) const
+        {
+            return std::memcmp(&a, &b, sizeof(a)) == 0;
+        }
+    };
+
+    bool BakeModel(const std::filesystem::path& modelPath, const std::filesystem::path& outputPath)
+    {
+        tinyobj::ObjReader reader;
+        if (!reader.ParseFromFile(modelPath.string()))
+        {
+            std::fprintf(stderr, "%s: %s\n", modelPath.string().c_str(), reader.Error().c_str());
+            return false;
+        }
+
+        if (!reader.Warning().empty())
+        {
+            std::fprintf(stderr, "%s: %s\n", modelPath.string().c_str(), reader.Warning().c_str());
+        }
+
+        const auto& attrib = reader.GetAttrib();
+        std::vector<BakedVertex> vertices;
+        std::vector<std::uint32_t> indices;
+        std::unordered_map<BakedVertex, std::uint32_t, VertexHash, VertexEqual> uniqueVertices;
+        for (const auto& shape : reader.GetShapes())
+        {
+            for (const auto& index : shape.mesh.indices)
+            {
+                BakedVertex vertex = {};
+                for (std::size_t i = 0; i < 3; i++)
+                {
+                    vertex.position[i] = attrib.vertices[index.vertex_index * 3 + i];
+                    vertex.normal[i] = attrib.normals[index.normal_index * 3 + i];
+                }
+                vertex.color = ToColor(attrib.colors[index.vertex_index * 3 + 0],
+                                       attrib.colors[index.vertex_index * 3 + 1],
+                                       attrib.colors[index.vertex_index * 3 + 2], 1.0f);
+
+                const auto [it, isNew] =
+                    uniqueVertices.try_emplace(vertex, static_cast<std::uint32_t>(vertices.size()));
+                if (isNew)
+                {
+                    vertices.push_back(vertex);
+                }
+                indices.push_back(it->second);
+            }
+        }
+
+        const auto blob = WriteMeshBlob(vertices, indices);
+
+        std::ifstream existingFile(outputPath, std::ios::binary);
+        const std::vector<std::uint8_t> existingBlob((std::istreambuf_iterator<char>(existingFile)),
+                                                     std::istreambuf_iterator<char>());
+        if (existingBlob == blob)
+        {
+            return true;
+        }
+        existingFile.close();
+
+        std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+        if (!file.flush())
+        {
+            std::fprintf(stderr, "Failed to write %s\n", outputPath.string().c_str());
+            return false;
+        }
+
+        std::printf("Baked %s: %zu vertices, %zu indices\n", modelPath.filename().string().c_str(), vertices.size(),
+                    indices.size());
+        return true;
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: MeshBaker <output directory> <model.obj>...\n");
+        return 2;
+    }
+
+    const std::filesystem::path outputDirectory = argv[1];
+    std::error_code errorCode;
+    std::filesystem::create_directories(outputDirectory, errorCode);
+
+    bool succeeded = true;
+    for (int i = 2; i < argc; i++)
+    {
+        const std::filesystem::path modelPath = argv[i];
+        auto outputPath = outputDirectory / modelPath.filename();
+        outputPath.replace_extension(".mesh");
+        succeeded &= BakeModel(modelPath, outputPath);
+    }
+
+    return succeeded ? 0 : 1;
+}
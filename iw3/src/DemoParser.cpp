@@ -123,13 +123,14 @@ namespace IWXMVM::IW3::DemoParser
                 demoStartTick = demoEndTick = 0;
                 LOG_ERROR("Could not determine demo length due to invalid archives. Cannot render timeline.");
             }
-
-            Events::Invoke(EventType::OnDemoBoundsDetermined);
         }
         else
         {
             LOG_ERROR("Could not determine demo length due to lack of 256 client archives (found {0})",
                       archives.size());
         }
+
+        // also when they couldn't be determined, so that nothing keeps the bounds of the previous demo
+        Events::Invoke<EventType::OnDemoBoundsDetermined>(Events::DemoBounds{demoStartTick, demoEndTick});
     }
 }  // namespace IWXMVM::IW3::DemoParser
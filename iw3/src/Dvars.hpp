@@ -0,0 +1,63 @@
+#pragma once
+#include "StdInclude.hpp"
+#include "DvarHandle.hpp"
+
+namespace IWXMVM::IW3
+{
+    // The dvars that are read or written every frame, or whenever the visuals or the camera change. They are looked up
+    // once, and again after vid_restart and after a server changed them (see Hooks/Dvars.cpp).
+    struct IW3Dvars
+    {
+        DvarHandle<bool> cl_ingame{"cl_ingame"};
+        DvarHandle<bool> raw_input{"raw_input"};
+        DvarHandle<bool> sv_cheats{"sv_cheats"};
+        DvarHandle<float> cg_fov{"cg_fov"};
+
+        DvarHandle<bool> cg_thirdperson{"cg_thirdperson"};
+        DvarHandle<float> r_lodBiasRigid{"r_lodBiasRigid"};
+        DvarHandle<float> r_lodBiasSkinned{"r_lodBiasSkinned"};
+
+        DvarHandle<glm::vec4> r_lightTweakSunDirection{"r_lightTweakSunDirection"};
+        DvarHandle<std::int32_t> r_lightTweakSunColor{"r_lightTweakSunColor"};
+        DvarHandle<float> r_lightTweakSunLight{"r_lightTweakSunLight"};
+
+        DvarHandle<bool> r_dof_tweak{"r_dof_tweak"};
+        DvarHandle<bool> r_dof_enable{"r_dof_enable"};
+        DvarHandle<float> r_dof_farBlur{"r_dof_farBlur"};
+        DvarHandle<float> r_dof_farStart{"r_dof_farStart"};
+        DvarHandle<float> r_dof_farEnd{"r_dof_farEnd"};
+        DvarHandle<float> r_dof_nearBlur{"r_dof_nearBlur"};
+        DvarHandle<float> r_dof_nearStart{"r_dof_nearStart"};
+        DvarHandle<float> r_dof_nearEnd{"r_dof_nearEnd"};
+        DvarHandle<float> r_dof_bias{"r_dof_bias"};
+
+        DvarHandle<bool> r_filmUseTweaks{"r_filmUseTweaks"};
+        DvarHandle<bool> r_filmTweakEnable{"r_filmTweakEnable"};
+        DvarHandle<float> r_filmTweakBrightness{"r_filmTweakBrightness"};
+        DvarHandle<float> r_filmTweakContrast{"r_filmTweakContrast"};
+        DvarHandle<float> r_filmTweakDesaturation{"r_filmTweakDesaturation"};
+        DvarHandle<glm::vec4> r_filmTweakLightTint{"r_filmTweakLightTint"};
+        DvarHandle<glm::vec4> r_filmTweakDarkTint{"r_filmTweakDarkTint"};
+        DvarHandle<bool> r_filmTweakInvert{"r_filmTweakInvert"};
+
+        DvarHandle<bool> cg_draw2D{"cg_draw2D"};
+        DvarHandle<bool> cg_drawShellshock{"cg_drawShellshock"};
+        DvarHandle<bool> ui_hud_hardcore{"ui_hud_hardcore"};
+        DvarHandle<bool> ui_drawCrosshair{"ui_drawCrosshair"};
+        DvarHandle<const char*> ui_hud_obituaries{"ui_hud_obituaries"};
+        DvarHandle<const char*> g_TeamColor_Allies{"g_TeamColor_Allies"};
+        DvarHandle<const char*> g_TeamColor_Axis{"g_TeamColor_Axis"};
+        DvarHandle<float> cg_centertime{"cg_centertime"};
+        DvarHandle<float> cg_overheadranksize{"cg_overheadranksize"};
+        DvarHandle<float> cg_overheadnamessize{"cg_overheadnamessize"};
+        DvarHandle<float> cg_overheadiconsize{"cg_overheadiconsize"};
+        DvarHandle<float> con_gamemsgwindow0msgtime{"con_gamemsgwindow0msgtime"};
+        DvarHandle<std::int32_t> con_gamemsgwindow0linecount{"con_gamemsgwindow0linecount"};
+    };
+
+    inline IW3Dvars& GetDvars()
+    {
+        static IW3Dvars dvars;
+        return dvars;
+    }
+}  // namespace IWXMVM::IW3
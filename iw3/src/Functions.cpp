@@ -43,7 +43,7 @@ namespace IWXMVM::IW3::Functions
     // TODO: now this should really not belong in a file called "Structures.cpp"...
     void Cbuf_AddText(std::string command)
     {
-        LOG_DEBUG("Executing command \"{0}\"", command);
+        LOG_CATEGORY_DEBUG(Commands, "Executing command \"{0}\"", command);
 
         command.append("\n");
 
@@ -4,6 +4,7 @@
 #include "Hooks/Commands.hpp"
 #include "Hooks/Playback.hpp"
 #include "Hooks/Camera.hpp"
+#include "Hooks/Dvars.hpp"
 #include "Hooks/PlayerAnimation.hpp"
 #include "Hooks/HUD.hpp"
 
@@ -14,6 +15,7 @@ namespace IWXMVM::IW3::Hooks
         Hooks::Playback::Install();
         Hooks::Commands::Install();
         Hooks::Camera::Install();
+        Hooks::Dvars::Install();
         Hooks::PlayerAnimation::Install();
         Hooks::HUD::Install();
     }
@@ -1,11 +1,13 @@
 #include "StdInclude.hpp"
 #include "Camera.hpp"
 
+#include "Utilities/FrameProfiler.hpp"
 #include "Utilities/HookManager.hpp"
 #include "Utilities/MathUtils.hpp"
 #include "../Structures.hpp"
 #include "../Functions.hpp"
 #include "../Addresses.hpp"
+#include "../Dvars.hpp"
 #include "Mod.hpp"
 
 namespace IWXMVM::IW3::Hooks::Camera
@@ -13,6 +15,7 @@ namespace IWXMVM::IW3::Hooks::Camera
 
     void R_SetViewParmsForScene()
     {
+        IWXMVM_PROFILE_ZONE("R_SetViewParmsForScene");
         auto& refdef = Structures::GetClientGlobals()->refdef;
 
         auto& camera = Components::CameraManager::Get().GetActiveCamera();
@@ -74,6 +77,7 @@ namespace IWXMVM::IW3::Hooks::Camera
 
     void FX_SetupCamera()
     {
+        IWXMVM_PROFILE_ZONE("FX_SetupCamera");
         auto& camera = Components::CameraManager::Get().GetActiveCamera();
 
         if (!camera->IsModControlledCameraMode())
@@ -144,13 +148,13 @@ namespace IWXMVM::IW3::Hooks::Camera
         auto& camera = Components::CameraManager::Get().GetActiveCamera();
         auto isFreeCamera = camera->IsModControlledCameraMode();
 
-        Functions::FindDvar("cg_thirdperson")->current.enabled =
-            (camera->GetMode() == Components::Camera::Mode::ThirdPerson || isFreeCamera) ? 1 : 0;
-        Functions::FindDvar("cg_draw2d")->current.enabled = (isFreeCamera) ? 0 : 1;
-        Functions::FindDvar("cg_drawShellshock")->current.enabled = (isFreeCamera) ? 0 : 1;
+        auto& dvars = GetDvars();
+        dvars.cg_thirdperson.Set(camera->GetMode() == Components::Camera::Mode::ThirdPerson || isFreeCamera);
+        dvars.cg_draw2D.Set(!isFreeCamera);
+        dvars.cg_drawShellshock.Set(!isFreeCamera);
 
         constexpr int32_t LODBIAS = -40000;
-        Functions::FindDvar("r_lodBiasRigid")->current.value = LODBIAS;
-        Functions::FindDvar("r_lodBiasSkinned")->current.value = LODBIAS;
+        dvars.r_lodBiasRigid.Set(LODBIAS);
+        dvars.r_lodBiasSkinned.Set(LODBIAS);
     }
 }  // namespace IWXMVM::IW3::Hooks::Camera
@@ -0,0 +1,63 @@
+#include "StdInclude.hpp"
+#include "Dvars.hpp"
+
+#include "Utilities/HookManager.hpp"
+#include "../Addresses.hpp"
+#include "Mod.hpp"
+
+namespace IWXMVM::IW3::Hooks::Dvars
+{
+    // Dvar handles keep pointers to the dvars they resolved. These hooks make them look their dvars up again whenever
+    // the game may have registered dvars again: on vid_restart, and when a server sends new dvar values.
+
+    void InvalidateDvars()
+    {
+        Mod::GetGameInterface()->InvalidateDvars();
+    }
+
+    typedef void (*CL_Vid_Restart_f_t)();
+    CL_Vid_Restart_f_t CL_Vid_Restart_f_Trampoline;
+    void CL_Vid_Restart_f_Hook()
+    {
+        CL_Vid_Restart_f_Trampoline();
+        InvalidateDvars();
+    }
+
+    // the local client number is passed in eax, so the registers are left as they were
+    uintptr_t CL_SystemInfoChanged_Trampoline;
+    void __declspec(naked) CL_SystemInfoChanged_Hook()
+    {
+        __asm pushad
+
+        InvalidateDvars();
+
+        __asm popad
+        __asm jmp CL_SystemInfoChanged_Trampoline
+    }
+
+    uintptr_t CL_SystemInfoChangedCoD4X_Trampoline;
+    void __declspec(naked) CL_SystemInfoChangedCoD4X_Hook()
+    {
+        __asm pushad
+
+        InvalidateDvars();
+
+        __asm popad
+        __asm jmp CL_SystemInfoChangedCoD4X_Trampoline
+    }
+
+    void Install()
+    {
+        HookManager::CreateHook(GetGameAddresses().CL_Vid_Restart_f(), (uintptr_t)CL_Vid_Restart_f_Hook,
+                                (uintptr_t*)&CL_Vid_Restart_f_Trampoline);
+        HookManager::CreateHook(GetGameAddresses().CL_SystemInfoChanged(), (uintptr_t)CL_SystemInfoChanged_Hook,
+                                &CL_SystemInfoChanged_Trampoline);
+
+        // only found when the CoD4X client module is loaded
+        if (GetGameAddresses().CL_SystemInfoChangedCoD4X())
+        {
+            HookManager::CreateHook(GetGameAddresses().CL_SystemInfoChangedCoD4X(),
+                                    (uintptr_t)CL_SystemInfoChangedCoD4X_Hook, &CL_SystemInfoChangedCoD4X_Trampoline);
+        }
+    }
+}  // namespace IWXMVM::IW3::Hooks::Dvars
@@ -0,0 +1,6 @@
+#pragma once
+
+namespace IWXMVM::IW3::Hooks::Dvars
+{
+    void Install();
+}  // namespace IWXMVM::IW3::Hooks::Dvars
@@ -3,6 +3,7 @@
 
 #include "Components/Playback.hpp"
 #include "Components/Rewinding.hpp"
+#include "Utilities/FrameProfiler.hpp"
 #include "Utilities/HookManager.hpp"
 #include "Events.hpp"
 #include "../Addresses.hpp"
@@ -14,6 +15,7 @@ namespace IWXMVM::IW3::Hooks::Playback
 {
     void SV_Frame_Internal(std::int32_t& msec)
     {
+        IWXMVM_PROFILE_ZONE("SV_Frame_Internal");
         msec = Components::Playback::CalculatePlaybackDelta(msec);
     }
 
@@ -56,6 +58,7 @@ namespace IWXMVM::IW3::Hooks::Playback
     FS_Read_t FS_Read_Trampoline;
     int FS_Read_Hook(void* buffer, int len, int f)
     {
+        IWXMVM_PROFILE_ZONE("FS_Read");
         using namespace Structures;
         fileHandleData_t fh =
             *reinterpret_cast<fileHandleData_t*>(GetGameAddresses().fsh() + f * sizeof(fileHandleData_t));
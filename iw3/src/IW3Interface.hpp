@@ -11,6 +11,7 @@
 #include "Hooks/Playback.hpp"
 #include "Hooks/HUD.hpp"
 #include "Addresses.hpp"
+#include "Dvars.hpp"
 #include "Patches.hpp"
 #include "Components/Rewinding.hpp"
 
@@ -77,10 +78,9 @@ namespace IWXMVM::IW3
         {
             // disable raw_input because it messes with our IN_Frame patch
             // on cod4x
-            auto raw_input = Functions::FindDvar("raw_input");
-            if (raw_input)
+            if (auto raw_input = GetDvars().raw_input.Get())
             {
-                raw_input->current.enabled = false;
+                *raw_input = false;
             }
         }
 
@@ -88,17 +88,23 @@ namespace IWXMVM::IW3
         {
             DisableRawInput();
 
-            Events::RegisterListener(EventType::PostDemoLoad, DemoParser::Run);
+            Events::RegisterListener<EventType::PostDemoLoad>("DemoParser", DemoParser::Run);
+            // before anyone else asks for the demo info
+            Events::RegisterListener<EventType::OnDemoBoundsDetermined>(
+                "IW3Interface",
+                [&](const Events::DemoBounds& bounds) { demoInfo.endTick = bounds.endTick - bounds.startTick; },
+                Events::ListenerPriority::First);
 
-            Events::RegisterListener(EventType::OnCameraChanged, Hooks::Camera::OnCameraChanged);
+            Events::RegisterListener<EventType::OnCameraChanged>("CameraHooks", Hooks::Camera::OnCameraChanged);
 
-            Events::RegisterListener(EventType::PostDemoLoad, [&]() { 
-                Functions::FindDvar("sv_cheats")->current.enabled = true; 
+            Events::RegisterListener<EventType::PostDemoLoad>("IW3Interface", [&]() { 
+                auto& dvars = GetDvars();
+                dvars.sv_cheats.Set(true);
                 DisableRawInput();
                     
                 // ensure these are set to their defaults, so our killfeed toggle works properly
-                Functions::FindDvar("con_gamemsgwindow0msgtime")->current.value = 5;
-                Functions::FindDvar("con_gamemsgwindow0linecount")->current.integer = 4;
+                dvars.con_gamemsgwindow0msgtime.Set(5);
+                dvars.con_gamemsgwindow0linecount.Set(4);
             });
         }
 
@@ -122,7 +128,8 @@ namespace IWXMVM::IW3
 
         Types::GameState GetGameState() final
         {
-            if (!Functions::FindDvar("cl_ingame")->current.enabled)
+            const auto inGame = GetDvars().cl_ingame.Get();
+            if (!inGame || !*inGame)
                 return Types::GameState::MainMenu;
 
             if (Structures::GetClientConnection()->demoplaying)
@@ -211,29 +218,54 @@ namespace IWXMVM::IW3
             }
         }
 
-        Types::DemoInfo demoInfo;
+        static constexpr auto MISSING_DEMO_PATH_RETRY_INTERVAL = std::chrono::seconds(1);
 
-        Types::DemoInfo GetDemoInfo() final
+        Types::DemoInfo demoInfo = {};
+        std::string demoServerName;  // what the demo info was last built from
+        std::chrono::steady_clock::time_point demoPathRetryTime;
+        std::uint32_t demoTick = 0;
+
+        // the end tick is set once the demo's bounds were determined
+        const Types::DemoInfo& GetDemoInfo() final
         {
-            demoInfo.name = Structures::GetClientStatic()->servername;
-            demoInfo.name = demoInfo.name.starts_with(DEMO_TEMP_DIRECTORY)
-                                ? demoInfo.name.substr(strlen(DEMO_TEMP_DIRECTORY) + 1)
-                                : demoInfo.name;
+            // the name and the path only change along with the demo that is played
+            const char* serverName = Structures::GetClientStatic()->servername;
+            const bool isDemoChanged = demoServerName != serverName;
+            if (isDemoChanged)
+            {
+                demoServerName = serverName;
+
+                demoInfo.name = demoServerName.starts_with(DEMO_TEMP_DIRECTORY)
+                                    ? demoServerName.substr(strlen(DEMO_TEMP_DIRECTORY) + 1)
+                                    : demoServerName;
+            }
 
-            std::string str = static_cast<std::string>(Structures::GetClientStatic()->servername);
-            str += (str.ends_with(".dm_1")) ? "" : ".dm_1";
-            demoInfo.path = Functions::GetFilePath(std::move(str));
+            // The path is found by looking for the demo in every search path. A demo outside of them, or a server name
+            // that isn't a demo at all, is never found, so that is only tried again once per second and not per frame.
+            if (isDemoChanged || (demoInfo.path.empty() && !demoServerName.empty() &&
+                                  std::chrono::steady_clock::now() >= demoPathRetryTime))
+            {
+                demoPathRetryTime = std::chrono::steady_clock::now() + MISSING_DEMO_PATH_RETRY_INTERVAL;
+
+                std::string str = demoServerName;
+                str += (str.ends_with(".dm_1")) ? "" : ".dm_1";
+                demoInfo.path = Functions::GetFilePath(std::move(str));
+            }
 
+            return demoInfo;
+        }
+
+        std::uint32_t GetDemoTick() final
+        {
             auto [demoStartTick, demoEndTick] = DemoParser::GetDemoTickRange();
 
             const auto serverTime = Structures::GetClientActive()->serverTime;
             if (serverTime > demoStartTick && serverTime < demoEndTick && !Components::Rewinding::IsRewinding())
             {
-                demoInfo.gameTick = serverTime - demoStartTick;
+                demoTick = serverTime - demoStartTick;
             }
-            demoInfo.endTick = demoEndTick - demoStartTick;
 
-            return demoInfo;
+            return demoTick;
         }
 
         std::string_view GetDemoExtension() final
@@ -243,7 +275,7 @@ namespace IWXMVM::IW3
 
         void PlayDemo(std::filesystem::path demoPath) final
         {
-            Events::Invoke(EventType::PreDemoLoad);
+            Events::Invoke<EventType::PreDemoLoad>(demoPath);
             
             const auto demoDirectory =
                 std::filesystem::path(GetDvar("fs_basepath")->value->string) / "players" / "demos";
@@ -294,47 +326,42 @@ namespace IWXMVM::IW3
             Types::Dvar dvar;
             dvar.name = iw3Dvar->name;
             dvar.value = (Types::Dvar::Value*)&iw3Dvar->current;
+            dvar.modified = &iw3Dvar->modified;
 
             return dvar;
         }
 
         void SetFov(float fov) final
         {
-            Functions::FindDvar("cg_fov")->current.value = fov;
+            GetDvars().cg_fov.Set(fov);
         }
 
         Types::Sun GetSun() final
         {
-            const auto& r_lightTweakSunDirection = Functions::FindDvar("r_lightTweakSunDirection");
-            const auto& r_lightTweakSunColor = Functions::FindDvar("r_lightTweakSunColor");
-            const auto& r_lightTweakSunLight = Functions::FindDvar("r_lightTweakSunLight");
+            auto& dvars = GetDvars();
 
-            auto unpackedColor = glm::unpackUint4x8(r_lightTweakSunColor->current.integer);
+            auto unpackedColor = glm::unpackUint4x8(dvars.r_lightTweakSunColor.Value());
 
             Types::Sun sun;
             sun.color = glm::vec3(unpackedColor.x / 255.0f, unpackedColor.y / 255.0f, unpackedColor.z / 255.0f);
-            sun.direction = glm::vec3(
-                r_lightTweakSunDirection->current.vector[0], 
-                r_lightTweakSunDirection->current.vector[1],
-                r_lightTweakSunDirection->current.vector[2]
-            );
-            sun.brightness = Functions::FindDvar("r_lightTweakSunLight")->current.value;
+            sun.direction = glm::vec3(dvars.r_lightTweakSunDirection.Value());
+            sun.brightness = dvars.r_lightTweakSunLight.Value();
             return sun;
         }
 
         Types::DoF GetDof()
         {
+            auto& dvars = GetDvars();
             Types::DoF dof = 
             {
-                Functions::FindDvar("r_dof_tweak")->current.enabled &&
-                    Functions::FindDvar("r_dof_enable")->current.enabled,
-                Functions::FindDvar("r_dof_farBlur")->current.value,
-                Functions::FindDvar("r_dof_farStart")->current.value,
-                Functions::FindDvar("r_dof_farEnd")->current.value,
-                Functions::FindDvar("r_dof_nearBlur")->current.value,
-                Functions::FindDvar("r_dof_nearStart")->current.value,
-                Functions::FindDvar("r_dof_nearEnd")->current.value,
-                Functions::FindDvar("r_dof_bias")->current.value
+                dvars.r_dof_tweak.Value() && dvars.r_dof_enable.Value(),
+                dvars.r_dof_farBlur.Value(),
+                dvars.r_dof_farStart.Value(),
+                dvars.r_dof_farEnd.Value(),
+                dvars.r_dof_nearBlur.Value(),
+                dvars.r_dof_nearStart.Value(),
+                dvars.r_dof_nearEnd.Value(),
+                dvars.r_dof_bias.Value()
             };
 
             return dof;
@@ -342,15 +369,15 @@ namespace IWXMVM::IW3
 
         Types::Filmtweaks GetFilmtweaks()
         {
+            auto& dvars = GetDvars();
             Types::Filmtweaks filmtweaks = {
-                Functions::FindDvar("r_filmUseTweaks")->current.enabled &&
-                    Functions::FindDvar("r_filmTweakEnable")->current.enabled,
-                Functions::FindDvar("r_filmTweakBrightness")->current.value,
-                Functions::FindDvar("r_filmTweakContrast")->current.value,
-                Functions::FindDvar("r_filmTweakDesaturation")->current.value,
-                glm::make_vec3(Functions::FindDvar("r_filmTweakLightTint")->current.vector),
-                glm::make_vec3(Functions::FindDvar("r_filmTweakDarkTint")->current.vector),
-                Functions::FindDvar("r_filmTweakInvert")->current.enabled
+                dvars.r_filmUseTweaks.Value() && dvars.r_filmTweakEnable.Value(),
+                dvars.r_filmTweakBrightness.Value(),
+                dvars.r_filmTweakContrast.Value(),
+                dvars.r_filmTweakDesaturation.Value(),
+                glm::vec3(dvars.r_filmTweakLightTint.Value()),
+                glm::vec3(dvars.r_filmTweakDarkTint.Value()),
+                dvars.r_filmTweakInvert.Value()
             };
 
             return filmtweaks;
@@ -358,23 +385,25 @@ namespace IWXMVM::IW3
 
         Types::HudInfo GetHudInfo()
         {
+            auto& dvars = GetDvars();
+
             glm::vec3 teamColorAllies;
-            auto ss = std::stringstream(Functions::FindDvar("g_TeamColor_Allies")->current.string);
+            auto ss = std::stringstream(dvars.g_TeamColor_Allies.Value());
             ss >> teamColorAllies[0] >> teamColorAllies[1] >> teamColorAllies[2];
             
             glm::vec3 teamColorAxis;
-            ss = std::stringstream(Functions::FindDvar("g_TeamColor_Axis")->current.string);
+            ss = std::stringstream(dvars.g_TeamColor_Axis.Value());
             ss >> teamColorAxis[0] >> teamColorAxis[1] >> teamColorAxis[2];
 
             Types::HudInfo hudInfo = {
-                Functions::FindDvar("cg_draw2D")->current.enabled,
-                !Functions::FindDvar("ui_hud_hardcore")->current.enabled,
-                Functions::FindDvar("cg_drawShellshock")->current.enabled,
-                Functions::FindDvar("ui_drawCrosshair")->current.enabled, 
+                dvars.cg_draw2D.Value(),
+                !dvars.ui_hud_hardcore.Value(),
+                dvars.cg_drawShellshock.Value(),
+                dvars.ui_drawCrosshair.Value(), 
                 Hooks::HUD::showScore,
                 Hooks::HUD::showOtherText, 
                 !Patches::GetGamePatches().CG_DrawPlayerLowHealthOverlay.IsApplied(),
-                Functions::FindDvar("ui_hud_obituaries")->current.string[0] == '1',
+                dvars.ui_hud_obituaries.Value()[0] == '1',
                 teamColorAllies,   
                 teamColorAxis
             };
@@ -384,32 +413,31 @@ namespace IWXMVM::IW3
 
         void SetSun(Types::Sun sun) final
         {
-            const auto& r_lightTweakSunDirection = Functions::FindDvar("r_lightTweakSunDirection");
-            const auto& r_lightTweakSunColor = Functions::FindDvar("r_lightTweakSunColor");
-            const auto& r_lightTweakSunLight = Functions::FindDvar("r_lightTweakSunLight");
+            auto& dvars = GetDvars();
             auto packedColor = glm::packUint4x8(glm::i8vec4(static_cast<uint8_t>(sun.color.x * 255),
                                                            static_cast<uint8_t>(sun.color.y * 255),
                                                            static_cast<uint8_t>(sun.color.z * 255), 1));
             for (int i = 0; i < 3; ++i)
             {
-                r_lightTweakSunDirection->current.vector[i] = sun.direction[i];
+                dvars.r_lightTweakSunDirection.Value()[i] = sun.direction[i];
             }
-            r_lightTweakSunColor->current.integer = packedColor;
-            r_lightTweakSunLight->current.value = sun.brightness;
+            dvars.r_lightTweakSunColor.Set(packedColor);
+            dvars.r_lightTweakSunLight.Set(sun.brightness);
 
-            r_lightTweakSunDirection->modified = true;
-            r_lightTweakSunColor->modified = true;
-            r_lightTweakSunLight->modified = true;
+            dvars.r_lightTweakSunDirection.MarkModified();
+            dvars.r_lightTweakSunColor.MarkModified();
+            dvars.r_lightTweakSunLight.MarkModified();
         }
 
         void SetDof(Types::DoF dof) final
         {
-            Functions::FindDvar("r_dof_tweak")->current.enabled = dof.enabled;
-            Functions::FindDvar("r_dof_enable")->current.enabled = dof.enabled;
+            auto& dvars = GetDvars();
+            dvars.r_dof_tweak.Set(dof.enabled);
+            dvars.r_dof_enable.Set(dof.enabled);
             
-            Functions::FindDvar("r_dof_farBlur")->current.value = dof.farBlur;
-            Functions::FindDvar("r_dof_farStart")->current.value = dof.farStart;
-            Functions::FindDvar("r_dof_farEnd")->current.value = dof.farEnd;
+            dvars.r_dof_farBlur.Set(dof.farBlur);
+            dvars.r_dof_farStart.Set(dof.farStart);
+            dvars.r_dof_farEnd.Set(dof.farEnd);
             
             // hacky workaround because nearblur works weirdly in this game
             if (dof.nearBlur < 1.3f)
@@ -419,45 +447,46 @@ namespace IWXMVM::IW3
                 dof.nearEnd = 0;
             }
 
-            Functions::FindDvar("r_dof_nearBlur")->current.value = dof.nearBlur;
-            Functions::FindDvar("r_dof_nearStart")->current.value = dof.nearStart;
-            Functions::FindDvar("r_dof_nearEnd")->current.value = dof.nearEnd;
+            dvars.r_dof_nearBlur.Set(dof.nearBlur);
+            dvars.r_dof_nearStart.Set(dof.nearStart);
+            dvars.r_dof_nearEnd.Set(dof.nearEnd);
 
-            Functions::FindDvar("r_dof_bias")->current.value = dof.bias;
+            dvars.r_dof_bias.Set(dof.bias);
         }
 
         void SetFilmtweaks(Types::Filmtweaks filmtweaks) final
         {
-            Functions::FindDvar("r_filmUseTweaks")->current.enabled = filmtweaks.enabled;
-            Functions::FindDvar("r_filmTweakEnable")->current.enabled = filmtweaks.enabled;
-            Functions::FindDvar("r_filmTweakBrightness")->current.value = filmtweaks.brightness;
-            Functions::FindDvar("r_filmTweakContrast")->current.value = filmtweaks.contrast;
-            Functions::FindDvar("r_filmTweakDesaturation")->current.value = filmtweaks.desaturation;
+            auto& dvars = GetDvars();
+            dvars.r_filmUseTweaks.Set(filmtweaks.enabled);
+            dvars.r_filmTweakEnable.Set(filmtweaks.enabled);
+            dvars.r_filmTweakBrightness.Set(filmtweaks.brightness);
+            dvars.r_filmTweakContrast.Set(filmtweaks.contrast);
+            dvars.r_filmTweakDesaturation.Set(filmtweaks.desaturation);
             for (int i = 0; i < 3; ++i)
             {
-                Functions::FindDvar("r_filmTweakLightTint")->current.vector[i] =
-                    glm::value_ptr(filmtweaks.tintLight)[i];
-                Functions::FindDvar("r_filmTweakDarkTint")->current.vector[i] = glm::value_ptr(filmtweaks.tintDark)[i];
+                dvars.r_filmTweakLightTint.Value()[i] = filmtweaks.tintLight[i];
+                dvars.r_filmTweakDarkTint.Value()[i] = filmtweaks.tintDark[i];
             }
-            Functions::FindDvar("r_filmTweakInvert")->current.enabled = filmtweaks.invert;
+            dvars.r_filmTweakInvert.Set(filmtweaks.invert);
         }
 
         void SetHudInfo(Types::HudInfo hudInfo) final
         {
-            Functions::FindDvar("con_gamemsgwindow0msgtime")->current.value = 5;
-            Functions::FindDvar("con_gamemsgwindow0linecount")->current.integer = 4;
+            auto& dvars = GetDvars();
+            dvars.con_gamemsgwindow0msgtime.Set(5);
+            dvars.con_gamemsgwindow0linecount.Set(4);
 
-            Functions::FindDvar("cg_draw2D")->current.enabled = hudInfo.show2DElements;
+            dvars.cg_draw2D.Set(hudInfo.show2DElements);
 
-            Functions::FindDvar("ui_hud_hardcore")->current.enabled = !hudInfo.showPlayerHUD;
-            Functions::FindDvar("cg_centertime")->current.value = hudInfo.showPlayerHUD ? 5.0f : 0.0f;
-            Functions::FindDvar("cg_overheadranksize")->current.value = hudInfo.showPlayerHUD ? 0.5f : 0;
-            Functions::FindDvar("cg_overheadnamessize")->current.value = hudInfo.showPlayerHUD ? 0.5f : 0;
-            Functions::FindDvar("cg_overheadiconsize")->current.value = hudInfo.showPlayerHUD ? 0.7f : 0;
+            dvars.ui_hud_hardcore.Set(!hudInfo.showPlayerHUD);
+            dvars.cg_centertime.Set(hudInfo.showPlayerHUD ? 5.0f : 0.0f);
+            dvars.cg_overheadranksize.Set(hudInfo.showPlayerHUD ? 0.5f : 0);
+            dvars.cg_overheadnamessize.Set(hudInfo.showPlayerHUD ? 0.5f : 0);
+            dvars.cg_overheadiconsize.Set(hudInfo.showPlayerHUD ? 0.7f : 0);
 
-            Functions::FindDvar("cg_drawShellshock")->current.enabled = hudInfo.showShellshock;
-            Functions::FindDvar("ui_hud_obituaries")->current.string = hudInfo.showKillfeed ? "1" : "0";
-            Functions::FindDvar("ui_drawCrosshair")->current.enabled = hudInfo.showCrosshair;
+            dvars.cg_drawShellshock.Set(hudInfo.showShellshock);
+            dvars.ui_hud_obituaries.Set(hudInfo.showKillfeed ? "1" : "0");
+            dvars.ui_drawCrosshair.Set(hudInfo.showCrosshair);
             Hooks::HUD::showScore = hudInfo.showScore;
             Hooks::HUD::showOtherText = hudInfo.showOtherText;
             if (hudInfo.showBloodOverlay)
@@ -501,16 +530,18 @@ namespace IWXMVM::IW3
                 }
             };
 
+            entities.reserve(256);
             for (int i = 0; i < 256; i++)
             {
-                auto entity = cg_entities[i];
+                const auto& entity = cg_entities[i];
                 entities.push_back(
                     Types::Entity
                     {
                         .id = i, 
                         .type = ToEntityType(entity.pose.eType),
                         .clientNum = entity.nextState.clientNum,
-                        .isValid = entity.nextValid
+                        .isValid = entity.nextValid,
+                        .origin = glm::make_vec3(entity.pose.origin)
                     }
                 );
             }
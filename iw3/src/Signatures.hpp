@@ -9,6 +9,12 @@ namespace IWXMVM::IW3::Signatures
 #define Sig IWXMVM::Signatures::Signature < IWXMVM::Signatures::SignatureImpl
 #define Lambda IWXMVM::Signatures::Lambdas
 
+        // the members below only register their signatures, so that the modules are scanned once for all of them
+        IW3Addresses()
+        {
+            IWXMVM::Signatures::ResolvePendingSignatures();
+        }
+
         using GAType = IWXMVM::Signatures::GameAddressType;
 
         Sig("51 8D 90 ?? ?? ?? ?? 52 50 E8 ?? ?? ?? ?? 68 ?? ?? ?? ?? 57", GAType::Code, 20,